@@ -419,6 +419,7 @@ public:
 	bool endOfData() const { return _parentStream->endOfData() || _samplesRead >= _totalSamples; }
 	bool isStereo() const { return _parentStream->isStereo(); }
 	int getRate() const { return _parentStream->getRate(); }
+	bool isCompressedOrFileBacked() const { return _parentStream->isCompressedOrFileBacked(); }
 
 private:
 	int getChannels() const { return isStereo() ? 2 : 1; }
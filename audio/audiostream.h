@@ -79,6 +79,14 @@ public:
 	 * By default this maps to endOfData()
 	 */
 	virtual bool endOfStream() const { return endOfData(); }
+
+	/**
+	 * Does reading from this stream decode compressed data, or read the
+	 * data from a file? Only such streams are worth decoding ahead of time,
+	 * see makeDecodeAheadStream(). By default this returns false, which
+	 * fits streams generated on the fly or read from memory.
+	 */
+	virtual bool isCompressedOrFileBacked() const { return false; }
 };
 
 /**
@@ -121,6 +129,7 @@ public:
 
 	bool isStereo() const { return _parent->isStereo(); }
 	int getRate() const { return _parent->getRate(); }
+	bool isCompressedOrFileBacked() const { return _parent->isCompressedOrFileBacked(); }
 
 	/**
 	 * Returns number of loops the stream has played.
@@ -251,6 +260,7 @@ public:
 
 	bool isStereo() const { return _parent->isStereo(); }
 	int getRate() const { return _parent->getRate(); }
+	bool isCompressedOrFileBacked() const { return _parent->isCompressedOrFileBacked(); }
 private:
 	Common::DisposablePtr<SeekableAudioStream> _parent;
 
@@ -289,6 +299,8 @@ public:
 
 	bool endOfData() const { return (_pos >= _length) || _parent->endOfStream(); }
 
+	bool isCompressedOrFileBacked() const { return _parent->isCompressedOrFileBacked(); }
+
 	bool seek(const Timestamp &where);
 
 	Timestamp getLength() const { return _length; }
@@ -0,0 +1,239 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/decodeahead.h"
+#include "audio/audiostream.h"
+
+#include "common/atomic.h"
+#include "common/ptr.h"
+#include "common/util.h"
+#include "common/workerpool.h"
+
+namespace Audio {
+
+/**
+ * The ring buffer and the parent stream. The worker runs this as its job,
+ * so it is handed over to WorkerPool::dispose() when the stream is deleted:
+ * if the worker is decoding at that moment, it deletes the buffer (and the
+ * parent) once it is done, and the deleting thread does not wait for it.
+ */
+class DecodeAheadBuffer : public Common::WorkerJob {
+public:
+	DecodeAheadBuffer(AudioStream *parent, DisposeAfterUse::Flag disposeAfterUse, Common::WorkerPool &pool);
+	~DecodeAheadBuffer();
+
+	void run() { refill(); }
+
+	int readBuffer(int16 *buffer, const int numSamples);
+	bool endOfData() const;
+	bool endOfStream() const;
+
+private:
+	enum {
+		/** Size of the ring buffer in samples, must be a power of two. */
+		kBufferSize = 16384,
+		/** The ring buffer is refilled once less samples are buffered. */
+		kLowWaterMark = kBufferSize / 2,
+		/** Number of samples decoded at once. */
+		kChunkSize = 2048
+	};
+
+	/**
+	 * Only one thread at a time may read from the parent stream. Neither
+	 * thread ever waits for the other: the worker tries again later, and
+	 * the reading thread, which must not block the audio callback, returns
+	 * what is buffered.
+	 */
+	bool tryLockParent() const { return Common::atomicCompareAndSwap(&_parentLocked, 0, 1); }
+	void unlockParent() const { Common::atomicStore(&_parentLocked, 0); }
+
+	/**
+	 * Decode up to numSamples into the ring buffer, the parent must be locked.
+	 * @return the number of samples decoded
+	 */
+	uint32 decode(uint32 numSamples);
+	void updateParentState() const;
+	void refill();
+
+	uint32 buffered() const { return (uint32)Common::atomicLoad(&_writePos) - (uint32)Common::atomicLoad(&_readPos); }
+
+	Common::DisposablePtr<AudioStream> _parent;
+	Common::WorkerPool &_pool;
+
+	int16 *_buffer;
+	/** Total number of samples read and written, wrapping around. */
+	volatile int32 _readPos, _writePos;
+
+	mutable volatile int32 _parentLocked;
+	mutable volatile int32 _parentEndOfData, _parentEndOfStream;
+};
+
+class DecodeAheadStream : public AudioStream {
+public:
+	DecodeAheadStream(AudioStream *parent, DisposeAfterUse::Flag disposeAfterUse, Common::WorkerPool &pool);
+	~DecodeAheadStream();
+
+	int readBuffer(int16 *buffer, const int numSamples) { return _buffer->readBuffer(buffer, numSamples); }
+
+	bool isStereo() const { return _isStereo; }
+	int getRate() const { return _rate; }
+
+	bool endOfData() const { return _buffer->endOfData(); }
+	bool endOfStream() const { return _buffer->endOfStream(); }
+
+private:
+	Common::WorkerPool &_pool;
+	DecodeAheadBuffer *_buffer;
+
+	const bool _isStereo;
+	const int _rate;
+};
+
+DecodeAheadStream::DecodeAheadStream(AudioStream *parent, DisposeAfterUse::Flag disposeAfterUse, Common::WorkerPool &pool)
+	: _pool(pool), _isStereo(parent->isStereo()), _rate(parent->getRate()) {
+	_buffer = new DecodeAheadBuffer(parent, disposeAfterUse, pool);
+}
+
+DecodeAheadStream::~DecodeAheadStream() {
+	_pool.dispose(_buffer);
+}
+
+DecodeAheadBuffer::DecodeAheadBuffer(AudioStream *parent, DisposeAfterUse::Flag disposeAfterUse, Common::WorkerPool &pool)
+	: _parent(parent, disposeAfterUse), _pool(pool),
+	  _readPos(0), _writePos(0), _parentLocked(0), _parentEndOfData(0), _parentEndOfStream(0) {
+	_buffer = new int16[kBufferSize];
+	updateParentState();
+
+	// Have some data ready before the stream is read for the first time
+	_pool.schedule(this);
+}
+
+DecodeAheadBuffer::~DecodeAheadBuffer() {
+	delete[] _buffer;
+}
+
+int DecodeAheadBuffer::readBuffer(int16 *buffer, const int numSamples) {
+	int samples = 0;
+
+	while (samples < numSamples) {
+		uint32 available = buffered();
+
+		if (!available) {
+			// Underflow, decode what is missing ourselves. If the worker is
+			// decoding right now, its data arrives in time for the next
+			// callback, so the rest of this one stays silent.
+			if (!tryLockParent())
+				break;
+			if (!buffered())
+				decode(MIN<uint32>(numSamples - samples, kChunkSize));
+			unlockParent();
+
+			available = buffered();
+			if (!available)
+				break;
+		}
+
+		const uint32 readPos = (uint32)_readPos;
+		const uint32 offset = readPos & (kBufferSize - 1);
+		const uint32 len = MIN<uint32>(MIN<uint32>(available, numSamples - samples), kBufferSize - offset);
+
+		memcpy(buffer + samples, _buffer + offset, len * sizeof(int16));
+		samples += len;
+		Common::atomicStore(&_readPos, (int32)(readPos + len));
+	}
+
+	if (buffered() < kLowWaterMark && !_parentEndOfData && !isPending())
+		_pool.schedule(this);
+
+	return samples;
+}
+
+bool DecodeAheadBuffer::endOfData() const {
+	if (buffered())
+		return false;
+
+	// The parent might have received new data since we last looked (e.g.
+	// a QueuingAudioStream), so check again. If the worker is busy with
+	// the parent, more data is on its way anyway.
+	if (_parentEndOfData && tryLockParent()) {
+		updateParentState();
+		unlockParent();
+	}
+
+	return _parentEndOfData;
+}
+
+bool DecodeAheadBuffer::endOfStream() const {
+	return endOfData() && _parentEndOfStream;
+}
+
+uint32 DecodeAheadBuffer::decode(uint32 numSamples) {
+	const uint32 startPos = (uint32)_writePos;
+	uint32 writePos = startPos;
+	numSamples = MIN<uint32>(numSamples, kBufferSize - buffered());
+
+	while (numSamples > 0) {
+		const uint32 offset = writePos & (kBufferSize - 1);
+		const uint32 len = MIN<uint32>(numSamples, kBufferSize - offset);
+
+		const int decoded = _parent->readBuffer(_buffer + offset, len);
+		if (decoded <= 0)
+			break;
+
+		writePos += decoded;
+		numSamples -= decoded;
+		Common::atomicStore(&_writePos, (int32)writePos);
+
+		if ((uint32)decoded < len)
+			break;
+	}
+
+	updateParentState();
+	return writePos - startPos;
+}
+
+void DecodeAheadBuffer::updateParentState() const {
+	Common::atomicStore(&_parentEndOfData, _parent->endOfData());
+	Common::atomicStore(&_parentEndOfStream, _parent->endOfStream());
+}
+
+void DecodeAheadBuffer::refill() {
+	// Release the parent after each chunk, so that a reader running out of
+	// data never has to wait for more than one chunk.
+	while (kBufferSize - buffered() >= kChunkSize && !_parentEndOfData) {
+		if (!tryLockParent())
+			return;
+
+		const uint32 decoded = decode(kChunkSize);
+		unlockParent();
+
+		// Nothing available right now, try again once the buffer is read
+		if (!decoded)
+			break;
+	}
+}
+
+AudioStream *makeDecodeAheadStream(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, Common::WorkerPool &pool) {
+	return new DecodeAheadStream(stream, disposeAfterUse, pool);
+}
+
+} // End of namespace Audio
@@ -0,0 +1,65 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_DECODEAHEAD_H
+#define AUDIO_DECODEAHEAD_H
+
+#include "common/scummsys.h"
+#include "common/types.h"
+
+namespace Common {
+class WorkerPool;
+}
+
+namespace Audio {
+
+class AudioStream;
+
+/**
+ * Wrap a stream so that its data is decoded ahead of time by the given
+ * worker pool into a ring buffer, moving the decoding work off the thread
+ * which reads from the returned stream (usually the audio callback).
+ *
+ * The ring buffer is refilled whenever it drops below half its size. If it
+ * runs empty anyway, the missing data is decoded by the reading thread. The
+ * reading thread never waits for the worker, though: if the worker is
+ * decoding at that moment, readBuffer() returns fewer samples instead.
+ *
+ * Only streams for which AudioStream::isCompressedOrFileBacked() is true
+ * are worth wrapping. For other streams, the ring buffer only adds latency.
+ *
+ * Note that the wrapped stream is read ahead by up to the size of the ring
+ * buffer, so it must not be manipulated (e.g. seeked) directly while the
+ * returned stream is in use. Deleting the returned stream never waits for
+ * the worker either: if the worker is decoding at that moment, it deletes
+ * the wrapped stream (when disposeAfterUse is YES) once it is done.
+ *
+ * @param stream           the stream to decode ahead
+ * @param disposeAfterUse  whether to delete the stream along with the wrapper
+ * @param pool             the worker pool doing the decoding
+ * @return a new AudioStream reading from the ring buffer
+ */
+AudioStream *makeDecodeAheadStream(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, Common::WorkerPool &pool);
+
+} // End of namespace Audio
+
+#endif
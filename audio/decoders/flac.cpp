@@ -136,6 +136,7 @@ public:
 		// or if we reached the last sample and completely emptied the sample cache.
 		return _streaminfo.channels == 0 || (_lastSampleWritten && _sampleCache.bufFill == 0);
 	}
+	bool isCompressedOrFileBacked() const { return true; }
 
 	bool seek(const Timestamp &where);
 	Timestamp getLength() const { return _length; }
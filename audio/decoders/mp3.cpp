@@ -82,6 +82,7 @@ public:
 	bool endOfData() const		{ return _state == MP3_STATE_EOS; }
 	bool isStereo() const		{ return MAD_NCHANNELS(&_frame.header) == 2; }
 	int getRate() const			{ return _frame.header.samplerate; }
+	bool isCompressedOrFileBacked() const	{ return true; }
 
 	bool seek(const Timestamp &where);
 	Timestamp getLength() const { return _length; }
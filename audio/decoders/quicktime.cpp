@@ -94,6 +94,7 @@ public:
 	bool endOfData() const { return _parentStream->endOfData(); }
 	bool isStereo() const { return false; }
 	int getRate() const { return _parentStream->getRate(); }
+	bool isCompressedOrFileBacked() const { return _parentStream->isCompressedOrFileBacked(); }
 
 private:
 	AudioStream *_parentStream;
@@ -689,6 +690,7 @@ public:
 	bool isStereo() const { return _audioTracks[0]->isStereo(); }
 	int getRate() const { return _audioTracks[0]->getRate(); }
 	bool endOfData() const { return _audioTracks[0]->endOfData(); }
+	bool isCompressedOrFileBacked() const { return true; }
 
 	// SeekableAudioStream API
 	bool seek(const Timestamp &where) { return _audioTracks[0]->seek(where); }
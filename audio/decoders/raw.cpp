@@ -71,6 +71,8 @@ public:
 	int getRate() const         { return _rate; }
 	Timestamp getLength() const { return _playtime; }
 
+	bool isCompressedOrFileBacked() const { return !_stream->getData(); }
+
 	bool seek(const Timestamp &where);
 private:
 	const int _rate;                                           ///< Sample rate of stream
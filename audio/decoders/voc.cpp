@@ -87,6 +87,8 @@ public:
 
 	virtual bool endOfData() const { return (_curBlock == _blocks.end()) && (_blockLeft == 0); }
 
+	virtual bool isCompressedOrFileBacked() const { return !_stream->getData(); }
+
 	virtual bool seek(const Timestamp &where);
 
 	virtual Timestamp getLength() const { return _length; }
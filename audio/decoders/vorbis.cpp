@@ -113,6 +113,7 @@ public:
 	bool endOfData() const		{ return _pos >= _bufferEnd; }
 	bool isStereo() const		{ return _isStereo; }
 	int getRate() const			{ return _rate; }
+	bool isCompressedOrFileBacked() const	{ return true; }
 
 	bool seek(const Timestamp &where);
 	Timestamp getLength() const { return _length; }
@@ -34,6 +34,7 @@ public:
 	bool isStereo() const { return false; }
 	bool endOfData() const { return _endOfData && _samplesRemaining == 0; }
 	int getRate() const { return _rate; }
+	bool isCompressedOrFileBacked() const { return true; }
 	int readBuffer(int16 *buffer, const int numSamples);
 
 	bool rewind();
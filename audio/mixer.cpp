@@ -22,12 +22,16 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/workerpool.h"
 
+#include "audio/decodeahead.h"
 #include "audio/mixer_intern.h"
 #include "audio/rate.h"
+#include "audio/rate_kernels.h"
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
 
@@ -44,7 +48,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateQuality quality, SincTableCache *sincTables);
 	~Channel();
 
 	/**
@@ -58,6 +62,12 @@ public:
 	 */
 	int mix(int16 *data, uint len);
 
+	/**
+	 * Same as above, but accumulates into a 32 bit mix bus. See
+	 * RateConverter::flow for the sample format.
+	 */
+	int mix(int32 *data, uint len);
+
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
@@ -123,9 +133,10 @@ public:
 	void notifyGlobalVolChange() { updateChannelVolumes(); }
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Returns the data needed to compute how long the channel has been
+	 * playing.
 	 */
-	Timestamp getElapsedTime();
+	ChannelTiming getTiming() const;
 
 	/**
 	 * Queries the channel's sound type.
@@ -157,6 +168,9 @@ private:
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
 
+	template<typename T>
+	int doMix(T *data, uint len);
+
 	Mixer *_mixer;
 
 	uint32 _samplesConsumed;
@@ -175,17 +189,44 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _commandMutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _commandReadPos(0), _commandWritePos(0), _decodePool(0), _useMixBus(false), _mixBus(0), _mixBusSize(0),
+	  _dither(false), _ditherSeed(1), _rateQuality(kRateQualityDefault) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_channelStates[i].handle = kFreeSlot;
+		_channelStates[i].timingSeq = 0;
+	}
+
+	if (ConfMan.getBool("decode_ahead")) {
+		_decodePool = new Common::WorkerPool(NUM_DECODE_THREADS);
+
+		// Without worker threads, decoding ahead would only add overhead
+		if (!_decodePool->isThreaded()) {
+			warning("MixerImpl: decode_ahead is not supported by this backend");
+			delete _decodePool;
+			_decodePool = 0;
+		}
+	}
+
+	_useMixBus = ConfMan.getBool("mix_bus_32bit");
+	_dither = _useMixBus && ConfMan.getBool("mix_dither");
+
+	_rateQuality = (RateQuality)CLIP<int>(ConfMan.getInt("resample_quality"), kRateQualityDefault, kRateQualityHigh);
 }
 
 MixerImpl::~MixerImpl() {
+	// Take over channels which were queued but never picked up
+	processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	delete _decodePool;
+	delete[] _mixBus;
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -199,7 +240,7 @@ uint MixerImpl::getOutputRate() const {
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
+		if (Common::atomicLoad(&_channelStates[i].handle) == kFreeSlot) {
 			index = i;
 			break;
 		}
@@ -210,17 +251,147 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
 	chan->setHandle(chanHandle);
 	_handleSeed++;
+
+	// Publish the slot right away, so that queries made before the mixing
+	// side picked up the channel already see it as playing.
+	ChannelState &state = _channelStates[index];
+	state.id = chan->getId();
+	state.type = chan->getType();
+	state.volume = chan->getVolume();
+	state.balance = chan->getBalance();
+	state.timing = ChannelTiming();
+	Common::atomicStore(&state.handle, (int32)chanHandle._val);
+
+	postCommand(kCommandPlay, chanHandle._val, -1, 0, chan);
+
 	if (handle)
 		*handle = chanHandle;
 }
 
+int MixerImpl::findChannelState(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (Common::atomicLoad(&_channelStates[index].handle) != (int32)handle._val)
+		return -1;
+	return index;
+}
+
+void MixerImpl::postCommand(CommandType type, uint32 handle, int id, int value, Channel *channel) {
+	const int32 writePos = _commandWritePos;
+	const int32 nextPos = (writePos + 1) % NUM_COMMANDS;
+
+	if (nextPos == Common::atomicLoad(&_commandReadPos)) {
+		// The queue is full, most likely because mixCallback() is not being
+		// called at the moment. Execute the pending commands ourselves.
+		Common::StackLock lock(_mutex);
+		processCommands();
+	}
+
+	Command &cmd = _commands[writePos];
+	cmd.type = type;
+	cmd.handle = handle;
+	cmd.id = id;
+	cmd.value = value;
+	cmd.channel = channel;
+
+	Common::atomicStore(&_commandWritePos, nextPos);
+}
+
+void MixerImpl::processCommands() {
+	int32 readPos = _commandReadPos;
+	const int32 writePos = Common::atomicLoad(&_commandWritePos);
+
+	while (readPos != writePos) {
+		executeCommand(_commands[readPos]);
+		readPos = (readPos + 1) % NUM_COMMANDS;
+	}
+
+	Common::atomicStore(&_commandReadPos, readPos);
+}
+
+void MixerImpl::executeCommand(const Command &cmd) {
+	Channel *chan;
+
+	switch (cmd.type) {
+	case kCommandPlay:
+		assert(!_channels[cmd.handle % NUM_CHANNELS]);
+		_channels[cmd.handle % NUM_CHANNELS] = cmd.channel;
+		break;
+
+	case kCommandPause:
+		// Simply ignore (un)pause requests for sounds that already terminated
+		chan = findChannel(cmd.handle);
+		if (chan) {
+			chan->pause(cmd.value != 0);
+			publishTiming(cmd.handle % NUM_CHANNELS);
+		}
+		break;
+
+	case kCommandPauseID:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == cmd.id) {
+				_channels[i]->pause(cmd.value != 0);
+				publishTiming(i);
+				break;
+			}
+		}
+		break;
+
+	case kCommandPauseAll:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0) {
+				_channels[i]->pause(cmd.value != 0);
+				publishTiming(i);
+			}
+		}
+		break;
+
+	case kCommandSetVolume:
+		chan = findChannel(cmd.handle);
+		if (chan)
+			chan->setVolume(cmd.value);
+		break;
+
+	case kCommandSetBalance:
+		chan = findChannel(cmd.handle);
+		if (chan)
+			chan->setBalance(cmd.value);
+		break;
+
+	case kCommandUpdateVolumes:
+		for (int i = 0; i != NUM_CHANNELS; ++i) {
+			if (_channels[i] && _channels[i]->getType() == cmd.value)
+				_channels[i]->notifyGlobalVolChange();
+		}
+		break;
+	}
+}
+
+Channel *MixerImpl::findChannel(uint32 handle) {
+	const int index = handle % NUM_CHANNELS;
+	if (!_channels[index] || _channels[index]->getHandle()._val != handle)
+		return 0;
+	return _channels[index];
+}
+
+void MixerImpl::freeChannel(int index) {
+	delete _channels[index];
+	_channels[index] = 0;
+	Common::atomicStore(&_channelStates[index].handle, kFreeSlot);
+}
+
+void MixerImpl::publishTiming(int index) {
+	ChannelState &state = _channelStates[index];
+
+	Common::atomicAdd(&state.timingSeq, 1);
+	state.timing = _channels[index]->getTiming();
+	Common::atomicAdd(&state.timingSeq, 1);
+}
+
 void MixerImpl::playStream(
 			SoundType type,
 			SoundHandle *handle,
@@ -229,7 +400,7 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_commandMutex);
 
 	if (stream == 0) {
 		warning("stream is 0");
@@ -242,7 +413,7 @@ void MixerImpl::playStream(
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+			if (Common::atomicLoad(&_channelStates[i].handle) != kFreeSlot && _channelStates[i].id == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -259,8 +430,16 @@ void MixerImpl::playStream(
 	reverseStereo = !reverseStereo;
 #endif
 
+	// Move the decoding off the audio thread. Streams which are generated
+	// on the fly (e.g. MIDI synths) or read from memory are cheap enough to
+	// read in the callback, and would only gain the ring buffer's latency.
+	if (_decodePool && stream->isCompressedOrFileBacked()) {
+		stream = makeDecodeAheadStream(stream, autofreeStream, *_decodePool);
+		autofreeStream = DisposeAfterUse::YES;
+	}
+
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateQuality, &_sincTables);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -279,67 +458,103 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
+	// Apply all control requests made since the last buffer
+	processCommands();
+
+	if (_useMixBus && _mixBusSize < len * 2) {
+		// Backends use the same buffer size for every callback, so this
+		// only allocates once
+		delete[] _mixBus;
+		_mixBusSize = len * 2;
+		_mixBus = new int32[_mixBusSize];
+	}
+
 	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	if (_useMixBus)
+		memset(_mixBus, 0, 2 * len * sizeof(int32));
+	else
+		memset(buf, 0, 2 * len * sizeof(int16));
 
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
+				freeChannel(i);
 			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+				if (_useMixBus)
+					tmp = _channels[i]->mix(_mixBus, len);
+				else
+					tmp = _channels[i]->mix(buf, len);
+				publishTiming(i);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	if (_useMixBus) {
+		// Don't add noise to silence
+		if (_dither && res > 0)
+			ditherMixBus(len * 2);
+
+		getBestRateKernels().clip(buf, _mixBus, len * 2);
+	}
+
 	return res;
 }
 
+void MixerImpl::ditherMixBus(uint count) {
+	uint32 seed = _ditherSeed;
+
+	for (uint i = 0; i < count; ++i) {
+		// The difference of two uniformly distributed values, each in the
+		// range of one output LSB, has a triangular distribution
+		seed = seed * 1664525 + 1013904223;
+		_mixBus[i] += (int32)((seed >> 8) & 0xFF) - (int32)((seed >> 16) & 0xFF);
+	}
+
+	_ditherSeed = seed;
+}
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
+	processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			freeChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
+	processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			freeChannel(i);
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (findChannelState(handle) == -1)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	Common::StackLock lock(_mutex);
+	processCommands();
+
+	if (findChannel(handle._val))
+		freeChannel(handle._val % NUM_CHANNELS);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	Common::StackLock lock(_commandMutex);
+	_soundTypeSettings[type].mute = mute;
+	postCommand(kCommandUpdateVolumes, 0, -1, type);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
@@ -348,39 +563,41 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_commandMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setVolume(volume);
+	_channelStates[index].volume = volume;
+	postCommand(kCommandSetVolume, handle._val, -1, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _channelStates[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_commandMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setBalance(balance);
+	_channelStates[index].balance = balance;
+	postCommand(kCommandSetBalance, handle._val, -1, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannelState(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _channelStates[index].balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -388,81 +605,94 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Audio::Timestamp ts(0, _sampleRate);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return Timestamp(0, _sampleRate);
+	const int index = findChannelState(handle);
+	if (index == -1)
+		return ts;
+
+	// Retry until we got a consistent copy of the timing data
+	const ChannelState &state = _channelStates[index];
+	ChannelTiming timing;
+	int32 seq;
+	do {
+		seq = Common::atomicLoad(&state.timingSeq);
+		timing = state.timing;
+		Common::memoryBarrier();
+	} while ((seq & 1) || seq != state.timingSeq);
+
+	if (timing.mixerTimeStamp == 0)
+		return ts;
+
+	uint32 delta = 0;
+	if (timing.paused)
+		delta = timing.pauseStartTime - timing.mixerTimeStamp;
+	else
+		delta = g_system->getMillis(true) - timing.mixerTimeStamp - timing.pauseTime;
+
+	// Convert the number of samples into a time duration.
+
+	ts = ts.addFrames(timing.samplesConsumed);
+	ts = ts.addMsecs(delta);
 
-	return _channels[index]->getElapsedTime();
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by
+	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
+	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
+	// isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
-		}
-	}
+	Common::StackLock lock(_commandMutex);
+	postCommand(kCommandPauseAll, 0, -1, paused);
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
-			return;
-		}
-	}
+	Common::StackLock lock(_commandMutex);
+	postCommand(kCommandPauseID, 0, id, paused);
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_commandMutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (findChannelState(handle) == -1)
 		return;
 
-	_channels[index]->pause(paused);
+	postCommand(kCommandPause, handle._val, -1, paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (Common::atomicLoad(&_channelStates[i].handle) != kFreeSlot && _channelStates[i].id == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	const int index = findChannelState(handle);
+	if (index != -1)
+		return _channelStates[index].id;
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findChannelState(handle) != -1;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (Common::atomicLoad(&_channelStates[i].handle) != kFreeSlot && _channelStates[i].type == type)
 			return true;
 	return false;
 }
@@ -479,13 +709,9 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_commandMutex);
 	_soundTypeSettings[type].volume = volume;
-
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	postCommand(kCommandUpdateVolumes, 0, -1, type);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -500,7 +726,7 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateQuality quality, SincTableCache *sincTables)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
@@ -509,7 +735,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality, sincTables);
 }
 
 Channel::~Channel() {
@@ -579,35 +805,26 @@ void Channel::pause(bool paused) {
 	}
 }
 
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Audio::Timestamp ts(0, rate);
-
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
-
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
+ChannelTiming Channel::getTiming() const {
+	ChannelTiming timing;
+	timing.samplesConsumed = _samplesConsumed;
+	timing.mixerTimeStamp = _mixerTimeStamp;
+	timing.pauseStartTime = _pauseStartTime;
+	timing.pauseTime = _pauseTime;
+	timing.paused = isPaused();
+	return timing;
+}
 
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
+int Channel::mix(int16 *data, uint len) {
+	return doMix(data, len);
+}
 
-	return ts;
+int Channel::mix(int32 *data, uint len) {
+	return doMix(data, len);
 }
 
-int Channel::mix(int16 *data, uint len) {
+template<typename T>
+int Channel::doMix(T *data, uint len) {
 	assert(_stream);
 
 	int res = 0;
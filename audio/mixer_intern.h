@@ -24,11 +24,30 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
+
+namespace Common {
+class WorkerPool;
+}
 
 namespace Audio {
 
+/**
+ * The data needed to compute the playback position of a channel.
+ */
+struct ChannelTiming {
+	ChannelTiming() : samplesConsumed(0), mixerTimeStamp(0), pauseStartTime(0), pauseTime(0), paused(false) {}
+
+	uint32 samplesConsumed;
+	uint32 mixerTimeStamp;
+	uint32 pauseStartTime;
+	uint32 pauseTime;
+	bool paused;
+};
+
 /**
  * The (default) implementation of the ScummVM audio mixing subsystem.
  *
@@ -42,6 +61,14 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * Control functions like playStream(), pauseHandle() or setChannelVolume()
+ * never wait for the mixing thread: they post a command into a lock-free
+ * queue, which is executed by mixCallback() at the next buffer boundary.
+ * Status queries like isSoundHandleActive() read a per channel state which
+ * is published without taking a mutex. Only the stop functions still
+ * synchronize with mixCallback(), since callers expect that a stopped
+ * stream is not accessed anymore once they return.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -51,10 +78,58 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		NUM_COMMANDS = 256,
+		NUM_DECODE_THREADS = 2
+	};
+
+	enum CommandType {
+		kCommandPlay,
+		kCommandPause,
+		kCommandPauseID,
+		kCommandPauseAll,
+		kCommandSetVolume,
+		kCommandSetBalance,
+		kCommandUpdateVolumes
+	};
+
+	/**
+	 * A deferred control request, executed on the mixing side.
+	 */
+	struct Command {
+		CommandType type;
+		uint32 handle;
+		int id;
+		int value;
+		Channel *channel;
 	};
 
+	/**
+	 * The state of a channel slot, which may be read without locking.
+	 * The handle is set as soon as playStream() reserves the slot and is
+	 * reset to kFreeSlot once the channel has been destroyed. The timing
+	 * data is written by the mixing side only and is guarded by timingSeq,
+	 * which is odd while an update is in progress.
+	 */
+	struct ChannelState {
+		volatile int32 handle;
+		volatile int32 id;
+		volatile int32 type;
+		volatile int32 volume;
+		volatile int32 balance;
+
+		volatile int32 timingSeq;
+		ChannelTiming timing;
+	};
+
+	enum {
+		kFreeSlot = -1
+	};
+
+	/** Held while mixing and while executing commands. */
 	Common::Mutex _mutex;
+	/** Serializes threads posting commands, never taken by mixCallback(). */
+	Common::Mutex _commandMutex;
 
 	const uint _sampleRate;
 	bool _mixerReady;
@@ -68,7 +143,35 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+
+	/** The channels, only accessed while holding _mutex. */
 	Channel *_channels[NUM_CHANNELS];
+	ChannelState _channelStates[NUM_CHANNELS];
+
+	Command _commands[NUM_COMMANDS];
+	volatile int32 _commandReadPos;
+	volatile int32 _commandWritePos;
+
+	/** Decodes streams ahead of time if enabled, see makeDecodeAheadStream(). */
+	Common::WorkerPool *_decodePool;
+
+	/**
+	 * If the 32 bit mix bus is enabled, all channels are accumulated in
+	 * this buffer first, and converted to the output format in one pass.
+	 */
+	bool _useMixBus;
+	int32 *_mixBus;
+	uint _mixBusSize;
+
+	/** Whether to dither the mix bus output, and the noise generator state. */
+	bool _dither;
+	uint32 _ditherSeed;
+
+	/** The rate conversion quality for new channels. */
+	RateQuality _rateQuality;
+
+	/** The filter tables of the channels' sinc rate converters. */
+	SincTableCache _sincTables;
 
 
 public:
@@ -121,6 +224,26 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Returns the index of the channel slot reserved for the given handle,
+	 * or -1 if the sound has already terminated.
+	 */
+	int findChannelState(SoundHandle handle) const;
+
+	/** Queues a command, must be called with _commandMutex held. */
+	void postCommand(CommandType type, uint32 handle, int id = -1, int value = 0, Channel *channel = 0);
+
+	/** Executes all pending commands, must be called with _mutex held. */
+	void processCommands();
+	void executeCommand(const Command &cmd);
+
+	Channel *findChannel(uint32 handle);
+	void freeChannel(int index);
+	void publishTiming(int index);
+
+	/** Adds triangular noise of +-1 output LSB to the mix bus. */
+	void ditherMixBus(uint count);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -2,6 +2,7 @@ MODULE := audio
 
 MODULE_OBJS := \
 	audiostream.o \
+	decodeahead.o \
 	fmopl.o \
 	mididrv.o \
 	midiparser_qt.o \
@@ -13,6 +14,8 @@ MODULE_OBJS := \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
+	rate_kernels.o \
+	rate_sinc.o \
 	timestamp.o \
 	decoders/aac.o \
 	decoders/adpcm.o \
@@ -24,6 +24,8 @@
 #define AUDIO_RATE_H
 
 #include "common/scummsys.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
 
 namespace Audio {
 
@@ -75,10 +77,72 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Same as above, but accumulates into 32 bit samples, which keep the
+	 * full precision of the volume scaling and are never saturated. See
+	 * RateKernels::accumStereo for the sample format.
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * The quality of the rate conversion. The default uses linear interpolation,
+ * the other levels use a windowed sinc filter with increasing length, i.e.
+ * less aliasing for more CPU time.
+ */
+enum RateQuality {
+	kRateQualityDefault = 0,
+	kRateQualityLow = 1,
+	kRateQualityMedium = 2,
+	kRateQualityHigh = 3
+};
+
+struct SincTable;
+
+/**
+ * Keeps the filter tables of the sinc rate converters for reuse, since they
+ * take a moment to compute. Converters created with the same cache share
+ * their tables. The tables are freed along with the cache, so the cache must
+ * outlive all converters using it.
+ */
+class SincTableCache : Common::NonCopyable {
+public:
+	SincTableCache();
+	~SincTableCache();
+
+	/**
+	 * Returns the table for the given ratio and quality, computing it if
+	 * necessary. Returns 0 if the cache is full.
+	 */
+	const SincTable *getTable(uint inStep, uint outStep, RateQuality quality);
+
+private:
+	enum {
+		kMaxTables = 16
+	};
+
+	Common::Mutex _mutex;
+	SincTable *_tables[kMaxTables];
+	int _numTables;
+};
+
+/**
+ * Create a RateConverter for the given rates and quality.
+ *
+ * @param sincTables  where sinc converters get their filter tables from; if
+ *                    0, every sinc converter computes a table of its own
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, RateQuality quality = kRateQualityDefault, SincTableCache *sincTables = 0);
+
+/**
+ * Create a polyphase windowed sinc rate converter. Used by makeRateConverter
+ * for qualities other than kRateQualityDefault, if the rates differ.
+ */
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateQuality quality, SincTableCache *sincTables);
 
 } // End of namespace Audio
 
@@ -43,6 +43,7 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_kernels.h"
 #include "audio/mixer.h"
 #include "common/util.h"
 #include "common/textconsole.h"
@@ -68,6 +69,39 @@ namespace Audio {
  */
 #define INTERMEDIATE_BUFFER_SIZE 512
 
+/**
+ * The assembler routines only mix into 16 bit samples. To accumulate into
+ * 32 bit samples, let them produce unscaled samples in chunks and scale
+ * those with the generic kernels.
+ */
+template<bool reverseStereo>
+static int flowAccumulate(RateConverter &converter, AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const RateKernels &kernels = getBestRateKernels();
+	st_sample_t chunk[INTERMEDIATE_BUFFER_SIZE];
+	int total = 0;
+
+	while (osamp > 0) {
+		const st_size_t len = MIN<st_size_t>(osamp, ARRAYSIZE(chunk) / 2);
+		memset(chunk, 0, sizeof(chunk));
+		const int res = converter.flow(input, chunk, len, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+
+		// The channels of the chunk have already been swapped, swap the
+		// volumes to match
+		if (reverseStereo)
+			kernels.accumStereo(obuf, chunk, res, vol_r, vol_l);
+		else
+			kernels.accumStereo(obuf, chunk, res, vol_l, vol_r);
+
+		obuf += res * 2;
+		osamp -= res;
+		total += res;
+		if ((st_size_t)res < len)
+			break;
+	}
+
+	return total;
+}
+
 
 /**
  * Audio rate converter based on simple resampling. Used when no
@@ -96,6 +130,9 @@ protected:
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowAccumulate<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -270,6 +307,9 @@ protected:
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowAccumulate<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -424,6 +464,10 @@ public:
 		return (obuf - ostart) / 2;
 	}
 
+	virtual int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowAccumulate<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -436,7 +480,10 @@ public:
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateQuality quality, SincTableCache *sincTables) {
+	if (quality != kRateQualityDefault && inrate != outrate)
+		return makeSincRateConverter(inrate, outrate, stereo, reverseStereo, quality, sincTables);
+
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0) {
 			if (stereo) {
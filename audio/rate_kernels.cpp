@@ -0,0 +1,612 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_kernels.h"
+#include "audio/mixer.h"
+
+#include "common/cpudetect.h"
+
+#if defined(SCUMMVM_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(SCUMMVM_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Audio {
+
+// The SIMD versions divide by kMaxMixerVolume through a shift by
+// VOLUME_SHIFT. Like the C++ code, they round towards zero.
+
+#pragma mark -
+#pragma mark --- Generic kernels ---
+#pragma mark -
+
+static void mixStereoScalar(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	for (; count > 0; --count) {
+		clampedAdd(dst[0], (src[0] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(dst[1], (src[1] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+		dst += 2;
+		src += 2;
+	}
+}
+
+static void mixStereoReverseScalar(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	for (; count > 0; --count) {
+		clampedAdd(dst[1], (src[0] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(dst[0], (src[1] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+		dst += 2;
+		src += 2;
+	}
+}
+
+static void mixMonoScalar(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	for (; count > 0; --count) {
+		clampedAdd(dst[0], (*src * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(dst[1], (*src * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+		dst += 2;
+		src++;
+	}
+}
+
+static void accumStereoScalar(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	for (; count > 0; --count) {
+		dst[0] += src[0] * (int)volL;
+		dst[1] += src[1] * (int)volR;
+		dst += 2;
+		src += 2;
+	}
+}
+
+static void accumStereoReverseScalar(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	for (; count > 0; --count) {
+		dst[1] += src[0] * (int)volL;
+		dst[0] += src[1] * (int)volR;
+		dst += 2;
+		src += 2;
+	}
+}
+
+static void accumMonoScalar(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	for (; count > 0; --count) {
+		dst[0] += *src * (int)volL;
+		dst[1] += *src * (int)volR;
+		dst += 2;
+		src++;
+	}
+}
+
+static void clipScalar(st_sample_t *dst, const int32 *src, uint count) {
+	for (; count > 0; --count) {
+		int val = (*src++ + (1 << (VOLUME_SHIFT - 1))) >> VOLUME_SHIFT;
+
+		if (val > ST_SAMPLE_MAX)
+			val = ST_SAMPLE_MAX;
+		else if (val < ST_SAMPLE_MIN)
+			val = ST_SAMPLE_MIN;
+
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*dst++ = ((int16)val) ^ 0x8000;
+#else
+		*dst++ = val;
+#endif
+	}
+}
+
+static int32 dotProductScalar(const st_sample_t *src, const int16 *coefs, uint count) {
+	int32 sum = 0;
+	for (uint i = 0; i < count; ++i)
+		sum += src[i] * coefs[i];
+	return sum;
+}
+
+static const RateKernels s_scalarKernels = {
+	mixStereoScalar,
+	mixStereoReverseScalar,
+	mixMonoScalar,
+	accumStereoScalar,
+	accumStereoReverseScalar,
+	accumMonoScalar,
+	clipScalar,
+	dotProductScalar
+};
+
+// The SIMD kernels assume signed output samples
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+
+#if defined(SCUMMVM_SIMD_X86)
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+SCUMMVM_TARGET_SSE2 static inline __m128i divideVolumeSSE2(__m128i p) {
+	const __m128i bias = _mm_set1_epi32((1 << VOLUME_SHIFT) - 1);
+	return _mm_srai_epi32(_mm_add_epi32(p, _mm_and_si128(_mm_srai_epi32(p, 31), bias)), VOLUME_SHIFT);
+}
+
+SCUMMVM_TARGET_SSE2 static inline __m128i scaleSSE2(__m128i s, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(s, vol);
+	const __m128i hi = _mm_mulhi_epi16(s, vol);
+	const __m128i p0 = divideVolumeSSE2(_mm_unpacklo_epi16(lo, hi));
+	const __m128i p1 = divideVolumeSSE2(_mm_unpackhi_epi16(lo, hi));
+	return _mm_packs_epi32(p0, p1);
+}
+
+SCUMMVM_TARGET_SSE2 static inline void mixSSE2(st_sample_t *dst, __m128i s, __m128i vol) {
+	const __m128i d = _mm_loadu_si128((const __m128i *)dst);
+	_mm_storeu_si128((__m128i *)dst, _mm_adds_epi16(d, scaleSSE2(s, vol)));
+}
+
+SCUMMVM_TARGET_SSE2 static void mixStereoSSE2(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		mixSSE2(dst + i * 2, _mm_loadu_si128((const __m128i *)(src + i * 2)), vol);
+
+	mixStereoScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_SSE2 static void mixStereoReverseSSE2(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volL, volR, volL, volR, volL, volR, volL, volR);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i * 2));
+		s = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		mixSSE2(dst + i * 2, s, vol);
+	}
+
+	mixStereoReverseScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_SSE2 static void mixMonoSSE2(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		mixSSE2(dst + i * 2, _mm_unpacklo_epi16(s, s), vol);
+		mixSSE2(dst + i * 2 + 8, _mm_unpackhi_epi16(s, s), vol);
+	}
+
+	mixMonoScalar(dst + i * 2, src + i, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_SSE2 static inline void accumSSE2(int32 *dst, __m128i s, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(s, vol);
+	const __m128i hi = _mm_mulhi_epi16(s, vol);
+	const __m128i d0 = _mm_loadu_si128((const __m128i *)dst);
+	const __m128i d1 = _mm_loadu_si128((const __m128i *)(dst + 4));
+	_mm_storeu_si128((__m128i *)dst, _mm_add_epi32(d0, _mm_unpacklo_epi16(lo, hi)));
+	_mm_storeu_si128((__m128i *)(dst + 4), _mm_add_epi32(d1, _mm_unpackhi_epi16(lo, hi)));
+}
+
+SCUMMVM_TARGET_SSE2 static void accumStereoSSE2(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		accumSSE2(dst + i * 2, _mm_loadu_si128((const __m128i *)(src + i * 2)), vol);
+
+	accumStereoScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_SSE2 static void accumStereoReverseSSE2(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volL, volR, volL, volR, volL, volR, volL, volR);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i * 2));
+		s = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		accumSSE2(dst + i * 2, s, vol);
+	}
+
+	accumStereoReverseScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_SSE2 static void accumMonoSSE2(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		accumSSE2(dst + i * 2, _mm_unpacklo_epi16(s, s), vol);
+		accumSSE2(dst + i * 2 + 8, _mm_unpackhi_epi16(s, s), vol);
+	}
+
+	accumMonoScalar(dst + i * 2, src + i, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_SSE2 static void clipSSE2(st_sample_t *dst, const int32 *src, uint count) {
+	const __m128i round = _mm_set1_epi32(1 << (VOLUME_SHIFT - 1));
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i s0 = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(src + i)), round);
+		const __m128i s1 = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(src + i + 4)), round);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(_mm_srai_epi32(s0, VOLUME_SHIFT), _mm_srai_epi32(s1, VOLUME_SHIFT)));
+	}
+
+	clipScalar(dst + i, src + i, count - i);
+}
+
+SCUMMVM_TARGET_SSE2 static inline int32 horizontalSumSSE2(__m128i v) {
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(v);
+}
+
+SCUMMVM_TARGET_SSE2 static int32 dotProductSSE2(const st_sample_t *src, const int16 *coefs, uint count) {
+	__m128i sum = _mm_setzero_si128();
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coefs + i));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s, c));
+	}
+
+	return horizontalSumSSE2(sum) + dotProductScalar(src + i, coefs + i, count - i);
+}
+
+static const RateKernels s_sse2Kernels = {
+	mixStereoSSE2,
+	mixStereoReverseSSE2,
+	mixMonoSSE2,
+	accumStereoSSE2,
+	accumStereoReverseSSE2,
+	accumMonoSSE2,
+	clipSSE2,
+	dotProductSSE2
+};
+
+#pragma mark -
+#pragma mark --- AVX2 kernels ---
+#pragma mark -
+
+// Note that the unpack and pack instructions work on the two 128 bit lanes
+// separately. As they are used in pairs, the sample order is preserved.
+//
+// The AVX2 kernels must not call the SSE2 ones: switching to non-VEX
+// encoded instructions with the upper register halves in use stalls
+// on many CPUs.
+
+SCUMMVM_TARGET_AVX2 static inline __m256i divideVolumeAVX2(__m256i p) {
+	const __m256i bias = _mm256_set1_epi32((1 << VOLUME_SHIFT) - 1);
+	return _mm256_srai_epi32(_mm256_add_epi32(p, _mm256_and_si256(_mm256_srai_epi32(p, 31), bias)), VOLUME_SHIFT);
+}
+
+SCUMMVM_TARGET_AVX2 static inline void mixAVX2(st_sample_t *dst, __m256i s, __m256i vol) {
+	const __m256i lo = _mm256_mullo_epi16(s, vol);
+	const __m256i hi = _mm256_mulhi_epi16(s, vol);
+	const __m256i p0 = divideVolumeAVX2(_mm256_unpacklo_epi16(lo, hi));
+	const __m256i p1 = divideVolumeAVX2(_mm256_unpackhi_epi16(lo, hi));
+
+	const __m256i d = _mm256_loadu_si256((const __m256i *)dst);
+	_mm256_storeu_si256((__m256i *)dst, _mm256_adds_epi16(d, _mm256_packs_epi32(p0, p1)));
+}
+
+SCUMMVM_TARGET_AVX2 static void mixStereoAVX2(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((volR << 16) | volL);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8)
+		mixAVX2(dst + i * 2, _mm256_loadu_si256((const __m256i *)(src + i * 2)), vol);
+
+	mixStereoScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_AVX2 static void mixStereoReverseAVX2(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((volL << 16) | volR);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i s = _mm256_loadu_si256((const __m256i *)(src + i * 2));
+		s = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		mixAVX2(dst + i * 2, s, vol);
+	}
+
+	mixStereoReverseScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_AVX2 static void mixMonoAVX2(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((volR << 16) | volL);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i lo = _mm256_unpacklo_epi16(s, s);
+		const __m256i hi = _mm256_unpackhi_epi16(s, s);
+		mixAVX2(dst + i * 2, _mm256_permute2x128_si256(lo, hi, 0x20), vol);
+		mixAVX2(dst + i * 2 + 16, _mm256_permute2x128_si256(lo, hi, 0x31), vol);
+	}
+
+	mixMonoScalar(dst + i * 2, src + i, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_AVX2 static inline void accumAVX2(int32 *dst, __m256i s, __m256i vol) {
+	const __m256i lo = _mm256_mullo_epi16(s, vol);
+	const __m256i hi = _mm256_mulhi_epi16(s, vol);
+	const __m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+	const __m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+
+	// Restore the sample order across the 128 bit lanes
+	const __m256i d0 = _mm256_loadu_si256((const __m256i *)dst);
+	const __m256i d1 = _mm256_loadu_si256((const __m256i *)(dst + 8));
+	_mm256_storeu_si256((__m256i *)dst, _mm256_add_epi32(d0, _mm256_permute2x128_si256(p0, p1, 0x20)));
+	_mm256_storeu_si256((__m256i *)(dst + 8), _mm256_add_epi32(d1, _mm256_permute2x128_si256(p0, p1, 0x31)));
+}
+
+SCUMMVM_TARGET_AVX2 static void accumStereoAVX2(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((volR << 16) | volL);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8)
+		accumAVX2(dst + i * 2, _mm256_loadu_si256((const __m256i *)(src + i * 2)), vol);
+
+	accumStereoScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_AVX2 static void accumStereoReverseAVX2(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((volL << 16) | volR);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i s = _mm256_loadu_si256((const __m256i *)(src + i * 2));
+		s = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		accumAVX2(dst + i * 2, s, vol);
+	}
+
+	accumStereoReverseScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_AVX2 static void accumMonoAVX2(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32((volR << 16) | volL);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i lo = _mm256_unpacklo_epi16(s, s);
+		const __m256i hi = _mm256_unpackhi_epi16(s, s);
+		accumAVX2(dst + i * 2, _mm256_permute2x128_si256(lo, hi, 0x20), vol);
+		accumAVX2(dst + i * 2 + 16, _mm256_permute2x128_si256(lo, hi, 0x31), vol);
+	}
+
+	accumMonoScalar(dst + i * 2, src + i, count - i, volL, volR);
+}
+
+SCUMMVM_TARGET_AVX2 static void clipAVX2(st_sample_t *dst, const int32 *src, uint count) {
+	const __m256i round = _mm256_set1_epi32(1 << (VOLUME_SHIFT - 1));
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i s0 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(src + i)), round), VOLUME_SHIFT);
+		const __m256i s1 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(src + i + 8)), round), VOLUME_SHIFT);
+		// The pack works per 128 bit lane, which interleaves s0 and s1
+		const __m256i packed = _mm256_packs_epi32(s0, s1);
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+
+	clipScalar(dst + i, src + i, count - i);
+}
+
+SCUMMVM_TARGET_AVX2 static int32 dotProductAVX2(const st_sample_t *src, const int16 *coefs, uint count) {
+	__m256i sum = _mm256_setzero_si256();
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(coefs + i));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(s, c));
+	}
+
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(half) + dotProductScalar(src + i, coefs + i, count - i);
+}
+
+static const RateKernels s_avx2Kernels = {
+	mixStereoAVX2,
+	mixStereoReverseAVX2,
+	mixMonoAVX2,
+	accumStereoAVX2,
+	accumStereoReverseAVX2,
+	accumMonoAVX2,
+	clipAVX2,
+	dotProductAVX2
+};
+
+#endif // SCUMMVM_SIMD_X86
+
+#if defined(SCUMMVM_SIMD_NEON)
+
+#pragma mark -
+#pragma mark --- NEON kernels ---
+#pragma mark -
+
+static inline int32x4_t divideVolumeNEON(int32x4_t p) {
+	const int32x4_t bias = vdupq_n_s32((1 << VOLUME_SHIFT) - 1);
+	return vshrq_n_s32(vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), bias)), VOLUME_SHIFT);
+}
+
+static inline void mixNEON(st_sample_t *dst, int16x8_t s, int16x8_t vol) {
+	const int32x4_t p0 = divideVolumeNEON(vmull_s16(vget_low_s16(s), vget_low_s16(vol)));
+	const int32x4_t p1 = divideVolumeNEON(vmull_s16(vget_high_s16(s), vget_high_s16(vol)));
+	const int16x8_t scaled = vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1));
+	vst1q_s16(dst, vqaddq_s16(vld1q_s16(dst), scaled));
+}
+
+static inline int16x8_t makeVolumeNEON(st_volume_t vol0, st_volume_t vol1) {
+	return vreinterpretq_s16_u32(vdupq_n_u32((vol1 << 16) | vol0));
+}
+
+static void mixStereoNEON(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = makeVolumeNEON(volL, volR);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		mixNEON(dst + i * 2, vld1q_s16(src + i * 2), vol);
+
+	mixStereoScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+static void mixStereoReverseNEON(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = makeVolumeNEON(volR, volL);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		mixNEON(dst + i * 2, vrev32q_s16(vld1q_s16(src + i * 2)), vol);
+
+	mixStereoReverseScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+static void mixMonoNEON(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = makeVolumeNEON(volL, volR);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const int16x4_t s = vld1_s16(src + i);
+		const int16x4x2_t frames = vzip_s16(s, s);
+		mixNEON(dst + i * 2, vcombine_s16(frames.val[0], frames.val[1]), vol);
+	}
+
+	mixMonoScalar(dst + i * 2, src + i, count - i, volL, volR);
+}
+
+static inline void accumNEON(int32 *dst, int16x8_t s, int16x8_t vol) {
+	vst1q_s32(dst, vmlal_s16(vld1q_s32(dst), vget_low_s16(s), vget_low_s16(vol)));
+	vst1q_s32(dst + 4, vmlal_s16(vld1q_s32(dst + 4), vget_high_s16(s), vget_high_s16(vol)));
+}
+
+static void accumStereoNEON(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = makeVolumeNEON(volL, volR);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		accumNEON(dst + i * 2, vld1q_s16(src + i * 2), vol);
+
+	accumStereoScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+static void accumStereoReverseNEON(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = makeVolumeNEON(volR, volL);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		accumNEON(dst + i * 2, vrev32q_s16(vld1q_s16(src + i * 2)), vol);
+
+	accumStereoReverseScalar(dst + i * 2, src + i * 2, count - i, volL, volR);
+}
+
+static void accumMonoNEON(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR) {
+	const int16x8_t vol = makeVolumeNEON(volL, volR);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const int16x4_t s = vld1_s16(src + i);
+		const int16x4x2_t frames = vzip_s16(s, s);
+		accumNEON(dst + i * 2, vcombine_s16(frames.val[0], frames.val[1]), vol);
+	}
+
+	accumMonoScalar(dst + i * 2, src + i, count - i, volL, volR);
+}
+
+static void clipNEON(st_sample_t *dst, const int32 *src, uint count) {
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		// vqrshrn rounds to nearest and saturates in one go
+		const int16x4_t s0 = vqrshrn_n_s32(vld1q_s32(src + i), VOLUME_SHIFT);
+		const int16x4_t s1 = vqrshrn_n_s32(vld1q_s32(src + i + 4), VOLUME_SHIFT);
+		vst1q_s16(dst + i, vcombine_s16(s0, s1));
+	}
+
+	clipScalar(dst + i, src + i, count - i);
+}
+
+static int32 dotProductNEON(const st_sample_t *src, const int16 *coefs, uint count) {
+	int32x4_t sum = vdupq_n_s32(0);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const int16x8_t s = vld1q_s16(src + i);
+		const int16x8_t c = vld1q_s16(coefs + i);
+		sum = vmlal_s16(sum, vget_low_s16(s), vget_low_s16(c));
+		sum = vmlal_s16(sum, vget_high_s16(s), vget_high_s16(c));
+	}
+
+	const int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(half, half), 0) + dotProductScalar(src + i, coefs + i, count - i);
+}
+
+static const RateKernels s_neonKernels = {
+	mixStereoNEON,
+	mixStereoReverseNEON,
+	mixMonoNEON,
+	accumStereoNEON,
+	accumStereoReverseNEON,
+	accumMonoNEON,
+	clipNEON,
+	dotProductNEON
+};
+
+#endif // SCUMMVM_SIMD_NEON
+
+#endif // !OUTPUT_UNSIGNED_AUDIO
+
+#pragma mark -
+
+const RateKernels *getRateKernels(RateKernelType type) {
+	switch (type) {
+	case kRateKernelsScalar:
+		return &s_scalarKernels;
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#if defined(SCUMMVM_SIMD_X86)
+	case kRateKernelsSSE2:
+		return Common::hasCPUFeature(Common::kCPUFeatureSSE2) ? &s_sse2Kernels : 0;
+	case kRateKernelsAVX2:
+		return Common::hasCPUFeature(Common::kCPUFeatureAVX2) ? &s_avx2Kernels : 0;
+#endif
+#if defined(SCUMMVM_SIMD_NEON)
+	case kRateKernelsNEON:
+		return Common::hasCPUFeature(Common::kCPUFeatureNEON) ? &s_neonKernels : 0;
+#endif
+#endif
+	default:
+		return 0;
+	}
+}
+
+const RateKernels &getBestRateKernels() {
+	for (int type = kRateKernelsCount - 1; type > kRateKernelsScalar; --type) {
+		const RateKernels *kernels = getRateKernels((RateKernelType)type);
+		if (kernels)
+			return *kernels;
+	}
+
+	return s_scalarKernels;
+}
+
+} // End of namespace Audio
@@ -0,0 +1,130 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_KERNELS_H
+#define AUDIO_RATE_KERNELS_H
+
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * The number of fractional bits of the samples produced by the accum
+ * functions below, i.e. log2(Mixer::kMaxMixerVolume).
+ */
+#define VOLUME_SHIFT 8
+
+/**
+ * The inner loops of the rate converters, in a plain C++ version and,
+ * where available, SIMD versions. All versions produce the same results.
+ */
+struct RateKernels {
+	/**
+	 * Mix count interleaved stereo frames from src into dst, scaling the
+	 * left and right channel with volL resp. volR and saturating the result.
+	 */
+	void (*mixStereo)(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Same as mixStereo, but with the channels of src swapped. Note that
+	 * volL still applies to the left channel of src.
+	 */
+	void (*mixStereoReverse)(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Mix count mono samples from src into both channels of dst.
+	 */
+	void (*mixMono)(st_sample_t *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Same as mixStereo, but accumulates into 32 bit samples. The volume
+	 * scaling is not divided out, i.e. each sample is a fixed point value
+	 * with VOLUME_SHIFT fractional bits, and nothing is saturated.
+	 */
+	void (*accumStereo)(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR);
+
+	/** Same as mixStereoReverse, but accumulates like accumStereo. */
+	void (*accumStereoReverse)(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR);
+
+	/** Same as mixMono, but accumulates like accumStereo. */
+	void (*accumMono)(int32 *dst, const st_sample_t *src, uint count, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Convert count samples accumulated by the accum functions back to
+	 * output samples, rounding to nearest and saturating.
+	 */
+	void (*clip)(st_sample_t *dst, const int32 *src, uint count);
+
+	/**
+	 * Returns the dot product of count samples with count filter
+	 * coefficients. The coefficients must not be -32768.
+	 */
+	int32 (*dotProduct)(const st_sample_t *src, const int16 *coefs, uint count);
+};
+
+enum RateKernelType {
+	kRateKernelsScalar,
+	kRateKernelsSSE2,
+	kRateKernelsAVX2,
+	kRateKernelsNEON,
+
+	kRateKernelsCount
+};
+
+/**
+ * Returns the given kernel implementation, or 0 if it is not supported by
+ * the CPU or was not compiled in.
+ */
+const RateKernels *getRateKernels(RateKernelType type);
+
+/**
+ * Returns the fastest kernel implementation supported by the CPU.
+ */
+const RateKernels &getBestRateKernels();
+
+/**
+ * Mix a block of frames into the output buffer, using the kernel matching
+ * the channel layout and the output sample type.
+ */
+template<bool stereo, bool reverseStereo>
+inline void mixFrames(const RateKernels &kernels, st_sample_t *obuf, const st_sample_t *src, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	if (!stereo)
+		kernels.mixMono(obuf, src, count, vol_l, vol_r);
+	else if (reverseStereo)
+		kernels.mixStereoReverse(obuf, src, count, vol_l, vol_r);
+	else
+		kernels.mixStereo(obuf, src, count, vol_l, vol_r);
+}
+
+template<bool stereo, bool reverseStereo>
+inline void mixFrames(const RateKernels &kernels, int32 *obuf, const st_sample_t *src, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	if (!stereo)
+		kernels.accumMono(obuf, src, count, vol_l, vol_r);
+	else if (reverseStereo)
+		kernels.accumStereoReverse(obuf, src, count, vol_l, vol_r);
+	else
+		kernels.accumStereo(obuf, src, count, vol_l, vol_r);
+}
+
+} // End of namespace Audio
+
+#endif
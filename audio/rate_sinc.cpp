@@ -0,0 +1,395 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * A polyphase windowed sinc rate converter.
+ *
+ * For a conversion from inrate to outrate, reduced to the ratio M:L, every
+ * output sample lies at one of L fractional positions between two input
+ * samples. For each of these phases, the coefficients of a Kaiser windowed
+ * sinc low pass filter are computed once and kept in a table, which is
+ * shared through a SincTableCache by all converters using the same ratio and
+ * quality. The cutoff is
+ * placed below the lower of the two Nyquist frequencies, so the filter both
+ * removes the images when upsampling and prevents aliasing when
+ * downsampling.
+ *
+ * The cost per output sample and channel is one dot product of the filter
+ * length, i.e. 16, 32 or 64 multiply-adds depending on the quality.
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/rate_kernels.h"
+#include "common/algorithm.h"
+#include "common/util.h"
+#include "common/textconsole.h"
+
+namespace Audio {
+
+/**
+ * The number of input frames read at once.
+ */
+#define INTERMEDIATE_BUFFER_SIZE 512
+
+enum {
+	/** The maximum filter length, see s_sincQualities. */
+	kMaxTaps = 64,
+
+	/**
+	 * The maximum number of phases in a table. Ratios with more phases use
+	 * the nearest lower phase, which keeps the timing error below 1/512 of
+	 * an input sample.
+	 */
+	kMaxPhases = 512,
+
+	/** The number of fractional bits of the filter coefficients. */
+	kCoefBits = 14
+};
+
+struct SincQuality {
+	uint taps;
+	/** The cutoff frequency, relative to the lower Nyquist frequency. */
+	double cutoff;
+	/** The Kaiser window parameter, higher values mean more stop band attenuation. */
+	double beta;
+};
+
+static const SincQuality s_sincQualities[] = {
+	{ 16, 0.80, 5.0 },	// kRateQualityLow
+	{ 32, 0.88, 7.0 },	// kRateQualityMedium
+	{ 64, 0.94, 9.0 }	// kRateQualityHigh
+};
+
+struct SincTable {
+	uint inStep, outStep;
+	RateQuality quality;
+
+	uint taps;
+	uint phases;
+	int16 *coefs;
+};
+
+/** The zeroth order modified Bessel function of the first kind. */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 50 && term > sum * 1e-12; ++k) {
+		const double t = x / (2 * k);
+		term *= t * t;
+		sum += term;
+	}
+	return sum;
+}
+
+static SincTable *createSincTable(uint inStep, uint outStep, RateQuality quality) {
+	const SincQuality &q = s_sincQualities[quality - kRateQualityLow];
+
+	SincTable *table = new SincTable;
+	table->inStep = inStep;
+	table->outStep = outStep;
+	table->quality = quality;
+	table->taps = q.taps;
+	table->phases = MIN<uint>(outStep, kMaxPhases);
+	table->coefs = new int16[table->phases * table->taps];
+
+	// The cutoff relative to the input Nyquist frequency
+	const double cutoff = q.cutoff * MIN<double>(1.0, (double)outStep / inStep);
+	const double halfLength = table->taps / 2;
+	const double windowScale = 1.0 / besselI0(q.beta);
+
+	double h[kMaxTaps];
+	for (uint phase = 0; phase < table->phases; ++phase) {
+		// The output sample lies this far behind the center tap
+		const double offset = (double)phase / table->phases;
+
+		double sum = 0.0;
+		for (uint k = 0; k < table->taps; ++k) {
+			const double x = k - (halfLength - 1) - offset;
+			const double r = x / halfLength;
+			const double window = (r * r < 1.0) ? besselI0(q.beta * sqrt(1.0 - r * r)) * windowScale : 0.0;
+			const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+			h[k] = sinc * window;
+			sum += h[k];
+		}
+
+		// Normalize every phase to unity gain, and put the rounding error
+		// into the largest coefficient, so that DC passes unchanged
+		int16 *coefs = table->coefs + phase * table->taps;
+		int total = 0;
+		uint largest = 0;
+		for (uint k = 0; k < table->taps; ++k) {
+			coefs[k] = (int16)floor(h[k] / sum * (1 << kCoefBits) + 0.5);
+			total += coefs[k];
+			if (coefs[k] > coefs[largest])
+				largest = k;
+		}
+		coefs[largest] += (1 << kCoefBits) - total;
+	}
+
+	return table;
+}
+
+static void deleteSincTable(SincTable *table) {
+	delete[] table->coefs;
+	delete table;
+}
+
+SincTableCache::SincTableCache() : _numTables(0) {
+}
+
+SincTableCache::~SincTableCache() {
+	for (int i = 0; i < _numTables; ++i)
+		deleteSincTable(_tables[i]);
+}
+
+const SincTable *SincTableCache::getTable(uint inStep, uint outStep, RateQuality quality) {
+	Common::StackLock lock(_mutex);
+
+	for (int i = 0; i < _numTables; ++i) {
+		SincTable *table = _tables[i];
+		if (table->inStep == inStep && table->outStep == outStep && table->quality == quality)
+			return table;
+	}
+
+	if (_numTables == kMaxTables)
+		return 0;
+
+	// Converters are created outside of the audio callback, so computing the
+	// table while holding the lock never delays the mixing
+	_tables[_numTables] = createSincTable(inStep, outStep, quality);
+	return _tables[_numTables++];
+}
+
+
+#pragma mark -
+
+
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	enum {
+		kChannels = stereo ? 2 : 1,
+		kHistorySize = INTERMEDIATE_BUFFER_SIZE + kMaxTaps
+	};
+
+	const SincTable *_table;
+	/** the table, if it was not taken from a cache and has to be deleted */
+	SincTable *_ownTable;
+
+	/** input frames to advance per output frame, split into integer and fraction */
+	uint _intStep, _fracStep;
+
+	/** position of the first filter tap in _history, and fractional position in 1/outStep */
+	uint _pos, _phase;
+
+	/** number of valid frames in _history */
+	uint _historyLen;
+
+	/** whether the end of the stream has been padded with silence */
+	bool _flushed;
+
+	st_sample_t _inBuf[INTERMEDIATE_BUFFER_SIZE];
+	st_sample_t _history[kChannels][kHistorySize];
+	st_sample_t _outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	const RateKernels &_kernels;
+
+	bool refill(AudioStream &input);
+	st_sample_t filter(const st_sample_t *src, const int16 *coefs) const;
+
+	template<typename T>
+	int doFlow(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate, RateQuality quality, SincTableCache *sincTables);
+	~SincRateConverter();
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return doFlow(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return doFlow(input, obuf, osamp, vol_l, vol_r);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate, RateQuality quality, SincTableCache *sincTables)
+	: _ownTable(0), _kernels(getBestRateKernels()) {
+	if (quality < kRateQualityLow || quality > kRateQualityHigh) {
+		error("SincRateConverter: Invalid quality %d", quality);
+	}
+
+	const st_rate_t divisor = Common::gcd(inrate, outrate);
+	const uint inStep = inrate / divisor;
+	const uint outStep = outrate / divisor;
+
+	_table = sincTables ? sincTables->getTable(inStep, outStep, quality) : 0;
+	if (!_table)
+		_table = _ownTable = createSincTable(inStep, outStep, quality);
+
+	_intStep = inStep / outStep;
+	_fracStep = inStep % outStep;
+	_pos = 0;
+	_phase = 0;
+	_flushed = false;
+
+	// Start with silence before the first sample, so that the first output
+	// sample is centered on the first input sample
+	_historyLen = _table->taps / 2 - 1;
+	for (int ch = 0; ch < kChannels; ++ch)
+		memset(_history[ch], 0, _historyLen * sizeof(st_sample_t));
+}
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::~SincRateConverter() {
+	if (_ownTable)
+		deleteSincTable(_ownTable);
+}
+
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	// Drop the frames which are not needed anymore
+	const uint drop = MIN(_pos, _historyLen);
+	for (int ch = 0; ch < kChannels; ++ch)
+		memmove(_history[ch], _history[ch] + drop, (_historyLen - drop) * sizeof(st_sample_t));
+	_historyLen -= drop;
+	_pos -= drop;
+
+	if (_flushed)
+		return false;
+
+	const uint padding = _table->taps / 2;
+	const uint space = MIN<uint>(kHistorySize - _historyLen - padding, ARRAYSIZE(_inBuf) / kChannels);
+	const int len = input.readBuffer(_inBuf, space * kChannels);
+
+	if (len > 0) {
+		const uint frames = len / kChannels;
+		const st_sample_t *in = _inBuf;
+		for (uint i = 0; i < frames; ++i) {
+			for (int ch = 0; ch < kChannels; ++ch)
+				_history[ch][_historyLen + i] = *in++;
+		}
+		_historyLen += frames;
+	}
+
+	// Let the filter run over the end of the input. This is done right away,
+	// since the mixer stops calling flow() once the input has ended. A queue
+	// which merely ran empty is not flushed, so that the history is intact
+	// when more data arrives.
+	if (input.endOfStream()) {
+		for (int ch = 0; ch < kChannels; ++ch)
+			memset(_history[ch] + _historyLen, 0, padding * sizeof(st_sample_t));
+		_historyLen += padding;
+		_flushed = true;
+		return true;
+	}
+
+	return len > 0;
+}
+
+template<bool stereo, bool reverseStereo>
+st_sample_t SincRateConverter<stereo, reverseStereo>::filter(const st_sample_t *src, const int16 *coefs) const {
+	int val = (_kernels.dotProduct(src, coefs, _table->taps) + (1 << (kCoefBits - 1))) >> kCoefBits;
+
+	if (val > ST_SAMPLE_MAX)
+		val = ST_SAMPLE_MAX;
+	else if (val < ST_SAMPLE_MIN)
+		val = ST_SAMPLE_MIN;
+
+	return val;
+}
+
+template<bool stereo, bool reverseStereo>
+template<typename T>
+int SincRateConverter<stereo, reverseStereo>::doFlow(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	const uint taps = _table->taps;
+	const uint phases = _table->phases;
+	const uint outStep = _table->outStep;
+
+	while (obuf < oend) {
+		// Filter as many samples as fit into the intermediate buffer
+		const uint maxFrames = MIN<uint>((oend - obuf) / 2, ARRAYSIZE(_outBuf) / 2);
+		st_sample_t *out = _outBuf;
+		uint frames = 0;
+		bool endOfInput = false;
+
+		while (frames < maxFrames) {
+			// Make sure all input samples covered by the filter are available
+			while (_pos + taps > _historyLen) {
+				if (!refill(input)) {
+					endOfInput = true;
+					break;
+				}
+			}
+
+			if (endOfInput)
+				break;
+
+			const uint phase = (phases == outStep) ? _phase : _phase * phases / outStep;
+			const int16 *coefs = _table->coefs + phase * taps;
+			*out++ = filter(_history[0] + _pos, coefs);
+			if (stereo)
+				*out++ = filter(_history[kChannels - 1] + _pos, coefs);
+
+			// Increment input position
+			_pos += _intStep;
+			_phase += _fracStep;
+			if (_phase >= outStep) {
+				_phase -= outStep;
+				_pos++;
+			}
+
+			frames++;
+		}
+
+		mixFrames<stereo, reverseStereo>(_kernels, obuf, _outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
+
+		if (endOfInput)
+			break;
+	}
+	return (obuf - ostart) / 2;
+}
+
+
+#pragma mark -
+
+
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateQuality quality, SincTableCache *sincTables) {
+	if (stereo) {
+		if (reverseStereo)
+			return new SincRateConverter<true, true>(inrate, outrate, quality, sincTables);
+		else
+			return new SincRateConverter<true, false>(inrate, outrate, quality, sincTables);
+	} else
+		return new SincRateConverter<false, false>(inrate, outrate, quality, sincTables);
+}
+
+} // End of namespace Audio
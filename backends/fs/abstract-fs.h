@@ -158,6 +158,21 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Returns the time the object referred by this path was last modified,
+	 * in seconds since an arbitrary, backend specific epoch.
+	 *
+	 * @return the modification time, or 0 if it is unknown
+	 */
+	virtual uint32 getModificationTime() const { return 0; }
+
+	/**
+	 * Returns the size of the file referred by this path.
+	 *
+	 * @return the size in bytes, or -1 if it is unknown or does not fit
+	 *         into an int32
+	 */
+	virtual int32 getFileSize() const { return -1; }
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -168,6 +183,15 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Like createReadStream(), but the file may be mapped into memory. This
+	 * is only safe for files which are not truncated while the stream is
+	 * open, see FSNode::createMappedReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream() { return createReadStream(); }
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
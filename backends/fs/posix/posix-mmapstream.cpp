@@ -0,0 +1,93 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX)
+
+// Disable symbol overrides so that we can use open, mmap etc.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/fs/posix/posix-mmapstream.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MmapStream::Mapping::~Mapping() {
+	munmap(_addr, _length);
+}
+
+MmapStream::MmapStream(const Common::SharedPtr<Mapping> &mapping, const byte *data, uint32 size)
+	: Common::MemoryReadStream(data, size), _mapping(mapping) {
+}
+
+MmapStream *MmapStream::makeFromPath(const Common::String &path) {
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	// Only regular files can be mapped. Empty files can't be mapped either,
+	// and large files are left to stdio, so that they don't use up the
+	// address space of 32 bit hosts.
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || st.st_size > kMaxMappingSize) {
+		close(fd);
+		return 0;
+	}
+
+	const uint32 length = (uint32)st.st_size;
+	void *addr = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps the file referenced, so the descriptor is no
+	// longer needed
+	close(fd);
+
+	if (addr == MAP_FAILED)
+		return 0;
+
+	Common::SharedPtr<Mapping> mapping(new Mapping(addr, length));
+	return new MmapStream(mapping, (const byte *)addr, length);
+#else
+	return 0;
+#endif
+}
+
+Common::SeekableReadStream *MmapStream::readStream(uint32 dataSize) {
+	const byte *data = getData() + pos();
+	const uint32 available = size() - pos();
+
+	if (dataSize > available) {
+		// Consume the rest of the data, and set the end-of-stream flag just
+		// like a short read() would
+		dataSize = available;
+		byte dummy;
+		skip(dataSize);
+		read(&dummy, 1);
+	} else {
+		skip(dataSize);
+	}
+
+	return new MmapStream(_mapping, data, dataSize);
+}
+
+#endif
@@ -0,0 +1,78 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+#include "common/memstream.h"
+#include "common/noncopyable.h"
+#include "common/ptr.h"
+#include "common/str.h"
+
+/**
+ * A read stream for a file which is mapped into memory with mmap().
+ *
+ * Reads are plain copies out of the mapping, and getData() gives direct
+ * access to the whole file. readStream() returns streams which share the
+ * mapping instead of copying the requested data; the mapping stays alive
+ * until the last of these streams is deleted.
+ *
+ * Note that if the file is truncated while it is mapped, by this or another
+ * process, reading from the part past its new end raises SIGBUS instead of
+ * failing like a read() would. Therefore, only files opened through
+ * FSNode::createMappedReadStream() are mapped, which is meant for game data
+ * and never used for savegames or configuration files.
+ */
+class MmapStream : public Common::MemoryReadStream, public Common::NonCopyable {
+protected:
+	enum {
+		/** Files larger than this are read through stdio instead. */
+		kMaxMappingSize = 64 * 1024 * 1024
+	};
+
+	/** A mapped file; unmapped when the last stream referring to it goes away. */
+	struct Mapping {
+		void *_addr;
+		uint32 _length;
+
+		Mapping(void *addr, uint32 length) : _addr(addr), _length(length) {}
+		~Mapping();
+	};
+
+	Common::SharedPtr<Mapping> _mapping;
+
+	MmapStream(const Common::SharedPtr<Mapping> &mapping, const byte *data, uint32 size);
+
+public:
+	/**
+	 * Maps the file at the given path into memory and wraps it in a
+	 * MmapStream instance. Returns 0 if the file is not a regular file or
+	 * could not be mapped, in which case the caller should fall back to
+	 * regular file I/O.
+	 */
+	static MmapStream *makeFromPath(const Common::String &path);
+
+	virtual Common::SeekableReadStream *readStream(uint32 dataSize);
+};
+
+#endif
@@ -27,6 +27,9 @@
 #include "backends/fs/windows/windows-fs.h"
 #include "backends/fs/stdiostream.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 // F_OK, R_OK and W_OK are not defined under MSVC, so we define them here
 // For more information on the modes used by MSVC, check:
 // http://msdn2.microsoft.com/en-us/library/1w06ktdy(VS.80).aspx
@@ -54,6 +57,23 @@ bool WindowsFilesystemNode::isWritable() const {
 	return _access(_path.c_str(), W_OK) == 0;
 }
 
+uint32 WindowsFilesystemNode::getModificationTime() const {
+	struct _stat st;
+
+	if (_stat(_path.c_str(), &st) != 0)
+		return 0;
+	return (uint32)st.st_mtime;
+}
+
+int32 WindowsFilesystemNode::getFileSize() const {
+	// The size in struct _stat is only 32 bits wide
+	struct _stati64 st;
+
+	if (_stati64(_path.c_str(), &st) != 0 || !(st.st_mode & _S_IFREG) || st.st_size > 0x7FFFFFFF)
+		return -1;
+	return (int32)st.st_size;
+}
+
 void WindowsFilesystemNode::addFile(AbstractFSList &list, ListMode mode, const char *base, bool hidden, WIN32_FIND_DATA* find_data) {
 	WindowsFilesystemNode entry;
 	char *asciiName = toAscii(find_data->cFileName);
@@ -28,10 +28,12 @@
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #include "common/util.h"
+#include "common/workerpool.h"
 #ifdef USE_RGB_COLOR
 #include "common/list.h"
 #endif
@@ -129,7 +131,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_overlayVisible(false),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerPool(0), _screenChangeCount(0),
 	_mouseVisible(false), _mouseNeedsRedraw(false), _mouseData(0), _mouseSurface(0),
 	_mouseOrigSurface(0), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
@@ -205,6 +207,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 		SDL_FreeSurface(_mouseOrigSurface);
 	_mouseOrigSurface = 0;
 	g_system->deleteMutex(_graphicsMutex);
+	delete _scalerPool;
 
 	free(_currentPalette);
 	free(_cursorPalette);
@@ -1096,8 +1099,16 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				if (scalerProc == Normal1x) {
+					scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				} else {
+					if (!_scalerPool)
+						_scalerPool = new Common::WorkerPool(kScalerThreads);
+					ScaleInBands(*_scalerPool, kScalerThreads + 1, scalerProc, scale1,
+						(byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				}
 			}
 
 			r->x = rx1;
@@ -1200,6 +1211,11 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		}
 #endif
 
+		int updatedPixels = 0;
+		for (r = _dirtyRectList; r != _dirtyRectList + _numDirtyRects; ++r)
+			updatedPixels += r->w * r->h;
+		debug(9, "SDL: Updating %d of %d pixels in %d rects", updatedPixels, _hwscreen->w * _hwscreen->h, _numDirtyRects);
+
 		// Finally, blit all our changes to the screen
 		if (!_displayDisabled) {
 			SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
@@ -1343,15 +1359,41 @@ void SurfaceSdlGraphicsManager::fillScreen(uint32 col) {
 	unlockScreen();
 }
 
+static int rectArea(const SDL_Rect &r) {
+	return r.w * r.h;
+}
+
+/** Compute the smallest rect containing both a and b. */
+static SDL_Rect rectUnion(const SDL_Rect &a, const SDL_Rect &b) {
+	const int x1 = MIN<int>(a.x, b.x);
+	const int y1 = MIN<int>(a.y, b.y);
+	const int x2 = MAX<int>(a.x + a.w, b.x + b.w);
+	const int y2 = MAX<int>(a.y + a.h, b.y + b.h);
+
+	SDL_Rect u;
+	u.x = x1;
+	u.y = y1;
+	u.w = x2 - x1;
+	u.h = y2 - y1;
+	return u;
+}
+
+/**
+ * Compute how many pixels the union of a and b covers which neither a nor b
+ * cover, i.e. how much merging the two rects would add to the update.
+ */
+static int rectMergeCost(const SDL_Rect &a, const SDL_Rect &b) {
+	const int overlapW = MIN<int>(a.x + a.w, b.x + b.w) - MAX<int>(a.x, b.x);
+	const int overlapH = MIN<int>(a.y + a.h, b.y + b.h) - MAX<int>(a.y, b.y);
+	const int overlap = (overlapW > 0 && overlapH > 0) ? overlapW * overlapH : 0;
+
+	return rectArea(rectUnion(a, b)) - rectArea(a) - rectArea(b) + overlap;
+}
+
 void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool realCoordinates) {
 	if (_forceFull)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceFull = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1401,14 +1443,59 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		return;
 	}
 
-	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+	if (w <= 0 || h <= 0)
+		return;
+
+	SDL_Rect rect;
+	rect.x = x;
+	rect.y = y;
+	rect.w = w;
+	rect.h = h;
+
+	// Merge the new rect with every rect which overlaps or nearly touches
+	// it, so overlapping sprites are not scaled and blitted several times.
+	// A few extra pixels are cheaper than another rect to scale and blit.
+	// Since the merged rect may reach other rects, start over after each
+	// merge. If the list is full, merge with the rect adding the fewest
+	// pixels instead of falling back to a full update.
+	for (;;) {
+		int i = 0;
+		while (i < _numDirtyRects) {
+			const SDL_Rect merged = rectUnion(_dirtyRectList[i], rect);
+			const int cost = rectMergeCost(_dirtyRectList[i], rect);
+			if (cost <= kDirtyRectMergeSlack || cost * 4 <= rectArea(merged)) {
+				rect = merged;
+				_dirtyRectList[i] = _dirtyRectList[--_numDirtyRects];
+				i = 0;
+			} else {
+				++i;
+			}
+		}
+
+		if (_numDirtyRects < NUM_DIRTY_RECT)
+			break;
 
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
+		int best = 0;
+		int bestCost = rectMergeCost(_dirtyRectList[0], rect);
+		for (i = 1; i < _numDirtyRects; ++i) {
+			const int cost = rectMergeCost(_dirtyRectList[i], rect);
+			if (cost < bestCost) {
+				best = i;
+				bestCost = cost;
+			}
+		}
+		rect = rectUnion(_dirtyRectList[best], rect);
+		_dirtyRectList[best] = _dirtyRectList[--_numDirtyRects];
 	}
+
+	// After the screen was scaled, the list holds real coordinates and a
+	// full update is not possible anymore
+	if (rect.w == width && rect.h == height && !realCoordinates) {
+		_forceFull = true;
+		return;
+	}
+
+	_dirtyRectList[_numDirtyRects++] = rect;
 }
 
 int16 SurfaceSdlGraphicsManager::getHeight() {
@@ -232,6 +232,13 @@ protected:
 	int _scalerType;
 	int _transactionMode;
 
+	enum {
+		kScalerThreads = 3
+	};
+
+	/** Worker threads scaling the dirty rects in bands, created on first use */
+	Common::WorkerPool *_scalerPool;
+
 	// Indicates whether it is needed to free _hwsurface in destructor
 	bool _displayDisabled;
 
@@ -245,6 +252,11 @@ protected:
 		MAX_SCALING = 3
 	};
 
+	enum {
+		/** Pixels a merge of two dirty rects may add in any case */
+		kDirtyRectMergeSlack = 64
+	};
+
 	// Dirty rect management
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
@@ -29,6 +29,7 @@
 #include "common/system.h"
 #include "common/config-manager.h"
 #include "common/textconsole.h"
+#include "common/util.h"
 
 #ifdef GP2X
 #define SAMPLES_PER_SEC 11025
@@ -117,6 +118,15 @@ SDL_AudioSpec SdlMixerManager::getAudioSpec(uint32 outputRate) {
 	while (samples * 16 > samplesPerSec * 2)
 		samples >>= 1;
 
+	// Allow overriding the buffer size, e.g. for lower latency when the
+	// mixer decodes ahead of time. Round down to a power of two.
+	if (ConfMan.hasKey("audio_buffer_size")) {
+		const uint32 requested = CLIP<int>(ConfMan.getInt("audio_buffer_size"), 256, 8192);
+		samples = 256;
+		while (samples * 2 <= requested)
+			samples <<= 1;
+	}
+
 	memset(&desired, 0, sizeof(desired));
 	desired.freq = samplesPerSec;
 	desired.format = AUDIO_S16SYS;
@@ -26,6 +26,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/mutex/mutex.h"
+#include "backends/thread/thread.h"
 #include "gui/EventRecorder.h"
 
 #include "audio/mixer.h"
@@ -34,6 +35,7 @@
 ModularBackend::ModularBackend()
 	:
 	_mutexManager(0),
+	_threadManager(0),
 	_graphicsManager(0),
 	_mixer(0) {
 
@@ -44,6 +46,8 @@ ModularBackend::~ModularBackend() {
 	_graphicsManager = 0;
 	delete _mixer;
 	_mixer = 0;
+	delete _threadManager;
+	_threadManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 }
@@ -232,6 +236,38 @@ void ModularBackend::deleteMutex(MutexRef mutex) {
 	_mutexManager->deleteMutex(mutex);
 }
 
+OSystem::ThreadRef ModularBackend::createThread(ThreadProc proc, void *param) {
+	if (!_threadManager)
+		return 0;
+	return _threadManager->createThread(proc, param);
+}
+
+void ModularBackend::joinThread(ThreadRef thread) {
+	assert(_threadManager);
+	_threadManager->joinThread(thread);
+}
+
+OSystem::SemaphoreRef ModularBackend::createSemaphore(uint initialCount) {
+	if (!_threadManager)
+		return 0;
+	return _threadManager->createSemaphore(initialCount);
+}
+
+void ModularBackend::waitSemaphore(SemaphoreRef semaphore) {
+	assert(_threadManager);
+	_threadManager->waitSemaphore(semaphore);
+}
+
+void ModularBackend::postSemaphore(SemaphoreRef semaphore) {
+	assert(_threadManager);
+	_threadManager->postSemaphore(semaphore);
+}
+
+void ModularBackend::deleteSemaphore(SemaphoreRef semaphore) {
+	assert(_threadManager);
+	_threadManager->deleteSemaphore(semaphore);
+}
+
 Audio::Mixer *ModularBackend::getMixer() {
 	assert(_mixer);
 	return (Audio::Mixer *)_mixer;
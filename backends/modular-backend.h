@@ -27,6 +27,7 @@
 
 class GraphicsManager;
 class MutexManager;
+class ThreadManager;
 
 /**
  * Base class for modular backends.
@@ -115,6 +116,18 @@ public:
 
 	//@}
 
+	/** @name Thread handling */
+	//@{
+
+	virtual ThreadRef createThread(ThreadProc proc, void *param);
+	virtual void joinThread(ThreadRef thread);
+	virtual SemaphoreRef createSemaphore(uint initialCount);
+	virtual void waitSemaphore(SemaphoreRef semaphore);
+	virtual void postSemaphore(SemaphoreRef semaphore);
+	virtual void deleteSemaphore(SemaphoreRef semaphore);
+
+	//@}
+
 	/** @name Sound */
 	//@{
 
@@ -135,6 +148,7 @@ protected:
 	//@{
 
 	MutexManager *_mutexManager;
+	ThreadManager *_threadManager;
 	GraphicsManager *_graphicsManager;
 	Audio::Mixer *_mixer;
 
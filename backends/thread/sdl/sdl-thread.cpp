@@ -0,0 +1,59 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/thread/sdl/sdl-thread.h"
+#include "backends/platform/sdl/sdl-sys.h"
+
+
+OSystem::ThreadRef SdlThreadManager::createThread(OSystem::ThreadProc proc, void *param) {
+#if SDL_VERSION_ATLEAST(1, 3, 0)
+	return (OSystem::ThreadRef) SDL_CreateThread(proc, "ScummVM worker", param);
+#else
+	return (OSystem::ThreadRef) SDL_CreateThread(proc, param);
+#endif
+}
+
+void SdlThreadManager::joinThread(OSystem::ThreadRef thread) {
+	SDL_WaitThread((SDL_Thread *)thread, NULL);
+}
+
+OSystem::SemaphoreRef SdlThreadManager::createSemaphore(uint initialCount) {
+	return (OSystem::SemaphoreRef) SDL_CreateSemaphore(initialCount);
+}
+
+void SdlThreadManager::waitSemaphore(OSystem::SemaphoreRef semaphore) {
+	SDL_SemWait((SDL_sem *)semaphore);
+}
+
+void SdlThreadManager::postSemaphore(OSystem::SemaphoreRef semaphore) {
+	SDL_SemPost((SDL_sem *)semaphore);
+}
+
+void SdlThreadManager::deleteSemaphore(OSystem::SemaphoreRef semaphore) {
+	SDL_DestroySemaphore((SDL_sem *)semaphore);
+}
+
+#endif
@@ -0,0 +1,46 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_THREAD_ABSTRACT_H
+#define BACKENDS_THREAD_ABSTRACT_H
+
+#include "common/system.h"
+#include "common/noncopyable.h"
+
+/**
+ * Abstract class for thread manager. Subclasses
+ * implement the real functionality.
+ */
+class ThreadManager : Common::NonCopyable {
+public:
+	virtual ~ThreadManager() {}
+
+	virtual OSystem::ThreadRef createThread(OSystem::ThreadProc proc, void *param) = 0;
+	virtual void joinThread(OSystem::ThreadRef thread) = 0;
+
+	virtual OSystem::SemaphoreRef createSemaphore(uint initialCount) = 0;
+	virtual void waitSemaphore(OSystem::SemaphoreRef semaphore) = 0;
+	virtual void postSemaphore(OSystem::SemaphoreRef semaphore) = 0;
+	virtual void deleteSemaphore(OSystem::SemaphoreRef semaphore) = 0;
+};
+
+#endif
@@ -33,78 +33,147 @@ struct TimerSlot {
 	uint32 nextFireTime;	// in milliseconds
 	uint32 nextFireTimeMicro;	// microseconds part of nextFire
 
-	TimerSlot *next;
-};
+	bool removed;	// set when removed while its callback is running
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
+	uint32 calls;
+	uint32 lateCalls;
+	uint32 totalLateness;
+	uint32 maxLateness;
+	uint32 totalDuration;
+	uint32 maxDuration;
+};
 
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = 0;
+/**
+ * Return whether slot a is due before slot b. The millisecond counter
+ * may wrap, so only the difference between the two is compared.
+ */
+static bool firesBefore(const TimerSlot *a, const TimerSlot *b) {
+	const int32 diff = (int32)(a->nextFireTime - b->nextFireTime);
+	if (diff != 0)
+		return diff < 0;
+	return a->nextFireTimeMicro < b->nextFireTimeMicro;
+}
 
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
-	while (true) {
-		assert(slot);
-		if (slot->next == 0 || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
-	}
+static void resetStats(TimerSlot *slot) {
+	slot->calls = 0;
+	slot->lateCalls = 0;
+	slot->totalLateness = 0;
+	slot->maxLateness = 0;
+	slot->totalDuration = 0;
+	slot->maxDuration = 0;
 }
 
 
 DefaultTimerManager::DefaultTimerManager() :
-	_head(0) {
-
-	_head = new TimerSlot();
-	memset(_head, 0, sizeof(TimerSlot));
+	_running(0), _thread(0), _threadQuit(false) {
 }
 
 DefaultTimerManager::~DefaultTimerManager() {
+	stopThread();
+
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
+	for (TimerSlotHeap::iterator i = _heap.begin(); i != _heap.end(); ++i)
+		delete *i;
+	_heap.clear();
+}
+
+void DefaultTimerManager::pushSlot(TimerSlot *slot) {
+	uint pos = _heap.size();
+	_heap.push_back(slot);
+
+	while (pos > 0) {
+		const uint parent = (pos - 1) / 2;
+		if (!firesBefore(slot, _heap[parent]))
+			break;
+		_heap[pos] = _heap[parent];
+		pos = parent;
+	}
+	_heap[pos] = slot;
+}
+
+TimerSlot *DefaultTimerManager::popSlot() {
+	TimerSlot *slot = _heap[0];
+	_heap[0] = _heap.back();
+	_heap.pop_back();
+	if (!_heap.empty())
+		siftDown(0);
+	return slot;
+}
+
+void DefaultTimerManager::siftDown(uint pos) {
+	const uint size = _heap.size();
+	TimerSlot *slot = _heap[pos];
+
+	while (true) {
+		uint child = pos * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && firesBefore(_heap[child + 1], _heap[child]))
+			child++;
+		if (!firesBefore(_heap[child], slot))
+			break;
+		_heap[pos] = _heap[child];
+		pos = child;
 	}
-	_head = 0;
+	_heap[pos] = slot;
 }
 
 void DefaultTimerManager::handler() {
-	Common::StackLock lock(_mutex);
+	// Callbacks are invoked with _runMutex held instead of _mutex, so that
+	// timers can be installed and removed while a slow callback is running.
+	Common::StackLock runLock(_runMutex);
 
-	uint32 curTime = g_system->getMillis(true);
+	const uint32 curTime = g_system->getMillis(true);
 
 	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
+	while (true) {
+		TimerSlot *slot;
+		{
+			Common::StackLock lock(_mutex);
+			if (_heap.empty() || (int32)(curTime - _heap[0]->nextFireTime) <= 0)
+				break;
+			slot = popSlot();
+			_running = slot;
+		}
 
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
+		const uint32 startTime = g_system->getMillis(true);
+		const int32 lateness = MAX<int32>(0, (int32)(startTime - slot->nextFireTime));
+
+		// Update the fire time. It is advanced from the previous deadline
+		// rather than from the current time, so the timer does not drift.
 		assert(slot->interval > 0);
 		slot->nextFireTime += (slot->interval / 1000);
 		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
+		if (slot->nextFireTimeMicro >= 1000) {
 			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
 			slot->nextFireTimeMicro %= 1000;
 		}
-		insertPrioQueue(_head, slot);
 
 		// Invoke the timer callback
 		assert(slot->callback);
 		slot->callback(slot->refCon);
 
-		// Look at the next scheduled timer
-		slot = _head->next;
+		const uint32 duration = g_system->getMillis(true) - startTime;
+
+		Common::StackLock lock(_mutex);
+		_running = 0;
+
+		if (slot->removed) {
+			delete slot;
+			continue;
+		}
+
+		slot->calls++;
+		if ((uint32)lateness * 1000 >= slot->interval)
+			slot->lateCalls++;
+		slot->totalLateness += lateness;
+		slot->maxLateness = MAX<uint32>(slot->maxLateness, lateness);
+		slot->totalDuration += duration;
+		slot->maxDuration = MAX(slot->maxDuration, duration);
+
+		// Reinsert the TimerSlot into the priority queue
+		pushSlot(slot);
 	}
 }
 
@@ -133,42 +202,141 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	slot->interval = interval;
 	slot->nextFireTime = g_system->getMillis() + interval / 1000;
 	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = 0;
+	slot->removed = false;
+	resetStats(slot);
 
-	insertPrioQueue(_head, slot);
+	pushSlot(slot);
 
 	return true;
 }
 
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
-	Common::StackLock lock(_mutex);
+	bool isRunning = false;
+
+	{
+		Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
+		uint count = 0;
+		for (uint i = 0; i < _heap.size(); ++i) {
+			if (_heap[i]->callback == callback)
+				delete _heap[i];
+			else
+				_heap[count++] = _heap[i];
+		}
 
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
-		} else {
-			slot = slot->next;
+		if (count != _heap.size()) {
+			_heap.resize(count);
+			for (uint i = count / 2; i-- > 0; )
+				siftDown(i);
 		}
+
+		// The slot of a running callback is not in the heap; handler()
+		// deletes it once the callback has returned.
+		if (_running && _running->callback == callback) {
+			_running->removed = true;
+			isRunning = true;
+		}
+
+		// We need to remove all names referencing the timer proc here.
+		//
+		// Else we run into troubles, when the client code removes and readds timer
+		// callbacks.
+		//
+		// Another issues occurs when one plays a game with ALSA as music driver,
+		// does RTL and starts a different engine game with ALSA as music driver.
+		// In this case the MPU401 code will add different timer procs with the
+		// same name, resulting in two different callbacks added with the same
+		// name and causing installTimerProc to error out.
+		// A good test case is running a SCUMM with ALSA output and then a KYRA
+		// game for example.
+		for (TimerSlotMap::iterator i = _callbacks.begin(), end = _callbacks.end(); i != end; ++i) {
+			if (i->_value == callback)
+				_callbacks.erase(i);
+		}
+	}
+
+	// No instance of the callback may be running once we return, so wait
+	// for handler() to finish it. The mutex is recursive, so this does not
+	// block when a callback removes itself.
+	if (isRunning) {
+		Common::StackLock runLock(_runMutex);
 	}
+}
+
+Common::TimerManager::TimerInfoList DefaultTimerManager::getTimerInfo() {
+	Common::StackLock lock(_mutex);
 
-	// We need to remove all names referencing the timer proc here.
-	//
-	// Else we run into troubles, when the client code removes and readds timer
-	// callbacks.
-	//
-	// Another issues occurs when one plays a game with ALSA as music driver,
-	// does RTL and starts a different engine game with ALSA as music driver.
-	// In this case the MPU401 code will add different timer procs with the
-	// same name, resulting in two different callbacks added with the same
-	// name and causing installTimerProc to error out.
-	// A good test case is running a SCUMM with ALSA output and then a KYRA
-	// game for example.
-	for (TimerSlotMap::iterator i = _callbacks.begin(), end = _callbacks.end(); i != end; ++i) {
-		if (i->_value == callback)
-			_callbacks.erase(i);
+	TimerInfoList list;
+	for (uint i = 0; i <= _heap.size(); ++i) {
+		const TimerSlot *slot = (i < _heap.size()) ? _heap[i] : _running;
+		if (!slot || slot->removed)
+			continue;
+
+		TimerInfo info;
+		info.id = slot->id;
+		info.interval = slot->interval;
+		info.calls = slot->calls;
+		info.lateCalls = slot->lateCalls;
+		info.totalLateness = slot->totalLateness;
+		info.maxLateness = slot->maxLateness;
+		info.totalDuration = slot->totalDuration;
+		info.maxDuration = slot->maxDuration;
+		list.push_back(info);
 	}
+
+	return list;
+}
+
+void DefaultTimerManager::resetTimerInfo() {
+	Common::StackLock lock(_mutex);
+
+	for (TimerSlotHeap::iterator i = _heap.begin(); i != _heap.end(); ++i)
+		resetStats(*i);
+	if (_running)
+		resetStats(_running);
+}
+
+uint32 DefaultTimerManager::getMillisToNextTimer(uint32 maxDelay) {
+	Common::StackLock lock(_mutex);
+
+	if (_heap.empty())
+		return maxDelay;
+
+	// handler() fires a timer once its deadline has passed
+	const int32 delay = (int32)(_heap[0]->nextFireTime + 1 - g_system->getMillis(true));
+	return CLIP<int32>(delay, 0, maxDelay);
+}
+
+int DefaultTimerManager::threadProc(void *param) {
+	DefaultTimerManager *manager = (DefaultTimerManager *)param;
+
+	while (!manager->_threadQuit) {
+		manager->handler();
+
+		// Sleep until the next timer is due. The delay is limited, so that
+		// newly installed timers and stopThread() are noticed in time.
+		const uint32 delay = manager->getMillisToNextTimer(10);
+		if (delay)
+			g_system->delayMillis(delay);
+	}
+
+	return 0;
+}
+
+bool DefaultTimerManager::startThread() {
+	if (_thread)
+		return true;
+
+	_threadQuit = false;
+	_thread = g_system->createThread(&threadProc, this);
+	return _thread != 0;
+}
+
+void DefaultTimerManager::stopThread() {
+	if (!_thread)
+		return;
+
+	_threadQuit = true;
+	g_system->joinThread(_thread);
+	_thread = 0;
 }
@@ -23,30 +23,70 @@
 #define BACKENDS_TIMER_DEFAULT_H
 
 #include "common/str.h"
+#include "common/array.h"
 #include "common/hash-str.h"
 #include "common/timer.h"
 #include "common/mutex.h"
+#include "common/system.h"
 
 struct TimerSlot;
 
+/**
+ * Generic timer manager. The installed timers are kept in a binary heap
+ * ordered by their next deadline. The backend either calls handler() at
+ * regular intervals, or starts a dedicated timer thread with startThread().
+ */
 class DefaultTimerManager : public Common::TimerManager {
 private:
 	typedef Common::HashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
+	typedef Common::Array<TimerSlot *> TimerSlotHeap;
 
+	/** Protects the heap, the callback map and _running. */
 	Common::Mutex _mutex;
-	TimerSlot *_head;
+	/** Held while handler() invokes callbacks. */
+	Common::Mutex _runMutex;
+	TimerSlotHeap _heap;
 	TimerSlotMap _callbacks;
+	/** The slot whose callback is currently being invoked, if any. */
+	TimerSlot *_running;
+
+	OSystem::ThreadRef _thread;
+	volatile bool _threadQuit;
+
+	void pushSlot(TimerSlot *slot);
+	TimerSlot *popSlot();
+	void siftDown(uint pos);
+
+	/** Return the number of milliseconds until the next timer is due. */
+	uint32 getMillisToNextTimer(uint32 maxDelay);
+
+	static int threadProc(void *param);
 
 public:
 	DefaultTimerManager();
 	virtual ~DefaultTimerManager();
 	virtual bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id);
 	virtual void removeTimerProc(TimerProc proc);
+	virtual TimerInfoList getTimerInfo();
+	virtual void resetTimerInfo();
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
 	 */
 	void handler();
+
+	/**
+	 * Start a thread which invokes the timers when they are due, so the
+	 * backend does not need to call handler() itself.
+	 * @return true if the thread was started, false if threads are not
+	 *         supported by the backend.
+	 */
+	bool startThread();
+
+	/**
+	 * Stop the timer thread started by startThread(), if any.
+	 */
+	void stopThread();
 };
 
 #endif
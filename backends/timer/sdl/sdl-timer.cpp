@@ -27,6 +27,7 @@
 
 #include "backends/timer/sdl/sdl-timer.h"
 
+#include "common/config-manager.h"
 #include "common/textconsole.h"
 
 static Uint32 timer_handler(Uint32 interval, void *param) {
@@ -34,19 +35,25 @@ static Uint32 timer_handler(Uint32 interval, void *param) {
 	return interval;
 }
 
-SdlTimerManager::SdlTimerManager() {
+SdlTimerManager::SdlTimerManager() : _timerID(0) {
 	// Initializes the SDL timer subsystem
 	if (SDL_InitSubSystem(SDL_INIT_TIMER) == -1) {
 		error("Could not initialize SDL: %s", SDL_GetError());
 	}
 
-	// Creates the timer callback
-	_timerID = SDL_AddTimer(10, &timer_handler, this);
+	// Use a dedicated timer thread if requested, otherwise poll the timers
+	// from an SDL timer callback
+	if (!ConfMan.getBool("timer_thread") || !startThread()) {
+		// Creates the timer callback
+		_timerID = SDL_AddTimer(10, &timer_handler, this);
+	}
 }
 
 SdlTimerManager::~SdlTimerManager() {
 	// Removes the timer callback
-	SDL_RemoveTimer(_timerID);
+	if (_timerID)
+		SDL_RemoveTimer(_timerID);
+	stopThread();
 }
 
 #endif
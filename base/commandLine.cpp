@@ -190,6 +190,13 @@ void registerDefaults() {
 	ConfMan.registerDefault("speech_mute", false);
 	ConfMan.registerDefault("mute", false);
 
+	ConfMan.registerDefault("decode_ahead", false);
+	ConfMan.registerDefault("mix_bus_32bit", false);
+	ConfMan.registerDefault("mix_dither", false);
+	ConfMan.registerDefault("resample_quality", 0);
+
+	ConfMan.registerDefault("timer_thread", false);
+
 	ConfMan.registerDefault("multi_midi", false);
 	ConfMan.registerDefault("native_mt32", false);
 	ConfMan.registerDefault("enable_gs", false);
@@ -31,6 +31,7 @@
 // FIXME: Avoid using printf
 #define FORBIDDEN_SYMBOL_EXCEPTION_printf
 
+#include "engines/detectioncache.h"
 #include "engines/engine.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
@@ -423,6 +424,12 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	MusicManager::instance();
 	Common::DebugManager::instance();
 
+	// Engines look up many files by name through the SearchManager. Remember
+	// which archive has which file, instead of asking every archive each time.
+	// This needs no locking, since SearchMan is only used on the main thread;
+	// background jobs such as the SCI prefetcher open their files beforehand.
+	SearchMan.setIndexEnabled(true);
+
 	// Init the event manager. As the virtual keyboard is loaded here, it must
 	// take place after the backend is initiated and the screen has been setup
 	system.getEventManager()->init();
@@ -473,6 +480,10 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 			// Try to run the game
 			Common::Error result = runGame(plugin, system, specialDebug);
 
+			// Stop the YUV conversion threads, which only videos of the
+			// game use
+			Graphics::YUVToRGBManager::destroy();
+
 #ifdef ENABLE_EVENTRECORDER
 			// Flush Event recorder file. The recorder does not get reinitialized for next game
 			// which is intentional. Only single game per session is allowed.
@@ -527,6 +538,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	}
 	PluginManager::instance().unloadAllPlugins();
 	PluginManager::destroy();
+	DetectionCache::destroy();
 	GUI::GuiManager::destroy();
 	Common::ConfigManager::destroy();
 	Common::DebugManager::destroy();
@@ -444,12 +444,22 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 
 // Engine plugins
 
+#include "common/workerpool.h"
+
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 
 namespace Common {
 DECLARE_SINGLETON(EngineManager);
 }
 
+EngineManager::EngineManager() : _detectionPool(0) {
+}
+
+EngineManager::~EngineManager() {
+	delete _detectionPool;
+}
+
 /**
  * This function works for both cached and uncached PluginManagers.
  * For the cached version, most of the logic here will short circuit.
@@ -527,9 +537,116 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 			candidates.push_back((**iter)->detectGames(fslist));
 		}
 	} while (PluginManager::instance().loadNextPlugin());
+
+	// Keep the file fingerprints computed by the engines for the next scan
+	DetectionCache::instance().flush();
 	return candidates;
 }
 
+namespace {
+
+/**
+ * Lists a directory and runs the thread safe detectors of the currently
+ * loaded engine plugins on it.
+ *
+ * All the FSNodes of the directory are only used by the job while it runs,
+ * as their reference counts may not be touched by several threads at once.
+ */
+class DirectoryDetectionJob : public Common::WorkerJob {
+public:
+	DirectoryDetectionJob(const Common::FSNode &dir) : _dir(dir), _plugins(0), _listed(false), _listable(false) {}
+
+	void setPlugins(const EnginePlugin::List &plugins) {
+		_plugins = &plugins;
+		_results.clear();
+		_results.resize(plugins.size());
+	}
+
+	virtual void run() {
+		if (!_listed) {
+			_listable = _dir.getChildren(_files, Common::FSNode::kListAll);
+			_listed = true;
+		}
+
+		for (uint i = 0; i < _plugins->size(); i++) {
+			const MetaEngine &metaEngine = **(*_plugins)[i];
+			if (_listable && metaEngine.isDetectionThreadSafe())
+				_results[i] = metaEngine.detectGames(_files);
+		}
+	}
+
+	const Common::FSNode &_dir;
+	const EnginePlugin::List *_plugins;
+	bool _listed;
+	bool _listable;
+	Common::FSList _files;
+	/** Games detected by each of the plugins, in plugin order */
+	Common::Array<GameList> _results;
+};
+
+} // End of anonymous namespace
+
+void EngineManager::detectGamesInDirectories(const Common::FSList &dirs, Common::Array<GameList> &results, Common::Array<Common::FSList> &contents, Common::Array<bool> &listed) const {
+	results.clear();
+	results.resize(dirs.size());
+	contents.clear();
+	contents.resize(dirs.size());
+	listed.clear();
+	listed.resize(dirs.size());
+
+	if (dirs.empty())
+		return;
+
+	if (!_detectionPool)
+		_detectionPool = new Common::WorkerPool(kDetectionThreads);
+
+	// Make sure the singletons used by the detectors are created on this
+	// thread, and that the detection cache is read through the savefile
+	// manager here, rather than on a worker thread
+	DetectionCache::instance().load();
+
+	Common::Array<DirectoryDetectionJob *> jobs;
+	Common::Array<Common::WorkerJob *> workerJobs;
+	for (uint i = 0; i < dirs.size(); i++) {
+		jobs.push_back(new DirectoryDetectionJob(dirs[i]));
+		workerJobs.push_back(jobs.back());
+	}
+
+	EnginePlugin::List plugins;
+	PluginManager::instance().loadFirstPlugin();
+	do {
+		plugins = getPlugins();
+		for (uint i = 0; i < jobs.size(); i++)
+			jobs[i]->setPlugins(plugins);
+
+		_detectionPool->runAll(&workerJobs[0], workerJobs.size());
+
+		// Merge the results in plugin order, running the detectors which
+		// are not thread safe on the way
+		for (uint i = 0; i < jobs.size(); i++) {
+			const DirectoryDetectionJob &job = *jobs[i];
+			if (!job._listable)
+				continue;
+
+			for (uint j = 0; j < plugins.size(); j++) {
+				if ((*plugins[j])->isDetectionThreadSafe())
+					results[i].push_back(job._results[j]);
+				else
+					results[i].push_back((*plugins[j])->detectGames(job._files));
+			}
+		}
+	} while (PluginManager::instance().loadNextPlugin());
+
+	for (uint i = 0; i < jobs.size(); i++) {
+		contents[i] = jobs[i]->_files;
+		listed[i] = jobs[i]->_listable;
+		delete jobs[i];
+	}
+
+	// Keep the file fingerprints computed by the engines for the next scan
+	DetectionCache::instance().flush();
+}
+
 const EnginePlugin::List &EngineManager::getPlugins() const {
 	return (const EnginePlugin::List &)PluginManager::instance().getPlugins(PLUGIN_TYPE_ENGINE);
 }
@@ -98,6 +98,9 @@ void SearchSet::add(const String &name, Archive *archive, int priority, bool aut
 	if (find(name) == _list.end()) {
 		Node node(priority, name, archive, autoFree);
 		insert(node);
+		if (!archive->isIndexable())
+			_unindexable++;
+		invalidateIndex();
 	} else {
 		if (autoFree)
 			delete archive;
@@ -171,9 +174,12 @@ void SearchSet::addSubDirectoriesMatching(const FSNode &directory, String origPa
 void SearchSet::remove(const String &name) {
 	ArchiveNodeList::iterator it = find(name);
 	if (it != _list.end()) {
+		if (!it->_arc->isIndexable())
+			_unindexable--;
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		invalidateIndex();
 	}
 }
 
@@ -188,6 +194,8 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	_unindexable = 0;
+	invalidateIndex();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -204,12 +212,44 @@ void SearchSet::setPriority(const String &name, int priority) {
 	_list.erase(it);
 	node._priority = priority;
 	insert(node);
+	invalidateIndex();
+}
+
+void SearchSet::setIndexEnabled(bool enable) {
+	_indexEnabled = enable;
+	invalidateIndex();
+}
+
+void SearchSet::invalidateIndex() {
+	_index.clear(true);
+	_patternIndex.clear(true);
+}
+
+Archive *SearchSet::findArchive(const String &name) const {
+	ArchiveIndex::const_iterator i = _index.find(name);
+	if (i != _index.end())
+		return i->_value;
+
+	Archive *arc = 0;
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for ( ; it != _list.end(); ++it) {
+		if (it->_arc->hasFile(name)) {
+			arc = it->_arc;
+			break;
+		}
+	}
+
+	_index[name] = arc;
+	return arc;
 }
 
 bool SearchSet::hasFile(const String &name) const {
 	if (name.empty())
 		return false;
 
+	if (useIndex())
+		return findArchive(name) != 0;
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for ( ; it != _list.end(); ++it) {
 		if (it->_arc->hasFile(name))
@@ -220,6 +260,21 @@ bool SearchSet::hasFile(const String &name) const {
 }
 
 int SearchSet::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
+	if (useIndex()) {
+		PatternIndex::const_iterator i = _patternIndex.find(pattern);
+		if (i == _patternIndex.end()) {
+			ArchiveMemberList members;
+			ArchiveNodeList::const_iterator it = _list.begin();
+			for ( ; it != _list.end(); ++it)
+				it->_arc->listMatchingMembers(members, pattern);
+			_patternIndex[pattern] = members;
+			i = _patternIndex.find(pattern);
+		}
+
+		list.insert(list.end(), i->_value.begin(), i->_value.end());
+		return i->_value.size();
+	}
+
 	int matches = 0;
 
 	ArchiveNodeList::const_iterator it = _list.begin();
@@ -243,6 +298,11 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
+	if (useIndex()) {
+		Archive *arc = findArchive(name);
+		return arc ? arc->getMember(name) : ArchiveMemberPtr();
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for ( ; it != _list.end(); ++it) {
 		if (it->_arc->hasFile(name))
@@ -256,6 +316,18 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	if (name.empty())
 		return 0;
 
+	if (useIndex()) {
+		Archive *arc = findArchive(name);
+		if (!arc)
+			return 0;
+
+		// Should the archive fail to open the member after all, fall back
+		// to asking all archives
+		SeekableReadStream *stream = arc->createReadStreamForMember(name);
+		if (stream)
+			return stream;
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for ( ; it != _list.end(); ++it) {
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
@@ -24,6 +24,8 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -117,6 +119,12 @@ public:
 	 * @return the newly created input stream
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const = 0;
+
+	/**
+	 * Check whether a SearchSet containing this archive may remember which
+	 * names the archive has (see SearchSet::setIndexEnabled).
+	 */
+	virtual bool isIndexable() const { return true; }
 };
 
 
@@ -126,6 +134,13 @@ public:
  * contained Archives, hence the simplistic policy of always looking for the first
  * match. SearchSet *DOES* guarantee that searches are performed in *DESCENDING*
  * priority order. In case of conflicting priorities, insertion order prevails.
+ *
+ * Optionally, a SearchSet can keep an index of the lookups made so far (see
+ * setIndexEnabled), so that looking up the same name again does not have to
+ * ask every archive in turn.
+ *
+ * A SearchSet must only be used from one thread at a time. In particular,
+ * SearchMan must only be used from the main thread.
  */
 class SearchSet : public Archive {
 	struct Node {
@@ -146,7 +161,24 @@ class SearchSet : public Archive {
 	// Add an archive keeping the list sorted by descending priority.
 	void insert(const Node& node);
 
+	typedef HashMap<String, Archive *> ArchiveIndex;
+	typedef HashMap<String, ArchiveMemberList> PatternIndex;
+
+	bool _indexEnabled;
+	int _unindexable;					///< number of archives in the set which are not indexable
+	mutable ArchiveIndex _index;		///< archive to use for each name looked up so far, 0 if none
+	mutable PatternIndex _patternIndex;	///< result of each listMatchingMembers call so far
+
+	bool useIndex() const { return _indexEnabled && !_unindexable; }
+
+	/**
+	 * Returns the highest priority archive containing the given name, or 0.
+	 * Only used while the index is in use.
+	 */
+	Archive *findArchive(const String &name) const;
+
 public:
+	SearchSet() : _indexEnabled(false), _unindexable(0) {}
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -230,6 +262,24 @@ public:
 	 */
 	void setPriority(const String& name, int priority);
 
+	/**
+	 * Enable or disable the lookup index. While enabled, the archive found
+	 * for a name (or the fact that none has it) and the members matching a
+	 * pattern are remembered, until an archive is added, removed or
+	 * reprioritized.
+	 *
+	 * Only enable this if the contents of the archives in the set do not
+	 * change, or call invalidateIndex() when they do. The index is not used
+	 * while the set contains archives which are not indexable, such as other
+	 * SearchSets, since these change without the set noticing.
+	 */
+	void setIndexEnabled(bool enable);
+
+	/**
+	 * Forget all lookups remembered by the index.
+	 */
+	void invalidateIndex();
+
 	virtual bool hasFile(const String &name) const;
 	virtual int listMatchingMembers(ArchiveMemberList &list, const String &pattern) const;
 	virtual int listMembers(ArchiveMemberList &list) const;
@@ -241,6 +291,12 @@ public:
 	 * opening the first file encountered that matches the name.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/**
+	 * SearchSets are not indexable, their parent would not notice when
+	 * archives are added to or removed from them.
+	 */
+	virtual bool isIndexable() const { return false; }
 };
 
 
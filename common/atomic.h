@@ -0,0 +1,114 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @name Atomic operations
+ *
+ * A minimal set of atomic operations on 32 bit integers, suitable for
+ * exchanging data between threads without taking a mutex (e.g. between
+ * the engine thread and the audio callback).
+ *
+ * atomicLoad has acquire semantics and atomicStore has release semantics,
+ * i.e. everything written before an atomicStore is visible to a thread
+ * which observed the stored value through atomicLoad. The read-modify-write
+ * operations imply a full memory barrier.
+ *
+ * On compilers for which no implementation is provided, these fall back to
+ * plain volatile accesses, which is only safe on single core targets.
+ */
+//@{
+
+#if defined(__GNUC__) && GCC_ATLEAST(4, 1)
+
+inline void memoryBarrier() {
+	__sync_synchronize();
+}
+
+inline int32 atomicAdd(volatile int32 *ptr, int32 delta) {
+	return __sync_add_and_fetch(ptr, delta);
+}
+
+inline bool atomicCompareAndSwap(volatile int32 *ptr, int32 oldValue, int32 newValue) {
+	return __sync_bool_compare_and_swap(ptr, oldValue, newValue);
+}
+
+#elif defined(_MSC_VER)
+
+inline void memoryBarrier() {
+	// Interlocked operations act as a full barrier on all MSVC targets
+	long barrier = 0;
+	_InterlockedExchange(&barrier, 0);
+}
+
+inline int32 atomicAdd(volatile int32 *ptr, int32 delta) {
+	return _InterlockedExchangeAdd((volatile long *)ptr, delta) + delta;
+}
+
+inline bool atomicCompareAndSwap(volatile int32 *ptr, int32 oldValue, int32 newValue) {
+	return _InterlockedCompareExchange((volatile long *)ptr, newValue, oldValue) == oldValue;
+}
+
+#else
+
+inline void memoryBarrier() {
+}
+
+inline int32 atomicAdd(volatile int32 *ptr, int32 delta) {
+	return (*ptr += delta);
+}
+
+inline bool atomicCompareAndSwap(volatile int32 *ptr, int32 oldValue, int32 newValue) {
+	if (*ptr != oldValue)
+		return false;
+	*ptr = newValue;
+	return true;
+}
+
+#endif
+
+inline int32 atomicLoad(const volatile int32 *ptr) {
+	int32 value = *ptr;
+	memoryBarrier();
+	return value;
+}
+
+inline void atomicStore(volatile int32 *ptr, int32 value) {
+	memoryBarrier();
+	*ptr = value;
+}
+
+//@}
+
+} // End of namespace Common
+
+#endif
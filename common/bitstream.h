@@ -26,8 +26,10 @@
 #define COMMON_BITSTREAM_H
 
 #include "common/scummsys.h"
+#include "common/endian.h"
 #include "common/textconsole.h"
 #include "common/stream.h"
+#include "common/util.h"
 
 namespace Common {
 
@@ -79,10 +81,10 @@ protected:
  * gives access to their bits, one at a time.
  *
  * For example, a bit stream with the layout parameters 32, true, false
- * for valueBits, isLE and isMSB2LSB, reads 32bit little-endian values
+ * for valueBits, isLE and MSB2LSB, reads 32bit little-endian values
  * from the data stream and hands out the bits in the order of LSB to MSB.
  */
-template<int valueBits, bool isLE, bool isMSB2LSB>
+template<int valueBits, bool isLE, bool MSB2LSB>
 class BitStreamImpl : public BitStream {
 private:
 	SeekableReadStream *_stream; ///< The input stream.
@@ -123,7 +125,7 @@ private:
 			error("BitStreamImpl::readValue(): Read error");
 
 		// If we're reading the bits MSB first, we need to shift the value to that position
-		if (isMSB2LSB)
+		if (MSB2LSB)
 			_value <<= 32 - valueBits;
 		}
 
@@ -133,7 +135,7 @@ public:
 		_stream(stream), _disposeAfterUse(disposeAfterUse), _value(0), _inValue(0) {
 
 		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
-			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, MSB2LSB);
 	}
 
 	/** Create a bit stream using this input data stream. */
@@ -141,7 +143,7 @@ public:
 		_stream(&stream), _disposeAfterUse(false), _value(0), _inValue(0) {
 
 		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
-			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, MSB2LSB);
 	}
 
 	~BitStreamImpl() {
@@ -157,13 +159,13 @@ public:
 
 		// Get the current bit
 		int b = 0;
-		if (isMSB2LSB)
+		if (MSB2LSB)
 			b = ((_value & 0x80000000) == 0) ? 0 : 1;
 		else
 			b = ((_value & 1) == 0) ? 0 : 1;
 
 		// Shift to the next bit
-		if (isMSB2LSB)
+		if (MSB2LSB)
 			_value <<= 1;
 		else
 			_value >>= 1;
@@ -194,7 +196,7 @@ public:
 		// Read the number of bits
 		uint32 v = 0;
 
-		if (isMSB2LSB) {
+		if (MSB2LSB) {
 			while (n-- > 0)
 				v = (v << 1) | getBit();
 		} else {
@@ -225,14 +227,24 @@ public:
 	/**
 	 * Read a multi-bit value from the bit stream, without changing the stream's position.
 	 *
-	 * The bit order is the same as in getBits().
+	 * The bit order is the same as in getBits(). Bits past the end of the
+	 * stream read as 0.
 	 */
 	uint32 peekBits(uint8 n) {
 		uint32 value   = _value;
 		uint8  inValue = _inValue;
 		uint32 curPos  = _stream->pos();
 
-		uint32 v = getBits(n);
+		uint32 available = size() - pos();
+		uint32 v;
+		if (n <= available)
+			v = getBits(n);
+		else if (available == 0)
+			v = 0; // Shifting by all 32 bits below would be undefined
+		else if (MSB2LSB)
+			v = getBits(available) << (n - available);
+		else
+			v = getBits(available);
 
 		_stream->seek(curPos);
 		_inValue = inValue;
@@ -256,12 +268,17 @@ public:
 		if (n >= 32)
 			error("BitStreamImpl::addBit(): Too many bits requested to be read");
 
-		if (isMSB2LSB)
+		if (MSB2LSB)
 			x = (x << 1) | getBit();
 		else
 			x = (x & ~(1 << n)) | (getBit() << n);
 	}
 
+	/** Are the bits handed out from MSB to LSB? */
+	static bool isMSB2LSB() {
+		return MSB2LSB;
+	}
+
 	/** Rewind the bit stream back to the start. */
 	void rewind() {
 		_stream->seek(0);
@@ -295,6 +312,230 @@ public:
 	}
 };
 
+/**
+ * A bit stream reading directly from a memory buffer.
+ *
+ * It has the same interface and the same data memory layouts as
+ * BitStreamImpl, but is not derived from BitStream, so that its methods
+ * can be inlined into the decoders using it. The next bits are kept in a
+ * 64 bit cache, which is refilled 32 bits at a time, so that multi-bit
+ * reads and peeks are a few shifts.
+ *
+ * The buffer is not copied and has to stay valid while it is read.
+ */
+template<int valueBits, bool isLE, bool MSB2LSB>
+class BitStreamMemoryImpl {
+private:
+	enum {
+		/**
+		 * Bits loaded into the cache at once. Layouts whose bits follow the
+		 * byte order of the data load 32 bits, the others one value.
+		 */
+		kChunkBits = (valueBits == 8 || isLE != MSB2LSB) ? 32 : valueBits
+	};
+
+	const byte *_data; ///< Start of the data.
+	const byte *_end;  ///< End of the last complete value of the data.
+	const byte *_ptr;  ///< The data after the cached bits.
+
+	/** The cached bits, with the next one at the MSB resp. LSB. Bits past them are 0. */
+	uint64 _cache;
+	uint32 _cacheBits; ///< Number of cached bits.
+
+	/** Read the data of a chunk. */
+	inline uint32 readChunk() const {
+		if (kChunkBits == 16)
+			return isLE ? READ_LE_UINT16(_ptr) : READ_BE_UINT16(_ptr);
+
+		// 8 bit values are read in the order their bits are handed out
+		if ((valueBits == 8) ? !MSB2LSB : isLE)
+			return READ_LE_UINT32(_ptr);
+		return READ_BE_UINT32(_ptr);
+	}
+
+	/** Read a single data value. */
+	inline uint32 readValue() const {
+		if (valueBits == 8)
+			return *_ptr;
+		if (valueBits == 16)
+			return isLE ? READ_LE_UINT16(_ptr) : READ_BE_UINT16(_ptr);
+		return isLE ? READ_LE_UINT32(_ptr) : READ_BE_UINT32(_ptr);
+	}
+
+	/** Add n bits of data to the cache. */
+	inline void append(uint32 value, uint32 n) {
+		if (MSB2LSB)
+			_cache |= (uint64)value << (64 - n - _cacheBits);
+		else
+			_cache |= (uint64)value << _cacheBits;
+
+		_cacheBits += n;
+		_ptr += n / 8;
+	}
+
+	/** Fill the cache with at least 33 bits, if the data has that many left. */
+	void refill() {
+		while ((_cacheBits <= 64 - kChunkBits) && ((_end - _ptr) >= kChunkBits / 8))
+			append(readChunk(), kChunkBits);
+
+		// Near the end, go on with single values
+		if ((_end - _ptr) < kChunkBits / 8)
+			while ((_cacheBits <= 64 - valueBits) && (_ptr < _end))
+				append(readValue(), valueBits);
+	}
+
+	/** Return the next n cached bits, 0 < n <= 32. */
+	inline uint32 peekCache(uint32 n) const {
+		if (MSB2LSB)
+			return (uint32)(_cache >> (64 - n));
+		return (uint32)_cache & (0xFFFFFFFF >> (32 - n));
+	}
+
+	/** Drop the next n cached bits, n < 64. */
+	inline void consume(uint32 n) {
+		if (MSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheBits -= n;
+	}
+
+	/** Make sure n bits are cached. */
+	inline void require(uint32 n) {
+		if (n > _cacheBits) {
+			refill();
+			if (n > _cacheBits)
+				error("BitStreamMemoryImpl: End of bit stream reached");
+		}
+	}
+
+public:
+	/** Create a bit stream reading the given data. */
+	BitStreamMemoryImpl(const byte *data, uint32 size) :
+		_data(data), _end(data + (size & ~((uint32) ((valueBits >> 3) - 1)))), _ptr(data), _cache(0), _cacheBits(0) {
+
+		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
+			error("BitStreamMemoryImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, MSB2LSB);
+	}
+
+	/** Read a bit from the bit stream. */
+	inline uint32 getBit() {
+		require(1);
+
+		const uint32 b = MSB2LSB ? (uint32)(_cache >> 63) : (uint32)(_cache & 1);
+		consume(1);
+		return b;
+	}
+
+	/**
+	 * Read a multi-bit value from the bit stream.
+	 *
+	 * The bit order is the same as in BitStreamImpl::getBits().
+	 */
+	inline uint32 getBits(uint8 n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			error("BitStreamMemoryImpl::getBits(): Too many bits requested to be read");
+
+		require(n);
+
+		const uint32 v = peekCache(n);
+		consume(n);
+		return v;
+	}
+
+	/** Read a bit from the bit stream, without changing the stream's position. */
+	inline uint32 peekBit() {
+		return peekBits(1);
+	}
+
+	/**
+	 * Read a multi-bit value from the bit stream, without changing the stream's position.
+	 *
+	 * The bit order is the same as in getBits(). Bits past the end of the
+	 * stream read as 0.
+	 */
+	inline uint32 peekBits(uint8 n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			error("BitStreamMemoryImpl::peekBits(): Too many bits requested to be read");
+
+		if (n > _cacheBits)
+			refill();
+
+		return peekCache(n);
+	}
+
+	/**
+	 * Add a bit to the value x, making it an n+1-bit value.
+	 *
+	 * See BitStreamImpl::addBit().
+	 */
+	inline void addBit(uint32 &x, uint32 n) {
+		if (n >= 32)
+			error("BitStreamMemoryImpl::addBit(): Too many bits requested to be read");
+
+		if (MSB2LSB)
+			x = (x << 1) | getBit();
+		else
+			x = (x & ~(1 << n)) | (getBit() << n);
+	}
+
+	/** Are the bits handed out from MSB to LSB? */
+	static bool isMSB2LSB() {
+		return MSB2LSB;
+	}
+
+	/** Rewind the bit stream back to the start. */
+	void rewind() {
+		_ptr = _data;
+		_cache = 0;
+		_cacheBits = 0;
+	}
+
+	/** Skip the specified amount of bits. */
+	inline void skip(uint32 n) {
+		if (n > _cacheBits) {
+			// Drop the cache and whole values without reading them
+			n -= _cacheBits;
+			_cache = 0;
+			_cacheBits = 0;
+
+			const uint32 values = MIN<uint32>(n / valueBits, (_end - _ptr) / (valueBits / 8));
+			_ptr += values * (valueBits / 8);
+			n -= values * valueBits;
+
+			require(n);
+		}
+
+		if (n == 64) {
+			_cache = 0;
+			_cacheBits = 0;
+		} else {
+			consume(n);
+		}
+	}
+
+	/** Return the stream position in bits. */
+	uint32 pos() const {
+		return (_ptr - _data) * 8 - _cacheBits;
+	}
+
+	/** Return the stream size in bits. */
+	uint32 size() const {
+		return (_end - _data) * 8;
+	}
+
+	bool eos() const {
+		return pos() >= size();
+	}
+};
+
 // typedefs for various memory layouts.
 
 /** 8-bit data, MSB to LSB. */
@@ -320,6 +561,29 @@ typedef BitStreamImpl<32, false, true > BitStream32BEMSB;
 /** 32-bit big-endian data, LSB to MSB. */
 typedef BitStreamImpl<32, false, false> BitStream32BELSB;
 
+/** 8-bit data, MSB to LSB, read from memory. */
+typedef BitStreamMemoryImpl<8, false, true > BitStreamMemory8MSB;
+/** 8-bit data, LSB to MSB, read from memory. */
+typedef BitStreamMemoryImpl<8, false, false> BitStreamMemory8LSB;
+
+/** 16-bit little-endian data, MSB to LSB, read from memory. */
+typedef BitStreamMemoryImpl<16, true , true > BitStreamMemory16LEMSB;
+/** 16-bit little-endian data, LSB to MSB, read from memory. */
+typedef BitStreamMemoryImpl<16, true , false> BitStreamMemory16LELSB;
+/** 16-bit big-endian data, MSB to LSB, read from memory. */
+typedef BitStreamMemoryImpl<16, false, true > BitStreamMemory16BEMSB;
+/** 16-bit big-endian data, LSB to MSB, read from memory. */
+typedef BitStreamMemoryImpl<16, false, false> BitStreamMemory16BELSB;
+
+/** 32-bit little-endian data, MSB to LSB, read from memory. */
+typedef BitStreamMemoryImpl<32, true , true > BitStreamMemory32LEMSB;
+/** 32-bit little-endian data, LSB to MSB, read from memory. */
+typedef BitStreamMemoryImpl<32, true , false> BitStreamMemory32LELSB;
+/** 32-bit big-endian data, MSB to LSB, read from memory. */
+typedef BitStreamMemoryImpl<32, false, true > BitStreamMemory32BEMSB;
+/** 32-bit big-endian data, LSB to MSB, read from memory. */
+typedef BitStreamMemoryImpl<32, false, false> BitStreamMemory32BELSB;
+
 } // End of namespace Common
 
 #endif // COMMON_BITSTREAM_H
@@ -0,0 +1,112 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_getenv
+
+#include "common/cpudetect.h"
+
+#if defined(SCUMMVM_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Common {
+
+#if defined(SCUMMVM_SIMD_X86)
+
+static void cpuid(uint32 leaf, uint32 subLeaf, uint32 regs[4]) {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, leaf, subLeaf);
+	for (int i = 0; i < 4; ++i)
+		regs[i] = info[i];
+#else
+	__cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint32 getXCR0() {
+#if defined(_MSC_VER)
+	return (uint32)_xgetbv(0);
+#else
+	uint32 eax, edx;
+	// xgetbv, spelled out for assemblers which do not know it
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0));
+	return eax;
+#endif
+}
+
+static uint32 detectCPUFeatures() {
+	uint32 features = 0;
+	uint32 regs[4];
+
+	cpuid(0, 0, regs);
+	const uint32 maxLeaf = regs[0];
+	if (maxLeaf < 1)
+		return 0;
+
+	cpuid(1, 0, regs);
+	if (regs[3] & (1 << 26))
+		features |= kCPUFeatureSSE2;
+	if (regs[2] & (1 << 9))
+		features |= kCPUFeatureSSSE3;
+
+	// AVX2 also requires the OS to save the YMM registers (OSXSAVE + XCR0)
+	const bool osSavesYMM = (regs[2] & (1 << 27)) && (getXCR0() & 6) == 6;
+	if (osSavesYMM && maxLeaf >= 7) {
+		cpuid(7, 0, regs);
+		if (regs[1] & (1 << 5))
+			features |= kCPUFeatureAVX2;
+	}
+
+	return features;
+}
+
+#else
+
+static uint32 detectCPUFeatures() {
+#if defined(SCUMMVM_SIMD_NEON)
+	return kCPUFeatureNEON;
+#else
+	return 0;
+#endif
+}
+
+#endif
+
+bool hasCPUFeature(CPUFeature feature) {
+	// Detection is cheap and deterministic, so racing threads do no harm
+	static bool detected = false;
+	static uint32 features = 0;
+
+	if (!detected) {
+		features = getenv("SCUMMVM_DISABLE_SIMD") ? 0 : detectCPUFeatures();
+		detected = true;
+	}
+
+	return (features & feature) != 0;
+}
+
+} // End of namespace Common
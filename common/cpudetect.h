@@ -0,0 +1,82 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_CPUDETECT_H
+#define COMMON_CPUDETECT_H
+
+#include "common/scummsys.h"
+
+/**
+ * @name SIMD support
+ *
+ * SCUMMVM_SIMD_X86 is defined if the compiler allows using SSE2 and AVX2
+ * intrinsics in functions marked with SCUMMVM_TARGET_SSE2 resp.
+ * SCUMMVM_TARGET_AVX2, regardless of the flags the file is compiled with.
+ * Such functions may only be called after checking the corresponding
+ * feature with Common::hasCPUFeature().
+ *
+ * SCUMMVM_SIMD_NEON is defined if the code is compiled for a CPU with
+ * NEON support, NEON intrinsics can then be used unconditionally.
+ */
+//@{
+
+#if (defined(__i386__) || defined(__x86_64__)) && (defined(__clang__) || (defined(__GNUC__) && GCC_ATLEAST(4, 9)))
+#define SCUMMVM_SIMD_X86
+#define SCUMMVM_TARGET_SSE2 __attribute__((target("sse2")))
+#define SCUMMVM_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define SCUMMVM_TARGET_AVX2 __attribute__((target("avx2")))
+#elif (defined(_M_IX86) || defined(_M_X64)) && defined(_MSC_VER) && _MSC_VER >= 1700
+#define SCUMMVM_SIMD_X86
+#define SCUMMVM_TARGET_SSE2
+#define SCUMMVM_TARGET_SSSE3
+#define SCUMMVM_TARGET_AVX2
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SCUMMVM_SIMD_NEON
+#endif
+
+//@}
+
+namespace Common {
+
+enum CPUFeature {
+	kCPUFeatureSSE2  = 1 << 0,
+	kCPUFeatureSSSE3 = 1 << 1,
+	kCPUFeatureAVX2  = 1 << 2,
+	kCPUFeatureNEON  = 1 << 3
+};
+
+/**
+ * Queries whether the CPU we are running on supports the given feature.
+ * The result also takes into account whether the operating system saves
+ * the corresponding registers, and whether SIMD code was compiled in at
+ * all (see SCUMMVM_SIMD_X86 and SCUMMVM_SIMD_NEON).
+ *
+ * Setting the environment variable SCUMMVM_DISABLE_SIMD disables all
+ * features, which is useful for testing the generic code paths.
+ */
+bool hasCPUFeature(CPUFeature feature);
+
+} // End of namespace Common
+
+#endif
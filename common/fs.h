@@ -205,6 +205,23 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Returns the time the object referred by this node was last modified,
+	 * in seconds. The epoch is backend specific, so the value is only useful
+	 * to check whether a file has changed.
+	 *
+	 * @return the modification time, or 0 if it is unknown
+	 */
+	uint32 getModificationTime() const;
+
+	/**
+	 * Returns the size of the file referred by this node, without opening
+	 * it.
+	 *
+	 * @return the size in bytes, or -1 if it is unknown
+	 */
+	int32 getFileSize() const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -214,6 +231,17 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Like createReadStream(), but the backend may map the file into memory
+	 * instead of reading it. If the file is truncated while the stream is
+	 * open, reading from the stream may crash instead of failing. So only
+	 * use this for game data and other files which are never modified, and
+	 * never for savegames or configuration files.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -20,25 +20,34 @@
  *
  */
 
+
 // Based on eos' Huffman code
 
 #ifndef COMMON_HUFFMAN_H
 #define COMMON_HUFFMAN_H
 
 #include "common/array.h"
-#include "common/list.h"
+#include "common/textconsole.h"
 #include "common/types.h"
+#include "common/util.h"
 
 namespace Common {
 
-class BitStream;
-
 /**
  * Huffman bitstream decoding
  *
- * Used in engines:
- *  - scumm
+ * Symbols are decoded with lookup tables: the first bits of a code index
+ * a root table, which resolves all short codes in one step. Longer codes
+ * continue in sub-tables indexed by the following bits.
+ *
+ * BITSTREAM is the bit stream class the codes are read from, e.g. one of
+ * the BitStreamImpl typedefs. Its bit order decides how the codes are laid
+ * out in the tables, so it has to be known when they are built.
+ *
+ * Used in:
+ *  - Bink video
  */
+template<class BITSTREAM>
 class Huffman {
 public:
 	/** Construct a Huffman decoder.
@@ -50,33 +59,172 @@ public:
 	 *  @param symbols The symbols. If 0, assume they are identical to the code indices.
 	 */
 	Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols = 0);
-	~Huffman();
 
 	/** Modify the codes' symbols. */
 	void setSymbols(const uint32 *symbols = 0);
 
 	/** Return the next symbol in the bitstream. */
-	uint32 getSymbol(BitStream &bits) const;
+	uint32 getSymbol(BITSTREAM &bits) const;
 
 private:
-	struct Symbol {
-		uint32 code;
-		uint32 symbol;
+	enum {
+		/** Index bits of the root table and the most index bits of sub-tables. */
+		kLookupBits = 9
+	};
 
-		Symbol(uint32 c, uint32 s);
+	/**
+	 * An entry of the lookup tables. It either resolves a code, or links
+	 * to the sub-table for the longer codes starting with its index bits.
+	 */
+	struct LookupEntry {
+		uint8 length;  ///< Bits of the code left at this table, 0 for links and unused entries.
+		uint8 subBits; ///< Index bits of the linked sub-table, 0 for codes and unused entries.
+		uint32 value;  ///< Index of the code's symbol, or offset of the linked sub-table.
 	};
 
-	typedef List<Symbol> CodeList;
-	typedef Array<CodeList> CodeLists;
-	typedef Array<Symbol *> SymbolList;
+	/** The symbols, by code index. */
+	Array<uint32> _symbols;
+
+	/** All lookup tables, starting with the root table. */
+	Array<LookupEntry> _lookup;
+
+	/** Index bits of the root table. */
+	uint8 _rootBits;
 
-	/** Lists of codes and their symbols, sorted by code length. */
-	CodeLists _codes;
+	/** Return the bits of a code following its first consumed bits, in stream bit order. */
+	static uint32 remainingBits(uint32 code, uint8 length, uint8 consumed);
 
-	/** Sorted list of pointers to the symbols. */
-	SymbolList _symbols;
+	/**
+	 * Fill the table at offset with the given codes, whose first consumed
+	 * bits were resolved by the tables linking to it. Creates sub-tables
+	 * for the codes which do not fit.
+	 */
+	void buildTable(uint32 offset, uint8 tableBits, uint8 consumed, const Array<uint32> &indices, const uint32 *codes, const uint8 *lengths);
 };
 
+template<class BITSTREAM>
+Huffman<BITSTREAM>::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols) {
+	assert(codeCount > 0);
+
+	assert(codes);
+	assert(lengths);
+
+	if (maxLength == 0)
+		for (uint32 i = 0; i < codeCount; i++)
+			maxLength = MAX(maxLength, lengths[i]);
+
+	assert(maxLength <= 32);
+
+	_symbols.resize(codeCount);
+	setSymbols(symbols);
+
+	// Sort the codes by length, so that a shorter code takes precedence
+	// over longer codes starting with it
+	Array<uint32> indices;
+	for (uint8 length = 1; length <= maxLength; length++)
+		for (uint32 i = 0; i < codeCount; i++)
+			if (lengths[i] == length)
+				indices.push_back(i);
+
+	_rootBits = MIN<uint8>(maxLength, kLookupBits);
+	_lookup.resize(1 << _rootBits);
+	buildTable(0, _rootBits, 0, indices, codes, lengths);
+}
+
+template<class BITSTREAM>
+void Huffman<BITSTREAM>::setSymbols(const uint32 *symbols) {
+	for (uint32 i = 0; i < _symbols.size(); i++)
+		_symbols[i] = symbols ? *symbols++ : i;
+}
+
+template<class BITSTREAM>
+uint32 Huffman<BITSTREAM>::remainingBits(uint32 code, uint8 length, uint8 consumed) {
+	// MSB first streams hold the first bit of a code in its highest bit,
+	// LSB first streams in its lowest bit
+	if (!BITSTREAM::isMSB2LSB())
+		return code >> consumed;
+
+	const uint8 remaining = length - consumed;
+	return (remaining >= 32) ? code : (code & ((1u << remaining) - 1));
+}
+
+template<class BITSTREAM>
+void Huffman<BITSTREAM>::buildTable(uint32 offset, uint8 tableBits, uint8 consumed, const Array<uint32> &indices, const uint32 *codes, const uint8 *lengths) {
+	const uint32 tableSize = 1 << tableBits;
+	Array<Array<uint32> > longCodes;
+
+	for (uint32 i = 0; i < indices.size(); i++) {
+		const uint32 index = indices[i];
+		const uint8 length = lengths[index] - consumed;
+		const uint32 code = remainingBits(codes[index], lengths[index], consumed);
+
+		if (length > tableBits) {
+			// Collect the code for the sub-table of its first bits
+			const uint32 prefix = BITSTREAM::isMSB2LSB() ? (code >> (length - tableBits)) : (code & (tableSize - 1));
+			if (longCodes.empty())
+				longCodes.resize(tableSize);
+			longCodes[prefix].push_back(index);
+			continue;
+		}
+
+		// The code fills all entries starting with it, whatever bits follow
+		for (uint32 fill = 0; fill < (1u << (tableBits - length)); fill++) {
+			const uint32 entry = BITSTREAM::isMSB2LSB() ? ((code << (tableBits - length)) | fill) : (code | (fill << length));
+			LookupEntry &e = _lookup[offset + entry];
+			if (e.length == 0) {
+				e.length = length;
+				e.subBits = 0;
+				e.value = index;
+			}
+		}
+	}
+
+	for (uint32 prefix = 0; prefix < longCodes.size(); prefix++) {
+		// Codes behind a shorter code can never be decoded
+		if (longCodes[prefix].empty() || _lookup[offset + prefix].length != 0)
+			continue;
+
+		uint8 subLength = 0;
+		for (uint32 i = 0; i < longCodes[prefix].size(); i++)
+			subLength = MAX<uint8>(subLength, lengths[longCodes[prefix][i]] - consumed - tableBits);
+
+		const uint8 subBits = MIN<uint8>(subLength, kLookupBits);
+		const uint32 subOffset = _lookup.size();
+		_lookup.resize(subOffset + (1 << subBits));
+
+		LookupEntry &link = _lookup[offset + prefix];
+		link.length = 0;
+		link.subBits = subBits;
+		link.value = subOffset;
+
+		buildTable(subOffset, subBits, consumed + tableBits, longCodes[prefix], codes, lengths);
+	}
+}
+
+template<class BITSTREAM>
+uint32 Huffman<BITSTREAM>::getSymbol(BITSTREAM &bits) const {
+	const LookupEntry *table = _lookup.begin();
+	uint8 tableBits = _rootBits;
+
+	for (;;) {
+		const LookupEntry &entry = table[bits.peekBits(tableBits)];
+		if (entry.length != 0) {
+			bits.skip(entry.length);
+			return _symbols[entry.value];
+		}
+
+		if (entry.subBits == 0)
+			break;
+
+		bits.skip(tableBits);
+		table = _lookup.begin() + entry.value;
+		tableBits = entry.subBits;
+	}
+
+	error("Unknown Huffman code");
+	return 0;
+}
+
 } // End of namespace Common
 
 #endif // COMMON_HUFFMAN_H
@@ -4,6 +4,7 @@ MODULE_OBJS := \
 	archive.o \
 	config-manager.o \
 	coroutines.o \
+	cpudetect.o \
 	dcl.o \
 	debug.o \
 	error.o \
@@ -36,6 +37,7 @@ MODULE_OBJS := \
 	unarj.o \
 	unzip.o \
 	util.o \
+	workerpool.o \
 	winexe.o \
 	winexe_ne.o \
 	winexe_pe.o \
@@ -46,7 +48,6 @@ MODULE_OBJS += \
 	cosinetables.o \
 	dct.o \
 	fft.o \
-	huffman.o \
 	rdft.o \
 	sinetables.o
 
@@ -47,6 +47,30 @@ void Mutex::unlock() {
 #pragma mark -
 
 
+Semaphore::Semaphore(uint initialCount) {
+	assert(g_system);
+	_semaphore = g_system->createSemaphore(initialCount);
+}
+
+Semaphore::~Semaphore() {
+	if (_semaphore)
+		g_system->deleteSemaphore(_semaphore);
+}
+
+void Semaphore::wait() {
+	if (_semaphore)
+		g_system->waitSemaphore(_semaphore);
+}
+
+void Semaphore::post() {
+	if (_semaphore)
+		g_system->postSemaphore(_semaphore);
+}
+
+
+#pragma mark -
+
+
 StackLock::StackLock(MutexRef mutex, const char *mutexName)
 	: _mutex(mutex), _mutexName(mutexName) {
 	lock();
@@ -69,6 +69,25 @@ public:
 };
 
 
+/**
+ * Wrapper class around the OSystem semaphore functions.
+ * If the backend does not support threads, isValid() returns false and
+ * wait() and post() do nothing.
+ */
+class Semaphore {
+	OSystem::SemaphoreRef _semaphore;
+
+public:
+	explicit Semaphore(uint initialCount = 0);
+	~Semaphore();
+
+	bool isValid() const { return _semaphore != 0; }
+
+	void wait();
+	void post();
+};
+
+
 } // End of namespace Common
 
 #endif
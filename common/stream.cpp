@@ -241,6 +241,18 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 }
 
 uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
+	const byte *data = _parentStream->getData();
+	if (data) {
+		if (dataSize > _end - _pos) {
+			dataSize = _end - _pos;
+			_eos = true;
+		}
+
+		memcpy(dataPtr, data + _pos, dataSize);
+		_pos += dataSize;
+		return dataSize;
+	}
+
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
 
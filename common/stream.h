@@ -318,8 +318,11 @@ public:
 	 * if reading more failed, because of an I/O error or because
 	 * the end of the stream was reached. Which can be determined by
 	 * calling err() and eos().
+	 *
+	 * Streams whose data is already in memory may return a stream which
+	 * shares that data instead of copying it.
 	 */
-	SeekableReadStream *readStream(uint32 dataSize);
+	virtual SeekableReadStream *readStream(uint32 dataSize);
 
 };
 
@@ -371,6 +374,14 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Returns a pointer to the whole contents of the stream, if the stream
+	 * keeps them in memory, and 0 otherwise. This allows to access the data
+	 * without copying it. The pointer stays valid as long as the stream
+	 * exists, and does not depend on the position indicator.
+	 */
+	virtual const byte *getData() const { return 0; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
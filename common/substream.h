@@ -77,6 +77,11 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual const byte *getData() const {
+		const byte *data = _parentStream->getData();
+		return data ? data + _begin : 0;
+	}
 };
 
 /**
@@ -106,6 +111,9 @@ public:
  *
  * Note that this stream is *not* threading safe. Calling read from the audio
  * thread and from the main thread might mess up the data retrieved.
+ *
+ * If the parent stream provides its data through getData(), reads are served
+ * directly from that data and the parent stream is not repositioned at all.
  */
 class SafeSeekableSubReadStream : public SeekableSubReadStream {
 public:
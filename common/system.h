@@ -1018,6 +1018,62 @@ public:
 
 
 
+	/**
+	 * @name Thread handling
+	 * Optional support for worker threads, used to move expensive work
+	 * (like audio decoding) off the engine and audio threads. Code using
+	 * these methods must not rely on threads being available: backends
+	 * without thread support return 0 from createThread() and
+	 * createSemaphore(), in which case the work has to be done on the
+	 * calling thread instead. Common::WorkerPool takes care of this.
+	 */
+	//@{
+
+	typedef struct OpaqueThread *ThreadRef;
+	typedef struct OpaqueSemaphore *SemaphoreRef;
+	typedef int (*ThreadProc)(void *param);
+
+	/**
+	 * Create and start a new thread running the given function.
+	 * @return the newly created thread, or 0 if threads are not supported.
+	 */
+	virtual ThreadRef createThread(ThreadProc proc, void *param) { return 0; }
+
+	/**
+	 * Wait until the given thread has finished and free its resources.
+	 * @param thread	the thread to wait for.
+	 */
+	virtual void joinThread(ThreadRef thread) {}
+
+	/**
+	 * Create a new counting semaphore.
+	 * @param initialCount	the initial value of the semaphore.
+	 * @return the newly created semaphore, or 0 if threads are not supported.
+	 */
+	virtual SemaphoreRef createSemaphore(uint initialCount) { return 0; }
+
+	/**
+	 * Wait until the value of the semaphore is positive, then decrement it.
+	 * @param semaphore	the semaphore to wait on.
+	 */
+	virtual void waitSemaphore(SemaphoreRef semaphore) {}
+
+	/**
+	 * Increment the value of the semaphore, waking up a waiting thread.
+	 * @param semaphore	the semaphore to post.
+	 */
+	virtual void postSemaphore(SemaphoreRef semaphore) {}
+
+	/**
+	 * Delete the given semaphore. No thread may be waiting on it.
+	 * @param semaphore	the semaphore to delete.
+	 */
+	virtual void deleteSemaphore(SemaphoreRef semaphore) {}
+
+	//@}
+
+
+
 	/** @name Sound */
 	//@{
 
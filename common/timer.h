@@ -23,6 +23,7 @@
 #define COMMON_TIMER_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/str.h"
 #include "common/noncopyable.h"
 
@@ -54,6 +55,34 @@ public:
 	 * and no instance of this callback will be running anymore.
 	 */
 	virtual void removeTimerProc(TimerProc proc) = 0;
+
+	/**
+	 * Statistics about an installed timer, used for debugging timing issues.
+	 * All times are in milliseconds.
+	 */
+	struct TimerInfo {
+		String id;
+		int32 interval;         ///< the interval of the timer, in microseconds
+		uint32 calls;           ///< number of times the callback has been invoked
+		uint32 lateCalls;       ///< number of calls which were a full interval or more late
+		uint32 totalLateness;   ///< sum of the delays between deadline and call
+		uint32 maxLateness;     ///< largest delay between deadline and call
+		uint32 totalDuration;   ///< sum of the time spent in the callback
+		uint32 maxDuration;     ///< longest time spent in the callback
+	};
+
+	typedef Array<TimerInfo> TimerInfoList;
+
+	/**
+	 * Return statistics about all installed timers. Timer managers which do
+	 * not keep statistics return an empty list.
+	 */
+	virtual TimerInfoList getTimerInfo() { return TimerInfoList(); }
+
+	/**
+	 * Reset the statistics of all installed timers.
+	 */
+	virtual void resetTimerInfo() {}
 };
 
 } // End of namespace Common
@@ -105,6 +105,9 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -379,6 +382,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _sharedStream;	/* owns _stream, shared with open members */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -541,6 +545,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_sharedStream = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -592,7 +597,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -641,7 +645,7 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
+	// The stream itself is deleted once no member stream uses it any more
 	delete s;
 	return UNZ_OK;
 }
@@ -1416,6 +1420,240 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+#ifdef USE_ZLIB
+
+/**
+ * A seekable stream which inflates a deflated ZIP member on demand.
+ *
+ * Every ZIP_RESTART_INTERVAL bytes of output, a copy of the inflater state is
+ * kept as a restart point. Seeking backwards, or far forwards, resumes from
+ * the nearest restart point instead of inflating everything from the start
+ * of the member again.
+ */
+class ZipInflateReadStream : public SeekableReadStream {
+protected:
+	enum {
+		BUFSIZE = 16384,
+		ZIP_RESTART_INTERVAL = 512 * 1024
+	};
+
+	/** A snapshot of the inflater at a multiple of ZIP_RESTART_INTERVAL */
+	struct RestartPoint {
+		uint32 inPos;     ///< position in the compressed data
+		z_stream stream;  ///< copy of the inflater, including its window
+	};
+
+	byte _buf[BUFSIZE];
+
+	ScopedPtr<SeekableReadStream> _wrapped;
+	z_stream _stream;
+	int _zlibErr;
+	uint32 _pos;
+	uint32 _size;
+	bool _eos;
+
+	/** _restartPoints[i] is the state at output position (i + 1) * ZIP_RESTART_INTERVAL */
+	Array<RestartPoint *> _restartPoints;
+
+	uint32 nextRestartPos() const {
+		return (_restartPoints.size() + 1) * ZIP_RESTART_INTERVAL;
+	}
+
+	void addRestartPoint() {
+		RestartPoint *point = new RestartPoint();
+		if (inflateCopy(&point->stream, &_stream) != Z_OK) {
+			delete point;
+			return;
+		}
+		point->inPos = _wrapped->pos() - _stream.avail_in;
+		_restartPoints.push_back(point);
+	}
+
+	/** Restarts inflating at the given restart point; 0 is the start of the member */
+	void restart(uint index) {
+		if (index == 0) {
+			_wrapped->seek(0, SEEK_SET);
+			_zlibErr = inflateReset(&_stream);
+		} else {
+			const RestartPoint *point = _restartPoints[index - 1];
+			_wrapped->seek(point->inPos, SEEK_SET);
+			inflateEnd(&_stream);
+			_zlibErr = inflateCopy(&_stream, const_cast<z_stream *>(&point->stream));
+		}
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_pos = index * ZIP_RESTART_INTERVAL;
+	}
+
+public:
+	ZipInflateReadStream(SeekableReadStream *w, uint32 size) : _wrapped(w), _stream(), _pos(0), _size(size), _eos(false) {
+		assert(w != 0);
+
+		// Negative window bits: raw deflate data, without a zlib header
+		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+	}
+
+	~ZipInflateReadStream() {
+		for (uint i = 0; i < _restartPoints.size(); i++) {
+			inflateEnd(&_restartPoints[i]->stream);
+			delete _restartPoints[i];
+		}
+		inflateEnd(&_stream);
+	}
+
+	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
+	void clearErr() {
+		// only reset _eos; I/O errors are not recoverable
+		_eos = false;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		byte *dst = (byte *)dataPtr;
+		uint32 total = 0;
+
+		while (total < dataSize && _zlibErr == Z_OK) {
+			// Stop at the next restart point, so that it can be recorded
+			uint32 chunk = dataSize - total;
+			const uint32 restartPos = nextRestartPos();
+			if (_pos < restartPos)
+				chunk = MIN(chunk, restartPos - _pos);
+
+			_stream.next_out = dst + total;
+			_stream.avail_out = chunk;
+			while (_zlibErr == Z_OK && _stream.avail_out) {
+				if (_stream.avail_in == 0 && !_wrapped->eos()) {
+					// If we are out of input data: Read more data, if available.
+					_stream.next_in = _buf;
+					_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
+				}
+				_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+			}
+
+			total += chunk - _stream.avail_out;
+			_pos += chunk - _stream.avail_out;
+
+			if (_pos == restartPos && _zlibErr == Z_OK)
+				addRestartPoint();
+		}
+
+		if (total < dataSize)
+			_eos = true;
+
+		return total;
+	}
+
+	bool eos() const {
+		return _eos;
+	}
+	int32 pos() const {
+		return _pos;
+	}
+	int32 size() const {
+		return _size;
+	}
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		int32 newPos = 0;
+		switch (whence) {
+		case SEEK_END:
+			newPos = _size + offset;
+			break;
+		case SEEK_SET:
+			newPos = offset;
+			break;
+		case SEEK_CUR:
+			newPos = _pos + offset;
+		}
+
+		if (newPos < 0 || (uint32)newPos > _size)
+			return false;
+
+		// Resume from the closest restart point before the new position,
+		// unless the current position is at least as close
+		const uint index = MIN<uint>(newPos / ZIP_RESTART_INTERVAL, _restartPoints.size());
+		if ((uint32)newPos < _pos || index * ZIP_RESTART_INTERVAL > _pos)
+			restart(index);
+
+		// Inflate up to the new position
+		byte tmpBuf[1024];
+		uint32 skip = newPos - _pos;
+		while (!err() && skip > 0) {
+			const uint32 done = read(tmpBuf, MIN<uint32>(sizeof(tmpBuf), skip));
+			if (!done)
+				break;
+			skip -= done;
+		}
+
+		_eos = false;
+		return !err() && _pos == (uint32)newPos;
+	}
+};
+
+#endif
+
+/**
+ * The stream returned for a ZIP member, wrapping either a view onto the
+ * archive or an inflater.
+ *
+ * It shares the ownership of the archive stream, so that it stays usable
+ * after the ZipArchive it was created from has been deleted. When the member
+ * is read in order up to its end, its CRC is checked, and a mismatch is
+ * reported through err().
+ */
+class ZipMemberReadStream : public SeekableReadStream {
+protected:
+	// Declared first, so that it is released after _member, which reads from it
+	SharedPtr<SeekableReadStream> _archiveStream;
+	ScopedPtr<SeekableReadStream> _member;
+	String _name;
+	uint32 _crc;
+	uint32 _crcWait;
+	uint32 _crcPos;     ///< the CRC covers the bytes before this position
+	bool _crcError;
+
+public:
+	ZipMemberReadStream(const SharedPtr<SeekableReadStream> &archiveStream, SeekableReadStream *member, const String &name, uint32 crc)
+		: _archiveStream(archiveStream), _member(member), _name(name), _crc(0), _crcWait(crc), _crcPos(0), _crcError(false) {
+	}
+
+	bool err() const { return _crcError || _member->err(); }
+	void clearErr() { _member->clearErr(); }
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		const uint32 pos = _member->pos();
+		const uint32 done = _member->read(dataPtr, dataSize);
+
+#ifdef USE_ZLIB
+		// Only data which continues the checked part counts: after a seek
+		// forward, the CRC is not checked any more
+		if (pos <= _crcPos && pos + done > _crcPos) {
+			const uint32 skip = _crcPos - pos;
+			_crc = crc32(_crc, (const byte *)dataPtr + skip, done - skip);
+			_crcPos = pos + done;
+			if (_crcPos == (uint32)_member->size() && _crc != _crcWait) {
+				warning("ZipMemberReadStream: CRC mismatch in '%s'", _name.c_str());
+				_crcError = true;
+			}
+		}
+#endif
+
+		return done;
+	}
+
+	bool eos() const { return _member->eos(); }
+	int32 pos() const { return _member->pos(); }
+	int32 size() const { return _member->size(); }
+	bool seek(int32 offset, int whence = SEEK_SET) { return _member->seek(offset, whence); }
+	const byte *getData() const { return _member->getData(); }
+};
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
@@ -1486,32 +1724,38 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	// Opening the member only serves to validate its local header and to
+	// find where its data starts. The data itself is read through a
+	// substream of its own, so that several members can be read at the same
+	// time without interfering with each other.
+	if (unzOpenCurrentFile(_zipFile) != UNZ_OK) {
+		unzCloseCurrentFile(_zipFile);
 		return 0;
+	}
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
-		return 0;
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	const file_in_zip_read_info_s *const info = archive->pfile_in_zip_read;
+	const uint32 begin = info->pos_in_zipfile + info->byte_before_the_zipfile;
+	const uint32 compressedSize = archive->cur_file_info.compressed_size;
+	const uint32 uncompressedSize = archive->cur_file_info.uncompressed_size;
+	const uLong method = info->compression_method;
+	const uint32 crc = archive->cur_file_info.crc;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
+	unzCloseCurrentFile(_zipFile);
 
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return 0;
-	}
+	SeekableReadStream *data = new SafeSeekableSubReadStream(archive->_stream, begin, begin + compressedSize);
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
+	// Stored members need no decoding: read them straight from the archive
+	if (method != 0) {
+#ifdef USE_ZLIB
+		data = new ZipInflateReadStream(data, uncompressedSize);
+#else
+		delete data;
 		return 0;
+#endif
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	return new ZipMemberReadStream(archive->_sharedStream, data, name, crc);
 }
 
 Archive *makeZipArchive(const String &name) {
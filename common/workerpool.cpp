@@ -0,0 +1,231 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/workerpool.h"
+#include "common/system.h"
+
+namespace Common {
+
+WorkerJob::WorkerJob() : _state(kStateIdle), _rerun(false), _dispose(false), _worker(0), _done(0) {
+}
+
+WorkerPool::WorkerPool(uint numThreads) : _quit(false) {
+	if (!_jobsAvailable.isValid())
+		return;
+
+	for (uint i = 0; i < numThreads; ++i) {
+		Worker *worker = new Worker();
+		worker->pool = this;
+		worker->index = i;
+		worker->thread = g_system->createThread(threadProc, worker);
+		if (!worker->thread) {
+			delete worker;
+			break;
+		}
+		_workers.push_back(worker);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		StackLock lock(_mutex);
+		_quit = true;
+
+		for (List<WorkerJob *>::iterator i = _queue.begin(); i != _queue.end(); ++i)
+			(*i)->setState(WorkerJob::kStateIdle);
+		_queue.clear();
+	}
+
+	for (uint i = 0; i < _workers.size(); ++i)
+		_jobsAvailable.post();
+	for (uint i = 0; i < _workers.size(); ++i) {
+		g_system->joinThread(_workers[i]->thread);
+		delete _workers[i];
+	}
+}
+
+void WorkerPool::schedule(WorkerJob *job) {
+	if (!isThreaded()) {
+		job->run();
+		return;
+	}
+
+	StackLock lock(_mutex);
+
+	if (job->_state == WorkerJob::kStateRunning) {
+		job->_rerun = true;
+	} else if (job->_state == WorkerJob::kStateIdle) {
+		job->setState(WorkerJob::kStateQueued);
+		_queue.push_back(job);
+		_jobsAvailable.post();
+	}
+}
+
+void WorkerPool::cancel(WorkerJob *job) {
+	if (!isThreaded())
+		return;
+
+	Worker *worker;
+	{
+		StackLock lock(_mutex);
+		job->_rerun = false;
+		if (job->_state != WorkerJob::kStateRunning) {
+			unqueue(job);
+			return;
+		}
+		worker = _workers[job->_worker];
+	}
+
+	// The worker keeps its busy mutex locked until the job went back to
+	// idle, so once we got hold of it, the job is done.
+	StackLock busyLock(worker->busy);
+}
+
+void WorkerPool::dispose(WorkerJob *job) {
+	if (isThreaded()) {
+		StackLock lock(_mutex);
+		job->_rerun = false;
+		if (job->_state == WorkerJob::kStateRunning) {
+			job->_dispose = true;
+			return;
+		}
+		unqueue(job);
+	}
+
+	delete job;
+}
+
+void WorkerPool::runAll(WorkerJob *const *jobs, uint count) {
+	if (!count)
+		return;
+
+	if (!isThreaded() || count == 1) {
+		for (uint i = 0; i < count; ++i)
+			jobs[i]->run();
+		return;
+	}
+
+	Semaphore done;
+
+	{
+		StackLock lock(_mutex);
+		for (uint i = 1; i < count; ++i) {
+			assert(jobs[i]->_state == WorkerJob::kStateIdle);
+			jobs[i]->setState(WorkerJob::kStateQueued);
+			jobs[i]->_done = &done;
+			_queue.push_back(jobs[i]);
+			_jobsAvailable.post();
+		}
+	}
+
+	jobs[0]->run();
+
+	// Take back the jobs no worker has picked up yet
+	uint remaining = count - 1;
+	for (uint i = 1; i < count; ++i) {
+		bool taken;
+		{
+			StackLock lock(_mutex);
+			taken = unqueue(jobs[i]);
+		}
+
+		if (taken) {
+			jobs[i]->run();
+			--remaining;
+		}
+	}
+
+	while (remaining--)
+		done.wait();
+}
+
+bool WorkerPool::unqueue(WorkerJob *job) {
+	if (job->_state != WorkerJob::kStateQueued)
+		return false;
+
+	for (List<WorkerJob *>::iterator i = _queue.begin(); i != _queue.end(); ++i) {
+		if (*i == job) {
+			_queue.erase(i);
+			break;
+		}
+	}
+
+	job->setState(WorkerJob::kStateIdle);
+	job->_done = 0;
+	return true;
+}
+
+int WorkerPool::threadProc(void *param) {
+	Worker *worker = (Worker *)param;
+	worker->pool->workerLoop(worker);
+	return 0;
+}
+
+void WorkerPool::workerLoop(Worker *worker) {
+	while (true) {
+		_jobsAvailable.wait();
+
+		StackLock busyLock(worker->busy);
+
+		WorkerJob *job;
+		{
+			StackLock lock(_mutex);
+			if (_quit)
+				break;
+			// Jobs taken back by runAll() leave extra posts behind
+			if (_queue.empty())
+				continue;
+
+			job = _queue.front();
+			_queue.pop_front();
+			job->setState(WorkerJob::kStateRunning);
+			job->_worker = worker->index;
+		}
+
+		Semaphore *done;
+		bool dispose;
+		while (true) {
+			job->run();
+
+			StackLock lock(_mutex);
+			if (job->_rerun) {
+				job->_rerun = false;
+				continue;
+			}
+
+			// Past this point, the job may be destroyed at any time, unless
+			// its owner handed it over to dispose()
+			done = job->_done;
+			dispose = job->_dispose;
+			job->_done = 0;
+			job->setState(WorkerJob::kStateIdle);
+			break;
+		}
+
+		if (done)
+			done->post();
+		if (dispose)
+			delete job;
+	}
+}
+
+} // End of namespace Common
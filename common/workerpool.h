@@ -0,0 +1,148 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_WORKERPOOL_H
+#define COMMON_WORKERPOOL_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * A unit of work which can be executed by a WorkerPool.
+ *
+ * A job may be scheduled again after it completed, but it is never queued
+ * twice or run on two threads at the same time. A job must not be destroyed
+ * while it is pending, use WorkerPool::cancel() first, or hand it over to
+ * WorkerPool::dispose().
+ */
+class WorkerJob : NonCopyable {
+	friend class WorkerPool;
+
+public:
+	WorkerJob();
+	virtual ~WorkerJob() {}
+
+	/**
+	 * Perform the actual work. Called either on a worker thread or, if the
+	 * backend does not support threads, on the thread scheduling the job.
+	 */
+	virtual void run() = 0;
+
+	/**
+	 * Queries whether the job is queued or currently running. This may be
+	 * called from any thread, without synchronizing with the pool.
+	 */
+	bool isPending() const { return atomicLoad(&_state) != kStateIdle; }
+
+private:
+	enum State {
+		kStateIdle,
+		kStateQueued,
+		kStateRunning
+	};
+
+	/** Only changed with the pool mutex held, but read by isPending(). */
+	void setState(State state) { atomicStore(&_state, state); }
+
+	volatile int32 _state;
+	bool _rerun;
+	bool _dispose;
+	uint _worker;
+	Semaphore *_done;
+};
+
+/**
+ * A fixed set of worker threads executing WorkerJobs in FIFO order.
+ *
+ * If the backend does not support threads (or numThreads is 0), jobs are
+ * run right away on the thread scheduling them, so code using a WorkerPool
+ * works the same on all backends.
+ */
+class WorkerPool : NonCopyable {
+public:
+	explicit WorkerPool(uint numThreads);
+	~WorkerPool();
+
+	/**
+	 * Queries whether jobs are run on worker threads.
+	 */
+	bool isThreaded() const { return !_workers.empty(); }
+
+	/**
+	 * Queue a job for execution. If the job is already queued, nothing
+	 * happens; if it is currently running, it is run once more afterwards.
+	 */
+	void schedule(WorkerJob *job);
+
+	/**
+	 * Make sure the job is neither queued nor running anymore. A queued
+	 * job is removed from the queue, a running one is waited for.
+	 */
+	void cancel(WorkerJob *job);
+
+	/**
+	 * Delete the job once it is neither queued nor running anymore. Unlike
+	 * cancel(), this never waits for a running job: the worker running it
+	 * deletes it when it is done. The job must not be used afterwards.
+	 */
+	void dispose(WorkerJob *job);
+
+	/**
+	 * Run all the given jobs and return once all of them completed. The
+	 * calling thread executes jobs as well, instead of just waiting.
+	 */
+	void runAll(WorkerJob *const *jobs, uint count);
+
+private:
+	struct Worker {
+		WorkerPool *pool;
+		uint index;
+		OSystem::ThreadRef thread;
+		/** Held while the worker runs a job. */
+		Mutex busy;
+	};
+
+	static int threadProc(void *param);
+	void workerLoop(Worker *worker);
+
+	/**
+	 * Remove the job from the queue, must be called with _mutex held.
+	 * @return true if the job was queued
+	 */
+	bool unqueue(WorkerJob *job);
+
+	Mutex _mutex;
+	Semaphore _jobsAvailable;
+	List<WorkerJob *> _queue;
+	Array<Worker *> _workers;
+	bool _quit;
+};
+
+} // End of namespace Common
+
+#endif
@@ -31,6 +31,8 @@
 #include "common/translation.h"
 #include "gui/EventRecorder.h"
 #include "engines/advancedDetector.h"
+#include "engines/detectioncache.h"
+#include "engines/metaengine.h"
 #include "engines/obsolete.h"
 
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
@@ -146,7 +148,10 @@ GameList AdvancedMetaEngine::detectGames(const Common::FSList &fslist) const {
 	matches = detectGame(fslist.begin()->getParent(), allFiles, Common::UNK_LANG, Common::kPlatformUnknown, "");
 
 	if (matches.empty()) {
-		// Use fallback detector if there were no matches by other means
+		// Use fallback detector if there were no matches by other means.
+		// Fallback detectors commonly return static descriptions, so they
+		// are serialized when directories are scanned concurrently.
+		Common::StackLock lock(EngineMan.getDetectionMutex());
 		const ADGameDescription *fallbackDesc = fallbackDetect(allFiles, fslist);
 		if (fallbackDesc != 0) {
 			GameDescriptor desc(toGameDescriptor(*fallbackDesc, _gameids));
@@ -314,6 +319,7 @@ void AdvancedMetaEngine::reportUnknown(const Common::FSNode &path, const ADFileP
 	//
 	// Might also be helpful to display the full path (for when this is used
 	// from the mass detector).
+	Common::StackLock lock(EngineMan.getDetectionMutex());
 	Common::String report = Common::String::format(_("The game in '%s' seems to be unknown."), path.getPath().c_str()) + "\n";
 	report += _("Please, report the following data to the ScummVM team along with name");
 	report += "\n";
@@ -386,13 +392,26 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode &node = allFiles[fname];
+
+	// Files which did not change since they were last hashed are not even
+	// opened
+	const Common::String path = node.getPath();
+	const uint32 mtime = node.getModificationTime();
+	const int32 size = node.getFileSize();
+	if (size >= 0 && DetectionCache::instance().lookup(path, size, mtime, _md5Bytes, fileProps.md5)) {
+		fileProps.size = size;
+		return true;
+	}
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
 	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	DetectionCache::instance().store(path, fileProps.size, mtime, _md5Bytes, fileProps.md5);
 	return true;
 }
 
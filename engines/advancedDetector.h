@@ -263,6 +263,14 @@ public:
 
 	virtual GameList detectGames(const Common::FSList &fslist) const;
 
+	/**
+	 * The table based detection only reads the detection tables, and
+	 * fallbackDetect() is always called with the detection mutex held.
+	 */
+	virtual bool isDetectionThreadSafe() const {
+		return true;
+	}
+
 	virtual Common::Error createInstance(OSystem *syst, Engine **engine) const;
 
 	virtual const ExtraGuiOptions getExtraGuiOptions(const Common::String &target) const;
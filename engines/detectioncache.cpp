@@ -0,0 +1,203 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectioncache.h"
+
+#include "common/debug.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+static const char *const kDetectionCacheFile = "detection.cache";
+static const uint32 kDetectionCacheVersion = 1;
+
+static Common::String readString(Common::ReadStream &in) {
+	Common::String str;
+	uint16 length = in.readUint16LE();
+	while (length-- && !in.eos())
+		str += (char)in.readByte();
+	return str;
+}
+
+static void writeString(Common::WriteStream &out, const Common::String &str) {
+	out.writeUint16LE(str.size());
+	out.writeString(str);
+}
+
+DetectionCache::DetectionCache() : _loaded(false), _dirty(false), _lastFlush(0) {
+}
+
+DetectionCache::~DetectionCache() {
+	flush(true);
+}
+
+Common::String DetectionCache::makeKey(const Common::String &path, uint32 md5Bytes) {
+	return Common::String::format("%u:", md5Bytes) + path;
+}
+
+bool DetectionCache::lookup(const Common::String &path, int32 size, uint32 mtime, uint32 md5Bytes, Common::String &md5) {
+	if (!mtime)
+		return false;
+
+	Common::StackLock lock(_mutex);
+	load();
+
+	EntryMap::iterator i = _entries.find(makeKey(path, md5Bytes));
+	if (i == _entries.end() || i->_value.size != size || i->_value.mtime != mtime)
+		return false;
+
+	i->_value.used = true;
+	// Strings share their buffers, so hand out a copy which is safe to use
+	// on the calling thread
+	md5 = Common::String(i->_value.md5.c_str());
+	return true;
+}
+
+void DetectionCache::store(const Common::String &path, int32 size, uint32 mtime, uint32 md5Bytes, const Common::String &md5) {
+	if (!mtime)
+		return;
+
+	Common::StackLock lock(_mutex);
+	load();
+
+	Entry &entry = _entries[makeKey(path, md5Bytes)];
+	entry.path = Common::String(path.c_str());
+	entry.md5Bytes = md5Bytes;
+	entry.size = size;
+	entry.mtime = mtime;
+	entry.md5 = Common::String(md5.c_str());
+	entry.used = true;
+	_dirty = true;
+}
+
+void DetectionCache::flush(bool force) {
+	Common::StackLock lock(_mutex);
+
+	if (!_dirty)
+		return;
+
+	const uint32 now = g_system->getMillis();
+	if (!force && _lastFlush && now - _lastFlush < kFlushInterval)
+		return;
+
+	_lastFlush = now;
+	if (save())
+		_dirty = false;
+}
+
+void DetectionCache::load() {
+	Common::StackLock lock(_mutex);
+
+	if (_loaded)
+		return;
+
+	// Detection from the command line runs before the backend has set up
+	// its savefile manager. Until it is there, the cache only lives in
+	// memory.
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+	_loaded = true;
+
+	Common::InSaveFile *in = saveFileMan->openForLoading(kDetectionCacheFile);
+	if (!in)
+		return;
+
+	if (in->readUint32BE() != MKTAG('D', 'E', 'T', 'C') || in->readUint32LE() != kDetectionCacheVersion) {
+		debug(2, "DetectionCache: Ignoring '%s' with unknown format", kDetectionCacheFile);
+		delete in;
+		return;
+	}
+
+	uint32 count = in->readUint32LE();
+	while (count-- && !in->eos() && !in->err()) {
+		Entry entry;
+		entry.path = readString(*in);
+		entry.md5Bytes = in->readUint32LE();
+		entry.size = in->readSint32LE();
+		entry.mtime = in->readUint32LE();
+		entry.md5 = readString(*in);
+		entry.used = false;
+
+		if (in->eos() || in->err())
+			break;
+
+		// Entries stored before the cache could be loaded are more recent
+		const Common::String key = makeKey(entry.path, entry.md5Bytes);
+		if (!_entries.contains(key))
+			_entries[key] = entry;
+	}
+
+	debug(2, "DetectionCache: Loaded %d entries", _entries.size());
+	delete in;
+}
+
+bool DetectionCache::save() {
+	// Merge with the cache on disk first, if that was not possible so far
+	load();
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return false;
+
+	// Only keep the entries used during this run once the cache grows too
+	// big, which drops the entries of files that were moved or deleted
+	const bool prune = _entries.size() > kMaxEntries;
+
+	uint32 count = 0;
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (!prune || i->_value.used)
+			count++;
+	}
+
+	Common::OutSaveFile *out = saveFileMan->openForSaving(kDetectionCacheFile);
+	if (!out) {
+		warning("DetectionCache: Could not write '%s'", kDetectionCacheFile);
+		return false;
+	}
+
+	out->writeUint32BE(MKTAG('D', 'E', 'T', 'C'));
+	out->writeUint32LE(kDetectionCacheVersion);
+	out->writeUint32LE(count);
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		const Entry &entry = i->_value;
+		if (prune && !entry.used)
+			continue;
+
+		writeString(*out, entry.path);
+		out->writeUint32LE(entry.md5Bytes);
+		out->writeSint32LE(entry.size);
+		out->writeUint32LE(entry.mtime);
+		writeString(*out, entry.md5);
+	}
+
+	out->finalize();
+	const bool success = !out->err();
+	if (!success)
+		warning("DetectionCache: Could not write '%s'", kDetectionCacheFile);
+	delete out;
+	return success;
+}
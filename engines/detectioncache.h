@@ -0,0 +1,109 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+/**
+ * A persistent cache of the file fingerprints computed during game detection.
+ *
+ * Detection computes the MD5 of the beginning of every candidate file. The
+ * cache remembers these MD5s, keyed by the path of the file and the number
+ * of bytes hashed, together with the size and modification time of the
+ * file. An entry is only used while the size and modification time of its
+ * file are unchanged, so modified files are hashed again automatically.
+ *
+ * The cache is shared by all engines, and is stored in the savegame
+ * directory between runs. It may be used from several threads at once.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	DetectionCache();
+	~DetectionCache();
+
+	/**
+	 * Looks up the MD5 of the first md5Bytes bytes of a file.
+	 *
+	 * @param path		the full path of the file
+	 * @param size		the current size of the file
+	 * @param mtime		the current modification time of the file; 0 if unknown
+	 * @param md5Bytes	the number of bytes hashed
+	 * @param md5		receives the MD5 if it is known
+	 * @return true if the MD5 is known for the current version of the file
+	 */
+	bool lookup(const Common::String &path, int32 size, uint32 mtime, uint32 md5Bytes, Common::String &md5);
+
+	/**
+	 * Remembers the MD5 of the first md5Bytes bytes of a file. Nothing is
+	 * stored if the modification time of the file is unknown.
+	 */
+	void store(const Common::String &path, int32 size, uint32 mtime, uint32 md5Bytes, const Common::String &md5);
+
+	/**
+	 * Writes the cache to disk, if it changed. Unless forced, this is
+	 * skipped if the cache was written less than kFlushInterval ms ago.
+	 */
+	void flush(bool force = false);
+
+	/**
+	 * Reads the cache from disk, unless this was done already. lookup() and
+	 * store() take care of this, but reading the cache uses the savefile
+	 * manager, so call this on the main thread before detecting games on
+	 * other threads.
+	 */
+	void load();
+
+private:
+	enum {
+		kFlushInterval = 10000,
+		kMaxEntries = 50000
+	};
+
+	struct Entry {
+		Common::String path;
+		uint32 md5Bytes;
+		int32 size;
+		uint32 mtime;
+		Common::String md5;
+		bool used;	///< looked up or stored during this run
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	static Common::String makeKey(const Common::String &path, uint32 md5Bytes);
+
+	bool save();
+
+	Common::Mutex _mutex;
+	EntryMap _entries;
+	bool _loaded;
+	bool _dirty;
+	uint32 _lastFlush;
+};
+
+#endif
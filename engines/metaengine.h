@@ -25,6 +25,7 @@
 #include "common/scummsys.h"
 #include "common/error.h"
 #include "common/array.h"
+#include "common/mutex.h"
 
 #include "engines/game.h"
 #include "engines/savestate.h"
@@ -37,6 +38,7 @@ class OSystem;
 namespace Common {
 class FSList;
 class String;
+class WorkerPool;
 }
 
 /**
@@ -80,6 +82,17 @@ public:
 	 */
 	virtual GameList detectGames(const Common::FSList &fslist) const = 0;
 
+	/**
+	 * Queries whether detectGames() may be run on several threads at once,
+	 * each with its own list of files. Detectors which use shared state
+	 * must either protect it with EngineManager::getDetectionMutex() or
+	 * keep the default, in which case they are always run on the main
+	 * thread.
+	 */
+	virtual bool isDetectionThreadSafe() const {
+		return false;
+	}
+
 	/**
 	 * Tries to instantiate an engine instance based on the settings of
 	 * the currently active ConfMan target. That is, the MetaEngine should
@@ -256,10 +269,42 @@ typedef PluginSubclass<MetaEngine> EnginePlugin;
  */
 class EngineManager : public Common::Singleton<EngineManager> {
 public:
+	EngineManager();
+	~EngineManager();
+
 	GameDescriptor findGameInLoadedPlugins(const Common::String &gameName, const EnginePlugin **plugin = NULL) const;
 	GameDescriptor findGame(const Common::String &gameName, const EnginePlugin **plugin = NULL) const;
 	GameList detectGames(const Common::FSList &fslist) const;
+
+	/**
+	 * Lists several directories and runs the detectors of all engines on
+	 * each of them. Directories are scanned concurrently by the engines
+	 * whose detection is thread safe; the results are the same as calling
+	 * detectGames() on each directory in turn.
+	 *
+	 * @param dirs		the directories to scan
+	 * @param results	receives the games detected in each directory
+	 * @param contents	receives the contents of each directory, empty if
+	 *					it could not be listed
+	 * @param listed	receives whether each directory could be listed
+	 */
+	void detectGamesInDirectories(const Common::FSList &dirs, Common::Array<GameList> &results, Common::Array<Common::FSList> &contents, Common::Array<bool> &listed) const;
+
+	/**
+	 * Returns the mutex serializing the parts of thread safe detectors
+	 * which use shared state, like fallback detectors.
+	 */
+	Common::Mutex &getDetectionMutex() const { return _detectionMutex; }
+
 	const EnginePlugin::List &getPlugins() const;
+
+private:
+	enum {
+		kDetectionThreads = 3
+	};
+
+	mutable Common::Mutex _detectionMutex;
+	mutable Common::WorkerPool *_detectionPool;
 };
 
 /** Convenience shortcut for accessing the engine manager. */
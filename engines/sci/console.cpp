@@ -92,6 +92,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("opcodes",			WRAP_METHOD(Console, cmdOpcodes));
 	DCmd_Register("selector",			WRAP_METHOD(Console, cmdSelector));
 	DCmd_Register("selectors",			WRAP_METHOD(Console, cmdSelectors));
+	DCmd_Register("selector_cache",		WRAP_METHOD(Console, cmdSelectorCache));
 	DCmd_Register("functions",			WRAP_METHOD(Console, cmdKernelFunctions));
 	DCmd_Register("class_table",		WRAP_METHOD(Console, cmdClassTable));
 	// Parser
@@ -109,6 +110,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	DCmd_Register("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	DCmd_Register("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	DCmd_Register("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	DCmd_Register("list",				WRAP_METHOD(Console, cmdList));
 	DCmd_Register("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	DCmd_Register("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
@@ -151,6 +153,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	DCmd_Register("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	DCmd_Register("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	DCmd_Register("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	DCmd_Register("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	DCmd_Register("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -328,6 +331,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf("Kernel:\n");
 	DebugPrintf(" opcodes - Lists the opcode names\n");
 	DebugPrintf(" selectors - Lists the selector names\n");
+	DebugPrintf(" selector_cache - Shows the hit rate of the selector lookup cache\n");
 	DebugPrintf(" selector - Attempts to find the requested selector by name\n");
 	DebugPrintf(" functions - Lists the kernel functions\n");
 	DebugPrintf(" class_table - Shows the available classes\n");
@@ -348,6 +352,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	DebugPrintf(" resource_info - Shows info about a resource\n");
 	DebugPrintf(" resource_types - Shows the valid resource types\n");
+	DebugPrintf(" resource_cache - Shows the memory usage and hit rate of the resource cache\n");
 	DebugPrintf(" list - Lists all the resources of a given type\n");
 	DebugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	DebugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
@@ -387,6 +392,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	DebugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	DebugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	DebugPrintf(" gc_stats - Shows the pause times and the amount reclaimed by the garbage collector (\"reset\" clears them)\n");
 	DebugPrintf("\n");
 	DebugPrintf("Music/SFX:\n");
 	DebugPrintf(" songlib - Shows the song library\n");
@@ -541,6 +547,27 @@ bool Console::cmdSelector(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	SegManager *segMan = _engine->_gamestate->_segMan;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		segMan->_selectorCacheHits = 0;
+		segMan->_selectorCacheMisses = 0;
+		DebugPrintf("Selector cache counters reset\n");
+		return true;
+	} else if (argc != 1) {
+		DebugPrintf("Shows the hit rate of the selector lookup cache\n");
+		DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	const uint32 lookups = segMan->_selectorCacheHits + segMan->_selectorCacheMisses;
+	DebugPrintf("Selector lookups: %u, hits: %u, misses: %u, hit rate: %.1f%%\n", lookups,
+		segMan->_selectorCacheHits, segMan->_selectorCacheMisses,
+		lookups ? segMan->_selectorCacheHits * 100.0 / lookups : 0.0);
+	return true;
+}
+
 bool Console::cmdSelectors(int argc, const char **argv) {
 	DebugPrintf("Selector names in numeric order:\n");
 	Common::String selectorName;
@@ -792,6 +819,29 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		resMan->resetResourceCacheStats();
+		DebugPrintf("Resource cache counters reset\n");
+		return true;
+	} else if (argc != 1) {
+		DebugPrintf("Shows the memory usage, budget and hit rate of the resource cache\n");
+		DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	DebugPrintf("%-8s %7s %10s %10s %10s %10s %10s %10s\n", "class", "entries", "bytes", "budget", "hits", "misses", "evictions", "prefetches");
+	for (int i = 0; i < kResCacheCount; i++) {
+		const ResourceManager::ResourceCache &cache = resMan->getResourceCache((ResourceCacheClass)i);
+		DebugPrintf("%-8s %7d %10d %10d %10d %10d %10d %10d\n", ResourceManager::getResourceCacheName((ResourceCacheClass)i),
+			cache.entries, cache.memory, cache.budget, cache.hits, cache.misses, cache.evictions, cache.prefetches);
+	}
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		DebugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
@@ -2240,9 +2290,11 @@ bool Console::cmdGCInvoke(int argc, const char **argv) {
 bool Console::cmdGCObjects(int argc, const char **argv) {
 	AddrSet *use_map = findAllActiveReferences(_engine->_gamestate);
 
+	Common::Array<reg_t> addresses = use_map->getAddresses();
+
 	DebugPrintf("Reachable object references (normalised):\n");
-	for (AddrSet::iterator i = use_map->begin(); i != use_map->end(); ++i) {
-		DebugPrintf(" - %04x:%04x\n", PRINT_REG(i->_key));
+	for (Common::Array<reg_t>::const_iterator i = addresses.begin(); i != addresses.end(); ++i) {
+		DebugPrintf(" - %04x:%04x\n", PRINT_REG(*i));
 	}
 
 	delete use_map;
@@ -2250,6 +2302,27 @@ bool Console::cmdGCObjects(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	GCStats &stats = _engine->_gamestate->gcStats;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		memset(&stats, 0, sizeof(stats));
+		DebugPrintf("Garbage collector statistics reset\n");
+		return true;
+	}
+
+	DebugPrintf("Garbage collector runs: %d\n", stats.runs);
+	if (!stats.runs)
+		return true;
+
+	DebugPrintf("Pause: last %d ms, max %d ms, avg %d ms\n",
+		stats.lastPause, stats.maxPause, stats.totalPause / stats.runs);
+	DebugPrintf("Last run: %d references reachable, %d entries freed\n",
+		stats.lastMarked, stats.lastFreed);
+	DebugPrintf("Entries freed in total: %d\n", stats.totalFreed);
+	return true;
+}
+
 bool Console::cmdGCShowReachable(int argc, const char **argv) {
 	if (argc != 2) {
 		DebugPrintf("Prints all addresses directly reachable from the memory object specified as parameter.\n");
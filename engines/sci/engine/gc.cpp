@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 namespace Sci {
@@ -46,17 +47,76 @@ const char *segmentTypeNames[] = {
 };
 #endif
 
+bool AddrSet::insert(reg_t addr) {
+	if (addr.getOffset() >= kMaxBitmapOffset) {
+		if (_overflow.contains(addr))
+			return false;
+		_overflow.setVal(addr, true);
+		_size++;
+		return true;
+	}
+
+	const uint seg = addr.getSegment();
+	const uint word = addr.getOffset() >> 5;
+	const uint32 bit = 1U << (addr.getOffset() & 31);
+
+	if (seg >= _bitmaps.size())
+		_bitmaps.resize(seg + 1);
+	Common::Array<uint32> &bitmap = _bitmaps[seg];
+	if (word >= bitmap.size())
+		bitmap.resize(word + 1);
+
+	if (bitmap[word] & bit)
+		return false;
+	bitmap[word] |= bit;
+	_size++;
+	return true;
+}
+
+bool AddrSet::contains(reg_t addr) const {
+	if (addr.getOffset() >= kMaxBitmapOffset)
+		return _overflow.contains(addr);
+
+	const uint seg = addr.getSegment();
+	const uint word = addr.getOffset() >> 5;
+
+	if (seg >= _bitmaps.size() || word >= _bitmaps[seg].size())
+		return false;
+	return (_bitmaps[seg][word] >> (addr.getOffset() & 31)) & 1;
+}
+
+Common::Array<reg_t> AddrSet::getAddresses() const {
+	Common::Array<reg_t> addresses;
+	for (uint seg = 0; seg < _bitmaps.size(); seg++) {
+		const Common::Array<uint32> &bitmap = _bitmaps[seg];
+		for (uint word = 0; word < bitmap.size(); word++) {
+			for (uint bit = 0; bit < 32; bit++) {
+				if (bitmap[word] & (1U << bit))
+					addresses.push_back(make_reg(seg, word * 32 + bit));
+			}
+		}
+	}
+	for (Common::HashMap<reg_t, bool, reg_t_Hash>::const_iterator i = _overflow.begin(); i != _overflow.end(); ++i)
+		addresses.push_back(i->_key);
+	return addresses;
+}
+
 void WorklistManager::push(reg_t reg) {
 	if (!reg.getSegment()) // No numbers
 		return;
 
 	debugC(kDebugLevelGC, "[GC] Adding %04x:%04x", PRINT_REG(reg));
 
-	if (_map.contains(reg))
+	if (!_map.insert(reg))
 		return; // already dealt with it
 
-	_map.setVal(reg, true);
 	_worklist.push_back(reg);
+
+	// Normalize the address right away, instead of in a separate pass over
+	// all addresses afterwards
+	SegmentObj *mobj = _segMan->getSegmentObj(reg.getSegment());
+	if (mobj)
+		_normalizedMap.insert(mobj->findCanonicAddress(_segMan, reg));
 }
 
 void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
@@ -64,22 +124,6 @@ void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 		push(*it);
 }
 
-static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map) {
-	AddrSet *normal_map = new AddrSet();
-
-	for (AddrSet::const_iterator i = nonnormal_map.begin(); i != nonnormal_map.end(); ++i) {
-		reg_t reg = i->_key;
-		SegmentObj *mobj = segMan->getSegmentObj(reg.getSegment());
-
-		if (mobj) {
-			reg = mobj->findCanonicAddress(segMan, reg);
-			normal_map->setVal(reg, true);
-		}
-	}
-
-	return normal_map;
-}
-
 static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap) {
 	SegmentId stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
 	while (!wm._worklist.empty()) {
@@ -98,7 +142,8 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 AddrSet *findAllActiveReferences(EngineState *s) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
+	AddrSet *activeRefs = new AddrSet();
+	WorklistManager wm(s->_segMan, *activeRefs);
 
 	// Initialize registers
 	wm.push(s->r_acc);
@@ -157,11 +202,13 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
 
-	return normalizeAddresses(s->_segMan, wm._map);
+	return activeRefs;
 }
 
 void run_gc(EngineState *s) {
 	SegManager *segMan = s->_segMan;
+	const uint32 startTime = g_system->getMillis();
+	uint32 freed = 0;
 
 	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
@@ -196,6 +243,7 @@ void run_gc(EngineState *s) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					freed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -205,6 +253,15 @@ void run_gc(EngineState *s) {
 		}
 	}
 
+	GCStats &stats = s->gcStats;
+	stats.runs++;
+	stats.lastPause = g_system->getMillis() - startTime;
+	stats.maxPause = MAX(stats.maxPause, stats.lastPause);
+	stats.totalPause += stats.lastPause;
+	stats.lastMarked = activeRefs->size();
+	stats.lastFreed = freed;
+	stats.totalFreed += freed;
+
 	delete activeRefs;
 
 #ifdef GC_DEBUG_CODE
@@ -24,6 +24,7 @@
 #ifndef SCI_ENGINE_GC_H
 #define SCI_ENGINE_GC_H
 
+#include "common/array.h"
 #include "common/hashmap.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/state.h"
@@ -36,16 +37,45 @@ struct reg_t_Hash {
 	}
 };
 
-/*
- * The AddrSet is a "set" of reg_t values.
- * We don't have a HashSet type, so we abuse a HashMap for this.
+/**
+ * A set of reg_t values, stored as one bitmap of offsets per segment. The
+ * garbage collector marks thousands of addresses per run, and setting a bit
+ * is much cheaper than inserting into a hash map. Offsets beyond
+ * kMaxBitmapOffset (only possible with the 32-bit offsets of SCI32) are kept
+ * in a hash map instead, so that a stray large offset cannot blow up a bitmap.
  */
-typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
+class AddrSet {
+public:
+	AddrSet() : _size(0) {}
+
+	/**
+	 * Adds the address to the set.
+	 * @return true if the address was added, false if it was in the set already
+	 */
+	bool insert(reg_t addr);
+
+	bool contains(reg_t addr) const;
+
+	/** Returns the number of addresses in the set */
+	uint size() const { return _size; }
+
+	/** Returns all addresses in the set, ordered by segment and offset */
+	Common::Array<reg_t> getAddresses() const;
+
+private:
+	enum {
+		kMaxBitmapOffset = 0x10000
+	};
+
+	Common::Array<Common::Array<uint32> > _bitmaps; ///< bitmap of offsets, per segment
+	Common::HashMap<reg_t, bool, reg_t_Hash> _overflow; ///< addresses with offsets >= kMaxBitmapOffset
+	uint _size;
+};
 
 /**
  * Finds all used references and normalises them to their memory addresses
  * @param s The state to gather all information from
- * @return A hash map containing entries for all used references
+ * @return A set containing all used references
  */
 AddrSet *findAllActiveReferences(EngineState *s);
 
@@ -57,7 +87,11 @@ void run_gc(EngineState *s);
 
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
-	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
+	AddrSet _map;	///< all addresses pushed so far
+	AddrSet &_normalizedMap;	///< the canonical addresses of the entries of _map
+	SegManager *_segMan;
+
+	WorklistManager(SegManager *segMan, AddrSet &normalizedMap) : _normalizedMap(normalizedMap), _segMan(segMan) {}
 
 	void push(reg_t reg);
 	void pushArray(const Common::Array<reg_t> &tmp);
@@ -63,6 +63,30 @@ void Script::freeScript() {
 	_lockers = 1;
 	_markedAsDeleted = false;
 	_objects.clear();
+
+	invalidateInstructionCache();
+}
+
+void Script::invalidateInstructionCache() {
+	_instructionIndex.clear();
+	_instructions.clear();
+}
+
+const PMachineInstruction &Script::decodeInstruction(uint32 offset) {
+	if (_instructionIndex.empty())
+		_instructionIndex.resize(_bufSize);
+
+	// The index is 16 bits wide, don't cache any further instructions once
+	// it runs out of entries
+	if (offset >= _instructionIndex.size() || _instructions.size() >= 0xFFFF) {
+		decodePMachineInstruction(_buf, offset, _bufSize, _uncachedInstruction);
+		return _uncachedInstruction;
+	}
+
+	_instructions.push_back(PMachineInstruction());
+	decodePMachineInstruction(_buf, offset, _bufSize, _instructions.back());
+	_instructionIndex[offset] = _instructions.size();
+	return _instructions.back();
 }
 
 void Script::load(int script_nr, ResourceManager *resMan) {
@@ -463,6 +487,7 @@ void Script::mcpyInOut(int dst, const void *src, size_t n) {
 	if (_buf) {
 		assert(dst + n <= _bufSize);
 		memcpy(_buf + dst, src, n);
+		invalidateInstructionCache();
 	}
 }
 
@@ -74,6 +74,15 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	/**
+	 * Cache of pre-decoded instructions. For each offset in the buffer,
+	 * _instructionIndex holds the 1-based index of the decoded instruction
+	 * in _instructions, or 0 if the instruction has not been decoded yet.
+	 */
+	Common::Array<uint16> _instructionIndex;
+	Common::Array<PMachineInstruction> _instructions;
+	PMachineInstruction _uncachedInstruction; /**< Used once the cache is full */
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -98,6 +107,23 @@ public:
 	void freeScript();
 	void load(int script_nr, ResourceManager *resMan);
 
+	/**
+	 * Returns the decoded instruction at the given offset. Instructions are
+	 * decoded the first time they are executed and cached afterwards.
+	 * @note The reference is invalidated by the next call.
+	 */
+	const PMachineInstruction &getInstruction(uint32 offset) {
+		if (offset < _instructionIndex.size() && _instructionIndex[offset])
+			return _instructions[_instructionIndex[offset] - 1];
+		return decodeInstruction(offset);
+	}
+
+	/**
+	 * Discards all decoded instructions. Must be called whenever the script
+	 * buffer is modified.
+	 */
+	void invalidateInstructionCache();
+
 	void matchSignatureAndPatch(uint16 scriptNr, byte *scriptData, const uint32 scriptSize);
 	int32 findSignature(const SciScriptSignature *signature, const byte *scriptData, const uint32 scriptSize);
 	void applyPatch(const uint16 *patch, byte *scriptData, const uint32 scriptSize, int32 signatureOffset);
@@ -252,6 +278,11 @@ public:
 	int getCodeBlockOffsetSci3() { return READ_SCI11ENDIAN_UINT32(_buf); }
 
 private:
+	/**
+	 * Decodes the instruction at the given offset and adds it to the cache.
+	 */
+	const PMachineInstruction &decodeInstruction(uint32 offset);
+
 	/**
 	 * Processes a relocation block within a SCI0-SCI2.1 script
 	 *  This function is idempotent, but it must only be called after all
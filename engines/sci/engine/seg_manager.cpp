@@ -46,6 +46,12 @@ SegManager::SegManager(ResourceManager *resMan) {
 
 	_resMan = resMan;
 
+	// Generation 0 is never used, so all entries start out invalid
+	memset(_selectorCache, 0, sizeof(_selectorCache));
+	_selectorCacheGeneration = 1;
+	_selectorCacheHits = 0;
+	_selectorCacheMisses = 0;
+
 	createClassTable();
 }
 
@@ -171,6 +177,8 @@ void SegManager::deallocate(SegmentId seg) {
 
 	delete mobj;
 	_heap[seg] = NULL;
+
+	invalidateSelectorCache();
 }
 
 bool SegManager::isHeapObject(reg_t pos) const {
@@ -418,6 +426,9 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 
 	offset = table->allocEntry();
 
+	// The entry may have been used by a clone of a different object before
+	invalidateSelectorCache();
+
 	*addr = make_reg(_clonesSegId, offset);
 	return &(table->_table[offset]);
 }
@@ -982,6 +993,8 @@ int SegManager::instantiateScript(int scriptNum) {
 	scr->initializeClasses(this);
 	scr->initializeObjects(this, segmentId);
 
+	invalidateSelectorCache();
+
 	return segmentId;
 }
 
@@ -1007,6 +1020,8 @@ void SegManager::uninstantiateScript(int script_nr) {
 
 	if (getSciVersion() < SCI_VERSION_1_1)
 		uninstantiateScriptSci0(script_nr);
+
+	invalidateSelectorCache();
 	// FIXME: Add proper script uninstantiation for SCI 1.1
 
 	if (!scr->getLockers()) {
@@ -43,6 +43,23 @@ enum ScriptLoadType {
 
 class Script;
 
+/**
+ * An entry of the selector lookup cache. Caches the result of
+ * lookupSelector() for one object and selector.
+ */
+struct SelectorCacheEntry {
+	reg_t obj;
+	Selector selector;
+	uint32 generation;	///< Entry is valid if it matches the cache generation
+	SelectorType type;
+	int varIndex;		///< Index of the variable, for kSelectorVariable
+	reg_t funcp;		///< Address of the method, for kSelectorMethod
+};
+
+enum {
+	kSelectorCacheSize = 1024	///< Number of entries, must be a power of two
+};
+
 class SegManager : public Common::Serializable {
 	friend class Console;
 public:
@@ -441,6 +458,29 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	/**
+	 * Returns the selector cache entry for the given object and selector.
+	 * The entry caches the lookup if it is valid, i.e. if its object,
+	 * selector and generation match; otherwise it may be overwritten.
+	 */
+	SelectorCacheEntry &getSelectorCacheEntry(reg_t obj, Selector selector) {
+		const uint hash = (obj.getSegment() * 31 + obj.getOffset()) * 17 + selector;
+		return _selectorCache[hash & (kSelectorCacheSize - 1)];
+	}
+
+	/** The current generation of the selector cache, see SelectorCacheEntry */
+	uint32 getSelectorCacheGeneration() const { return _selectorCacheGeneration; }
+
+	/**
+	 * Invalidates all selector cache entries. Called whenever objects are
+	 * created, moved or removed, which may change the result of a lookup.
+	 */
+	void invalidateSelectorCache() { _selectorCacheGeneration++; }
+
+	/** Hit and miss counters of the selector cache, shown by the console */
+	uint32 _selectorCacheHits;
+	uint32 _selectorCacheMisses;
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -463,6 +503,9 @@ private:
 	SegmentId _stringSegId;
 #endif
 
+	SelectorCacheEntry _selectorCache[kSelectorCacheSize];
+	uint32 _selectorCacheGeneration;
+
 public:
 	SegmentObj *allocSegment(SegmentObj *mem, SegmentId *segid);
 
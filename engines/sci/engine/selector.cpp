@@ -265,32 +265,53 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 				PRINT_REG(obj_location));
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
-
-	if (index >= 0) {
-		// Found it as a variable
-		if (varp) {
-			varp->obj = obj_location;
-			varp->varindex = index;
-		}
-		return kSelectorVariable;
+	// Check the cache first, to avoid walking the superclass chain
+	SelectorCacheEntry &entry = segMan->getSelectorCacheEntry(obj_location, selectorId);
+	if (entry.generation == segMan->getSelectorCacheGeneration() &&
+		entry.obj == obj_location && entry.selector == selectorId) {
+		segMan->_selectorCacheHits++;
 	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
+		segMan->_selectorCacheMisses++;
+
+		entry.obj = obj_location;
+		entry.selector = selectorId;
+		entry.generation = segMan->getSelectorCacheGeneration();
+		entry.type = kSelectorNone;
+		entry.varIndex = -1;
+		entry.funcp = NULL_REG;
+
+		index = obj->locateVarSelector(segMan, selectorId);
+
+		if (index >= 0) {
+			// Found it as a variable
+			entry.type = kSelectorVariable;
+			entry.varIndex = index;
+		} else {
+			// Check if it's a method, with recursive lookup in superclasses
+			while (obj) {
+				index = obj->funcSelectorPosition(selectorId);
+				if (index >= 0) {
+					entry.type = kSelectorMethod;
+					entry.funcp = obj->getFunction(index);
+					break;
+				} else {
+					obj = segMan->getObject(obj->getSuperClassSelector());
+				}
 			}
 		}
+	}
 
-		return kSelectorNone;
+	if (entry.type == kSelectorVariable) {
+		if (varp) {
+			varp->obj = obj_location;
+			varp->varindex = entry.varIndex;
+		}
+	} else if (entry.type == kSelectorMethod) {
+		if (fptr)
+			*fptr = entry.funcp;
 	}
 
+	return entry.type;
 
 //	return _lookupSelector_function(segMan, obj, selectorId, fptr);
 }
@@ -104,6 +104,7 @@ void EngineState::reset(bool isRestoring) {
 	lastWaitTime = 0;
 
 	gcCountDown = 0;
+	memset(&gcStats, 0, sizeof(gcStats));
 
 	_throttleCounter = 0;
 	_throttleLastTime = 0;
@@ -95,6 +95,17 @@ struct VideoState {
 	}
 };
 
+/** Statistics of the garbage collector, shown by the gc_stats console command */
+struct GCStats {
+	uint32 runs;		///< Number of garbage collections
+	uint32 lastPause;	///< Duration of the last collection, in milliseconds
+	uint32 maxPause;	///< Longest collection, in milliseconds
+	uint32 totalPause;	///< Sum of the durations of all collections, in milliseconds
+	uint32 lastMarked;	///< Number of reachable addresses found by the last collection
+	uint32 lastFreed;	///< Number of entries freed by the last collection
+	uint32 totalFreed;	///< Number of entries freed by all collections
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -184,6 +195,7 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCStats gcStats;
 
 	MessageState *_msgState;
 
@@ -528,6 +528,32 @@ int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4])
 	return offset;
 }
 
+static inline bool isImmediatePush(byte opcode) {
+	return opcode == op_pushi || opcode == op_push0 || opcode == op_push1 || opcode == op_push2;
+}
+
+void decodePMachineInstruction(const byte *src, uint32 offset, uint32 codeSize, PMachineInstruction &instruction) {
+	instruction.size = readPMachineInstruction(src + offset, instruction.extOpcode, instruction.opparams);
+	instruction.pushCount = 0;
+	instruction.pushRunSize = 0;
+
+	if (!isImmediatePush(instruction.extOpcode >> 1))
+		return;
+
+	// Collect the values of the run of immediate pushes starting here. The
+	// longest of them (pushi with a word operand) takes 3 bytes.
+	uint32 pos = offset;
+	while (instruction.pushCount < kMaxFusedPushes && pos + 3 <= codeSize && isImmediatePush(src[pos] >> 1)) {
+		byte extOpcode;
+		int16 opparams[4];
+		pos += readPMachineInstruction(src + pos, extOpcode, opparams);
+
+		const byte opcode = extOpcode >> 1;
+		instruction.opparams[instruction.pushCount++] = (opcode == op_pushi) ? opparams[0] : opcode - op_push0;
+	}
+	instruction.pushRunSize = pos - offset;
+}
+
 void run_vm(EngineState *s) {
 	assert(s);
 
@@ -615,8 +641,21 @@ void run_vm(EngineState *s) {
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
 		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		const PMachineInstruction &instruction = scr->getInstruction(s->xs->addr.pc.getOffset());
+
+		// Superinstruction: push a whole run of immediate values at once.
+		// Not used while debugging, so that single stepping still works.
+		if (instruction.pushCount > 1 && !g_sci->_debugState.debugging) {
+			for (int i = 0; i < instruction.pushCount; i++)
+				PUSH(instruction.opparams[i]);
+			s->xs->addr.pc.incOffset(instruction.pushRunSize);
+			s->scriptStepCounter += instruction.pushCount;
+			continue;
+		}
+
+		const byte extOpcode = instruction.extOpcode;
+		memcpy(opparams, instruction.opparams, sizeof(opparams));
+		s->xs->addr.pc.incOffset(instruction.size);
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -366,6 +366,37 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
  */
 int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4]);
 
+/**
+ * A pre-decoded PMachine instruction, as cached by Script::getInstruction().
+ *
+ * Runs of immediate pushes (pushi, push0, push1 and push2), as used to set
+ * up the parameters of a send, are fused into a single superinstruction:
+ * the first instruction of the run holds the values of all its pushes in
+ * opparams, so that run_vm() can push them at once.
+ */
+struct PMachineInstruction {
+	byte extOpcode;		///< "extended" opcode of the instruction
+	byte size;			///< length in bytes of the instruction
+	byte pushCount;		///< number of fused pushes, 0 if not an immediate push
+	byte pushRunSize;	///< length in bytes of all fused pushes
+	int16 opparams[4];	///< parameters of the instruction
+};
+
+enum {
+	/** Maximum number of immediate pushes fused into one superinstruction */
+	kMaxFusedPushes = 4
+};
+
+/**
+ * Decodes the instruction at the given address, including the push
+ * superinstruction starting there, if any.
+ * @param[in] src			the script buffer
+ * @param[in] offset		the offset of the instruction in the buffer
+ * @param[in] codeSize		the size of the script buffer
+ * @param[out] instruction	the decoded instruction
+ */
+void decodePMachineInstruction(const byte *src, uint32 offset, uint32 codeSize, PMachineInstruction &instruction);
+
 } // End of namespace Sci
 
 #endif // SCI_ENGINE_VM_H
@@ -22,10 +22,12 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
 #include "common/textconsole.h"
+#include "common/workerpool.h"
 
 #include "sci/resource.h"
 #include "sci/resource_intern.h"
@@ -188,6 +190,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_lruPrev = NULL;
+	_lruNext = NULL;
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
@@ -883,13 +887,27 @@ void ResourceManager::freeResourceSources() {
 	_sources.clear();
 }
 
-ResourceManager::ResourceManager() {
+class ResourcePrefetchJob : public Common::WorkerJob {
+public:
+	ResourcePrefetchJob(ResourceManager *resMan) : _resMan(resMan) {}
+
+	virtual void run() {
+		_resMan->runPrefetch();
+	}
+
+private:
+	ResourceManager *_resMan;
+};
+
+ResourceManager::ResourceManager() :
+	_prefetchPool(0), _prefetchJob(0), _prefetchMemory(0),
+	_prefetchCancelled(false), _prefetching(false) {
 }
 
 void ResourceManager::init(bool initFromFallbackDetector) {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	initResourceCaches();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 
@@ -972,6 +990,10 @@ void ResourceManager::init(bool initFromFallbackDetector) {
 }
 
 ResourceManager::~ResourceManager() {
+	cancelPrefetch();
+	delete _prefetchPool;
+	delete _prefetchJob;
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -985,6 +1007,220 @@ ResourceManager::~ResourceManager() {
 		delete *it;
 		++it;
 	}
+
+	for (it = _prefetchFiles.begin(); it != _prefetchFiles.end(); ++it)
+		delete *it;
+}
+
+static ResourceCacheClass getResourceCacheClass(ResourceType type) {
+	switch (type) {
+	case kResourceTypeView:
+		return kResCacheViews;
+	case kResourceTypePic:
+		return kResCachePics;
+	case kResourceTypeSound:
+	case kResourceTypeAudio:
+	case kResourceTypeSync:
+	case kResourceTypeAudio36:
+	case kResourceTypeSync36:
+		return kResCacheAudio;
+	case kResourceTypeScript:
+	case kResourceTypeHeap:
+		return kResCacheScripts;
+	default:
+		return kResCacheOther;
+	}
+}
+
+static const struct {
+	const char *name;
+	const char *configKey;
+	int defaultBudget;	// in KB
+} s_resourceCacheInfo[kResCacheCount] = {
+	{ "views",   "rescache_views",   512 },
+	{ "pics",    "rescache_pics",    256 },
+	{ "audio",   "rescache_audio",   256 },
+	{ "scripts", "rescache_scripts", 256 },
+	{ "other",   "rescache_other",   256 }
+};
+
+const char *ResourceManager::getResourceCacheName(ResourceCacheClass cacheClass) {
+	return s_resourceCacheInfo[cacheClass].name;
+}
+
+void ResourceManager::initResourceCaches() {
+	for (int i = 0; i < kResCacheCount; i++) {
+		ResourceCache &cache = _LRU[i];
+		cache.head = NULL;
+		cache.tail = NULL;
+		cache.entries = 0;
+		cache.memory = 0;
+
+		// The budgets are configured in KB
+		const char *configKey = s_resourceCacheInfo[i].configKey;
+		int budget = s_resourceCacheInfo[i].defaultBudget;
+		if (ConfMan.hasKey(configKey))
+			budget = MAX(ConfMan.getInt(configKey), 0);
+		cache.budget = budget * 1024;
+	}
+
+	resetResourceCacheStats();
+}
+
+void ResourceManager::resetResourceCacheStats() {
+	for (int i = 0; i < kResCacheCount; i++) {
+		_LRU[i].hits = 0;
+		_LRU[i].misses = 0;
+		_LRU[i].evictions = 0;
+		_LRU[i].prefetches = 0;
+	}
+}
+
+/**
+ * Resource types which are prefetched for a room, in the order in which
+ * the game usually needs them. Only resources with the number of the room
+ * are prefetched.
+ */
+static const ResourceType s_prefetchTypes[] = {
+	kResourceTypeScript,
+	kResourceTypeHeap,
+	kResourceTypePic,
+	kResourceTypePalette,
+	kResourceTypeView,
+	kResourceTypeMessage,
+	kResourceTypeText,
+	kResourceTypeSound
+};
+
+void ResourceManager::prefetchRoom(uint16 roomNumber) {
+	cancelPrefetch();
+
+	// The amount of memory to prefetch is configured in KB
+	if (!ConfMan.hasKey("rescache_prefetch") || ConfMan.getInt("rescache_prefetch") <= 0)
+		return;
+
+	if (!_prefetchPool) {
+		_prefetchPool = new Common::WorkerPool(1);
+		_prefetchJob = new ResourcePrefetchJob(this);
+	}
+
+	// Without threads, the job would just load the resources right away
+	if (!_prefetchPool->isThreaded())
+		return;
+
+	// Keep only the volume files which the new room needs. The files stay
+	// open until the next room, so the job never reads through a closed
+	// file, however many volumes the resources are spread over.
+	Common::List<Common::File *> oldFiles = _prefetchFiles;
+	_prefetchFiles.clear();
+
+	_prefetchList.clear();
+	for (int i = 0; i < ARRAYSIZE(s_prefetchTypes); i++) {
+		Resource *res = testResource(ResourceId(s_prefetchTypes[i], roomNumber));
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		// Only resources in plain volume files are prefetched. Patches and
+		// the other sources are opened through SearchMan while loading.
+		if (res->_source->getSourceType() != kSourceVolume || res->_source->_resourceFile)
+			continue;
+
+		PrefetchEntry entry;
+		entry.res = res;
+		entry.file = getPrefetchFile(res->_source, oldFiles);
+		if (entry.file)
+			_prefetchList.push_back(entry);
+	}
+
+	Common::List<Common::File *>::iterator it;
+	for (it = oldFiles.begin(); it != oldFiles.end(); ++it)
+		delete *it;
+
+	if (_prefetchList.empty())
+		return;
+
+	debugC(kDebugLevelResMan, 2, "[resMan] Prefetching %d resources of room %d", _prefetchList.size(), roomNumber);
+
+	_prefetchMemory = ConfMan.getInt("rescache_prefetch") * 1024;
+	_prefetchCancelled = false;
+	_prefetchPool->schedule(_prefetchJob);
+}
+
+void ResourceManager::cancelPrefetch() {
+	if (!_prefetchPool)
+		return;
+
+	_prefetchCancelled = true;
+	_prefetchPool->cancel(_prefetchJob);
+}
+
+Common::File *ResourceManager::getPrefetchFile(ResourceSource *source, Common::List<Common::File *> &oldFiles) {
+	// Only called while no prefetch is running
+	const char *filename = source->getLocationName().c_str();
+
+	Common::List<Common::File *>::iterator it;
+	for (it = _prefetchFiles.begin(); it != _prefetchFiles.end(); ++it) {
+		if (scumm_stricmp((*it)->getName(), filename) == 0)
+			return *it;
+	}
+
+	// Reuse a file of the previous room instead of opening it again
+	for (it = oldFiles.begin(); it != oldFiles.end(); ++it) {
+		if (scumm_stricmp((*it)->getName(), filename) == 0) {
+			Common::File *file = *it;
+			oldFiles.erase(it);
+			_prefetchFiles.push_back(file);
+			return file;
+		}
+	}
+
+	Common::File *file = new Common::File;
+	if (!file->open(filename)) {
+		delete file;
+		return NULL;
+	}
+
+	_prefetchFiles.push_back(file);
+	return file;
+}
+
+void ResourceManager::runPrefetch() {
+	int classMemory[kResCacheCount] = { 0 };
+
+	for (uint i = 0; i < _prefetchList.size() && !_prefetchCancelled && _prefetchMemory > 0; i++) {
+		// Only one resource is loaded at a time, so the main thread never
+		// waits for more than a single resource
+		Common::StackLock lock(_mutex);
+
+		Resource *res = _prefetchList[i].res;
+		if (res->_status != kResStatusNoMalloc)
+			continue;
+
+		// Don't prefetch more of a class than its budget, or the prefetched
+		// resources would be evicted again right away
+		ResourceCacheClass cacheClass = getResourceCacheClass(res->getType());
+		ResourceCache &cache = _LRU[cacheClass];
+		if (classMemory[cacheClass] + (int)res->size > cache.budget)
+			continue;
+
+		// This is what loadResource() does for volume sources, but with the
+		// prefetch job's own file
+		Common::File *file = _prefetchList[i].file;
+		_prefetching = true;
+		file->seek(res->_fileOffset, SEEK_SET);
+		const int error = res->decompress(getVolVersion(), file);
+		_prefetching = false;
+
+		if (error || !res->data) {
+			res->unalloc();
+			continue;
+		}
+
+		addToLRU(res);
+		classMemory[cacheClass] += res->size;
+		_prefetchMemory -= res->size;
+		cache.prefetches++;
+	}
 }
 
 void ResourceManager::removeFromLRU(Resource *res) {
@@ -992,7 +1228,19 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	ResourceCache &cache = _LRU[getResourceCacheClass(res->getType())];
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		cache.head = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		cache.tail = res->_lruPrev;
+	res->_lruPrev = NULL;
+	res->_lruNext = NULL;
+	cache.entries--;
+	cache.memory -= res->size;
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -1002,7 +1250,16 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	ResourceCache &cache = _LRU[getResourceCacheClass(res->getType())];
+	res->_lruPrev = NULL;
+	res->_lruNext = cache.head;
+	if (cache.head)
+		cache.head->_lruPrev = res;
+	else
+		cache.tail = res;
+	cache.head = res;
+	cache.entries++;
+	cache.memory += res->size;
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s.%03d (%d bytes) to lru control: %d bytes total",
@@ -1015,29 +1272,36 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
-
-	while (it != _LRU.end()) {
-		res = *it;
-		debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
-		mem += res->size;
-		++entries;
-		++it;
+
+	for (int i = 0; i < kResCacheCount; i++) {
+		for (Resource *res = _LRU[i].head; res; res = res->_lruNext) {
+			debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
+			mem += res->size;
+			++entries;
+		}
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
-		removeFromLRU(goner);
-		goner->unalloc();
+	// The main thread may still be using the data of unlocked resources, so
+	// they are only freed when it calls into the resource manager
+	if (_prefetching)
+		return;
+
+	for (int i = 0; i < kResCacheCount; i++) {
+		ResourceCache &cache = _LRU[i];
+		while (cache.budget < cache.memory) {
+			assert(cache.tail);
+			Resource *goner = cache.tail;
+			removeFromLRU(goner);
+			goner->unalloc();
+			cache.evictions++;
 #ifdef SCI_VERBOSE_RESMAN
-		debug("resMan-debug: LRU: Freeing %s.%03d (%d bytes)", getResourceTypeName(goner->type), goner->number, goner->size);
+			debug("resMan-debug: LRU: Freeing %s.%03d (%d bytes)", getResourceTypeName(goner->type), goner->number, goner->size);
 #endif
+		}
 	}
 }
 
@@ -1055,15 +1319,22 @@ Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int m
 }
 
 Resource *ResourceManager::findResource(ResourceId id, bool lock) {
+	Common::StackLock stackLock(_mutex);
+
 	Resource *retval = testResource(id);
 
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	ResourceCache &cache = _LRU[getResourceCacheClass(retval->getType())];
+	if (retval->_status == kResStatusNoMalloc) {
+		cache.misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
-		removeFromLRU(retval);
+	} else {
+		cache.hits++;
+		if (retval->_status == kResStatusEnqueued)
+			removeFromLRU(retval);
+	}
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
 
@@ -1092,6 +1363,8 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 void ResourceManager::unlockResource(Resource *res) {
 	assert(res);
 
+	Common::StackLock lock(_mutex);
+
 	if (res->_status != kResStatusLocked) {
 		debugC(kDebugLevelResMan, 2, "[resMan] Attempt to unlock unlocked resource %s", res->_id.toString().c_str());
 		return;
@@ -1855,6 +2128,12 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 		_resMap.setVal(resId, res);
 	}
 
+	// The resource will be reloaded from its new source
+	if (res->_status == kResStatusEnqueued) {
+		removeFromLRU(res);
+		res->unalloc();
+	}
+
 	res->_status = kResStatusNoMalloc;
 	res->_source = src;
 	res->_headerSize = 0;
@@ -26,6 +26,7 @@
 #include "common/str.h"
 #include "common/list.h"
 #include "common/hashmap.h"
+#include "common/mutex.h"
 
 #include "sci/graphics/helpers.h"		// for ViewType
 #include "sci/decompressor.h"
@@ -37,6 +38,7 @@ class FSList;
 class FSNode;
 class WriteStream;
 class SeekableReadStream;
+class WorkerPool;
 }
 
 namespace Sci {
@@ -54,6 +56,19 @@ enum ResourceStatus {
 	kResStatusLocked /**< Allocated and in use */
 };
 
+/**
+ * Resource cache classes. Unlocked resources of each class are kept in a
+ * separate LRU list with its own memory budget.
+ */
+enum ResourceCacheClass {
+	kResCacheViews = 0,
+	kResCachePics,
+	kResCacheAudio,
+	kResCacheScripts,
+	kResCacheOther,
+	kResCacheCount
+};
+
 /** Resource error codes. Should be in sync with s_errorDescriptions */
 enum ResourceErrorCodes {
 	SCI_ERROR_NONE = 0,
@@ -240,6 +255,8 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	Resource *_lruPrev; /**< Previous (more recently used) resource in the LRU list */
+	Resource *_lruNext; /**< Next (less recently used) resource in the LRU list */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -254,7 +271,11 @@ protected:
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
+class ResourcePrefetchJob;
+
 class ResourceManager {
+	friend class ResourcePrefetchJob;
+
 	// FIXME: These 'friend' declarations are meant to be a temporary hack to
 	// ease transition to the ResourceSource class system.
 	friend class ResourceSource;
@@ -334,6 +355,41 @@ public:
 	const char *getVolVersionDesc() const { return versionDescription(_volVersion); }
 	ResVersion getVolVersion() const { return _volVersion; }
 
+	/** LRU list and statistics of one resource cache class */
+	struct ResourceCache {
+		Resource *head;     ///< Most recently used resource
+		Resource *tail;     ///< Least recently used resource
+		uint entries;       ///< Number of resources in the list
+		int memory;         ///< Amount of resource bytes in the list
+		int budget;         ///< Maximum amount of bytes to keep in the list
+		uint32 hits;        ///< Lookups of resources which were in memory
+		uint32 misses;      ///< Lookups which had to load the resource
+		uint32 evictions;   ///< Resources freed to stay within the budget
+		uint32 prefetches;  ///< Resources loaded in the background by prefetchRoom()
+	};
+
+	const ResourceCache &getResourceCache(ResourceCacheClass cacheClass) const { return _LRU[cacheClass]; }
+	static const char *getResourceCacheName(ResourceCacheClass cacheClass);
+
+	/** Resets the hit, miss and eviction counters of all cache classes. */
+	void resetResourceCacheStats();
+
+	/**
+	 * Starts loading the resources of the given room in the background,
+	 * cancelling any prefetch which is still in progress. The resources are
+	 * put into the resource cache, up to the memory configured with the
+	 * rescache_prefetch key. Does nothing if prefetching is disabled, or if
+	 * the backend does not support threads.
+	 * @param roomNumber	The number of the room which is being entered
+	 */
+	void prefetchRoom(uint16 roomNumber);
+
+	/**
+	 * Stops a prefetch started by prefetchRoom() and waits until no resource
+	 * is being loaded in the background anymore.
+	 */
+	void cancelPrefetch();
+
 	/**
 	 * Adds the appropriate GM patch from the Sierra MIDI utility as 4.pat, without
 	 * requiring the user to rename the file to 4.pat. Thus, the original Sierra
@@ -379,21 +435,41 @@ public:
 	ResourceType convertResType(byte type);
 
 protected:
-	// Maximum number of bytes to allow being allocated for resources
-	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
-	// for resources which are not explicitly locked. However, a warning will be
-	// issued whenever this limit is exceeded.
-	enum {
-		MAX_MEMORY = 256 * 1024	// 256KB
-	};
-
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	// Note: the budgets are not hard limits, only restrictions for resources
+	// which are not explicitly locked.
+	ResourceCache _LRU[kResCacheCount]; ///< Last Resource Used lists
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
+
+	/**
+	 * Protects the resource state and the LRU lists while resources are
+	 * prefetched in the background.
+	 */
+	Common::Mutex _mutex;
+	Common::WorkerPool *_prefetchPool;
+	ResourcePrefetchJob *_prefetchJob;
+
+	/** A resource to load in the background, and the file to read it from */
+	struct PrefetchEntry {
+		Resource *res;
+		Common::File *file;
+	};
+	Common::Array<PrefetchEntry> _prefetchList;
+	/**
+	 * Volume files which only the prefetch job reads from. They are opened
+	 * on the main thread, so that the job never uses _volumeFiles or
+	 * SearchMan, which the main thread accesses without locking _mutex.
+	 * These are exactly the files referenced by _prefetchList, so there are
+	 * at most as many as there are prefetched resource types.
+	 */
+	Common::List<Common::File *> _prefetchFiles;
+	int _prefetchMemory; ///< Amount of bytes the prefetch job may still load
+	volatile bool _prefetchCancelled;
+	bool _prefetching; ///< Set while the prefetch job loads a resource
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
 	ResVersion _volVersion; ///< resource.0xx version
 	ResVersion _mapVersion; ///< resource.map version
@@ -446,6 +522,8 @@ protected:
 	Common::SeekableReadStream *getVolumeFile(ResourceSource *source);
 	void loadResource(Resource *res);
 	void freeOldResources();
+	Common::File *getPrefetchFile(ResourceSource *source, Common::List<Common::File *> &oldFiles);
+	void runPrefetch();
 	void addResource(ResourceId resId, ResourceSource *src, uint32 offset, uint32 size = 0);
 	Resource *updateResource(ResourceId resId, ResourceSource *src, uint32 size);
 	void removeAudioResource(ResourceId resId);
@@ -508,6 +586,7 @@ protected:
 	 */
 	bool hasOldScriptHeader();
 
+	void initResourceCaches();
 	void printLRU();
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
@@ -208,6 +208,9 @@ void ResourceManager::readWaveAudioPatches() {
 }
 
 void ResourceManager::removeAudioResource(ResourceId resId) {
+	// The prefetch job may be loading the resource
+	cancelPrefetch();
+
 	// Remove resource, unless it was loaded from a patch
 	if (_resMap.contains(resId)) {
 		Resource *res = _resMap.getVal(resId);
@@ -472,6 +475,8 @@ int ResourceManager::readAudioMapSCI1(ResourceSource *map, bool unload) {
 }
 
 void ResourceManager::setAudioLanguage(int language) {
+	cancelPrefetch();
+
 	if (_audioMapSCI1) {
 		if (_audioMapSCI1->_volumeNumber == language) {
 			// This language is already loaded
@@ -914,6 +919,8 @@ bool ResourceManager::addAudioSources() {
 }
 
 void ResourceManager::changeAudioDirectory(Common::String path) {
+	cancelPrefetch();
+
 	// Remove all of the audio map resource sources, as well as the audio resource sources
 	for (Common::List<ResourceSource *>::iterator it = _sources.begin(); it != _sources.end();) {
 		ResourceSource *source = *it;
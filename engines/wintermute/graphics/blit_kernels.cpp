@@ -0,0 +1,468 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/wintermute/graphics/blit_kernels.h"
+#include "engines/wintermute/graphics/transparent_surface.h"
+
+#include "common/cpudetect.h"
+#include "common/util.h"
+
+#if defined(SCUMMVM_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace Wintermute {
+
+enum {
+	kAShift = TransparentSurface::kAShift,
+	kAMask = 0xFF << TransparentSurface::kAShift
+};
+
+/** The color channels, in pixel and in color modulation values */
+static const int s_colorShifts[3] = {
+	TransparentSurface::kBShift, TransparentSurface::kGShift, TransparentSurface::kRShift
+};
+static const int s_colorModShifts[3] = {
+	TransparentSurface::kBModShift, TransparentSurface::kGModShift, TransparentSurface::kRModShift
+};
+
+static inline uint32 channel(uint32 pixel, int shift) {
+	return (pixel >> shift) & 0xFF;
+}
+
+/**
+ * Turns a color modulation or alpha value into a factor to multiply with and
+ * shift right by 8 bits. 255 stands for no modulation, which makes it 256.
+ */
+static inline uint32 modFactor(uint32 value) {
+	return value == 255 ? 256 : value;
+}
+
+/** The color modulation factors for blue, green, red and alpha. */
+struct ColorMod {
+	uint32 c[3];
+	uint32 a;
+
+	explicit ColorMod(uint32 color) {
+		for (int i = 0; i < 3; ++i)
+			c[i] = modFactor(channel(color, s_colorModShifts[i]));
+		a = modFactor(channel(color, TransparentSurface::kAModShift));
+	}
+};
+
+#pragma mark -
+#pragma mark --- Generic kernels ---
+#pragma mark -
+
+static void copyOpaqueScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	for (uint i = 0; i < count; ++i, src += srcStep)
+		dst[i] = *src | kAMask;
+}
+
+static void copyBinaryScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	for (uint i = 0; i < count; ++i, src += srcStep) {
+		if (*src & kAMask)
+			dst[i] = *src | kAMask;
+	}
+}
+
+static void blendNormalScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	for (uint i = 0; i < count; ++i, src += srcStep) {
+		const uint32 in = *src;
+		const uint32 a = channel(in, kAShift);
+		if (a == 0)
+			continue;
+		if (a == 255) {
+			dst[i] = in;
+			continue;
+		}
+
+		const uint32 out = dst[i];
+		uint32 result = kAMask;
+		for (int c = 0; c < 3; ++c) {
+			const int shift = s_colorShifts[c];
+			result |= ((channel(in, shift) * a + channel(out, shift) * (255 - a)) >> 8) << shift;
+		}
+		dst[i] = result;
+	}
+}
+
+static void blendNormalModScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const ColorMod mod(color);
+	for (uint i = 0; i < count; ++i, src += srcStep) {
+		const uint32 in = *src;
+		const uint32 a = (channel(in, kAShift) * mod.a) >> 8;
+		if (a == 0)
+			continue;
+
+		const uint32 out = dst[i];
+		uint32 result = kAMask;
+		for (int c = 0; c < 3; ++c) {
+			const int shift = s_colorShifts[c];
+			if (a == 255)
+				result |= ((channel(in, shift) * mod.c[c]) >> 8) << shift;
+			else
+				result |= (((channel(out, shift) * (255 - a)) >> 8) + ((channel(in, shift) * a * mod.c[c]) >> 16)) << shift;
+		}
+		dst[i] = result;
+	}
+}
+
+static void blendAdditiveScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	for (uint i = 0; i < count; ++i, src += srcStep) {
+		const uint32 in = *src;
+		const uint32 a = modFactor(channel(in, kAShift));
+		if (a == 0)
+			continue;
+
+		const uint32 out = dst[i];
+		uint32 result = out & kAMask;
+		for (int c = 0; c < 3; ++c) {
+			const int shift = s_colorShifts[c];
+			result |= MIN<uint32>(channel(out, shift) + ((channel(in, shift) * a) >> 8), 255) << shift;
+		}
+		dst[i] = result;
+	}
+}
+
+static void blendAdditiveModScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const ColorMod mod(color);
+	for (uint i = 0; i < count; ++i, src += srcStep) {
+		const uint32 in = *src;
+		const uint32 a = (channel(in, kAShift) * mod.a) >> 8;
+		if (a == 0)
+			continue;
+
+		const uint32 out = dst[i];
+		uint32 result = out & kAMask;
+		for (int c = 0; c < 3; ++c) {
+			const int shift = s_colorShifts[c];
+			result |= MIN<uint32>(channel(out, shift) + ((channel(in, shift) * a * mod.c[c]) >> 16), 255) << shift;
+		}
+		dst[i] = result;
+	}
+}
+
+static void blendSubtractiveScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	for (uint i = 0; i < count; ++i, src += srcStep) {
+		const uint32 in = *src;
+		const uint32 a = modFactor(channel(in, kAShift));
+		if (a == 0)
+			continue;
+
+		const uint32 out = dst[i];
+		uint32 result = out & kAMask;
+		for (int c = 0; c < 3; ++c) {
+			const int shift = s_colorShifts[c];
+			const uint32 o = channel(out, shift);
+			result |= (o - ((channel(in, shift) * o * a) >> 16)) << shift;
+		}
+		dst[i] = result;
+	}
+}
+
+// As weird as it is, evidence suggests that the alpha modulation is ignored
+// when doing subtractive blending.
+static void blendSubtractiveModScalar(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const ColorMod mod(color);
+	for (uint i = 0; i < count; ++i, src += srcStep) {
+		const uint32 in = *src;
+		const uint32 a = channel(in, kAShift);
+		if (a == 0)
+			continue;
+
+		const uint32 out = dst[i];
+		uint32 result = out & kAMask;
+		for (int c = 0; c < 3; ++c) {
+			const int shift = s_colorShifts[c];
+			const uint32 o = channel(out, shift);
+			result |= (o - ((channel(in, shift) * o * mod.c[c] * a) >> 24)) << shift;
+		}
+		dst[i] = result;
+	}
+}
+
+static const BlitKernels s_scalarKernels = {
+	copyOpaqueScalar,
+	copyBinaryScalar,
+	blendNormalScalar,
+	blendNormalModScalar,
+	blendAdditiveScalar,
+	blendAdditiveModScalar,
+	blendSubtractiveScalar,
+	blendSubtractiveModScalar
+};
+
+#if defined(SCUMMVM_SIMD_X86)
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+// Four pixels are processed at a time. For the arithmetic they are unpacked
+// to two vectors of 16 bit lanes, where the lanes of each pixel are alpha,
+// blue, green and red, since alpha is the lowest byte (kAShift == 0).
+
+/** Loads four source pixels, in reverse order for flipped blits. */
+SCUMMVM_TARGET_SSE2 static inline __m128i loadPixelsSSE2(const uint32 *src, int srcStep) {
+	if (srcStep > 0)
+		return _mm_loadu_si128((const __m128i *)src);
+	return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(src - 3)), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+/** Copies the alpha lane of each pixel to its color lanes. */
+SCUMMVM_TARGET_SSE2 static inline __m128i broadcastAlphaSSE2(__m128i v) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+/** Returns the pixels of a where mask is set, those of b elsewhere. */
+SCUMMVM_TARGET_SSE2 static inline __m128i selectSSE2(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/** Turns alpha values of 255 into 256, see modFactor(). */
+SCUMMVM_TARGET_SSE2 static inline __m128i modFactorSSE2(__m128i v, __m128i c255) {
+	return _mm_sub_epi16(v, _mm_cmpeq_epi16(v, c255));
+}
+
+/** The color modulation factors, for the 16 bit lanes of two pixels. */
+SCUMMVM_TARGET_SSE2 static inline __m128i colorModSSE2(const ColorMod &mod, uint16 alphaLane) {
+	return _mm_set_epi16(mod.c[2], mod.c[1], mod.c[0], alphaLane, mod.c[2], mod.c[1], mod.c[0], alphaLane);
+}
+
+SCUMMVM_TARGET_SSE2 static void copyOpaqueSSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const __m128i alpha = _mm_set1_epi32(kAMask);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep)
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(loadPixelsSSE2(src, srcStep), alpha));
+	copyOpaqueScalar(dst + i, src, srcStep, count - i, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void copyBinarySSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const __m128i alpha = _mm_set1_epi32(kAMask);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep) {
+		const __m128i in = loadPixelsSSE2(src, srcStep);
+		const __m128i out = _mm_loadu_si128((const __m128i *)(dst + i));
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(in, alpha), zero);
+		_mm_storeu_si128((__m128i *)(dst + i), selectSSE2(transparent, out, _mm_or_si128(in, alpha)));
+	}
+	copyBinaryScalar(dst + i, src, srcStep, count - i, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void blendNormalSSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const __m128i alpha = _mm_set1_epi32(kAMask);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c255 = _mm_set1_epi16(255);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep) {
+		const __m128i in = loadPixelsSSE2(src, srcStep);
+		const __m128i out = _mm_loadu_si128((const __m128i *)(dst + i));
+		const __m128i a = _mm_and_si128(in, alpha);
+
+		const __m128i inLo = _mm_unpacklo_epi8(in, zero), inHi = _mm_unpackhi_epi8(in, zero);
+		const __m128i outLo = _mm_unpacklo_epi8(out, zero), outHi = _mm_unpackhi_epi8(out, zero);
+		const __m128i aLo = broadcastAlphaSSE2(inLo), aHi = broadcastAlphaSSE2(inHi);
+
+		const __m128i blendLo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(inLo, aLo), _mm_mullo_epi16(outLo, _mm_sub_epi16(c255, aLo))), 8);
+		const __m128i blendHi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(inHi, aHi), _mm_mullo_epi16(outHi, _mm_sub_epi16(c255, aHi))), 8);
+		const __m128i blend = _mm_or_si128(_mm_packus_epi16(blendLo, blendHi), alpha);
+
+		const __m128i result = selectSSE2(_mm_cmpeq_epi32(a, alpha), in, blend);
+		_mm_storeu_si128((__m128i *)(dst + i), selectSSE2(_mm_cmpeq_epi32(a, zero), out, result));
+	}
+	blendNormalScalar(dst + i, src, srcStep, count - i, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void blendNormalModSSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const ColorMod colorMod(color);
+	const __m128i mod = colorModSSE2(colorMod, colorMod.a);
+	const __m128i modA = _mm_set1_epi16(colorMod.a);
+	const __m128i alpha = _mm_set1_epi32(kAMask);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c255 = _mm_set1_epi16(255);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep) {
+		const __m128i in = loadPixelsSSE2(src, srcStep);
+		const __m128i out = _mm_loadu_si128((const __m128i *)(dst + i));
+
+		const __m128i inLo = _mm_unpacklo_epi8(in, zero), inHi = _mm_unpackhi_epi8(in, zero);
+		const __m128i outLo = _mm_unpacklo_epi8(out, zero), outHi = _mm_unpackhi_epi8(out, zero);
+		const __m128i aLo = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlphaSSE2(inLo), modA), 8);
+		const __m128i aHi = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlphaSSE2(inHi), modA), 8);
+
+		// The modulated alpha decides per pixel between keeping the
+		// destination, the modulated source and blending both
+		const __m128i transparent = _mm_packs_epi16(_mm_cmpeq_epi16(aLo, zero), _mm_cmpeq_epi16(aHi, zero));
+		const __m128i opaque = _mm_packs_epi16(_mm_cmpeq_epi16(aLo, c255), _mm_cmpeq_epi16(aHi, c255));
+
+		const __m128i fullLo = _mm_srli_epi16(_mm_mullo_epi16(inLo, mod), 8);
+		const __m128i fullHi = _mm_srli_epi16(_mm_mullo_epi16(inHi, mod), 8);
+		const __m128i full = _mm_packus_epi16(fullLo, fullHi);
+
+		const __m128i blendLo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(outLo, _mm_sub_epi16(c255, aLo)), 8),
+			_mm_mulhi_epu16(_mm_mullo_epi16(inLo, aLo), mod));
+		const __m128i blendHi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(outHi, _mm_sub_epi16(c255, aHi)), 8),
+			_mm_mulhi_epu16(_mm_mullo_epi16(inHi, aHi), mod));
+		const __m128i blend = _mm_packus_epi16(blendLo, blendHi);
+
+		const __m128i result = _mm_or_si128(selectSSE2(opaque, full, blend), alpha);
+		_mm_storeu_si128((__m128i *)(dst + i), selectSSE2(transparent, out, result));
+	}
+	blendNormalModScalar(dst + i, src, srcStep, count - i, color);
+}
+
+// The additive and subtractive kernels leave the destination alone for a
+// zero alpha without special casing it, since everything they add or
+// subtract is scaled by alpha. The alpha lane of the factors is zero, which
+// keeps the destination alpha.
+
+SCUMMVM_TARGET_SSE2 static void blendAdditiveSSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const __m128i colorLanes = _mm_set_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c255 = _mm_set1_epi16(255);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep) {
+		const __m128i in = loadPixelsSSE2(src, srcStep);
+		const __m128i out = _mm_loadu_si128((const __m128i *)(dst + i));
+
+		const __m128i inLo = _mm_unpacklo_epi8(in, zero), inHi = _mm_unpackhi_epi8(in, zero);
+		const __m128i aLo = _mm_and_si128(modFactorSSE2(broadcastAlphaSSE2(inLo), c255), colorLanes);
+		const __m128i aHi = _mm_and_si128(modFactorSSE2(broadcastAlphaSSE2(inHi), c255), colorLanes);
+
+		const __m128i resultLo = _mm_add_epi16(_mm_unpacklo_epi8(out, zero), _mm_srli_epi16(_mm_mullo_epi16(inLo, aLo), 8));
+		const __m128i resultHi = _mm_add_epi16(_mm_unpackhi_epi8(out, zero), _mm_srli_epi16(_mm_mullo_epi16(inHi, aHi), 8));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(resultLo, resultHi));
+	}
+	blendAdditiveScalar(dst + i, src, srcStep, count - i, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void blendAdditiveModSSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const ColorMod colorMod(color);
+	const __m128i mod = colorModSSE2(colorMod, 0);
+	const __m128i modA = _mm_set1_epi16(colorMod.a);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep) {
+		const __m128i in = loadPixelsSSE2(src, srcStep);
+		const __m128i out = _mm_loadu_si128((const __m128i *)(dst + i));
+
+		const __m128i inLo = _mm_unpacklo_epi8(in, zero), inHi = _mm_unpackhi_epi8(in, zero);
+		const __m128i aLo = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlphaSSE2(inLo), modA), 8);
+		const __m128i aHi = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlphaSSE2(inHi), modA), 8);
+
+		const __m128i resultLo = _mm_add_epi16(_mm_unpacklo_epi8(out, zero), _mm_mulhi_epu16(_mm_mullo_epi16(inLo, aLo), mod));
+		const __m128i resultHi = _mm_add_epi16(_mm_unpackhi_epi8(out, zero), _mm_mulhi_epu16(_mm_mullo_epi16(inHi, aHi), mod));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(resultLo, resultHi));
+	}
+	blendAdditiveModScalar(dst + i, src, srcStep, count - i, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void blendSubtractiveSSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const __m128i colorLanes = _mm_set_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c255 = _mm_set1_epi16(255);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep) {
+		const __m128i in = loadPixelsSSE2(src, srcStep);
+		const __m128i out = _mm_loadu_si128((const __m128i *)(dst + i));
+
+		const __m128i inLo = _mm_unpacklo_epi8(in, zero), inHi = _mm_unpackhi_epi8(in, zero);
+		const __m128i outLo = _mm_unpacklo_epi8(out, zero), outHi = _mm_unpackhi_epi8(out, zero);
+		const __m128i aLo = _mm_and_si128(modFactorSSE2(broadcastAlphaSSE2(inLo), c255), colorLanes);
+		const __m128i aHi = _mm_and_si128(modFactorSSE2(broadcastAlphaSSE2(inHi), c255), colorLanes);
+
+		const __m128i resultLo = _mm_sub_epi16(outLo, _mm_mulhi_epu16(_mm_mullo_epi16(inLo, outLo), aLo));
+		const __m128i resultHi = _mm_sub_epi16(outHi, _mm_mulhi_epu16(_mm_mullo_epi16(inHi, outHi), aHi));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(resultLo, resultHi));
+	}
+	blendSubtractiveScalar(dst + i, src, srcStep, count - i, color);
+}
+
+SCUMMVM_TARGET_SSE2 static void blendSubtractiveModSSE2(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color) {
+	const __m128i mod = colorModSSE2(ColorMod(color), 0);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4, src += 4 * srcStep) {
+		const __m128i in = loadPixelsSSE2(src, srcStep);
+		const __m128i out = _mm_loadu_si128((const __m128i *)(dst + i));
+
+		const __m128i inLo = _mm_unpacklo_epi8(in, zero), inHi = _mm_unpackhi_epi8(in, zero);
+		const __m128i outLo = _mm_unpacklo_epi8(out, zero), outHi = _mm_unpackhi_epi8(out, zero);
+		const __m128i factorLo = _mm_mullo_epi16(broadcastAlphaSSE2(inLo), mod);
+		const __m128i factorHi = _mm_mullo_epi16(broadcastAlphaSSE2(inHi), mod);
+
+		const __m128i resultLo = _mm_sub_epi16(outLo, _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(inLo, outLo), factorLo), 8));
+		const __m128i resultHi = _mm_sub_epi16(outHi, _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(inHi, outHi), factorHi), 8));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(resultLo, resultHi));
+	}
+	blendSubtractiveModScalar(dst + i, src, srcStep, count - i, color);
+}
+
+static const BlitKernels s_sse2Kernels = {
+	copyOpaqueSSE2,
+	copyBinarySSE2,
+	blendNormalSSE2,
+	blendNormalModSSE2,
+	blendAdditiveSSE2,
+	blendAdditiveModSSE2,
+	blendSubtractiveSSE2,
+	blendSubtractiveModSSE2
+};
+
+#endif // SCUMMVM_SIMD_X86
+
+#pragma mark -
+
+const BlitKernels *getBlitKernels(BlitKernelType type) {
+	switch (type) {
+	case kBlitKernelsScalar:
+		return &s_scalarKernels;
+#if defined(SCUMMVM_SIMD_X86)
+	case kBlitKernelsSSE2:
+		return Common::hasCPUFeature(Common::kCPUFeatureSSE2) ? &s_sse2Kernels : 0;
+#endif
+	default:
+		return 0;
+	}
+}
+
+const BlitKernels &getBestBlitKernels() {
+	for (int type = kBlitKernelsCount - 1; type > kBlitKernelsScalar; --type) {
+		const BlitKernels *kernels = getBlitKernels((BlitKernelType)type);
+		if (kernels)
+			return *kernels;
+	}
+
+	return s_scalarKernels;
+}
+
+} // End of namespace Wintermute
@@ -0,0 +1,77 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef WINTERMUTE_BLIT_KERNELS_H
+#define WINTERMUTE_BLIT_KERNELS_H
+
+#include "common/scummsys.h"
+
+namespace Wintermute {
+
+/**
+ * The inner loops of TransparentSurface::blit, one row at a time, in a
+ * plain C++ version and, where available, SIMD versions. All versions
+ * produce the same results.
+ *
+ * Pixels are in the TransparentSurface layout, see kAShift and friends.
+ * The source is read from src on, advancing srcStep pixels per
+ * destination pixel, which is -1 for horizontally flipped blits. color is
+ * the color modulation in 0xAARRGGBB format; the functions without
+ * modulation ignore it.
+ */
+struct BlitKernels {
+	typedef void (*RowFunc)(uint32 *dst, const uint32 *src, int srcStep, uint count, uint32 color);
+
+	/** Copies the pixels and makes them opaque, for ALPHA_OPAQUE surfaces. */
+	RowFunc copyOpaque;
+	/** Copies the pixels with a non-zero alpha and makes them opaque, for ALPHA_BINARY surfaces. */
+	RowFunc copyBinary;
+
+	RowFunc blendNormal;
+	RowFunc blendNormalMod;
+	RowFunc blendAdditive;
+	RowFunc blendAdditiveMod;
+	RowFunc blendSubtractive;
+	RowFunc blendSubtractiveMod;
+};
+
+enum BlitKernelType {
+	kBlitKernelsScalar,
+	kBlitKernelsSSE2,
+
+	kBlitKernelsCount
+};
+
+/**
+ * Returns the given kernel implementation, or 0 if it is not supported by
+ * the CPU or was not compiled in.
+ */
+const BlitKernels *getBlitKernels(BlitKernelType type);
+
+/**
+ * Returns the fastest kernel implementation supported by the CPU.
+ */
+const BlitKernels &getBestBlitKernels();
+
+} // End of namespace Wintermute
+
+#endif
@@ -27,248 +27,11 @@
 #include "common/textconsole.h"
 #include "graphics/primitives.h"
 #include "engines/wintermute/graphics/transparent_surface.h"
+#include "engines/wintermute/graphics/blit_kernels.h"
 #include "engines/wintermute/graphics/transform_tools.h"
 
 namespace Wintermute {
 
-void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
-void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
-
-// These gather together various blendPixel functions for use with templates.
-
-class BlenderAdditive {
-public:
-	static void blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb);
-	static void blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb, byte *ca, byte *cr, byte *cg, byte *cb);
-	static void blendPixel(byte *in, byte *out);
-	static void blendPixel(byte *in, byte *out, int colorMod);
-};
-
-class BlenderSubtractive {
-public:
-	static void blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb);
-	static void blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb, byte *ca, byte *cr, byte *cg, byte *cb);
-	static void blendPixel(byte *in, byte *out);
-	static void blendPixel(byte *in, byte *out, int colorMod);
-};
-
-class BlenderNormal {
-public:
-	static void blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb);
-	static void blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb, byte *ca, byte *cr, byte *cg, byte *cb);
-	static void blendPixel(byte *in, byte *out);
-	static void blendPixel(byte *in, byte *out, int colorMod);
-};
-
-/**
- * Perform additive blending of a pixel, applying beforehand a given colormod.
- * @param ina, inr, ing, inb: the input pixel, split into its components.
- * @param *outa, *outr, *outg, *outb pointer to the output pixel.
- * @param *outa, *outr, *outg, *outb pointer to the colormod components.
- */
-
-void BlenderAdditive::blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb, byte *ca, byte *cr, byte *cg, byte *cb) {
-	if (*ca != 255) {
-		ina = (ina) * (*ca) >> 8;
-	}
-
-	if (ina == 0) {
-		return;
-	} else {
-		if (*cb != 255)
-			*outb = MIN(*outb + ((inb * (*cb) * ina) >> 16), 255);
-		else
-			*outb = MIN(*outb + (inb * ina >> 8), 255);
-
-		if (*cg != 255)
-			*outg = MIN(*outg + ((ing * (*cg) * ina) >> 16), 255);
-		else
-			*outg = MIN(*outg + (ing * ina >> 8), 255);
-
-		if (*cr != 255)
-			*outr = MIN(*outr + ((inr * (*cr) * ina) >> 16), 255);
-		else
-			*outr = MIN(*outr + (inr * ina >> 8), 255);
-	}
-}
-
-/**
- * Perform subtractive blending of a pixel, applying beforehand a given colormod.
- * @param ina, inr, ing, inb: the input pixel, split into its components.
- * @param *outa, *outr, *outg, *outb pointer to the output pixel.
- * @param *outa, *outr, *outg, *outb pointer to the colormod components.
- */
-
-void BlenderSubtractive::blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb, byte *ca, byte *cr, byte *cg, byte *cb) {
-	//if (*ca != 255) {
-	//	ina = ina * (*ca) >> 8;
-	// }
-
-	// As weird as it is, evidence suggests that alphamod is ignored when doing
-	// subtractive...
-
-	// TODO if ina == 255 fast version
-
-	if (ina == 0) {
-		return;
-	} else {
-		if (*cb != 255)
-			*outb = MAX(*outb - ((inb * (*cb)  * (*outb) * ina) >> 24), 0);
-		else
-			*outb = MAX(*outb - (inb * (*outb) * ina >> 16), 0);
-
-		if (*cg != 255)
-			*outg = MAX(*outg - ((ing * (*cg)  * (*outg) * ina) >> 24), 0);
-		else
-			*outg = MAX(*outg - (ing * (*outg) * ina >> 16), 0);
-
-		if (*cr != 255)
-			*outr = MAX(*outr - ((inr * (*cr) *  (*outr) * ina) >> 24), 0);
-		else
-			*outr = MAX(*outr - (inr * (*outr) * ina >> 16), 0);
-	}
-}
-
-/**
- * Perform "regular" alphablending of a pixel, applying beforehand a given colormod.
- * @param ina, inr, ing, inb: the input pixel, split into its components.
- * @param *outa, *outr, *outg, *outb pointer to the output pixel.
- * @param *outa, *outr, *outg, *outb pointer to the colormod components.
- */
-
-void BlenderNormal::blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb, byte *ca, byte *cr, byte *cg, byte *cb) {
-	if (*ca != 255) {
-		ina = ina * (*ca) >> 8;
-	}
-
-	if (ina == 0) {
-		return;
-	} else if (ina == 255) {
-		if (*cb != 255)
-			*outb = (inb * (*cb)) >> 8;
-		else
-			*outb = inb;
-
-		if (*cr != 255)
-			*outr = (inr * (*cr)) >> 8;
-		else
-			*outr = inr;
-
-		if (*cg != 255)
-			*outg = (ing * (*cg)) >> 8;
-		else
-			*outg = ing;
-
-		*outa = ina;
-
-		return;
-
-	} else {
-
-		*outa = 255;
-		*outb = (*outb * (255 - ina) >> 8);
-		*outr = (*outr * (255 - ina) >> 8);
-		*outg = (*outg * (255 - ina) >> 8);
-
-		if (*cb == 0)
-			*outb = *outb;
-		else if (*cb != 255)
-			*outb = *outb + (inb * ina * (*cb) >> 16);
-		else
-			*outb = *outb + (inb * ina >> 8);
-
-		if (*cr == 0)
-			*outr = *outr;
-		else if (*cr != 255)
-			*outr = *outr + (inr * ina * (*cr) >> 16);
-		else
-			*outr = *outr + (inr * ina >> 8);
-
-		if (*cg == 0)
-			*outg = *outg;
-		else if (*cg != 255)
-			*outg = *outg + (ing * ina * (*cg) >> 16);
-		else
-			*outg = *outg + (ing * ina >> 8);
-
-		return;
-	}
-}
-
-/**
- * Perform "regular" alphablending of a pixel.
- * @param ina, inr, ing, inb: the input pixel, split into its components.
- * @param *outa, *outr, *outg, *outb pointer to the output pixel.
- */
-
-void BlenderNormal::blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb) {
-
-	if (ina == 0) {
-		return;
-	} else if (ina == 255) {
-		*outb = inb;
-		*outg = ing;
-		*outr = inr;
-		*outa = ina;
-		return;
-	} else {
-		*outa = 255;
-		*outb = ((inb * ina) + *outb * (255 - ina)) >> 8;
-		*outg = ((ing * ina) + *outg * (255 - ina)) >> 8;
-		*outr = ((inr * ina) + *outr * (255 - ina)) >> 8;
-	}
-}
-
-/**
- * Perform subtractive blending of a pixel.
- * @param ina, inr, ing, inb: the input pixel, split into its components.
- * @param *outa, *outr, *outg, *outb pointer to the output pixel.
- */
-
-void BlenderSubtractive::blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb) {
-
-	if (ina == 0) {
-		return;
-	} else if (ina == 255) {
-		*outa = *outa;
-		*outr = *outr - (inr * (*outr) >> 8);
-		*outg = *outg - (ing * (*outg) >> 8);
-		*outb = *outb - (inb * (*outb) >> 8);
-		return;
-	} else {
-		*outa = *outa;
-		*outb = MAX(*outb - ((inb * (*outb)) * ina >> 16), 0);
-		*outg = MAX(*outg - ((ing * (*outg)) * ina >> 16), 0);
-		*outr = MAX(*outr - ((inr * (*outr)) * ina >> 16), 0);
-		return;
-	}
-}
-
-/**
- * Perform additive blending of a pixel.
- * @param ina, inr, ing, inb: the input pixel, split into its components.
- * @param *outa, *outr, *outg, *outb pointer to the output pixel.
- */
-
-void BlenderAdditive::blendPixel(byte ina, byte inr, byte ing, byte inb, byte *outa, byte *outr, byte *outg, byte *outb) {
-
-	if (ina == 0) {
-		return;
-	} else if (ina == 255) {
-		*outa = *outa;
-		*outr = MIN(*outr + inr, 255);
-		*outg = MIN(*outg + ing, 255);
-		*outb = MIN(*outb + inb, 255);
-		return;
-	} else {
-		*outa = *outa;
-		*outb = MIN((inb * ina >> 8) + *outb, 255);
-		*outg = MIN((ing * ina >> 8) + *outg, 255);
-		*outr = MIN((inr * ina >> 8) + *outr, 255);
-		return;
-	}
-}
-
 #if ENABLE_BILINEAR
 void TransparentSurface::copyPixelBilinear(float projX, float projY, int dstX, int dstY, const Common::Rect &srcRect, const Common::Rect &dstRect, const TransparentSurface *src, TransparentSurface *dst) {
 
@@ -358,29 +121,6 @@ void TransparentSurface::copyPixelBilinear(float projX, float projY, int dstX, i
 	}
 	WRITE_UINT32((byte *)dst->getBasePtr(dstX + dstRect.left, dstY + dstRect.top), color);
 }
-#else
-void TransparentSurface::copyPixelNearestNeighbor(float projX, float projY, int dstX, int dstY, const Common::Rect &srcRect, const Common::Rect &dstRect, const TransparentSurface *src, TransparentSurface *dst) {
-
-	// TODO: Have the Rect arguments become completely useless at this point?
-
-	int srcW = srcRect.width();
-	int srcH = srcRect.height();
-	int dstW = dstRect.width();
-	int dstH = dstRect.height();
-
-	assert(dstX >= 0 && dstX < dstW);
-	assert(dstY >= 0 && dstY < dstH);
-
-	uint32 color;
-
-	if (projX >= srcW || projX < 0 || projY >= srcH || projY < 0) {
-		color = 0;
-	} else {
-		color = READ_UINT32((const byte *)src->getBasePtr((int)projX, (int)projY));
-	}
-
-	WRITE_UINT32((byte *)dst->getBasePtr(dstX, dstY), color);
-}
 #endif
 
 TransparentSurface::TransparentSurface() : Surface(), _alphaMode(ALPHA_FULL) {}
@@ -400,58 +140,8 @@ TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Sur
 	}
 }
 
-void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
-/**
- * Optimized version of doBlit to be used w/opaque blitting (no alpha).
- */
-	byte *in;
-	byte *out;
-
-	for (uint32 i = 0; i < height; i++) {
-		out = outo;
-		in = ino;
-		memcpy(out, in, width * 4);
-		for (uint32 j = 0; j < width; j++) {
-			out[TransparentSurface::kAIndex] = 0xFF;
-			out += 4;
-		}
-		outo += pitch;
-		ino += inoStep;
-	}
-}
-
 /**
- * Optimized version of doBlit to be used w/binary blitting (blit or no-blit, no blending).
- */
-
-void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
-
-	byte *in;
-	byte *out;
-
-	for (uint32 i = 0; i < height; i++) {
-		out = outo;
-		in = ino;
-		for (uint32 j = 0; j < width; j++) {
-			uint32 pix = *(uint32 *)in;
-			int a = (pix >> TransparentSurface::kAShift) & 0xff;
-
-			if (a == 0) { // Full transparency
-			} else { // Full opacity (Any value not exactly 0 is Opaque here)
-				*(uint32 *)out = pix;
-				out[TransparentSurface::kAIndex] = 0xFF;
-			}
-			out += 4;
-			in += inStep;
-		}
-		outo += pitch;
-		ino += inoStep;
-	}
-}
-
-/**
- * What we have here is a template method that calls blendPixel() from a different
- * class - the one we call it with - thus performing a different type of blending.
+ * Blits the rows of the input surface with the given row kernel.
  *
  * @param *ino a pointer to the input surface
  * @param *outo a pointer to the output surface
@@ -462,65 +152,13 @@ void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
  * @inoStep width in bytes of every row on the *input* surface / kind of like pitch
  * @color colormod in 0xAARRGGBB format - 0xFFFFFFFF for no colormod
  */
+static void doBlit(BlitKernels::RowFunc blitRow, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const int srcStep = inStep / 4;
 
-template<class Blender> 
-void doBlit(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
-
-	byte *in;
-	byte *out;
-
-	if (color == 0xffffffff) {
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				byte *outa = &out[TransparentSurface::kAIndex];
-				byte *outr = &out[TransparentSurface::kRIndex];
-				byte *outg = &out[TransparentSurface::kGIndex];
-				byte *outb = &out[TransparentSurface::kBIndex];
-
-				Blender::blendPixel(in[TransparentSurface::kAIndex],
-					in[TransparentSurface::kRIndex],
-					in[TransparentSurface::kGIndex],
-					in[TransparentSurface::kBIndex],
-					outa, outr, outg, outb);
-
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
-		}
-	} else {
-
-		byte ca = (color >> TransparentSurface::kAModShift) & 0xFF;
-		byte cr = (color >> TransparentSurface::kRModShift) & 0xFF;
-		byte cg = (color >> TransparentSurface::kGModShift) & 0xFF;
-		byte cb = (color >> TransparentSurface::kBModShift) & 0xFF;
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				byte *outa = &out[TransparentSurface::kAIndex];
-				byte *outr = &out[TransparentSurface::kRIndex];
-				byte *outg = &out[TransparentSurface::kGIndex];
-				byte *outb = &out[TransparentSurface::kBIndex];
-
-				Blender::blendPixel(in[TransparentSurface::kAIndex],
-					in[TransparentSurface::kRIndex],
-					in[TransparentSurface::kGIndex],
-					in[TransparentSurface::kBIndex],
-					outa, outr, outg, outb, &ca, &cr, &cg, &cb);
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
-		}
+	for (uint32 i = 0; i < height; i++) {
+		blitRow((uint32 *)outo, (const uint32 *)ino, srcStep, width, color);
+		outo += pitch;
+		ino += inoStep;
 	}
 }
 
@@ -626,21 +264,27 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 		byte *ino= (byte *)img->getBasePtr(xp, yp);
 		byte *outo = (byte *)target.getBasePtr(posX, posY);
 
-		if (color == 0xFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_OPAQUE) {
-			doBlitOpaqueFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else if (color == 0xFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
-			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
+		const BlitKernels &kernels = getBestBlitKernels();
+		const bool colorMod = (color != 0xFFFFFFFF);
+		BlitKernels::RowFunc blitRow;
+		if (blendMode == BLEND_ADDITIVE) {
+			blitRow = colorMod ? kernels.blendAdditiveMod : kernels.blendAdditive;
+		} else if (blendMode == BLEND_SUBTRACTIVE) {
+			blitRow = colorMod ? kernels.blendSubtractiveMod : kernels.blendSubtractive;
 		} else {
-			if (blendMode == BLEND_ADDITIVE) {
-				doBlit<BlenderAdditive>(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlit<BlenderSubtractive>(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else {
-				assert(blendMode == BLEND_NORMAL);
-				doBlit<BlenderNormal>(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			}
+			assert(blendMode == BLEND_NORMAL);
+			if (colorMod)
+				blitRow = kernels.blendNormalMod;
+			else if (_alphaMode == ALPHA_OPAQUE)
+				blitRow = kernels.copyOpaque;
+			else if (_alphaMode == ALPHA_BINARY)
+				blitRow = kernels.copyBinary;
+			else
+				blitRow = kernels.blendNormal;
 		}
 
+		doBlit(blitRow, ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+
 	}
 
 	retSize.setWidth(img->w);
@@ -678,6 +322,7 @@ TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transfo
 	float targX;
 	float targY;
 
+#if ENABLE_BILINEAR
 	for (int y = 0; y < dstH; y++) {
 		for (int x = 0; x < dstW; x++) {
 			int x1 = x - newHotspot.x;
@@ -689,13 +334,43 @@ TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transfo
 			targX += transform._hotspot.x;
 			targY += transform._hotspot.y;
 
-#if ENABLE_BILINEAR
 			copyPixelBilinear(targX, targY, x, y, srcRect, dstRect, this, target);
+		}
+	}
 #else
-			copyPixelNearestNeighbor(targX, targY, x, y, srcRect, dstRect, this, target);
-#endif
+	// The source position moves by a constant step along a row, so it is
+	// computed for the start of each row and then stepped in 16.16 fixed
+	// point.
+	const float scaleX = (float)kDefaultZoomX / transform._zoom.x;
+	const float scaleY = (float)kDefaultZoomY / transform._zoom.y;
+	const int32 stepX = (int32)(invCos * scaleX * 65536.0f);
+	const int32 stepY = (int32)(invSin * scaleY * 65536.0f);
+	const int32 srcW = srcRect.width();
+	const int32 srcH = srcRect.height();
+
+	for (int y = 0; y < dstH; y++) {
+		int x1 = -newHotspot.x;
+		int y1 = y - newHotspot.y;
+
+		targX = ((x1 * invCos - y1 * invSin)) * scaleX + srcRect.left + transform._hotspot.x;
+		targY = ((x1 * invSin + y1 * invCos)) * scaleY + srcRect.top + transform._hotspot.y;
+
+		int32 fixedX = (int32)(targX * 65536.0f);
+		int32 fixedY = (int32)(targY * 65536.0f);
+
+		uint32 *dst = (uint32 *)target->getBasePtr(0, y);
+		for (int x = 0; x < dstW; x++, fixedX += stepX, fixedY += stepY) {
+			// The shift rounds down for negative positions, which are
+			// all rejected
+			const int32 srcX = fixedX >> 16;
+			const int32 srcY = fixedY >> 16;
+			if (srcX < 0 || srcX >= srcW || srcY < 0 || srcY >= srcH)
+				dst[x] = 0;
+			else
+				dst[x] = *(const uint32 *)getBasePtr(srcX, srcY);
 		}
 	}
+#endif
 	return target;
 }
 
@@ -716,19 +391,32 @@ TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight)
 	target->create((uint16)dstW, (uint16)dstH, this->format);
 
 
+#if ENABLE_BILINEAR
 	float projX;
 	float projY;
 	for (int y = 0; y < dstH; y++) {
 		for (int x = 0; x < dstW; x++) {
 			projX = x / (float)dstW * srcW;
 			projY = y / (float)dstH * srcH;
-#if ENABLE_BILINEAR
 			copyPixelBilinear(projX, projY, x, y, srcRect, dstRect, this, target);
-#else
-			copyPixelNearestNeighbor(projX, projY, x, y, srcRect, dstRect, this, target);
-#endif
 		}
 	}
+#else
+	// Every destination row picks the same source columns, so they are
+	// looked up once
+	int *srcX = new int[dstW];
+	for (int x = 0; x < dstW; x++)
+		srcX[x] = x * srcW / dstW;
+
+	for (int y = 0; y < dstH; y++) {
+		const uint32 *src = (const uint32 *)getBasePtr(0, y * srcH / dstH);
+		uint32 *dst = (uint32 *)target->getBasePtr(0, y);
+		for (int x = 0; x < dstW; x++)
+			dst[x] = src[srcX[x]];
+	}
+
+	delete[] srcX;
+#endif
 	return target;
 
 }
@@ -65,18 +65,6 @@ struct TransparentSurface : public Graphics::Surface {
 	 * @param *src, *dst pointer to the source and dest surfaces
 	 */
 	static void copyPixelBilinear(float projX, float projY, int dstX, int dstY, const Common::Rect &srcRect, const Common::Rect &dstRect, const TransparentSurface *src, TransparentSurface *dst);
-#else
-	/*
-	 * Pick color from a point in source and copy it to a pixel in target.
-	 * The point in the source can be a float - we have subpixel accuracy in the arguments.
-	 * HOWEVER, this particular function just does nearest neighbor.
-	 * Use copyPixelBilinear if you interpolation.
-	 *
-	 * @param projX, projY, point in the source to pick color from.
-	 * @param dstX, dstY destionation pixel
-	 * @param *src, *dst pointer to the source and dest surfaces
-	 */
-	static void copyPixelNearestNeighbor(float projX, float projY, int dstX, int dstY, const Common::Rect &srcRect, const Common::Rect &dstRect, const TransparentSurface *src, TransparentSurface *dst);
 #endif
 	// Enums
 	/**
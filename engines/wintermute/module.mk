@@ -89,6 +89,7 @@ MODULE_OBJS := \
 	base/save_thumb_helper.o \
 	base/timer.o \
 	detection.o \
+	graphics/blit_kernels.o \
 	graphics/transform_struct.o \
 	graphics/transform_tools.o \
 	graphics/transparent_surface.o \
@@ -20,6 +20,7 @@
  */
 
 #include "graphics/conversion.h"
+#include "graphics/conversion_kernels.h"
 #include "graphics/pixelformat.h"
 
 #include "common/endian.h"
@@ -30,36 +31,6 @@ namespace Graphics {
 
 namespace {
 
-template<typename SrcColor, typename DstColor, bool backward>
-inline void crossBlitLogic(byte *dst, const byte *src, const uint w, const uint h,
-                           const PixelFormat &srcFmt, const PixelFormat &dstFmt,
-                           const uint srcDelta, const uint dstDelta) {
-	for (uint y = 0; y < h; ++y) {
-		for (uint x = 0; x < w; ++x) {
-			const uint32 color = *(const SrcColor *)src;
-			byte a, r, g, b;
-			srcFmt.colorToARGB(color, a, r, g, b);
-			*(DstColor *)dst = dstFmt.ARGBToColor(a, r, g, b);
-
-			if (backward) {
-				src -= sizeof(SrcColor);
-				dst -= sizeof(DstColor);
-			} else {
-				src += sizeof(SrcColor);
-				dst += sizeof(DstColor);
-			}
-		}
-
-		if (backward) {
-			src -= srcDelta;
-			dst -= dstDelta;
-		} else {
-			src += srcDelta;
-			dst += dstDelta;
-		}
-	}
-}
-
 template<typename DstColor, bool backward>
 inline void crossBlitLogic3BppSource(byte *dst, const byte *src, const uint w, const uint h,
                                      const PixelFormat &srcFmt, const PixelFormat &dstFmt,
@@ -95,6 +66,42 @@ inline void crossBlitLogic3BppSource(byte *dst, const byte *src, const uint w, c
 	}
 }
 
+/**
+ * Converts a rect between two formats with 2 or 4 bytes per pixel, using
+ * the fastest conversion kernels available.
+ */
+void crossBlitKernels(byte *dst, const byte *src,
+                      const uint dstPitch, const uint srcPitch,
+                      const uint w, const uint h,
+                      const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	ConversionProgram program;
+	program.init(dstFmt, srcFmt);
+	const ConversionKernels &kernels = getBestConversionKernels();
+
+	if (dstFmt.bytesPerPixel == 2) {
+		if (srcFmt.bytesPerPixel == 2) {
+			for (uint y = 0; y < h; ++y)
+				kernels.convert16To16((uint16 *)(dst + y * dstPitch), (const uint16 *)(src + y * srcPitch), w, program);
+		} else {
+			for (uint y = 0; y < h; ++y)
+				kernels.convert32To16((uint16 *)(dst + y * dstPitch), (const uint32 *)(src + y * srcPitch), w, program);
+		}
+	} else {
+		if (srcFmt.bytesPerPixel == 2) {
+			// Convert from the bottom to the top, so that the source is not
+			// overwritten when converting in place
+			for (uint y = h; y-- > 0; )
+				kernels.convert16To32((uint32 *)(dst + y * dstPitch), (const uint16 *)(src + y * srcPitch), w, program);
+		} else {
+			void (*convert)(uint32 *, const uint32 *, uint, const ConversionProgram &) = kernels.convert32To32;
+			if (program.isShuffle && kernels.shuffle32To32)
+				convert = kernels.shuffle32To32;
+			for (uint y = 0; y < h; ++y)
+				convert((uint32 *)(dst + y * dstPitch), (const uint32 *)(src + y * srcPitch), w, program);
+		}
+	}
+}
+
 } // End of anonymous namespace
 
 // Function to blit a rect from one color format to another
@@ -125,41 +132,28 @@ bool crossBlit(byte *dst, const byte *src,
 		return true;
 	}
 
-	// Faster, but larger, to provide optimized handling for each case.
+	if ((srcFmt.bytesPerPixel == 2 || srcFmt.bytesPerPixel == 4)
+			&& (dstFmt.bytesPerPixel == 2 || dstFmt.bytesPerPixel == 4)) {
+		crossBlitKernels(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt);
+		return true;
+	}
+
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
 
-	// TODO: optimized cases for dstDelta of 0
-	if (dstFmt.bytesPerPixel == 2) {
-		if (srcFmt.bytesPerPixel == 2) {
-			crossBlitLogic<uint16, uint16, false>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
-		} else if (srcFmt.bytesPerPixel == 3) {
-			crossBlitLogic3BppSource<uint16, false>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
-		} else {
-			crossBlitLogic<uint32, uint16, false>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
-		}
+	if (srcFmt.bytesPerPixel != 3) {
+		return false;
+	} else if (dstFmt.bytesPerPixel == 2) {
+		crossBlitLogic3BppSource<uint16, false>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
 	} else if (dstFmt.bytesPerPixel == 4) {
-		if (srcFmt.bytesPerPixel == 2) {
-			// We need to blit the surface from bottom right to top left here.
-			// This is neeeded, because when we convert to the same memory
-			// buffer copying the surface from top left to bottom right would
-			// overwrite the source, since we have more bits per destination
-			// color than per source color.
-			dst += h * dstPitch - dstDelta - dstFmt.bytesPerPixel;
-			src += h * srcPitch - srcDelta - srcFmt.bytesPerPixel;
-			crossBlitLogic<uint16, uint32, true>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
-		} else if (srcFmt.bytesPerPixel == 3) {
-			// We need to blit the surface from bottom right to top left here.
-			// This is neeeded, because when we convert to the same memory
-			// buffer copying the surface from top left to bottom right would
-			// overwrite the source, since we have more bits per destination
-			// color than per source color.
-			dst += h * dstPitch - dstDelta - dstFmt.bytesPerPixel;
-			src += h * srcPitch - srcDelta - srcFmt.bytesPerPixel;
-			crossBlitLogic3BppSource<uint32, true>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
-		} else {
-			crossBlitLogic<uint32, uint32, false>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
-		}
+		// We need to blit the surface from bottom right to top left here.
+		// This is neeeded, because when we convert to the same memory
+		// buffer copying the surface from top left to bottom right would
+		// overwrite the source, since we have more bits per destination
+		// color than per source color.
+		dst += h * dstPitch - dstDelta - dstFmt.bytesPerPixel;
+		src += h * srcPitch - srcDelta - srcFmt.bytesPerPixel;
+		crossBlitLogic3BppSource<uint32, true>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
 	} else {
 		return false;
 	}
@@ -0,0 +1,577 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/conversion_kernels.h"
+#include "graphics/pixelformat.h"
+
+#include "common/cpudetect.h"
+
+#if defined(SCUMMVM_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(SCUMMVM_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Graphics {
+
+void ConversionProgram::init(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const byte srcLoss[4] = { srcFmt.aLoss, srcFmt.rLoss, srcFmt.gLoss, srcFmt.bLoss };
+	const byte srcShift[4] = { srcFmt.aShift, srcFmt.rShift, srcFmt.gShift, srcFmt.bShift };
+	const byte dstLoss[4] = { dstFmt.aLoss, dstFmt.rLoss, dstFmt.gLoss, dstFmt.bLoss };
+	const byte dstShift[4] = { dstFmt.aShift, dstFmt.rShift, dstFmt.gShift, dstFmt.bShift };
+	const uint32 srcBits = (srcFmt.bytesPerPixel == 2) ? 0xFFFF : 0xFFFFFFFF;
+	const uint32 dstBits = (dstFmt.bytesPerPixel == 2) ? 0xFFFF : 0xFFFFFFFF;
+
+	numTerms = 0;
+	fill = 0;
+
+	for (uint c = 0; c < 4; ++c) {
+		if (dstLoss[c] >= 8)
+			continue;
+
+		// colorToARGB returns an opaque alpha for formats without alpha
+		if (c == 0 && srcLoss[c] >= 8) {
+			fill |= ((0xFF >> dstLoss[c]) << dstShift[c]) & dstBits;
+			continue;
+		}
+
+		if (srcLoss[c] >= 8)
+			continue;
+
+		// Keep the bits surviving in the destination and move them there
+		uint32 mask;
+		int shift;
+		if (srcLoss[c] >= dstLoss[c]) {
+			mask = ((1 << (8 - srcLoss[c])) - 1) << srcShift[c];
+			shift = dstShift[c] + srcLoss[c] - dstLoss[c] - srcShift[c];
+		} else {
+			mask = ((1 << (8 - dstLoss[c])) - 1) << (srcShift[c] + dstLoss[c] - srcLoss[c]);
+			shift = dstShift[c] - (srcShift[c] + dstLoss[c] - srcLoss[c]);
+		}
+
+		const uint32 rightShift = (shift < 0) ? -shift : 0;
+		const uint32 leftShift = (shift > 0) ? shift : 0;
+		mask &= srcBits & ((dstBits >> leftShift) << rightShift);
+
+		uint i = 0;
+		while (i < numTerms && (terms[i].rightShift != rightShift || terms[i].leftShift != leftShift))
+			++i;
+		if (i == numTerms) {
+			terms[i].mask = 0;
+			terms[i].rightShift = rightShift;
+			terms[i].leftShift = leftShift;
+			++numTerms;
+		}
+		terms[i].mask |= mask;
+	}
+
+	// Check for a byte permutation. The bytes of the pixel values are
+	// numbered from the least significant one here.
+	isShuffle = (srcFmt.bytesPerPixel == 4 && dstFmt.bytesPerPixel == 4);
+	byte valueShuffle[4] = { 0x80, 0x80, 0x80, 0x80 };
+	for (uint i = 0; i < numTerms && isShuffle; ++i) {
+		const Term &term = terms[i];
+		if ((term.rightShift | term.leftShift) & 7) {
+			isShuffle = false;
+			break;
+		}
+
+		for (int j = 0; j < 4; ++j) {
+			const uint32 byteMask = (term.mask >> (j * 8)) & 0xFF;
+			if (!byteMask)
+				continue;
+
+			const int k = j + (int)(term.leftShift / 8) - (int)(term.rightShift / 8);
+			if (byteMask != 0xFF || k < 0 || k > 3 || valueShuffle[k] != 0x80) {
+				isShuffle = false;
+				break;
+			}
+			valueShuffle[k] = j;
+		}
+	}
+
+	if (isShuffle) {
+		for (int k = 0; k < 4; ++k) {
+#ifdef SCUMM_BIG_ENDIAN
+			shuffle[3 - k] = (valueShuffle[k] == 0x80) ? 0x80 : 3 - valueShuffle[k];
+#else
+			shuffle[k] = valueShuffle[k];
+#endif
+		}
+	}
+}
+
+#pragma mark -
+#pragma mark --- Generic kernels ---
+#pragma mark -
+
+// The number of terms is made a compile time constant, so that the
+// compiler can unroll the loop over them.
+
+template<uint numTerms>
+static inline uint32 convertTerms(uint32 color, const ConversionProgram &program) {
+	uint32 result = program.fill;
+	for (uint i = 0; i < numTerms; ++i)
+		result |= ((color & program.terms[i].mask) >> program.terms[i].rightShift) << program.terms[i].leftShift;
+	return result;
+}
+
+template<uint numTerms, typename SrcColor, typename DstColor>
+static void convertPixels(DstColor *dst, const SrcColor *src, uint count, const ConversionProgram &program) {
+	if (sizeof(DstColor) > sizeof(SrcColor)) {
+		for (uint i = count; i-- > 0; )
+			dst[i] = convertTerms<numTerms>(src[i], program);
+	} else {
+		for (uint i = 0; i < count; ++i)
+			dst[i] = convertTerms<numTerms>(src[i], program);
+	}
+}
+
+template<typename SrcColor, typename DstColor>
+static void convertScalar(DstColor *dst, const SrcColor *src, uint count, const ConversionProgram &program) {
+	switch (program.numTerms) {
+	case 0:
+		convertPixels<0>(dst, src, count, program);
+		break;
+	case 1:
+		convertPixels<1>(dst, src, count, program);
+		break;
+	case 2:
+		convertPixels<2>(dst, src, count, program);
+		break;
+	case 3:
+		convertPixels<3>(dst, src, count, program);
+		break;
+	default:
+		convertPixels<4>(dst, src, count, program);
+		break;
+	}
+}
+
+static const ConversionKernels s_scalarKernels = {
+	convertScalar<uint16, uint16>,
+	convertScalar<uint16, uint32>,
+	convertScalar<uint32, uint16>,
+	convertScalar<uint32, uint32>,
+	0
+};
+
+#if defined(SCUMMVM_SIMD_X86)
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+/** The terms of a program, prepared for 32 bit resp. 16 bit lanes. */
+struct TermsSSE2 {
+	__m128i mask[ConversionProgram::kMaxTerms];
+	__m128i rightShift[ConversionProgram::kMaxTerms];
+	__m128i leftShift[ConversionProgram::kMaxTerms];
+	__m128i fill;
+	uint numTerms;
+};
+
+SCUMMVM_TARGET_SSE2 static void prepareSSE2(TermsSSE2 &t, const ConversionProgram &program, bool lanes16) {
+	for (uint i = 0; i < program.numTerms; ++i) {
+		t.mask[i] = lanes16 ? _mm_set1_epi16((int16)program.terms[i].mask) : _mm_set1_epi32(program.terms[i].mask);
+		t.rightShift[i] = _mm_cvtsi32_si128(program.terms[i].rightShift);
+		t.leftShift[i] = _mm_cvtsi32_si128(program.terms[i].leftShift);
+	}
+	t.fill = lanes16 ? _mm_set1_epi16((int16)program.fill) : _mm_set1_epi32(program.fill);
+	t.numTerms = program.numTerms;
+}
+
+SCUMMVM_TARGET_SSE2 static inline __m128i convert32SSE2(__m128i v, const TermsSSE2 &t) {
+	__m128i result = t.fill;
+	for (uint i = 0; i < t.numTerms; ++i) {
+		const __m128i x = _mm_and_si128(v, t.mask[i]);
+		result = _mm_or_si128(result, _mm_sll_epi32(_mm_srl_epi32(x, t.rightShift[i]), t.leftShift[i]));
+	}
+	return result;
+}
+
+SCUMMVM_TARGET_SSE2 static inline __m128i convert16SSE2(__m128i v, const TermsSSE2 &t) {
+	__m128i result = t.fill;
+	for (uint i = 0; i < t.numTerms; ++i) {
+		const __m128i x = _mm_and_si128(v, t.mask[i]);
+		result = _mm_or_si128(result, _mm_sll_epi16(_mm_srl_epi16(x, t.rightShift[i]), t.leftShift[i]));
+	}
+	return result;
+}
+
+/** Packs the 32 bit lanes of a and b, which must be below 65536, into 16 bit lanes. */
+SCUMMVM_TARGET_SSE2 static inline __m128i pack32To16SSE2(__m128i a, __m128i b) {
+	a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+	b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+	return _mm_packs_epi32(a, b);
+}
+
+SCUMMVM_TARGET_SSE2 static void convert16To16SSE2(uint16 *dst, const uint16 *src, uint count, const ConversionProgram &program) {
+	TermsSSE2 t;
+	prepareSSE2(t, program, true);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), convert16SSE2(v, t));
+	}
+	convertScalar<uint16, uint16>(dst + i, src + i, count - i, program);
+}
+
+SCUMMVM_TARGET_SSE2 static void convert16To32SSE2(uint32 *dst, const uint16 *src, uint count, const ConversionProgram &program) {
+	TermsSSE2 t;
+	prepareSSE2(t, program, false);
+
+	const __m128i zero = _mm_setzero_si128();
+	uint i = count;
+	while (i >= 8) {
+		i -= 8;
+		const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i lo = convert32SSE2(_mm_unpacklo_epi16(v, zero), t);
+		const __m128i hi = convert32SSE2(_mm_unpackhi_epi16(v, zero), t);
+		_mm_storeu_si128((__m128i *)(dst + i), lo);
+		_mm_storeu_si128((__m128i *)(dst + i + 4), hi);
+	}
+	convertScalar<uint16, uint32>(dst, src, i, program);
+}
+
+SCUMMVM_TARGET_SSE2 static void convert32To16SSE2(uint16 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	TermsSSE2 t;
+	prepareSSE2(t, program, false);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i lo = convert32SSE2(_mm_loadu_si128((const __m128i *)(src + i)), t);
+		const __m128i hi = convert32SSE2(_mm_loadu_si128((const __m128i *)(src + i + 4)), t);
+		_mm_storeu_si128((__m128i *)(dst + i), pack32To16SSE2(lo, hi));
+	}
+	convertScalar<uint32, uint16>(dst + i, src + i, count - i, program);
+}
+
+SCUMMVM_TARGET_SSE2 static void convert32To32SSE2(uint32 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	TermsSSE2 t;
+	prepareSSE2(t, program, false);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), convert32SSE2(v, t));
+	}
+	convertScalar<uint32, uint32>(dst + i, src + i, count - i, program);
+}
+
+static const ConversionKernels s_sse2Kernels = {
+	convert16To16SSE2,
+	convert16To32SSE2,
+	convert32To16SSE2,
+	convert32To32SSE2,
+	0
+};
+
+#pragma mark -
+#pragma mark --- SSSE3 kernels ---
+#pragma mark -
+
+/** Returns the byte shuffle of a program, repeated for four pixels. */
+static void makeShuffleMask(byte *mask, uint pixels, const ConversionProgram &program) {
+	for (uint p = 0; p < pixels; ++p) {
+		for (uint i = 0; i < 4; ++i)
+			mask[p * 4 + i] = (program.shuffle[i] & 0x80) ? 0x80 : (p % 4) * 4 + program.shuffle[i];
+	}
+}
+
+SCUMMVM_TARGET_SSSE3 static void shuffle32To32SSSE3(uint32 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	byte shuffle[16];
+	makeShuffleMask(shuffle, 4, program);
+	const __m128i mask = _mm_loadu_si128((const __m128i *)shuffle);
+	const __m128i fill = _mm_set1_epi32(program.fill);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_shuffle_epi8(v, mask), fill));
+	}
+	convertScalar<uint32, uint32>(dst + i, src + i, count - i, program);
+}
+
+static const ConversionKernels s_ssse3Kernels = {
+	convert16To16SSE2,
+	convert16To32SSE2,
+	convert32To16SSE2,
+	convert32To32SSE2,
+	shuffle32To32SSSE3
+};
+
+#pragma mark -
+#pragma mark --- AVX2 kernels ---
+#pragma mark -
+
+struct TermsAVX2 {
+	__m256i mask[ConversionProgram::kMaxTerms];
+	__m128i rightShift[ConversionProgram::kMaxTerms];
+	__m128i leftShift[ConversionProgram::kMaxTerms];
+	__m256i fill;
+	uint numTerms;
+};
+
+SCUMMVM_TARGET_AVX2 static void prepareAVX2(TermsAVX2 &t, const ConversionProgram &program, bool lanes16) {
+	for (uint i = 0; i < program.numTerms; ++i) {
+		t.mask[i] = lanes16 ? _mm256_set1_epi16((int16)program.terms[i].mask) : _mm256_set1_epi32(program.terms[i].mask);
+		t.rightShift[i] = _mm_cvtsi32_si128(program.terms[i].rightShift);
+		t.leftShift[i] = _mm_cvtsi32_si128(program.terms[i].leftShift);
+	}
+	t.fill = lanes16 ? _mm256_set1_epi16((int16)program.fill) : _mm256_set1_epi32(program.fill);
+	t.numTerms = program.numTerms;
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i convert32AVX2(__m256i v, const TermsAVX2 &t) {
+	__m256i result = t.fill;
+	for (uint i = 0; i < t.numTerms; ++i) {
+		const __m256i x = _mm256_and_si256(v, t.mask[i]);
+		result = _mm256_or_si256(result, _mm256_sll_epi32(_mm256_srl_epi32(x, t.rightShift[i]), t.leftShift[i]));
+	}
+	return result;
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i convert16AVX2(__m256i v, const TermsAVX2 &t) {
+	__m256i result = t.fill;
+	for (uint i = 0; i < t.numTerms; ++i) {
+		const __m256i x = _mm256_and_si256(v, t.mask[i]);
+		result = _mm256_or_si256(result, _mm256_sll_epi16(_mm256_srl_epi16(x, t.rightShift[i]), t.leftShift[i]));
+	}
+	return result;
+}
+
+SCUMMVM_TARGET_AVX2 static void convert16To16AVX2(uint16 *dst, const uint16 *src, uint count, const ConversionProgram &program) {
+	TermsAVX2 t;
+	prepareAVX2(t, program, true);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), convert16AVX2(v, t));
+	}
+	convertScalar<uint16, uint16>(dst + i, src + i, count - i, program);
+}
+
+SCUMMVM_TARGET_AVX2 static void convert16To32AVX2(uint32 *dst, const uint16 *src, uint count, const ConversionProgram &program) {
+	TermsAVX2 t;
+	prepareAVX2(t, program, false);
+
+	uint i = count;
+	while (i >= 16) {
+		i -= 16;
+		const __m128i lo = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i hi = _mm_loadu_si128((const __m128i *)(src + i + 8));
+		_mm256_storeu_si256((__m256i *)(dst + i), convert32AVX2(_mm256_cvtepu16_epi32(lo), t));
+		_mm256_storeu_si256((__m256i *)(dst + i + 8), convert32AVX2(_mm256_cvtepu16_epi32(hi), t));
+	}
+	convertScalar<uint16, uint32>(dst, src, i, program);
+}
+
+SCUMMVM_TARGET_AVX2 static void convert32To16AVX2(uint16 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	TermsAVX2 t;
+	prepareAVX2(t, program, false);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i lo = convert32AVX2(_mm256_loadu_si256((const __m256i *)(src + i)), t);
+		__m256i hi = convert32AVX2(_mm256_loadu_si256((const __m256i *)(src + i + 8)), t);
+		lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+		hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+		// The pack works on the two 128 bit lanes separately
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256((__m256i *)(dst + i), packed);
+	}
+	convertScalar<uint32, uint16>(dst + i, src + i, count - i, program);
+}
+
+SCUMMVM_TARGET_AVX2 static void convert32To32AVX2(uint32 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	TermsAVX2 t;
+	prepareAVX2(t, program, false);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), convert32AVX2(v, t));
+	}
+	convertScalar<uint32, uint32>(dst + i, src + i, count - i, program);
+}
+
+SCUMMVM_TARGET_AVX2 static void shuffle32To32AVX2(uint32 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	byte shuffle[32];
+	makeShuffleMask(shuffle, 8, program);
+	const __m256i mask = _mm256_loadu_si256((const __m256i *)shuffle);
+	const __m256i fill = _mm256_set1_epi32(program.fill);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_or_si256(_mm256_shuffle_epi8(v, mask), fill));
+	}
+	convertScalar<uint32, uint32>(dst + i, src + i, count - i, program);
+}
+
+static const ConversionKernels s_avx2Kernels = {
+	convert16To16AVX2,
+	convert16To32AVX2,
+	convert32To16AVX2,
+	convert32To32AVX2,
+	shuffle32To32AVX2
+};
+
+#endif // SCUMMVM_SIMD_X86
+
+#if defined(SCUMMVM_SIMD_NEON)
+
+#pragma mark -
+#pragma mark --- NEON kernels ---
+#pragma mark -
+
+// NEON shifts by a vector of signed counts, negative counts shift right.
+
+struct TermsNEON {
+	uint32x4_t mask[ConversionProgram::kMaxTerms];
+	int32x4_t rightShift[ConversionProgram::kMaxTerms];
+	int32x4_t leftShift[ConversionProgram::kMaxTerms];
+	uint32x4_t fill;
+	uint numTerms;
+};
+
+static void prepareNEON(TermsNEON &t, const ConversionProgram &program) {
+	for (uint i = 0; i < program.numTerms; ++i) {
+		t.mask[i] = vdupq_n_u32(program.terms[i].mask);
+		t.rightShift[i] = vdupq_n_s32(-(int32)program.terms[i].rightShift);
+		t.leftShift[i] = vdupq_n_s32(program.terms[i].leftShift);
+	}
+	t.fill = vdupq_n_u32(program.fill);
+	t.numTerms = program.numTerms;
+}
+
+static inline uint32x4_t convert32NEON(uint32x4_t v, const TermsNEON &t) {
+	uint32x4_t result = t.fill;
+	for (uint i = 0; i < t.numTerms; ++i) {
+		const uint32x4_t x = vandq_u32(v, t.mask[i]);
+		result = vorrq_u32(result, vshlq_u32(vshlq_u32(x, t.rightShift[i]), t.leftShift[i]));
+	}
+	return result;
+}
+
+static void convert16To16NEON(uint16 *dst, const uint16 *src, uint count, const ConversionProgram &program) {
+	TermsNEON t;
+	prepareNEON(t, program);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const uint16x8_t v = vld1q_u16(src + i);
+		const uint32x4_t lo = convert32NEON(vmovl_u16(vget_low_u16(v)), t);
+		const uint32x4_t hi = convert32NEON(vmovl_u16(vget_high_u16(v)), t);
+		vst1q_u16(dst + i, vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+	}
+	convertScalar<uint16, uint16>(dst + i, src + i, count - i, program);
+}
+
+static void convert16To32NEON(uint32 *dst, const uint16 *src, uint count, const ConversionProgram &program) {
+	TermsNEON t;
+	prepareNEON(t, program);
+
+	uint i = count;
+	while (i >= 8) {
+		i -= 8;
+		const uint16x8_t v = vld1q_u16(src + i);
+		const uint32x4_t lo = convert32NEON(vmovl_u16(vget_low_u16(v)), t);
+		const uint32x4_t hi = convert32NEON(vmovl_u16(vget_high_u16(v)), t);
+		vst1q_u32(dst + i, lo);
+		vst1q_u32(dst + i + 4, hi);
+	}
+	convertScalar<uint16, uint32>(dst, src, i, program);
+}
+
+static void convert32To16NEON(uint16 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	TermsNEON t;
+	prepareNEON(t, program);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const uint32x4_t lo = convert32NEON(vld1q_u32(src + i), t);
+		const uint32x4_t hi = convert32NEON(vld1q_u32(src + i + 4), t);
+		vst1q_u16(dst + i, vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+	}
+	convertScalar<uint32, uint16>(dst + i, src + i, count - i, program);
+}
+
+static void convert32To32NEON(uint32 *dst, const uint32 *src, uint count, const ConversionProgram &program) {
+	TermsNEON t;
+	prepareNEON(t, program);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+		vst1q_u32(dst + i, convert32NEON(vld1q_u32(src + i), t));
+	convertScalar<uint32, uint32>(dst + i, src + i, count - i, program);
+}
+
+static const ConversionKernels s_neonKernels = {
+	convert16To16NEON,
+	convert16To32NEON,
+	convert32To16NEON,
+	convert32To32NEON,
+	0
+};
+
+#endif // SCUMMVM_SIMD_NEON
+
+#pragma mark -
+
+const ConversionKernels *getConversionKernels(ConversionKernelType type) {
+	switch (type) {
+	case kConversionKernelsScalar:
+		return &s_scalarKernels;
+#if defined(SCUMMVM_SIMD_X86)
+	case kConversionKernelsSSE2:
+		return Common::hasCPUFeature(Common::kCPUFeatureSSE2) ? &s_sse2Kernels : 0;
+	case kConversionKernelsSSSE3:
+		return Common::hasCPUFeature(Common::kCPUFeatureSSSE3) ? &s_ssse3Kernels : 0;
+	case kConversionKernelsAVX2:
+		return Common::hasCPUFeature(Common::kCPUFeatureAVX2) ? &s_avx2Kernels : 0;
+#endif
+#if defined(SCUMMVM_SIMD_NEON)
+	case kConversionKernelsNEON:
+		return Common::hasCPUFeature(Common::kCPUFeatureNEON) ? &s_neonKernels : 0;
+#endif
+	default:
+		return 0;
+	}
+}
+
+const ConversionKernels &getBestConversionKernels() {
+	for (int type = kConversionKernelsCount - 1; type > kConversionKernelsScalar; --type) {
+		const ConversionKernels *kernels = getConversionKernels((ConversionKernelType)type);
+		if (kernels)
+			return *kernels;
+	}
+
+	return s_scalarKernels;
+}
+
+} // End of namespace Graphics
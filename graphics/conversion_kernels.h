@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_CONVERSION_KERNELS_H
+#define GRAPHICS_CONVERSION_KERNELS_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+struct PixelFormat;
+
+/**
+ * A pixel format conversion compiled down to a few shift and mask
+ * operations, so that it does not need to go through
+ * PixelFormat::colorToARGB and PixelFormat::ARGBToColor for every pixel.
+ *
+ * Source channels which end up at the same relative bit position are
+ * converted together, e.g. ARGB8888 to XRGB8888 is a single masking term.
+ */
+struct ConversionProgram {
+	enum {
+		kMaxTerms = 4
+	};
+
+	/** One part of the destination pixel: ((src & mask) >> rightShift) << leftShift */
+	struct Term {
+		uint32 mask;
+		uint32 rightShift;
+		uint32 leftShift;
+	};
+
+	Term terms[kMaxTerms];
+	uint numTerms;
+
+	/** Bits set in every destination pixel, i.e. the opaque alpha of sources without alpha */
+	uint32 fill;
+
+	/**
+	 * Whether the conversion only moves whole bytes around, which is true
+	 * for conversions between 32 bit formats with 8 bits per channel.
+	 */
+	bool isShuffle;
+
+	/**
+	 * For byte permutations, the index of the source byte of each
+	 * destination byte in memory order, or 0x80 for bytes set from fill.
+	 */
+	byte shuffle[4];
+
+	/**
+	 * Compiles the conversion from srcFmt to dstFmt. Both formats must have
+	 * 2 or 4 bytes per pixel.
+	 */
+	void init(const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+
+	/** Converts a single pixel, with the same result as the PixelFormat methods. */
+	inline uint32 convert(uint32 color) const {
+		uint32 result = fill;
+		for (uint i = 0; i < numTerms; ++i)
+			result |= ((color & terms[i].mask) >> terms[i].rightShift) << terms[i].leftShift;
+		return result;
+	}
+};
+
+/**
+ * The inner loops of crossBlit, in a plain C++ version and, where available,
+ * SIMD versions. All versions produce the same results.
+ *
+ * The functions converting to a larger pixel size work from the last pixel
+ * to the first, all others from the first to the last, so that rows can be
+ * converted in place like crossBlit allows.
+ */
+struct ConversionKernels {
+	void (*convert16To16)(uint16 *dst, const uint16 *src, uint count, const ConversionProgram &program);
+	void (*convert16To32)(uint32 *dst, const uint16 *src, uint count, const ConversionProgram &program);
+	void (*convert32To16)(uint16 *dst, const uint32 *src, uint count, const ConversionProgram &program);
+	void (*convert32To32)(uint32 *dst, const uint32 *src, uint count, const ConversionProgram &program);
+
+	/**
+	 * Same as convert32To32, for programs which are byte permutations.
+	 * May be 0, in which case convert32To32 is used.
+	 */
+	void (*shuffle32To32)(uint32 *dst, const uint32 *src, uint count, const ConversionProgram &program);
+};
+
+enum ConversionKernelType {
+	kConversionKernelsScalar,
+	kConversionKernelsSSE2,
+	kConversionKernelsSSSE3,
+	kConversionKernelsAVX2,
+	kConversionKernelsNEON,
+
+	kConversionKernelsCount
+};
+
+/**
+ * Returns the given kernel implementation, or 0 if it is not supported by
+ * the CPU or was not compiled in.
+ */
+const ConversionKernels *getConversionKernels(ConversionKernelType type);
+
+/**
+ * Returns the fastest kernel implementation supported by the CPU.
+ */
+const ConversionKernels &getBestConversionKernels();
+
+} // End of namespace Graphics
+
+#endif
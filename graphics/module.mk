@@ -2,6 +2,7 @@ MODULE := graphics
 
 MODULE_OBJS := \
 	conversion.o \
+	conversion_kernels.o \
 	cursorman.o \
 	font.o \
 	fontman.o \
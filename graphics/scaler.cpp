@@ -20,14 +20,19 @@
  *
  */
 
+#include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/scalebit.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/workerpool.h"
 
 int gBitFormat = 565;
 
+/** The pixel format set up by InitScalers(). */
+Graphics::PixelFormat gScalerFormat = Graphics::createPixelFormat<565>();
+
 #ifdef USE_HQ_SCALERS
 // RGB-to-YUV lookup table
 extern "C" {
@@ -121,35 +126,51 @@ void InitLUT(Graphics::PixelFormat format) {
 
 
 /** Lookup table for the DotMatrix scaler. */
-uint16 g_dotmatrix[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+uint32 g_dotmatrix[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
 /** Init the scaler subsystem. */
 void InitScalers(uint32 BitFormat) {
-	gBitFormat = BitFormat;
-
-	// FIXME: The pixelformat should be param to this function, not the bitformat.
-	// Until then, determine the pixelformat in other ways. Unfortunately,
-	// calling OSystem::getOverlayFormat() here might not be safe on all ports.
+	// Calling OSystem::getOverlayFormat() here might not be safe on all
+	// ports, so only do it for bit formats we do not know.
 	Graphics::PixelFormat format;
-	if (gBitFormat == 555) {
+	if (BitFormat == 555) {
 		format = Graphics::createPixelFormat<555>();
-	} else if (gBitFormat == 565) {
+	} else if (BitFormat == 565) {
 		format = Graphics::createPixelFormat<565>();
+	} else if (BitFormat == 8888) {
+		format = Graphics::createPixelFormat<8888>();
 	} else {
 		assert(g_system);
 		format = g_system->getOverlayFormat();
 	}
 
+	InitScalers(format);
+}
+
+void InitScalers(const Graphics::PixelFormat &format) {
+	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4);
+
+	gScalerFormat = format;
+	if (format.bytesPerPixel == 4)
+		gBitFormat = 8888;
+	else if (format == Graphics::createPixelFormat<565>())
+		gBitFormat = 565;
+	else
+		gBitFormat = 555;
+
 #ifdef USE_HQ_SCALERS
-	InitLUT(format);
+	// 32 bit pixels are converted to YUV on the fly
+	if (format.bytesPerPixel == 2)
+		InitLUT(format);
 #endif
 
-	// Build dotmatrix lookup table for the DotMatrix scaler.
-	g_dotmatrix[0] = g_dotmatrix[10] = format.RGBToColor(0, 63, 0);
-	g_dotmatrix[1] = g_dotmatrix[11] = format.RGBToColor(0, 0, 63);
-	g_dotmatrix[2] = g_dotmatrix[8] = format.RGBToColor(63, 0, 0);
+	// Build dotmatrix lookup table for the DotMatrix scaler. The alpha
+	// channel is left alone.
+	g_dotmatrix[0] = g_dotmatrix[10] = format.ARGBToColor(0, 0, 63, 0);
+	g_dotmatrix[1] = g_dotmatrix[11] = format.ARGBToColor(0, 0, 0, 63);
+	g_dotmatrix[2] = g_dotmatrix[8] = format.ARGBToColor(0, 63, 0, 0);
 	g_dotmatrix[4] = g_dotmatrix[6] =
-		g_dotmatrix[12] = g_dotmatrix[14] = format.RGBToColor(63, 63, 63);
+		g_dotmatrix[12] = g_dotmatrix[14] = format.ARGBToColor(0, 63, 63, 63);
 }
 
 void DestroyScalers() {
@@ -166,13 +187,15 @@ void DestroyScalers() {
  */
 void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							int width, int height) {
+	const uint32 rowSize = gScalerFormat.bytesPerPixel * width;
+
 	// Spot the case when it can all be done in 1 hit
-	if ((srcPitch == sizeof(uint16) * (uint)width) && (dstPitch == sizeof(uint16) * (uint)width)) {
-		memcpy(dstPtr, srcPtr, sizeof(uint16) * width * height);
+	if (srcPitch == rowSize && dstPitch == rowSize) {
+		memcpy(dstPtr, srcPtr, rowSize * height);
 		return;
 	}
 	while (height--) {
-		memcpy(dstPtr, srcPtr, sizeof(uint16) * width);
+		memcpy(dstPtr, srcPtr, rowSize);
 		srcPtr += srcPitch;
 		dstPtr += dstPitch;
 	}
@@ -180,6 +203,27 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 
 #ifdef USE_SCALERS
 
+/**
+ * Trivial nearest-neighbor scaler for 32 bit pixels, used by Normal2x and
+ * Normal3x.
+ */
+template<int scaleFactor>
+static void NormalNx32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	assert(IS_ALIGNED(dstPtr, 4));
+	while (height--) {
+		const uint32 *s = (const uint32 *)srcPtr;
+		for (int y = 0; y < scaleFactor; ++y) {
+			uint32 *d = (uint32 *)(dstPtr + y * dstPitch);
+			for (int i = 0; i < width; ++i) {
+				for (int x = 0; x < scaleFactor; ++x)
+					*d++ = s[i];
+			}
+		}
+		srcPtr += srcPitch;
+		dstPtr += dstPitch * scaleFactor;
+	}
+}
 
 #ifdef USE_ARM_SCALER_ASM
 extern "C" void Normal2xARM(const uint8  *srcPtr,
@@ -195,7 +239,10 @@ void Normal2x(const uint8  *srcPtr,
                     uint32  dstPitch,
                     int     width,
                     int     height) {
-	Normal2xARM(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	if (gBitFormat == 8888)
+		NormalNx32<2>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else
+		Normal2xARM(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
 #else
@@ -206,6 +253,11 @@ void Normal2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 							int width, int height) {
 	uint8 *r;
 
+	if (gBitFormat == 8888) {
+		NormalNx32<2>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
 	assert(IS_ALIGNED(dstPtr, 4));
 	while (height--) {
 		r = dstPtr;
@@ -232,6 +284,11 @@ void Normal3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 	const uint32 dstPitch2 = dstPitch * 2;
 	const uint32 dstPitch3 = dstPitch * 3;
 
+	if (gBitFormat == 8888) {
+		NormalNx32<3>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
 	assert(IS_ALIGNED(dstPtr, 2));
 	while (height--) {
 		r = dstPtr;
@@ -262,29 +319,31 @@ void Normal3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 template<typename ColorMask>
 void Normal1o5xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							int width, int height) {
+	typedef typename ColorMask::PixelType Pixel;
+	const uint32 pixel2 = sizeof(Pixel) * 2;
 	uint8 *r;
 	const uint32 dstPitch2 = dstPitch * 2;
 	const uint32 dstPitch3 = dstPitch * 3;
 	const uint32 srcPitch2 = srcPitch * 2;
 
-	assert(IS_ALIGNED(dstPtr, 2));
+	assert(IS_ALIGNED(dstPtr, sizeof(Pixel)));
 	while (height > 0) {
 		r = dstPtr;
-		for (int i = 0; i < width; i += 2, r += 6) {
-			uint16 color0 = *(((const uint16 *)srcPtr) + i);
-			uint16 color1 = *(((const uint16 *)srcPtr) + i + 1);
-			uint16 color2 = *(((const uint16 *)(srcPtr + srcPitch)) + i);
-			uint16 color3 = *(((const uint16 *)(srcPtr + srcPitch)) + i + 1);
-
-			*(uint16 *)(r + 0) = color0;
-			*(uint16 *)(r + 2) = interpolate_1_1(color0, color1);
-			*(uint16 *)(r + 4) = color1;
-			*(uint16 *)(r + 0 + dstPitch) = interpolate_1_1(color0, color2);
-			*(uint16 *)(r + 2 + dstPitch) = interpolate_1_1_1_1(color0, color1, color2, color3);
-			*(uint16 *)(r + 4 + dstPitch) = interpolate_1_1(color1, color3);
-			*(uint16 *)(r + 0 + dstPitch2) = color2;
-			*(uint16 *)(r + 2 + dstPitch2) = interpolate_1_1(color2, color3);
-			*(uint16 *)(r + 4 + dstPitch2) = color3;
+		for (int i = 0; i < width; i += 2, r += sizeof(Pixel) * 3) {
+			Pixel color0 = *(((const Pixel *)srcPtr) + i);
+			Pixel color1 = *(((const Pixel *)srcPtr) + i + 1);
+			Pixel color2 = *(((const Pixel *)(srcPtr + srcPitch)) + i);
+			Pixel color3 = *(((const Pixel *)(srcPtr + srcPitch)) + i + 1);
+
+			*(Pixel *)(r + 0) = color0;
+			*(Pixel *)(r + sizeof(Pixel)) = interpolate_1_1(color0, color1);
+			*(Pixel *)(r + pixel2) = color1;
+			*(Pixel *)(r + 0 + dstPitch) = interpolate_1_1(color0, color2);
+			*(Pixel *)(r + sizeof(Pixel) + dstPitch) = interpolate_1_1_1_1(color0, color1, color2, color3);
+			*(Pixel *)(r + pixel2 + dstPitch) = interpolate_1_1(color1, color3);
+			*(Pixel *)(r + 0 + dstPitch2) = color2;
+			*(Pixel *)(r + sizeof(Pixel) + dstPitch2) = interpolate_1_1(color2, color3);
+			*(Pixel *)(r + pixel2 + dstPitch2) = color3;
 		}
 		srcPtr += srcPitch2;
 		dstPtr += dstPitch3;
@@ -293,7 +352,9 @@ void Normal1o5xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uin
 }
 
 void Normal1o5x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888)
+		Normal1o5xTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else if (gBitFormat == 565)
 		Normal1o5xTemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		Normal1o5xTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
@@ -305,7 +366,7 @@ void Normal1o5x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstP
  */
 void AdvMame2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							 int width, int height) {
-	scale(2, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
+	scale(2, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, gScalerFormat.bytesPerPixel, width, height);
 }
 
 /**
@@ -314,30 +375,40 @@ void AdvMame2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
  */
 void AdvMame3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							 int width, int height) {
-	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
+	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, gScalerFormat.bytesPerPixel, width, height);
 }
 
 template<typename ColorMask>
 void TV2xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 					int width, int height) {
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	typedef typename ColorMask::PixelType Pixel;
+
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
+
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	// 32 bit pixels are darkened byte by byte, which would include alpha
+	const uint32 alphaMask = gScalerFormat.ARGBToColor(255, 0, 0, 0);
 
 	while (height--) {
 		for (int i = 0, j = 0; i < width; ++i, j += 2) {
-			uint16 p1 = *(p + i);
+			Pixel p1 = *(p + i);
 			uint32 pi;
 
-			pi = (((p1 & ColorMask::kRedBlueMask) * 7) >> 3) & ColorMask::kRedBlueMask;
-			pi |= (((p1 & ColorMask::kGreenMask) * 7) >> 3) & ColorMask::kGreenMask;
+			if (ColorMask::kBytesPerPixel == 4) {
+				pi = interpolate8888<7, 0, 0, 0, 3>(p1, 0);
+				pi = (pi & ~alphaMask) | (p1 & alphaMask);
+			} else {
+				pi = (((p1 & ColorMask::kRedBlueMask) * 7) >> 3) & ColorMask::kRedBlueMask;
+				pi |= (((p1 & ColorMask::kGreenMask) * 7) >> 3) & ColorMask::kGreenMask;
+			}
 
 			*(q + j) = p1;
 			*(q + j + 1) = p1;
-			*(q + j + nextlineDst) = (uint16)pi;
-			*(q + j + nextlineDst + 1) = (uint16)pi;
+			*(q + j + nextlineDst) = (Pixel)pi;
+			*(q + j + nextlineDst + 1) = (Pixel)pi;
 		}
 		p += nextlineSrc;
 		q += nextlineDst << 1;
@@ -345,13 +416,16 @@ void TV2xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 ds
 }
 
 void TV2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888)
+		TV2xTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else if (gBitFormat == 565)
 		TV2xTemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		TV2xTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
-static inline uint16 DOT_16(const uint16 *dotmatrix, uint16 c, int j, int i) {
+template<typename Pixel>
+static inline Pixel DOT(const uint32 *dotmatrix, Pixel c, int j, int i) {
 	return c - ((c >> 2) & dotmatrix[((j & 3) << 2) + (i & 3)]);
 }
 
@@ -362,28 +436,103 @@ static inline uint16 DOT_16(const uint16 *dotmatrix, uint16 c, int j, int i) {
 // a way that also works together with aspect-ratio correction is left as an
 // exercise for the reader.)
 
-void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+template<typename Pixel>
+static void DotMatrixTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 					int width, int height) {
 
-	const uint16 *dotmatrix = g_dotmatrix;
+	const uint32 *dotmatrix = g_dotmatrix;
 
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
 	for (int j = 0, jj = 0; j < height; ++j, jj += 2) {
 		for (int i = 0, ii = 0; i < width; ++i, ii += 2) {
-			uint16 c = *(p + i);
-			*(q + ii) = DOT_16(dotmatrix, c, jj, ii);
-			*(q + ii + 1) = DOT_16(dotmatrix, c, jj, ii + 1);
-			*(q + ii + nextlineDst) = DOT_16(dotmatrix, c, jj + 1, ii);
-			*(q + ii + nextlineDst + 1) = DOT_16(dotmatrix, c, jj + 1, ii + 1);
+			Pixel c = *(p + i);
+			*(q + ii) = DOT(dotmatrix, c, jj, ii);
+			*(q + ii + 1) = DOT(dotmatrix, c, jj, ii + 1);
+			*(q + ii + nextlineDst) = DOT(dotmatrix, c, jj + 1, ii);
+			*(q + ii + nextlineDst + 1) = DOT(dotmatrix, c, jj + 1, ii + 1);
 		}
 		p += nextlineSrc;
 		q += nextlineDst << 1;
 	}
 }
 
+void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+					int width, int height) {
+	if (gBitFormat == 8888)
+		DotMatrixTemplate<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else
+		DotMatrixTemplate<uint16>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
 #endif // #ifdef USE_SCALERS
+
+namespace {
+
+/** Scales a single horizontal band for ScaleInBands(). */
+class ScalerBandJob : public Common::WorkerJob {
+public:
+	ScalerProc *scaler;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width, height;
+
+	virtual void run() {
+		scaler(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	}
+};
+
+/** Returns whether several bands can be scaled with the given scaler at once. */
+bool isReentrant(ScalerProc *scaler) {
+#if defined(USE_SCALERS) && defined(USE_HQ_SCALERS) && defined(USE_NASM)
+	// The assembly versions of HQ2x and HQ3x keep their state in globals
+	if (gBitFormat != 8888 && (scaler == HQ2x || scaler == HQ3x))
+		return false;
+#endif
+	return true;
+}
+
+} // End of anonymous namespace
+
+void ScaleInBands(Common::WorkerPool &pool, uint numBands, ScalerProc *scaler, int scaleFactor,
+					const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	enum {
+		kMaxBands = 8,
+		// Smaller bands are not worth the synchronization
+		kMinBandHeight = 16
+	};
+
+	numBands = MIN<uint>(MIN<uint>(numBands, kMaxBands), height / kMinBandHeight);
+	if (numBands <= 1 || !pool.isThreaded() || !isReentrant(scaler)) {
+		scaler(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	// Every band starts on an even source row, so the DotMatrix pattern
+	// stays the same as when scaling the rect in one go
+	const int bandHeight = (height / numBands) & ~1;
+
+	ScalerBandJob bands[kMaxBands];
+	Common::WorkerJob *jobs[kMaxBands];
+	int y = 0;
+	for (uint i = 0; i < numBands; ++i) {
+		ScalerBandJob &band = bands[i];
+		band.scaler = scaler;
+		band.srcPtr = srcPtr + y * srcPitch;
+		band.srcPitch = srcPitch;
+		band.dstPtr = dstPtr + y * scaleFactor * dstPitch;
+		band.dstPitch = dstPitch;
+		band.width = width;
+		band.height = (i == numBands - 1) ? height - y : bandHeight;
+		y += band.height;
+		jobs[i] = &band;
+	}
+
+	pool.runAll(jobs, numBands);
+}
@@ -25,12 +25,40 @@
 #include "common/scummsys.h"
 #include "graphics/surface.h"
 
+namespace Common {
+class WorkerPool;
+}
+
 extern void InitScalers(uint32 BitFormat);
+
+/**
+ * Init the scaler subsystem for the given pixel format. All scalers support
+ * 555 and 565 formats as well as any 32 bit format; other 16 bit formats are
+ * treated like 555.
+ */
+extern void InitScalers(const Graphics::PixelFormat &format);
 extern void DestroyScalers();
 
 typedef void ScalerProc(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height);
 
+/**
+ * Runs a scaler on horizontal bands of the given rect, scaling the bands in
+ * parallel on a worker pool. The bands read the source rows around them just
+ * like a single call would, but never write the same destination rows. Small
+ * rects, a pool without worker threads, or scalers which are not reentrant
+ * (the assembly versions of HQ2x and HQ3x) are scaled in one go.
+ *
+ * Not usable with Normal1o5x, since its scale factor is not an integer.
+ *
+ * @param pool          the pool to run the bands on
+ * @param numBands      the maximum number of bands to split the rect into
+ * @param scaler        the scaler to run
+ * @param scaleFactor   the number of destination rows per source row
+ */
+extern void ScaleInBands(Common::WorkerPool &pool, uint numBands, ScalerProc *scaler, int scaleFactor,
+							const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+
 #define DECLARE_SCALER(x)	\
 	extern void x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, \
 					uint32 dstPitch, int width, int height)
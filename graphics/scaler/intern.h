@@ -53,12 +53,31 @@ static inline uint32 interpolate32_3_1(uint32 p1, uint32 p2) {
 	return x + y;
 }
 
+/**
+ * Interpolate up to four 32 bit pixels with the given weights, i.e.,
+ * (w1*p1+w2*p2+w3*p3+w4*p4) >> shift, where the weights add up to 1 << shift.
+ * Each byte is interpolated separately, so this works for every 32 bit
+ * format, including its alpha channel. The interpolate16_* functions below
+ * use this when they are instantiated for a 32 bit color mask.
+ */
+template<int w1, int w2, int w3, int w4, int shift>
+static inline uint32 interpolate8888(uint32 p1, uint32 p2, uint32 p3 = 0, uint32 p4 = 0) {
+	const uint32 rb = (p1 & 0x00FF00FF) * w1 + (p2 & 0x00FF00FF) * w2
+	                + (p3 & 0x00FF00FF) * w3 + (p4 & 0x00FF00FF) * w4;
+	const uint32 ag = ((p1 >> 8) & 0x00FF00FF) * w1 + ((p2 >> 8) & 0x00FF00FF) * w2
+	                + ((p3 >> 8) & 0x00FF00FF) * w3 + ((p4 >> 8) & 0x00FF00FF) * w4;
+	return ((rb >> shift) & 0x00FF00FF) | (((ag >> shift) & 0x00FF00FF) << 8);
+}
+
 /**
  * Interpolate two 16 bit pixels with weights 1 and 1, i.e., (p1+p2)/2.
  * See <http://www.slack.net/~ant/info/rgb_mixing.html> for details on how this works.
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_1_1(unsigned p1, unsigned p2) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<1, 1, 0, 0, 1>(p1, p2);
+
 	const unsigned lowbits = (p1 ^ p2) & ColorMask::kLowBits;
 	return ((p1 + p2) - lowbits) >> 1;
 }
@@ -68,6 +87,9 @@ static inline unsigned interpolate16_1_1(unsigned p1, unsigned p2) {
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_3_1(unsigned p1, unsigned p2) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<3, 1, 0, 0, 2>(p1, p2);
+
 	const unsigned lowbits = (((p1 & ColorMask::kLowBits) << 1) + (p1 & ColorMask::kLow2Bits)
 		                   + (p2 & ColorMask::kLow2Bits)) & ColorMask::kLow2Bits;
 	return ((p1*3 + p2) - lowbits) >> 2;
@@ -78,6 +100,9 @@ static inline unsigned interpolate16_3_1(unsigned p1, unsigned p2) {
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_5_3(unsigned p1, unsigned p2) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<5, 3, 0, 0, 3>(p1, p2);
+
 	const unsigned lowbits = (((p1 & ColorMask::kLowBits) << 2) + (p1 & ColorMask::kLow3Bits)
 		                   + ((p2 & ColorMask::kLow2Bits) << 1) + (p2 & ColorMask::kLow3Bits)) & ColorMask::kLow3Bits;
 	return ((p1*5 + p2*3) - lowbits) >> 3;
@@ -88,6 +113,9 @@ static inline unsigned interpolate16_5_3(unsigned p1, unsigned p2) {
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_7_1(unsigned p1, unsigned p2) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<7, 1, 0, 0, 3>(p1, p2);
+
 	const unsigned lowbits = (((p1 & ColorMask::kLowBits) << 2) + ((p1 & ColorMask::kLow2Bits) << 1) + (p1 & ColorMask::kLow3Bits)
 		                   +  (p2 & ColorMask::kLow3Bits)) & ColorMask::kLow3Bits;
 	return ((p1*7+p2) - lowbits) >> 3;
@@ -98,6 +126,9 @@ static inline unsigned interpolate16_7_1(unsigned p1, unsigned p2) {
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_2_1_1(unsigned p1, unsigned p2, unsigned p3) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<2, 1, 1, 0, 2>(p1, p2, p3);
+
 	p1<<=1;
 	const unsigned lowbits = ((p1 & (ColorMask::kLowBits << 1))
 		                   +  (p2 & ColorMask::kLow2Bits)
@@ -110,6 +141,9 @@ static inline unsigned interpolate16_2_1_1(unsigned p1, unsigned p2, unsigned p3
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_5_2_1(unsigned p1, unsigned p2, unsigned p3) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<5, 2, 1, 0, 3>(p1, p2, p3);
+
 	p2<<=1;
 	const unsigned lowbits = (((p1 & ColorMask::kLowBits) << 2) + (p1 & ColorMask::kLow3Bits)
 		                   +  (p2 & (ColorMask::kLow2Bits << 1))
@@ -122,6 +156,9 @@ static inline unsigned interpolate16_5_2_1(unsigned p1, unsigned p2, unsigned p3
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_6_1_1(unsigned p1, unsigned p2, unsigned p3) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<6, 1, 1, 0, 3>(p1, p2, p3);
+
 	const unsigned lowbits = (((((p1 & ColorMask::kLowBits) << 1) + (p1 & ColorMask::kLow2Bits)) << 1)
 		                   + (p2 & ColorMask::kLow3Bits)
 		                   + (p3 & ColorMask::kLow3Bits)) & ColorMask::kLow3Bits;
@@ -133,6 +170,9 @@ static inline unsigned interpolate16_6_1_1(unsigned p1, unsigned p2, unsigned p3
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_2_3_3(unsigned p1, unsigned p2, unsigned p3) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<2, 3, 3, 0, 3>(p1, p2, p3);
+
 	p1 <<= 1;
 	const unsigned rb = (p1 & (ColorMask::kRedBlueMask<<1))
 		              + ((p2 & ColorMask::kRedBlueMask) + (p3 & ColorMask::kRedBlueMask))*3;
@@ -146,6 +186,9 @@ static inline unsigned interpolate16_2_3_3(unsigned p1, unsigned p2, unsigned p3
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_2_7_7(unsigned p1, unsigned p2, unsigned p3) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<2, 7, 7, 0, 4>(p1, p2, p3);
+
 	p1 <<= 1;
 	const unsigned rb = (p1 & (ColorMask::kRedBlueMask<<1))
 		              + ((p2 & ColorMask::kRedBlueMask) + (p3 & ColorMask::kRedBlueMask))*7;
@@ -159,6 +202,9 @@ static inline unsigned interpolate16_2_7_7(unsigned p1, unsigned p2, unsigned p3
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_14_1_1(unsigned p1, unsigned p2, unsigned p3) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<14, 1, 1, 0, 4>(p1, p2, p3);
+
 	const unsigned rb = (p1&ColorMask::kRedBlueMask)*14
 	                  + (p2&ColorMask::kRedBlueMask)
 	                  + (p3&ColorMask::kRedBlueMask);
@@ -172,6 +218,9 @@ static inline unsigned interpolate16_14_1_1(unsigned p1, unsigned p2, unsigned p
  */
 template<typename ColorMask>
 static inline unsigned interpolate16_1_1_1_1(unsigned p1, unsigned p2, unsigned p3, unsigned p4) {
+	if (ColorMask::kBytesPerPixel == 4)
+		return interpolate8888<1, 1, 1, 1, 2>(p1, p2, p3, p4);
+
 	const unsigned lowbits = ((p1 & ColorMask::kLow2Bits)
 		                   +  (p2 & ColorMask::kLow2Bits)
 		                   +  (p3 & ColorMask::kLow2Bits)
@@ -179,6 +228,21 @@ static inline unsigned interpolate16_1_1_1_1(unsigned p1, unsigned p2, unsigned
 	return ((p1+p2+p3+p4) - lowbits) >> 2;
 }
 
+/**
+ * Convert a 32 bit pixel to YUV (encoded 8-8-8) the same way the RGBtoYUV
+ * table does for 16 bit pixels. Used by the hq scaler family.
+ */
+static inline int convertRGBToYUV(uint32 color, const Graphics::PixelFormat &format) {
+	const int r = (color >> format.rShift) & 0xFF;
+	const int g = (color >> format.gShift) & 0xFF;
+	const int b = (color >> format.bShift) & 0xFF;
+
+	const int Y = (r + g + b) >> 2;
+	const int u = 128 + ((r - b) >> 2);
+	const int v = 128 + ((-r + 2 * g - b) >> 3);
+	return (Y << 16) | (u << 8) | v;
+}
+
 /**
  * Compare two YUV values (encoded 8-8-8) and check if they differ by more than
  * a certain hard coded threshold. Used by the hq scaler family.
@@ -83,8 +83,20 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/cpudetect.h"
+#include "common/workerpool.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#if defined(SCUMMVM_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(SCUMMVM_SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -92,27 +104,47 @@ DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 
 namespace Graphics {
 
-class YUVToRGBLookup {
-public:
-	YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale);
-
-	Graphics::PixelFormat getFormat() const { return _format; }
-	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
-	const uint32 *getRGBToPix() const { return _rgbToPix; }
+enum {
+	/** Images with at least this many pixels are converted on several threads */
+	kThreadedPixels = 640 * 400,
 
-private:
-	Graphics::PixelFormat _format;
-	YUVToRGBManager::LuminanceScale _scale;
-	uint32 _rgbToPix[3 * 768]; // 9216 bytes
+	/** The number of worker threads, the calling thread converts a band as well */
+	kConversionThreads = 3
 };
 
-YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
-	_format = format;
-	_scale = scale;
+void YUVToRGBTables::init(const PixelFormat &dstFormat, YUVToRGBManager::LuminanceScale lumScale) {
+	format = dstFormat;
+	scale = lumScale;
+
+	fill = format.RGBToColor(0, 0, 0);
+	loss[0] = format.rLoss;
+	loss[1] = format.gLoss;
+	loss[2] = format.bLoss;
+	shift[0] = format.rShift;
+	shift[1] = format.gShift;
+	shift[2] = format.bShift;
+
+	int16 *Cr_r_tab = &colorTab[0 * 256];
+	int16 *Cr_g_tab = &colorTab[1 * 256];
+	int16 *Cb_g_tab = &colorTab[2 * 256];
+	int16 *Cb_b_tab = &colorTab[3 * 256];
+
+	// Generate the tables for the display surface
+
+	for (int i = 0; i < 256; i++) {
+		// Gamma correction (luminescence table) and chroma correction
+		// would be done here. See the Berkeley mpeg_play sources.
+
+		int16 CR = (i - 128), CB = CR;
+		Cr_r_tab[i] = (int16) ( (0.419 / 0.299) * CR) + 0 * 768 + 256;
+		Cr_g_tab[i] = (int16) (-(0.299 / 0.419) * CR) + 1 * 768 + 256;
+		Cb_g_tab[i] = (int16) (-(0.114 / 0.331) * CB);
+		Cb_b_tab[i] = (int16) ( (0.587 / 0.331) * CB) + 2 * 768 + 256;
+	}
 
-	uint32 *r_2_pix_alloc = &_rgbToPix[0 * 768];
-	uint32 *g_2_pix_alloc = &_rgbToPix[1 * 768];
-	uint32 *b_2_pix_alloc = &_rgbToPix[2 * 768];
+	uint32 *r_2_pix_alloc = &rgbToPix[0 * 768];
+	uint32 *g_2_pix_alloc = &rgbToPix[1 * 768];
+	uint32 *b_2_pix_alloc = &rgbToPix[2 * 768];
 
 	if (scale == YUVToRGBManager::kScaleFull) {
 		// Set up entries 0-255 in rgb-to-pixel value tables.
@@ -157,145 +189,67 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 	}
 }
 
-YUVToRGBManager::YUVToRGBManager() {
-	_lookup = 0;
-
-	int16 *Cr_r_tab = &_colorTab[0 * 256];
-	int16 *Cr_g_tab = &_colorTab[1 * 256];
-	int16 *Cb_g_tab = &_colorTab[2 * 256];
-	int16 *Cb_b_tab = &_colorTab[3 * 256];
-
-	// Generate the tables for the display surface
-
-	for (int i = 0; i < 256; i++) {
-		// Gamma correction (luminescence table) and chroma correction
-		// would be done here. See the Berkeley mpeg_play sources.
-
-		int16 CR = (i - 128), CB = CR;
-		Cr_r_tab[i] = (int16) ( (0.419 / 0.299) * CR) + 0 * 768 + 256;
-		Cr_g_tab[i] = (int16) (-(0.299 / 0.419) * CR) + 1 * 768 + 256;
-		Cb_g_tab[i] = (int16) (-(0.114 / 0.331) * CB);
-		Cb_b_tab[i] = (int16) ( (0.587 / 0.331) * CB) + 2 * 768 + 256;
-	}
-}
-
-YUVToRGBManager::~YUVToRGBManager() {
-	delete _lookup;
-}
-
-const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
-	if (_lookup && _lookup->getFormat() == format && _lookup->getScale() == scale)
-		return _lookup;
-
-	delete _lookup;
-	_lookup = new YUVToRGBLookup(format, scale);
-	return _lookup;
-}
+#pragma mark -
+#pragma mark --- Generic kernels ---
+#pragma mark -
 
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
 
 template<typename PixelInt>
-void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+static void convertYUV444ToRGB(PixelInt *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = tables.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
-
-	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
-			register const uint32 *L;
+	const uint32 *rgbToPix = tables.rgbToPix;
 
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
+	for (uint w = 0; w < count; w++) {
+		register const uint32 *L;
 
-			PUT_PIXEL(*ySrc, dstPtr);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-		}
+		int16 cr_r  = Cr_r_tab[*vSrc];
+		int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
+		int16 cb_b  = Cb_b_tab[*uSrc];
+		++uSrc;
+		++vSrc;
 
-		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
-		ySrc += yPitch - yWidth;
-		uSrc += uvPitch - yWidth;
-		vSrc += uvPitch - yWidth;
+		PUT_PIXEL(*ySrc, dst);
+		ySrc++;
+		dst++;
 	}
 }
 
-void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
-	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
-	assert(ySrc && uSrc && vSrc);
-
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-}
-
 template<typename PixelInt>
-void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	int halfHeight = yHeight >> 1;
-	int halfWidth = yWidth >> 1;
-
+static void convertYUV420ToRGB(PixelInt *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = tables.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
-
-	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
-			register const uint32 *L;
+	const uint32 *rgbToPix = tables.rgbToPix;
 
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
-
-			PUT_PIXEL(*ySrc, dstPtr);
-			PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-			PUT_PIXEL(*ySrc, dstPtr);
-			PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-		}
+	byte *dstPtr = (byte *)dst;
 
-		dstPtr += dstPitch;
-		ySrc += (yPitch << 1) - yWidth;
-		uSrc += uvPitch - halfWidth;
-		vSrc += uvPitch - halfWidth;
-	}
-}
+	for (uint w = 0; w < count / 2; w++) {
+		register const uint32 *L;
 
-void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
-	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
-	assert(ySrc && uSrc && vSrc);
-	assert((yWidth & 1) == 0);
-	assert((yHeight & 1) == 0);
-
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+		int16 cr_r  = Cr_r_tab[*vSrc];
+		int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
+		int16 cb_b  = Cb_b_tab[*uSrc];
+		++uSrc;
+		++vSrc;
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		PUT_PIXEL(*ySrc, dstPtr);
+		PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
+		ySrc++;
+		dstPtr += sizeof(PixelInt);
+		PUT_PIXEL(*ySrc, dstPtr);
+		PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
+		ySrc++;
+		dstPtr += sizeof(PixelInt);
+	}
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -323,13 +277,13 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	xDiff++
 
 template<typename PixelInt>
-void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+static void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBTables &tables, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = tables.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
+	const uint32 *rgbToPix = tables.rgbToPix;
 
 	int quarterWidth = yWidth >> 2;
 
@@ -365,6 +319,823 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 #undef READ_QUAD
 #undef DO_INTERPOLATION
 #undef DO_YUV410_PIXEL
+#undef PUT_PIXEL
+
+static const YUVToRGBKernels s_scalarKernels = {
+	convertYUV444ToRGB<uint16>,
+	convertYUV444ToRGB<uint32>,
+	convertYUV420ToRGB<uint16>,
+	convertYUV420ToRGB<uint32>
+};
+
+#if defined(SCUMMVM_SIMD_X86) || defined(SCUMMVM_SIMD_NEON)
+
+// The SIMD kernels compute the table entries instead of looking them up.
+// The chroma factors are fixed point, chosen so that (2 * |x| * factor) >> 16
+// truncates like the colorTab entries for every chroma value x, and
+// (2 * x * kITUToFull) >> 16 equals x * 255 / 219 for all x in [0, 219].
+// This keeps the pixels identical to those of the tables.
+enum {
+	kCrToR = 45901,     // 0.419 / 0.299
+	kCrToG = 23387,     // 0.299 / 0.419
+	kCbToG = 11284,     // 0.114 / 0.331
+	kCbToB = 58110,     // 0.587 / 0.331
+	kITUToFull = 38156  // 255 / 219
+};
+
+#endif
+
+#if defined(SCUMMVM_SIMD_X86)
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+/**
+ * Whether all channels have eight bits and start at a byte. Such channels
+ * can be moved into place with a 16 bit multiplication.
+ */
+static bool isByteAligned(const YUVToRGBTables &tables) {
+	for (int i = 0; i < 3; i++)
+		if (tables.loss[i] || (tables.shift[i] & 7))
+			return false;
+	return true;
+}
+
+/**
+ * The channel layout of a conversion, prepared for 16 bit lanes. 32 bit
+ * pixels are put together from their lower and upper halves, shifts by 16
+ * or more bits clear a lane, which drops the bits of the other half.
+ */
+struct ChannelsSSE2 {
+	__m128i lumMin;
+	__m128i lumMax;
+	__m128i loss[3];
+	__m128i shift[3];
+	__m128i highRightShift[3];
+	__m128i highLeftShift[3];
+	__m128i fill;
+	__m128i highFill;
+	__m128i lowFactor[3];
+	__m128i highFactor[3];
+	bool byteAligned;
+	bool itu;
+};
+
+/** The red, green and blue offsets of eight chroma values. */
+struct ChromaSSE2 {
+	__m128i r;
+	__m128i g;
+	__m128i b;
+};
+
+SCUMMVM_TARGET_SSE2 static void prepareSSE2(ChannelsSSE2 &c, const YUVToRGBTables &tables) {
+	c.itu = (tables.scale == YUVToRGBManager::kScaleITU);
+	c.lumMin = _mm_set1_epi16(c.itu ? 16 : 0);
+	c.lumMax = _mm_set1_epi16(c.itu ? 235 : 255);
+	for (int i = 0; i < 3; i++) {
+		const int shift = tables.shift[i];
+		c.loss[i] = _mm_cvtsi32_si128(tables.loss[i]);
+		c.shift[i] = _mm_cvtsi32_si128(shift);
+		c.highRightShift[i] = _mm_cvtsi32_si128(shift < 16 ? 16 - shift : 0);
+		c.highLeftShift[i] = _mm_cvtsi32_si128(shift < 16 ? 0 : shift - 16);
+		c.lowFactor[i] = _mm_set1_epi16(shift < 16 ? (int16)(1 << shift) : 0);
+		c.highFactor[i] = _mm_set1_epi16(shift < 16 ? 0 : (int16)(1 << (shift - 16)));
+	}
+	c.byteAligned = isByteAligned(tables);
+	c.fill = _mm_set1_epi16((int16)tables.fill);
+	c.highFill = _mm_set1_epi16((int16)(tables.fill >> 16));
+}
+
+SCUMMVM_TARGET_SSE2 static inline __m128i load8SSE2(const byte *src) {
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+}
+
+/** Multiplies by a chroma factor, truncating towards zero like the tables. */
+SCUMMVM_TARGET_SSE2 static inline __m128i mulChromaSSE2(__m128i x, int factor) {
+	const __m128i sign = _mm_srai_epi16(x, 15);
+	const __m128i a = _mm_sub_epi16(_mm_xor_si128(x, sign), sign);
+	const __m128i m = _mm_mulhi_epu16(_mm_add_epi16(a, a), _mm_set1_epi16((int16)factor));
+	return _mm_sub_epi16(_mm_xor_si128(m, sign), sign);
+}
+
+SCUMMVM_TARGET_SSE2 static inline void chromaSSE2(ChromaSSE2 &d, __m128i u, __m128i v) {
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+	d.r = mulChromaSSE2(cr, kCrToR);
+	d.g = _mm_sub_epi16(_mm_setzero_si128(), _mm_add_epi16(mulChromaSSE2(cr, kCrToG), mulChromaSSE2(cb, kCbToG)));
+	d.b = mulChromaSSE2(cb, kCbToB);
+}
+
+/** Duplicates each chroma offset, for two pixels of a 4:2:0 image. */
+SCUMMVM_TARGET_SSE2 static inline void splitChromaSSE2(ChromaSSE2 &lo, ChromaSSE2 &hi, const ChromaSSE2 &d) {
+	lo.r = _mm_unpacklo_epi16(d.r, d.r);
+	lo.g = _mm_unpacklo_epi16(d.g, d.g);
+	lo.b = _mm_unpacklo_epi16(d.b, d.b);
+	hi.r = _mm_unpackhi_epi16(d.r, d.r);
+	hi.g = _mm_unpackhi_epi16(d.g, d.g);
+	hi.b = _mm_unpackhi_epi16(d.b, d.b);
+}
+
+/** Returns a channel value in [0, 255], like the entries of rgbToPix. */
+SCUMMVM_TARGET_SSE2 static inline __m128i channelSSE2(__m128i y, __m128i offset, const ChannelsSSE2 &c) {
+	__m128i x = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(y, offset), c.lumMin), c.lumMax);
+	if (c.itu) {
+		x = _mm_sub_epi16(x, c.lumMin);
+		x = _mm_mulhi_epu16(_mm_add_epi16(x, x), _mm_set1_epi16((int16)kITUToFull));
+	}
+	return x;
+}
+
+/** Adds a channel to the lower halves of the pixels. */
+SCUMMVM_TARGET_SSE2 static inline __m128i addLowSSE2(__m128i pixels, __m128i x, int i, const ChannelsSSE2 &c) {
+	return _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(x, c.loss[i]), c.shift[i]));
+}
+
+/** Adds a channel to the upper halves of 32 bit pixels. */
+SCUMMVM_TARGET_SSE2 static inline __m128i addHighSSE2(__m128i pixels, __m128i x, int i, const ChannelsSSE2 &c) {
+	x = _mm_srl_epi16(_mm_srl_epi16(x, c.loss[i]), c.highRightShift[i]);
+	return _mm_or_si128(pixels, _mm_sll_epi16(x, c.highLeftShift[i]));
+}
+
+SCUMMVM_TARGET_SSE2 static inline void put8To16SSE2(uint16 *dst, __m128i y, const ChromaSSE2 &d, const ChannelsSSE2 &c) {
+	__m128i pixels = c.fill;
+	pixels = addLowSSE2(pixels, channelSSE2(y, d.r, c), 0, c);
+	pixels = addLowSSE2(pixels, channelSSE2(y, d.g, c), 1, c);
+	pixels = addLowSSE2(pixels, channelSSE2(y, d.b, c), 2, c);
+	_mm_storeu_si128((__m128i *)dst, pixels);
+}
+
+SCUMMVM_TARGET_SSE2 static inline void put8To32SSE2(uint32 *dst, __m128i y, const ChromaSSE2 &d, const ChannelsSSE2 &c) {
+	const __m128i r = channelSSE2(y, d.r, c);
+	const __m128i g = channelSSE2(y, d.g, c);
+	const __m128i b = channelSSE2(y, d.b, c);
+
+	__m128i low, high;
+	if (c.byteAligned) {
+		low = _mm_or_si128(c.fill, _mm_or_si128(_mm_mullo_epi16(r, c.lowFactor[0]), _mm_or_si128(_mm_mullo_epi16(g, c.lowFactor[1]), _mm_mullo_epi16(b, c.lowFactor[2]))));
+		high = _mm_or_si128(c.highFill, _mm_or_si128(_mm_mullo_epi16(r, c.highFactor[0]), _mm_or_si128(_mm_mullo_epi16(g, c.highFactor[1]), _mm_mullo_epi16(b, c.highFactor[2]))));
+	} else {
+		low = addLowSSE2(addLowSSE2(addLowSSE2(c.fill, r, 0, c), g, 1, c), b, 2, c);
+		high = addHighSSE2(addHighSSE2(addHighSSE2(c.highFill, r, 0, c), g, 1, c), b, 2, c);
+	}
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(low, high));
+	_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(low, high));
+}
+
+SCUMMVM_TARGET_SSE2 static void convert444To16SSE2(uint16 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsSSE2 c;
+	prepareSSE2(c, tables);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		ChromaSSE2 d;
+		chromaSSE2(d, load8SSE2(uSrc + i), load8SSE2(vSrc + i));
+		put8To16SSE2(dst + i, load8SSE2(ySrc + i), d, c);
+	}
+	convertYUV444ToRGB<uint16>(dst + i, ySrc + i, uSrc + i, vSrc + i, count - i, tables);
+}
+
+SCUMMVM_TARGET_SSE2 static void convert444To32SSE2(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsSSE2 c;
+	prepareSSE2(c, tables);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		ChromaSSE2 d;
+		chromaSSE2(d, load8SSE2(uSrc + i), load8SSE2(vSrc + i));
+		put8To32SSE2(dst + i, load8SSE2(ySrc + i), d, c);
+	}
+	convertYUV444ToRGB<uint32>(dst + i, ySrc + i, uSrc + i, vSrc + i, count - i, tables);
+}
+
+SCUMMVM_TARGET_SSE2 static void convert420To16SSE2(uint16 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsSSE2 c;
+	prepareSSE2(c, tables);
+
+	uint16 *dst2 = (uint16 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		ChromaSSE2 d, lo, hi;
+		chromaSSE2(d, load8SSE2(uSrc + i / 2), load8SSE2(vSrc + i / 2));
+		splitChromaSSE2(lo, hi, d);
+		put8To16SSE2(dst + i, load8SSE2(ySrc + i), lo, c);
+		put8To16SSE2(dst + i + 8, load8SSE2(ySrc + i + 8), hi, c);
+		put8To16SSE2(dst2 + i, load8SSE2(ySrc2 + i), lo, c);
+		put8To16SSE2(dst2 + i + 8, load8SSE2(ySrc2 + i + 8), hi, c);
+	}
+	convertYUV420ToRGB<uint16>(dst + i, dstPitch, ySrc + i, yPitch, uSrc + i / 2, vSrc + i / 2, count - i, tables);
+}
+
+SCUMMVM_TARGET_SSE2 static void convert420To32SSE2(uint32 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsSSE2 c;
+	prepareSSE2(c, tables);
+
+	uint32 *dst2 = (uint32 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		ChromaSSE2 d, lo, hi;
+		chromaSSE2(d, load8SSE2(uSrc + i / 2), load8SSE2(vSrc + i / 2));
+		splitChromaSSE2(lo, hi, d);
+		put8To32SSE2(dst + i, load8SSE2(ySrc + i), lo, c);
+		put8To32SSE2(dst + i + 8, load8SSE2(ySrc + i + 8), hi, c);
+		put8To32SSE2(dst2 + i, load8SSE2(ySrc2 + i), lo, c);
+		put8To32SSE2(dst2 + i + 8, load8SSE2(ySrc2 + i + 8), hi, c);
+	}
+	convertYUV420ToRGB<uint32>(dst + i, dstPitch, ySrc + i, yPitch, uSrc + i / 2, vSrc + i / 2, count - i, tables);
+}
+
+static const YUVToRGBKernels s_sse2Kernels = {
+	convert444To16SSE2,
+	convert444To32SSE2,
+	convert420To16SSE2,
+	convert420To32SSE2
+};
+
+#pragma mark -
+#pragma mark --- AVX2 kernels ---
+#pragma mark -
+
+// The same as the SSE2 kernels, for sixteen pixels at once.
+
+struct ChannelsAVX2 {
+	__m256i lumMin;
+	__m256i lumMax;
+	__m128i loss[3];
+	__m128i shift[3];
+	__m256i fill;
+	__m256i fill32;
+	__m256i highFill;
+	__m256i lowFactor[3];
+	__m256i highFactor[3];
+	bool byteAligned;
+	bool itu;
+};
+
+struct ChromaAVX2 {
+	__m256i r;
+	__m256i g;
+	__m256i b;
+};
+
+SCUMMVM_TARGET_AVX2 static void prepareAVX2(ChannelsAVX2 &c, const YUVToRGBTables &tables) {
+	c.itu = (tables.scale == YUVToRGBManager::kScaleITU);
+	c.lumMin = _mm256_set1_epi16(c.itu ? 16 : 0);
+	c.lumMax = _mm256_set1_epi16(c.itu ? 235 : 255);
+	for (int i = 0; i < 3; i++) {
+		const int shift = tables.shift[i];
+		c.loss[i] = _mm_cvtsi32_si128(tables.loss[i]);
+		c.shift[i] = _mm_cvtsi32_si128(shift);
+		c.lowFactor[i] = _mm256_set1_epi16(shift < 16 ? (int16)(1 << shift) : 0);
+		c.highFactor[i] = _mm256_set1_epi16(shift < 16 ? 0 : (int16)(1 << (shift - 16)));
+	}
+	c.fill = _mm256_set1_epi16((int16)tables.fill);
+	c.fill32 = _mm256_set1_epi32(tables.fill);
+	c.highFill = _mm256_set1_epi16((int16)(tables.fill >> 16));
+	c.byteAligned = isByteAligned(tables);
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i load16AVX2(const byte *src) {
+	return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)src));
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i mulChromaAVX2(__m256i x, int factor) {
+	const __m256i sign = _mm256_srai_epi16(x, 15);
+	const __m256i m = _mm256_mulhi_epu16(_mm256_slli_epi16(_mm256_abs_epi16(x), 1), _mm256_set1_epi16((int16)factor));
+	return _mm256_sub_epi16(_mm256_xor_si256(m, sign), sign);
+}
+
+SCUMMVM_TARGET_AVX2 static inline void chromaAVX2(ChromaAVX2 &d, __m256i u, __m256i v) {
+	const __m256i cb = _mm256_sub_epi16(u, _mm256_set1_epi16(128));
+	const __m256i cr = _mm256_sub_epi16(v, _mm256_set1_epi16(128));
+	d.r = mulChromaAVX2(cr, kCrToR);
+	d.g = _mm256_sub_epi16(_mm256_setzero_si256(), _mm256_add_epi16(mulChromaAVX2(cr, kCrToG), mulChromaAVX2(cb, kCbToG)));
+	d.b = mulChromaAVX2(cb, kCbToB);
+}
+
+/** Duplicates each chroma offset, the unpacks work within 128 bit lanes. */
+SCUMMVM_TARGET_AVX2 static inline void splitChromaAVX2(__m256i &lo, __m256i &hi, __m256i d) {
+	const __m256i a = _mm256_unpacklo_epi16(d, d);
+	const __m256i b = _mm256_unpackhi_epi16(d, d);
+	lo = _mm256_permute2x128_si256(a, b, 0x20);
+	hi = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+SCUMMVM_TARGET_AVX2 static inline void splitChromaAVX2(ChromaAVX2 &lo, ChromaAVX2 &hi, const ChromaAVX2 &d) {
+	splitChromaAVX2(lo.r, hi.r, d.r);
+	splitChromaAVX2(lo.g, hi.g, d.g);
+	splitChromaAVX2(lo.b, hi.b, d.b);
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i channelAVX2(__m256i y, __m256i offset, const ChannelsAVX2 &c) {
+	__m256i x = _mm256_min_epi16(_mm256_max_epi16(_mm256_add_epi16(y, offset), c.lumMin), c.lumMax);
+	if (c.itu) {
+		x = _mm256_sub_epi16(x, c.lumMin);
+		x = _mm256_mulhi_epu16(_mm256_add_epi16(x, x), _mm256_set1_epi16((int16)kITUToFull));
+	}
+	return x;
+}
+
+SCUMMVM_TARGET_AVX2 static inline __m256i addChannelAVX2(__m256i pixels, __m256i x, int i, const ChannelsAVX2 &c) {
+	return _mm256_or_si256(pixels, _mm256_sll_epi16(_mm256_srl_epi16(x, c.loss[i]), c.shift[i]));
+}
+
+/** Adds a channel to 32 bit pixels, given as two vectors of eight pixels each. */
+SCUMMVM_TARGET_AVX2 static inline void addChannel32AVX2(__m256i &lo, __m256i &hi, __m256i x, int i, const ChannelsAVX2 &c) {
+	x = _mm256_srl_epi16(x, c.loss[i]);
+	lo = _mm256_or_si256(lo, _mm256_sll_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(x)), c.shift[i]));
+	hi = _mm256_or_si256(hi, _mm256_sll_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(x, 1)), c.shift[i]));
+}
+
+SCUMMVM_TARGET_AVX2 static inline void put16To16AVX2(uint16 *dst, __m256i y, const ChromaAVX2 &d, const ChannelsAVX2 &c) {
+	__m256i pixels = c.fill;
+	pixels = addChannelAVX2(pixels, channelAVX2(y, d.r, c), 0, c);
+	pixels = addChannelAVX2(pixels, channelAVX2(y, d.g, c), 1, c);
+	pixels = addChannelAVX2(pixels, channelAVX2(y, d.b, c), 2, c);
+	_mm256_storeu_si256((__m256i *)dst, pixels);
+}
+
+SCUMMVM_TARGET_AVX2 static inline void put16To32AVX2(uint32 *dst, __m256i y, const ChromaAVX2 &d, const ChannelsAVX2 &c) {
+	const __m256i r = channelAVX2(y, d.r, c);
+	const __m256i g = channelAVX2(y, d.g, c);
+	const __m256i b = channelAVX2(y, d.b, c);
+
+	__m256i lo, hi;
+	if (c.byteAligned) {
+		const __m256i low = _mm256_or_si256(c.fill, _mm256_or_si256(_mm256_mullo_epi16(r, c.lowFactor[0]),
+			_mm256_or_si256(_mm256_mullo_epi16(g, c.lowFactor[1]), _mm256_mullo_epi16(b, c.lowFactor[2]))));
+		const __m256i high = _mm256_or_si256(c.highFill, _mm256_or_si256(_mm256_mullo_epi16(r, c.highFactor[0]),
+			_mm256_or_si256(_mm256_mullo_epi16(g, c.highFactor[1]), _mm256_mullo_epi16(b, c.highFactor[2]))));
+
+		// The unpacks work within 128 bit lanes
+		const __m256i first = _mm256_unpacklo_epi16(low, high);
+		const __m256i second = _mm256_unpackhi_epi16(low, high);
+		lo = _mm256_permute2x128_si256(first, second, 0x20);
+		hi = _mm256_permute2x128_si256(first, second, 0x31);
+	} else {
+		lo = hi = c.fill32;
+		addChannel32AVX2(lo, hi, r, 0, c);
+		addChannel32AVX2(lo, hi, g, 1, c);
+		addChannel32AVX2(lo, hi, b, 2, c);
+	}
+	_mm256_storeu_si256((__m256i *)dst, lo);
+	_mm256_storeu_si256((__m256i *)(dst + 8), hi);
+}
+
+SCUMMVM_TARGET_AVX2 static void convert444To16AVX2(uint16 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsAVX2 c;
+	prepareAVX2(c, tables);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		ChromaAVX2 d;
+		chromaAVX2(d, load16AVX2(uSrc + i), load16AVX2(vSrc + i));
+		put16To16AVX2(dst + i, load16AVX2(ySrc + i), d, c);
+	}
+	convertYUV444ToRGB<uint16>(dst + i, ySrc + i, uSrc + i, vSrc + i, count - i, tables);
+}
+
+SCUMMVM_TARGET_AVX2 static void convert444To32AVX2(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsAVX2 c;
+	prepareAVX2(c, tables);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		ChromaAVX2 d;
+		chromaAVX2(d, load16AVX2(uSrc + i), load16AVX2(vSrc + i));
+		put16To32AVX2(dst + i, load16AVX2(ySrc + i), d, c);
+	}
+	convertYUV444ToRGB<uint32>(dst + i, ySrc + i, uSrc + i, vSrc + i, count - i, tables);
+}
+
+SCUMMVM_TARGET_AVX2 static void convert420To16AVX2(uint16 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsAVX2 c;
+	prepareAVX2(c, tables);
+
+	uint16 *dst2 = (uint16 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+
+	uint i = 0;
+	for (; i + 32 <= count; i += 32) {
+		ChromaAVX2 d, lo, hi;
+		chromaAVX2(d, load16AVX2(uSrc + i / 2), load16AVX2(vSrc + i / 2));
+		splitChromaAVX2(lo, hi, d);
+		put16To16AVX2(dst + i, load16AVX2(ySrc + i), lo, c);
+		put16To16AVX2(dst + i + 16, load16AVX2(ySrc + i + 16), hi, c);
+		put16To16AVX2(dst2 + i, load16AVX2(ySrc2 + i), lo, c);
+		put16To16AVX2(dst2 + i + 16, load16AVX2(ySrc2 + i + 16), hi, c);
+	}
+	convertYUV420ToRGB<uint16>(dst + i, dstPitch, ySrc + i, yPitch, uSrc + i / 2, vSrc + i / 2, count - i, tables);
+}
+
+SCUMMVM_TARGET_AVX2 static void convert420To32AVX2(uint32 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsAVX2 c;
+	prepareAVX2(c, tables);
+
+	uint32 *dst2 = (uint32 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+
+	uint i = 0;
+	for (; i + 32 <= count; i += 32) {
+		ChromaAVX2 d, lo, hi;
+		chromaAVX2(d, load16AVX2(uSrc + i / 2), load16AVX2(vSrc + i / 2));
+		splitChromaAVX2(lo, hi, d);
+		put16To32AVX2(dst + i, load16AVX2(ySrc + i), lo, c);
+		put16To32AVX2(dst + i + 16, load16AVX2(ySrc + i + 16), hi, c);
+		put16To32AVX2(dst2 + i, load16AVX2(ySrc2 + i), lo, c);
+		put16To32AVX2(dst2 + i + 16, load16AVX2(ySrc2 + i + 16), hi, c);
+	}
+	convertYUV420ToRGB<uint32>(dst + i, dstPitch, ySrc + i, yPitch, uSrc + i / 2, vSrc + i / 2, count - i, tables);
+}
+
+static const YUVToRGBKernels s_avx2Kernels = {
+	convert444To16AVX2,
+	convert444To32AVX2,
+	convert420To16AVX2,
+	convert420To32AVX2
+};
+
+#endif // SCUMMVM_SIMD_X86
+
+#if defined(SCUMMVM_SIMD_NEON)
+
+#pragma mark -
+#pragma mark --- NEON kernels ---
+#pragma mark -
+
+// NEON shifts by a vector of signed counts, negative counts shift right.
+
+struct ChannelsNEON {
+	int16x8_t lumMin;
+	int16x8_t lumMax;
+	int16x8_t loss[3];
+	int16x8_t shift16[3];
+	int32x4_t shift32[3];
+	uint16x8_t fill16;
+	uint32x4_t fill32;
+	bool itu;
+};
+
+struct ChromaNEON {
+	int16x8_t r;
+	int16x8_t g;
+	int16x8_t b;
+};
+
+static void prepareNEON(ChannelsNEON &c, const YUVToRGBTables &tables) {
+	c.itu = (tables.scale == YUVToRGBManager::kScaleITU);
+	c.lumMin = vdupq_n_s16(c.itu ? 16 : 0);
+	c.lumMax = vdupq_n_s16(c.itu ? 235 : 255);
+	for (int i = 0; i < 3; i++) {
+		c.loss[i] = vdupq_n_s16(-(int16)tables.loss[i]);
+		c.shift16[i] = vdupq_n_s16(tables.shift[i]);
+		c.shift32[i] = vdupq_n_s32(tables.shift[i]);
+	}
+	c.fill16 = vdupq_n_u16((uint16)tables.fill);
+	c.fill32 = vdupq_n_u32(tables.fill);
+}
+
+static inline int16x8_t load8NEON(const byte *src) {
+	return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src)));
+}
+
+/** Returns the upper 16 bits of the products. */
+static inline uint16x8_t mulHighNEON(uint16x8_t x, uint16 factor) {
+	const uint16x4_t f = vdup_n_u16(factor);
+	return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(x), f), 16), vshrn_n_u32(vmull_u16(vget_high_u16(x), f), 16));
+}
+
+static inline int16x8_t mulChromaNEON(int16x8_t x, uint16 factor) {
+	const int16x8_t m = vreinterpretq_s16_u16(mulHighNEON(vreinterpretq_u16_s16(vshlq_n_s16(vabsq_s16(x), 1)), factor));
+	return vbslq_s16(vcltq_s16(x, vdupq_n_s16(0)), vnegq_s16(m), m);
+}
+
+static inline void chromaNEON(ChromaNEON &d, int16x8_t u, int16x8_t v) {
+	const int16x8_t cb = vsubq_s16(u, vdupq_n_s16(128));
+	const int16x8_t cr = vsubq_s16(v, vdupq_n_s16(128));
+	d.r = mulChromaNEON(cr, kCrToR);
+	d.g = vnegq_s16(vaddq_s16(mulChromaNEON(cr, kCrToG), mulChromaNEON(cb, kCbToG)));
+	d.b = mulChromaNEON(cb, kCbToB);
+}
+
+static inline void splitChromaNEON(ChromaNEON &lo, ChromaNEON &hi, const ChromaNEON &d) {
+	const int16x8x2_t r = vzipq_s16(d.r, d.r);
+	const int16x8x2_t g = vzipq_s16(d.g, d.g);
+	const int16x8x2_t b = vzipq_s16(d.b, d.b);
+	lo.r = r.val[0];
+	lo.g = g.val[0];
+	lo.b = b.val[0];
+	hi.r = r.val[1];
+	hi.g = g.val[1];
+	hi.b = b.val[1];
+}
+
+static inline uint16x8_t channelNEON(int16x8_t y, int16x8_t offset, const ChannelsNEON &c) {
+	int16x8_t x = vminq_s16(vmaxq_s16(vaddq_s16(y, offset), c.lumMin), c.lumMax);
+	if (c.itu)
+		return mulHighNEON(vreinterpretq_u16_s16(vshlq_n_s16(vsubq_s16(x, c.lumMin), 1)), kITUToFull);
+	return vreinterpretq_u16_s16(x);
+}
+
+static inline uint16x8_t addChannelNEON(uint16x8_t pixels, uint16x8_t x, int i, const ChannelsNEON &c) {
+	return vorrq_u16(pixels, vshlq_u16(vshlq_u16(x, c.loss[i]), c.shift16[i]));
+}
+
+/** Adds a channel to 32 bit pixels, given as two vectors of four pixels each. */
+static inline void addChannel32NEON(uint32x4_t &lo, uint32x4_t &hi, uint16x8_t x, int i, const ChannelsNEON &c) {
+	x = vshlq_u16(x, c.loss[i]);
+	lo = vorrq_u32(lo, vshlq_u32(vmovl_u16(vget_low_u16(x)), c.shift32[i]));
+	hi = vorrq_u32(hi, vshlq_u32(vmovl_u16(vget_high_u16(x)), c.shift32[i]));
+}
+
+static inline void put8To16NEON(uint16 *dst, int16x8_t y, const ChromaNEON &d, const ChannelsNEON &c) {
+	uint16x8_t pixels = c.fill16;
+	pixels = addChannelNEON(pixels, channelNEON(y, d.r, c), 0, c);
+	pixels = addChannelNEON(pixels, channelNEON(y, d.g, c), 1, c);
+	pixels = addChannelNEON(pixels, channelNEON(y, d.b, c), 2, c);
+	vst1q_u16(dst, pixels);
+}
+
+static inline void put8To32NEON(uint32 *dst, int16x8_t y, const ChromaNEON &d, const ChannelsNEON &c) {
+	uint32x4_t lo = c.fill32, hi = c.fill32;
+	addChannel32NEON(lo, hi, channelNEON(y, d.r, c), 0, c);
+	addChannel32NEON(lo, hi, channelNEON(y, d.g, c), 1, c);
+	addChannel32NEON(lo, hi, channelNEON(y, d.b, c), 2, c);
+	vst1q_u32(dst, lo);
+	vst1q_u32(dst + 4, hi);
+}
+
+static void convert444To16NEON(uint16 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsNEON c;
+	prepareNEON(c, tables);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		ChromaNEON d;
+		chromaNEON(d, load8NEON(uSrc + i), load8NEON(vSrc + i));
+		put8To16NEON(dst + i, load8NEON(ySrc + i), d, c);
+	}
+	convertYUV444ToRGB<uint16>(dst + i, ySrc + i, uSrc + i, vSrc + i, count - i, tables);
+}
+
+static void convert444To32NEON(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsNEON c;
+	prepareNEON(c, tables);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		ChromaNEON d;
+		chromaNEON(d, load8NEON(uSrc + i), load8NEON(vSrc + i));
+		put8To32NEON(dst + i, load8NEON(ySrc + i), d, c);
+	}
+	convertYUV444ToRGB<uint32>(dst + i, ySrc + i, uSrc + i, vSrc + i, count - i, tables);
+}
+
+static void convert420To16NEON(uint16 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsNEON c;
+	prepareNEON(c, tables);
+
+	uint16 *dst2 = (uint16 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		ChromaNEON d, lo, hi;
+		chromaNEON(d, load8NEON(uSrc + i / 2), load8NEON(vSrc + i / 2));
+		splitChromaNEON(lo, hi, d);
+		put8To16NEON(dst + i, load8NEON(ySrc + i), lo, c);
+		put8To16NEON(dst + i + 8, load8NEON(ySrc + i + 8), hi, c);
+		put8To16NEON(dst2 + i, load8NEON(ySrc2 + i), lo, c);
+		put8To16NEON(dst2 + i + 8, load8NEON(ySrc2 + i + 8), hi, c);
+	}
+	convertYUV420ToRGB<uint16>(dst + i, dstPitch, ySrc + i, yPitch, uSrc + i / 2, vSrc + i / 2, count - i, tables);
+}
+
+static void convert420To32NEON(uint32 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables) {
+	ChannelsNEON c;
+	prepareNEON(c, tables);
+
+	uint32 *dst2 = (uint32 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		ChromaNEON d, lo, hi;
+		chromaNEON(d, load8NEON(uSrc + i / 2), load8NEON(vSrc + i / 2));
+		splitChromaNEON(lo, hi, d);
+		put8To32NEON(dst + i, load8NEON(ySrc + i), lo, c);
+		put8To32NEON(dst + i + 8, load8NEON(ySrc + i + 8), hi, c);
+		put8To32NEON(dst2 + i, load8NEON(ySrc2 + i), lo, c);
+		put8To32NEON(dst2 + i + 8, load8NEON(ySrc2 + i + 8), hi, c);
+	}
+	convertYUV420ToRGB<uint32>(dst + i, dstPitch, ySrc + i, yPitch, uSrc + i / 2, vSrc + i / 2, count - i, tables);
+}
+
+static const YUVToRGBKernels s_neonKernels = {
+	convert444To16NEON,
+	convert444To32NEON,
+	convert420To16NEON,
+	convert420To32NEON
+};
+
+#endif // SCUMMVM_SIMD_NEON
+
+#pragma mark -
+
+const YUVToRGBKernels *getYUVToRGBKernels(YUVToRGBKernelType type) {
+	switch (type) {
+	case kYUVToRGBKernelsScalar:
+		return &s_scalarKernels;
+#if defined(SCUMMVM_SIMD_X86)
+	case kYUVToRGBKernelsSSE2:
+		return Common::hasCPUFeature(Common::kCPUFeatureSSE2) ? &s_sse2Kernels : 0;
+	case kYUVToRGBKernelsAVX2:
+		return Common::hasCPUFeature(Common::kCPUFeatureAVX2) ? &s_avx2Kernels : 0;
+#endif
+#if defined(SCUMMVM_SIMD_NEON)
+	case kYUVToRGBKernelsNEON:
+		return Common::hasCPUFeature(Common::kCPUFeatureNEON) ? &s_neonKernels : 0;
+#endif
+	default:
+		return 0;
+	}
+}
+
+const YUVToRGBKernels &getBestYUVToRGBKernels() {
+	for (int type = kYUVToRGBKernelsCount - 1; type > kYUVToRGBKernelsScalar; --type) {
+		const YUVToRGBKernels *kernels = getYUVToRGBKernels((YUVToRGBKernelType)type);
+		if (kernels)
+			return *kernels;
+	}
+
+	return s_scalarKernels;
+}
+
+#pragma mark -
+#pragma mark --- YUVToRGBManager ---
+#pragma mark -
+
+/** Converts a band of rows of an image, see YUVToRGBManager::convert(). */
+class YUVToRGBManager::ConversionJob : public Common::WorkerJob {
+public:
+	Subsampling subsampling;
+	const YUVToRGBKernels *kernels;
+	const YUVToRGBTables *tables;
+	byte *dst;
+	int dstPitch;
+	const byte *ySrc;
+	const byte *uSrc;
+	const byte *vSrc;
+	int yWidth;
+	int yHeight;
+	int yPitch;
+	int uvPitch;
+
+	virtual void run();
+};
+
+void YUVToRGBManager::ConversionJob::run() {
+	const bool is16 = (tables->format.bytesPerPixel == 2);
+	byte *dstPtr = dst;
+	const byte *yPtr = ySrc, *uPtr = uSrc, *vPtr = vSrc;
+
+	switch (subsampling) {
+	case kSubsampling444:
+		for (int h = 0; h < yHeight; h++) {
+			if (is16)
+				kernels->convert444To16((uint16 *)dstPtr, yPtr, uPtr, vPtr, yWidth, *tables);
+			else
+				kernels->convert444To32((uint32 *)dstPtr, yPtr, uPtr, vPtr, yWidth, *tables);
+
+			dstPtr += dstPitch;
+			yPtr += yPitch;
+			uPtr += uvPitch;
+			vPtr += uvPitch;
+		}
+		break;
+	case kSubsampling420:
+		for (int h = 0; h < yHeight; h += 2) {
+			if (is16)
+				kernels->convert420To16((uint16 *)dstPtr, dstPitch, yPtr, yPitch, uPtr, vPtr, yWidth, *tables);
+			else
+				kernels->convert420To32((uint32 *)dstPtr, dstPitch, yPtr, yPitch, uPtr, vPtr, yWidth, *tables);
+
+			dstPtr += dstPitch * 2;
+			yPtr += yPitch * 2;
+			uPtr += uvPitch;
+			vPtr += uvPitch;
+		}
+		break;
+	case kSubsampling410:
+		if (is16)
+			convertYUV410ToRGB<uint16>(dstPtr, dstPitch, *tables, yPtr, uPtr, vPtr, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV410ToRGB<uint32>(dstPtr, dstPitch, *tables, yPtr, uPtr, vPtr, yWidth, yHeight, yPitch, uvPitch);
+		break;
+	}
+}
+
+YUVToRGBManager::YUVToRGBManager() : _pool(0), _kernels(getBestYUVToRGBKernels()) {
+}
+
+YUVToRGBManager::~YUVToRGBManager() {
+	delete _pool;
+	for (uint i = 0; i < _tables.size(); i++)
+		delete _tables[i];
+}
+
+const YUVToRGBTables *YUVToRGBManager::getTables(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
+	Common::StackLock lock(_mutex);
+
+	const YUVToRGBTables *tables = 0;
+	for (uint i = 0; i < _tables.size() && !tables; i++)
+		if (_tables[i]->format == format && _tables[i]->scale == scale)
+			tables = _tables[i];
+
+	if (!tables) {
+		_tables.push_back(new YUVToRGBTables());
+		_tables.back()->init(format, scale);
+		tables = _tables.back();
+	}
+
+	return tables;
+}
+
+Common::WorkerPool *YUVToRGBManager::getPool() {
+	Common::StackLock lock(_mutex);
+
+	if (!_pool)
+		_pool = new Common::WorkerPool(kConversionThreads);
+
+	return _pool;
+}
+
+void YUVToRGBManager::convert(Subsampling subsampling, Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const YUVToRGBTables *tables = getTables(dst->format, scale);
+
+	// The number of rows sharing a row of chroma values, bands must not
+	// split them
+	const int chromaRows = (subsampling == kSubsampling410) ? 4 : (subsampling == kSubsampling420) ? 2 : 1;
+
+	Common::WorkerPool *pool = 0;
+	int numBands = 1;
+	if (yWidth * yHeight >= kThreadedPixels) {
+		pool = getPool();
+		if (pool->isThreaded())
+			numBands = kConversionThreads + 1;
+	}
+
+	const int bandHeight = (yHeight / chromaRows + numBands - 1) / numBands * chromaRows;
+
+	ConversionJob jobs[kConversionThreads + 1];
+	Common::WorkerJob *workerJobs[kConversionThreads + 1];
+	uint count = 0;
+	for (int y = 0; y < yHeight; y += bandHeight) {
+		ConversionJob &job = jobs[count];
+		job.subsampling = subsampling;
+		job.kernels = &_kernels;
+		job.tables = tables;
+		job.dst = (byte *)dst->getBasePtr(0, y);
+		job.dstPitch = dst->pitch;
+		job.ySrc = ySrc + y * yPitch;
+		job.uSrc = uSrc + y / chromaRows * uvPitch;
+		job.vSrc = vSrc + y / chromaRows * uvPitch;
+		job.yWidth = yWidth;
+		job.yHeight = MIN(bandHeight, yHeight - y);
+		job.yPitch = yPitch;
+		job.uvPitch = uvPitch;
+		workerJobs[count++] = &job;
+	}
+
+	if (pool)
+		pool->runAll(workerJobs, count);
+	else if (count)
+		jobs[0].run();
+}
+
+void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(ySrc && uSrc && vSrc);
+
+	convert(kSubsampling444, dst, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(ySrc && uSrc && vSrc);
+	assert((yWidth & 1) == 0);
+	assert((yHeight & 1) == 0);
+
+	convert(kSubsampling420, dst, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
 
 void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
@@ -374,13 +1145,7 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 3) == 0);
 	assert((yHeight & 3) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	convert(kSubsampling410, dst, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
@@ -39,12 +39,19 @@
 #define GRAPHICS_YUV_TO_RGB_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/mutex.h"
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
+namespace Common {
+class WorkerPool;
+}
+
 namespace Graphics {
 
-class YUVToRGBLookup;
+struct YUVToRGBKernels;
+struct YUVToRGBTables;
 
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
@@ -110,10 +117,34 @@ private:
 	YUVToRGBManager();
 	~YUVToRGBManager();
 
-	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale);
+	enum Subsampling {
+		kSubsampling444,
+		kSubsampling420,
+		kSubsampling410
+	};
+
+	class ConversionJob;
+
+	/**
+	 * Convert an image with the given chroma subsampling. Large images are
+	 * split into bands of rows, which are converted on several threads.
+	 */
+	void convert(Subsampling subsampling, Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
+	const YUVToRGBTables *getTables(Graphics::PixelFormat format, LuminanceScale scale);
+	Common::WorkerPool *getPool();
+
+	/**
+	 * The tables of all formats used so far. Videos may be converted on
+	 * worker threads, so the tables and the pool are guarded by _mutex and
+	 * kept around until the manager is destroyed. Deleting the pool waits
+	 * for its threads to finish.
+	 */
+	Common::Array<YUVToRGBTables *> _tables;
+	Common::WorkerPool *_pool;
+	Common::Mutex _mutex;
 
-	YUVToRGBLookup *_lookup;
-	int16 _colorTab[4 * 256]; // 2048 bytes
+	const YUVToRGBKernels &_kernels;
 };
 
 } // End of namespace Graphics
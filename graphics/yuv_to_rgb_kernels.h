@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_KERNELS_H
+#define GRAPHICS_YUV_TO_RGB_KERNELS_H
+
+#include "common/scummsys.h"
+#include "graphics/pixelformat.h"
+#include "graphics/yuv_to_rgb.h"
+
+namespace Graphics {
+
+/**
+ * The lookup tables of a YUV to RGB conversion into one pixel format,
+ * along with the channel layout the SIMD kernels compute the same pixels
+ * from.
+ */
+struct YUVToRGBTables {
+	PixelFormat format;
+	YUVToRGBManager::LuminanceScale scale;
+
+	/** The offsets of the chroma values into rgbToPix */
+	int16 colorTab[4 * 256];
+
+	/** The pixel bits of every red, green and blue value, clamped at both ends */
+	uint32 rgbToPix[3 * 768];
+
+	/** The bits set in every pixel, i.e. the opaque alpha */
+	uint32 fill;
+
+	/** Loss and shift of the red, green and blue channel */
+	byte loss[3];
+	byte shift[3];
+
+	void init(const PixelFormat &dstFormat, YUVToRGBManager::LuminanceScale lumScale);
+};
+
+/**
+ * The inner loops of YUVToRGBManager, in a plain C++ version using the
+ * lookup tables and, where available, SIMD versions computing the channels
+ * with fixed point arithmetic. All versions produce the same pixels.
+ */
+struct YUVToRGBKernels {
+	/** Converts count pixels with one chroma value each. */
+	void (*convert444To16)(uint16 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables);
+	void (*convert444To32)(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables);
+
+	/**
+	 * Converts two rows of count pixels, which share one chroma value
+	 * for each two pixels. count must be even, the pitches are in bytes.
+	 */
+	void (*convert420To16)(uint16 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables);
+	void (*convert420To32)(uint32 *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBTables &tables);
+};
+
+enum YUVToRGBKernelType {
+	kYUVToRGBKernelsScalar,
+	kYUVToRGBKernelsSSE2,
+	kYUVToRGBKernelsAVX2,
+	kYUVToRGBKernelsNEON,
+
+	kYUVToRGBKernelsCount
+};
+
+/**
+ * Returns the given kernel implementation, or 0 if it is not supported by
+ * the CPU or was not compiled in.
+ */
+const YUVToRGBKernels *getYUVToRGBKernels(YUVToRGBKernelType type);
+
+/**
+ * Returns the fastest kernel implementation supported by the CPU.
+ */
+const YUVToRGBKernels &getBestYUVToRGBKernels();
+
+} // End of namespace Graphics
+
+#endif
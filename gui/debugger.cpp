@@ -25,6 +25,7 @@
 
 #include "common/debug-channels.h"
 #include "common/system.h"
+#include "common/timer.h"
 
 #include "engines/engine.h"
 
@@ -64,6 +65,8 @@ Debugger::Debugger() {
 	DCmd_Register("debugflag_list",		WRAP_METHOD(Debugger, Cmd_DebugFlagsList));
 	DCmd_Register("debugflag_enable",	WRAP_METHOD(Debugger, Cmd_DebugFlagEnable));
 	DCmd_Register("debugflag_disable",	WRAP_METHOD(Debugger, Cmd_DebugFlagDisable));
+
+	DCmd_Register("timer_stats",		WRAP_METHOD(Debugger, Cmd_TimerStats));
 }
 
 Debugger::~Debugger() {
@@ -537,6 +540,35 @@ bool Debugger::Cmd_DebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::Cmd_TimerStats(int argc, const char **argv) {
+	Common::TimerManager *timerManager = g_system->getTimerManager();
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		timerManager->resetTimerInfo();
+		DebugPrintf("Timer statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		DebugPrintf("timer_stats [reset]\n");
+		return true;
+	}
+
+	const Common::TimerManager::TimerInfoList timers = timerManager->getTimerInfo();
+	if (timers.empty()) {
+		DebugPrintf("No timer statistics available\n");
+		return true;
+	}
+
+	// All times in milliseconds, except for the interval
+	DebugPrintf("%-24s %11s %8s %6s %8s %8s %8s %8s\n", "id", "interval_us", "calls", "late", "avglate", "maxlate", "avgtime", "maxtime");
+	for (Common::TimerManager::TimerInfoList::const_iterator i = timers.begin(); i != timers.end(); ++i) {
+		const uint32 calls = MAX<uint32>(i->calls, 1);
+		DebugPrintf("%-24s %11d %8u %6u %8u %8u %8u %8u\n", i->id.c_str(), i->interval,
+				i->calls, i->lateCalls, i->totalLateness / calls, i->maxLateness,
+				i->totalDuration / calls, i->maxDuration);
+	}
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
@@ -47,7 +47,10 @@ enum {
 	// Upper bound (im milliseconds) we want to spend in handleTickle.
 	// Setting this low makes the GUI more responsive but also slows
 	// down the scanning.
-	kMaxScanTime = 50
+	kMaxScanTime = 50,
+
+	// Number of directories handed to the detectors at once.
+	kScanBatchSize = 8
 };
 
 enum {
@@ -176,75 +179,84 @@ void MassAddDialog::handleTickle() {
 
 	uint32 t = g_system->getMillis();
 
-	// Perform a breadth-first scan of the filesystem.
+	// Perform a breadth-first scan of the filesystem. Several directories
+	// are scanned at once, so the detectors can run on them concurrently.
 	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
-
-		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
-			continue;
-		}
-
-		// Run the detector on the dir
-		GameList candidates(EngineMan.detectGames(files));
-
-		// Just add all detected games / game variants. If we get more than one,
-		// that either means the directory contains multiple games, or the detector
-		// could not fully determine which game variant it was seeing. In either
-		// case, let the user choose which entries he wants to keep.
-		//
-		// However, we only add games which are not already in the config file.
-		for (GameList::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
-			GameDescriptor result = *cand;
-			Common::String path = dir.getPath();
-
-			// Remove trailing slashes
-			while (path != "/" && path.lastChar() == '/')
-				path.deleteLastChar();
-
-			// Check for existing config entries for this path/gameid/lang/platform combination
-			if (_pathToTargets.contains(path)) {
-				bool duplicate = false;
-				const StringArray &targets = _pathToTargets[path];
-				for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
-					// If the gameid, platform and language match -> skip it
-					Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
-					assert(dom);
-
-					if ((*dom)["gameid"] == result["gameid"] &&
-					    (*dom)["platform"] == result["platform"] &&
-					    (*dom)["language"] == result["language"]) {
-						duplicate = true;
-						break;
+		Common::FSList dirs;
+		while (!_scanStack.empty() && dirs.size() < kScanBatchSize)
+			dirs.push_back(_scanStack.pop());
+
+		Common::Array<GameList> dirCandidates;
+		Common::Array<Common::FSList> dirContents;
+		Common::Array<bool> dirListed;
+		EngineMan.detectGamesInDirectories(dirs, dirCandidates, dirContents, dirListed);
+
+		for (uint i = 0; i < dirs.size(); i++) {
+			if (!dirListed[i])
+				continue;
+
+			const Common::FSNode &dir = dirs[i];
+			const Common::FSList &files = dirContents[i];
+			const GameList &candidates = dirCandidates[i];
+
+			// Just add all detected games / game variants. If we get more than one,
+			// that either means the directory contains multiple games, or the detector
+			// could not fully determine which game variant it was seeing. In either
+			// case, let the user choose which entries he wants to keep.
+			//
+			// However, we only add games which are not already in the config file.
+			for (GameList::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
+				GameDescriptor result = *cand;
+				Common::String path = dir.getPath();
+
+				// Remove trailing slashes
+				while (path != "/" && path.lastChar() == '/')
+					path.deleteLastChar();
+
+				// Check for existing config entries for this path/gameid/lang/platform combination
+				if (_pathToTargets.contains(path)) {
+					bool duplicate = false;
+					const StringArray &targets = _pathToTargets[path];
+					for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
+						// If the gameid, platform and language match -> skip it
+						Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
+						assert(dom);
+
+						if ((*dom)["gameid"] == result["gameid"] &&
+						    (*dom)["platform"] == result["platform"] &&
+						    (*dom)["language"] == result["language"]) {
+							duplicate = true;
+							break;
+						}
+					}
+					if (duplicate) {
+						_oldGamesCount++;
+						break;	// Skip duplicates
 					}
 				}
-				if (duplicate) {
-					_oldGamesCount++;
-					break;	// Skip duplicates
-				}
-			}
-			result["path"] = path;
-			_games.push_back(result);
+				result["path"] = path;
+				_games.push_back(result);
 
-			_list->append(result.description());
-		}
+				_list->append(result.description());
+			}
 
 
-		// Recurse into all subdirs
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			if (file->isDirectory()) {
-				_scanStack.push(*file);
+			// Recurse into all subdirs
+			for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+				if (file->isDirectory()) {
+					_scanStack.push(*file);
 
-				_dirTotal++;
+					_dirTotal++;
+				}
 			}
-		}
 
-		_dirsScanned++;
+			_dirsScanned++;
 
 #if defined(USE_TASKBAR)
-		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
-		g_system->getTaskbarManager()->setCount(_games.size());
+			g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
+			g_system->getTaskbarManager()->setCount(_games.size());
 #endif
+		}
 	}
 
 
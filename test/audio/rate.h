@@ -0,0 +1,384 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/rate_kernels.h"
+#include "audio/mixer.h"
+#include "audio/decoders/raw.h"
+
+#include "common/frac.h"
+#include "common/stream.h"
+#include "common/util.h"
+
+#include <math.h>
+
+/**
+ * A stand-in for QueuingAudioStream, which needs OSystem mutexes. It runs
+ * empty until more data is queued, and only ends once it is finished.
+ */
+class TestQueueStream : public Audio::AudioStream {
+	const int16 *_data;
+	int _left;
+	bool _finished;
+
+public:
+	TestQueueStream() : _data(0), _left(0), _finished(false) {}
+
+	void queue(const int16 *data, int samples) { _data = data; _left = samples; }
+	void finish() { _finished = true; }
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const int samples = MIN(numSamples, _left);
+		memcpy(buffer, _data, samples * 2);
+		_data += samples;
+		_left -= samples;
+		return samples;
+	}
+	bool isStereo() const { return false; }
+	int getRate() const { return 22050; }
+	bool endOfData() const { return _left == 0; }
+	bool endOfStream() const { return _finished && _left == 0; }
+};
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int16 nextSample() {
+		_seed = _seed * 1103515245 + 12345;
+		// Favor the extremes, which is where saturation and overflow bugs hide
+		switch ((_seed >> 8) & 7) {
+		case 0:
+			return 32767;
+		case 1:
+			return -32768;
+		default:
+			return (int16)(_seed >> 16);
+		}
+	}
+
+	void fill(int16 *buf, uint count) {
+		for (uint i = 0; i < count; ++i)
+			buf[i] = nextSample();
+	}
+
+	void compareKernels(const Audio::RateKernels &kernels, const Audio::RateKernels &reference) {
+		const uint maxCount = 301;
+		int16 src[maxCount * 2];
+		int16 dst[maxCount * 2], ref[maxCount * 2];
+		int32 accum[maxCount * 2], accumRef[maxCount * 2];
+		static const Audio::st_volume_t volumes[] = { 0, 1, 77, 128, 255, 256 };
+
+		for (uint count = 0; count < maxCount; count += 7) {
+			for (uint v = 0; v < ARRAYSIZE(volumes); ++v) {
+				const Audio::st_volume_t volL = volumes[v];
+				const Audio::st_volume_t volR = volumes[ARRAYSIZE(volumes) - 1 - v];
+
+				fill(src, count * 2);
+				fill(dst, count * 2);
+				memcpy(ref, dst, sizeof(ref));
+				kernels.mixStereo(dst, src, count, volL, volR);
+				reference.mixStereo(ref, src, count, volL, volR);
+				TS_ASSERT_EQUALS(memcmp(dst, ref, count * 4), 0);
+
+				kernels.mixStereoReverse(dst, src, count, volL, volR);
+				reference.mixStereoReverse(ref, src, count, volL, volR);
+				TS_ASSERT_EQUALS(memcmp(dst, ref, count * 4), 0);
+
+				kernels.mixMono(dst, src, count, volL, volR);
+				reference.mixMono(ref, src, count, volL, volR);
+				TS_ASSERT_EQUALS(memcmp(dst, ref, count * 4), 0);
+
+				// Start from a bus holding a few loud channels already
+				for (uint i = 0; i < count * 2; ++i)
+					accum[i] = accumRef[i] = nextSample() * 256 * 3;
+				kernels.accumStereo(accum, src, count, volL, volR);
+				reference.accumStereo(accumRef, src, count, volL, volR);
+				kernels.accumStereoReverse(accum, src, count, volL, volR);
+				reference.accumStereoReverse(accumRef, src, count, volL, volR);
+				kernels.accumMono(accum, src, count, volL, volR);
+				reference.accumMono(accumRef, src, count, volL, volR);
+				TS_ASSERT_EQUALS(memcmp(accum, accumRef, count * 8), 0);
+
+				kernels.clip(dst, accum, count * 2);
+				reference.clip(ref, accum, count * 2);
+				TS_ASSERT_EQUALS(memcmp(dst, ref, count * 4), 0);
+			}
+
+			int16 coefs[maxCount];
+			fill(src, count);
+			fill(coefs, count);
+			for (uint i = 0; i < count; ++i) {
+				// The sinc tables never contain -32768
+				if (coefs[i] == -32768)
+					coefs[i] = -32767;
+			}
+			TS_ASSERT_EQUALS(kernels.dotProduct(src, coefs, count), reference.dotProduct(src, coefs, count));
+		}
+	}
+
+	// The linear rate converter as it was before using the rate kernels,
+	// to verify that its output did not change.
+	void referenceLinear(const int16 *in, uint inSamples, int16 *out, uint outFrames, bool stereo, bool reverseStereo,
+	                     Audio::st_rate_t inrate, Audio::st_rate_t outrate, Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		const frac_t oposInc = (inrate << FRAC_BITS) / outrate;
+		frac_t opos = FRAC_ONE;
+		int16 last0 = 0, last1 = 0, cur0 = 0, cur1 = 0;
+		const int16 *inEnd = in + inSamples;
+		int16 *outEnd = out + outFrames * 2;
+
+		while (out < outEnd) {
+			while ((frac_t)FRAC_ONE <= opos) {
+				if (in == inEnd)
+					return;
+				last0 = cur0;
+				cur0 = *in++;
+				if (stereo) {
+					last1 = cur1;
+					cur1 = *in++;
+				}
+				opos -= FRAC_ONE;
+			}
+
+			while (opos < (frac_t)FRAC_ONE && out < outEnd) {
+				int16 out0 = (int16)(last0 + (((cur0 - last0) * opos + FRAC_HALF) >> FRAC_BITS));
+				int16 out1 = stereo ? (int16)(last1 + (((cur1 - last1) * opos + FRAC_HALF) >> FRAC_BITS)) : out0;
+				Audio::clampedAdd(out[reverseStereo    ], (out0 * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+				Audio::clampedAdd(out[reverseStereo ^ 1], (out1 * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+				out += 2;
+				opos += oposInc;
+			}
+		}
+	}
+
+	void linearConverterTest(bool stereo, bool reverseStereo, Audio::st_rate_t inrate, Audio::st_rate_t outrate) {
+		const uint inFrames = 5000;
+		const uint inSamples = inFrames * (stereo ? 2 : 1);
+		const uint outFrames = inFrames * outrate / inrate + 1000;
+
+		int16 *in = (int16 *)malloc(inSamples * 2);
+		fill(in, inSamples);
+
+		int16 *out = new int16[outFrames * 2];
+		int16 *ref = new int16[outFrames * 2];
+		fill(out, outFrames * 2);
+		memcpy(ref, out, outFrames * 4);
+
+		referenceLinear(in, inSamples, ref, outFrames, stereo, reverseStereo, inrate, outrate, 200, 256);
+
+		Audio::AudioStream *stream = Audio::makeRawStream((const byte *)in, inSamples * 2, inrate,
+		                                                  Audio::FLAG_16BITS | (stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+		                                                  | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                                                  , DisposeAfterUse::YES);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inrate, outrate, stereo, reverseStereo);
+
+		// Pull the output in uneven chunks, to cross buffer boundaries
+		uint pos = 0;
+		while (pos < outFrames) {
+			const uint chunk = MIN<uint>(outFrames - pos, 333);
+			const int got = converter->flow(*stream, out + pos * 2, chunk, 200, 256);
+			pos += got;
+			if (got < (int)chunk)
+				break;
+		}
+
+		TS_ASSERT_EQUALS(memcmp(out, ref, outFrames * 4), 0);
+
+		delete converter;
+		delete stream;
+		delete[] out;
+		delete[] ref;
+	}
+
+	Audio::AudioStream *makeStream(int16 *data, uint samples, Audio::st_rate_t rate, bool stereo) {
+		return Audio::makeRawStream((const byte *)data, samples * 2, rate,
+		                            Audio::FLAG_16BITS | (stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+		                            | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                            , DisposeAfterUse::YES);
+	}
+
+	// Runs the whole stream through the converter, returns the number of frames
+	uint convert(Audio::RateConverter *converter, Audio::AudioStream *stream, int16 *out, uint maxFrames) {
+		memset(out, 0, maxFrames * 4);
+
+		uint pos = 0;
+		while (pos < maxFrames) {
+			const uint chunk = MIN<uint>(maxFrames - pos, 333);
+			const int got = converter->flow(*stream, out + pos * 2, chunk, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			pos += got;
+			if (got == 0)
+				break;
+		}
+
+		return pos;
+	}
+
+public:
+	void setUp() {
+		_seed = 0x2468ace1;
+	}
+
+	void test_kernels_match_scalar() {
+		const Audio::RateKernels *reference = Audio::getRateKernels(Audio::kRateKernelsScalar);
+		TS_ASSERT(reference != 0);
+
+		for (int type = 0; type < Audio::kRateKernelsCount; ++type) {
+			const Audio::RateKernels *kernels = Audio::getRateKernels((Audio::RateKernelType)type);
+			if (kernels)
+				compareKernels(*kernels, *reference);
+		}
+	}
+
+	void test_mix_bus_full_volume() {
+		// A single channel at full volume must pass the mix bus unchanged
+		const Audio::RateKernels &kernels = Audio::getBestRateKernels();
+		const uint count = 123;
+		int16 src[count * 2], dst[count * 2];
+		int32 accum[count * 2];
+
+		fill(src, count * 2);
+		memset(accum, 0, sizeof(accum));
+		kernels.accumStereo(accum, src, count, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		kernels.clip(dst, accum, count * 2);
+		TS_ASSERT_EQUALS(memcmp(dst, src, sizeof(src)), 0);
+	}
+
+	void test_mix_bus_clips_sum_only() {
+		// Two loud channels cancelling each other must not be clipped
+		const Audio::RateKernels &kernels = Audio::getBestRateKernels();
+		const uint count = 40;
+		int16 loud[count * 2], negative[count * 2], dst[count * 2];
+		int32 accum[count * 2];
+
+		for (uint i = 0; i < count * 2; ++i) {
+			loud[i] = 30000;
+			negative[i] = -20000;
+		}
+
+		memset(accum, 0, sizeof(accum));
+		kernels.accumStereo(accum, loud, count, 256, 256);
+		kernels.accumStereo(accum, loud, count, 256, 256);
+		kernels.accumStereo(accum, negative, count, 256, 256);
+		kernels.accumStereo(accum, negative, count, 256, 256);
+		kernels.clip(dst, accum, count * 2);
+		for (uint i = 0; i < count * 2; ++i)
+			TS_ASSERT_EQUALS(dst[i], 20000);
+
+		kernels.accumStereo(accum, loud, count, 256, 256);
+		kernels.clip(dst, accum, count * 2);
+		for (uint i = 0; i < count * 2; ++i)
+			TS_ASSERT_EQUALS(dst[i], 32767);
+	}
+
+	void test_sinc_converter_dc() {
+		// Each filter phase has unity gain, so constant input must come out
+		// unchanged once the filter is filled
+		const uint inFrames = 2000;
+		const uint maxFrames = 5000;
+
+		for (int quality = Audio::kRateQualityLow; quality <= Audio::kRateQualityHigh; ++quality) {
+			int16 *in = (int16 *)malloc(inFrames * 4);
+			for (uint i = 0; i < inFrames; ++i) {
+				in[i * 2] = 1000;
+				in[i * 2 + 1] = -2000;
+			}
+
+			Audio::AudioStream *stream = makeStream(in, inFrames * 2, 22050, true);
+			Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, true, true, (Audio::RateQuality)quality);
+			int16 *out = new int16[maxFrames * 2];
+			const uint frames = convert(converter, stream, out, maxFrames);
+
+			TS_ASSERT_LESS_THAN(3990u, frames);
+			for (uint i = 100; i < frames - 100; ++i) {
+				TS_ASSERT_EQUALS(out[i * 2], -2000);
+				TS_ASSERT_EQUALS(out[i * 2 + 1], 1000);
+			}
+
+			delete converter;
+			delete stream;
+			delete[] out;
+		}
+	}
+
+	void test_sinc_converter_sine() {
+		// A 1 kHz sine must be reproduced closely at the right position
+		const Audio::st_rate_t inrate = 11025, outrate = 48000;
+		const uint inFrames = 4000;
+		const uint maxFrames = inFrames * outrate / inrate + 100;
+
+		int16 *in = (int16 *)malloc(inFrames * 2);
+		for (uint i = 0; i < inFrames; ++i)
+			in[i] = (int16)(16000 * sin(2 * M_PI * 1000 * i / inrate));
+
+		Audio::AudioStream *stream = makeStream(in, inFrames, inrate, false);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inrate, outrate, false, false, Audio::kRateQualityHigh);
+		int16 *out = new int16[maxFrames * 2];
+		const uint frames = convert(converter, stream, out, maxFrames);
+
+		const uint expected = inFrames * outrate / inrate;
+		TS_ASSERT_LESS_THAN(expected - 8, frames);
+		TS_ASSERT_LESS_THAN(frames, expected + 8);
+
+		int maxError = 0;
+		for (uint i = 500; i < frames - 500; ++i) {
+			const int ideal = (int)(16000 * sin(2 * M_PI * 1000 * i / outrate));
+			maxError = MAX(maxError, ABS(out[i * 2] - ideal));
+			TS_ASSERT_EQUALS(out[i * 2], out[i * 2 + 1]);
+		}
+		TS_ASSERT_LESS_THAN(maxError, 32);
+
+		delete converter;
+		delete stream;
+		delete[] out;
+	}
+
+	void test_sinc_converter_underrun() {
+		// A queue running empty for a moment must not end the output
+		const uint inFrames = 2000;
+		const uint maxFrames = 5000;
+		int16 in[inFrames];
+		for (uint i = 0; i < inFrames; ++i)
+			in[i] = 1000;
+
+		TestQueueStream stream;
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, false, false, Audio::kRateQualityMedium);
+		int16 *out = new int16[maxFrames * 2];
+
+		stream.queue(in, inFrames);
+		const uint first = convert(converter, &stream, out, maxFrames);
+		TS_ASSERT_LESS_THAN(3900u, first);
+		TS_ASSERT(stream.endOfData());
+
+		stream.queue(in, inFrames);
+		stream.finish();
+		const uint second = convert(converter, &stream, out, maxFrames);
+		TS_ASSERT_LESS_THAN(3990u, second);
+		TS_ASSERT_LESS_THAN(first + second, 2 * inFrames * 2 + 8);
+
+		// The second buffer continues the first one without a gap
+		for (uint i = 0; i < second - 100; ++i) {
+			TS_ASSERT_EQUALS(out[i * 2], 1000);
+		}
+
+		delete converter;
+		delete[] out;
+	}
+
+	void test_linear_converter_mono() {
+		linearConverterTest(false, false, 11025, 44100);
+		linearConverterTest(false, false, 22050, 48000);
+	}
+
+	void test_linear_converter_stereo() {
+		linearConverterTest(true, false, 22050, 44100);
+		linearConverterTest(true, false, 48000, 44100);
+	}
+
+	void test_linear_converter_reverse_stereo() {
+		linearConverterTest(true, true, 32000, 44100);
+	}
+};
@@ -3,6 +3,9 @@
 #include "audio/decoders/raw.h"
 #include "audio/audiostream.h"
 
+#include "common/bufferedstream.h"
+#include "common/memstream.h"
+
 #include "helper.h"
 
 class RawStreamTestSuite : public CxxTest::TestSuite
@@ -288,4 +291,26 @@ public:
 	void test_seek_stereo() {
 		seekTest(11025, 2, true);
 	}
+
+	void test_compressed_or_file_backed() {
+		// Raw data in memory is cheap to read
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, false, false);
+		TS_ASSERT(!s->isCompressedOrFileBacked());
+		delete[] sine;
+
+		// Wrappers ask the stream they wrap
+		Audio::AudioStream *looping = Audio::makeLoopingAudioStream(s, 0);
+		TS_ASSERT(!looping->isCompressedOrFileBacked());
+		delete looping;
+
+		// A stream which does not keep its data in memory counts as a file
+		byte *data = (byte *)malloc(1024);
+		memset(data, 0, 1024);
+		Common::SeekableReadStream *buffered = Common::wrapBufferedSeekableReadStream(
+			new Common::MemoryReadStream(data, 1024, DisposeAfterUse::YES), 256, DisposeAfterUse::YES);
+		s = Audio::makeRawStream(buffered, 11025, Audio::FLAG_16BITS, DisposeAfterUse::YES);
+		TS_ASSERT(s->isCompressedOrFileBacked());
+		delete s;
+	}
 };
@@ -0,0 +1,161 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the bit stream throughput of the stream backed Common::BitStream
+// and of the memory backed Common::BitStreamMemory, reading fields of mixed
+// widths and decoding Huffman symbols in Bink's layout.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/array.h"
+#include "common/bitstream.h"
+#include "common/huffman.h"
+#include "common/memstream.h"
+#include "common/util.h"
+
+#include "video/binkdata.h"
+
+#include <stdio.h>
+#include <time.h>
+
+namespace {
+
+const uint kDataSize = 1 << 20;
+const double kMinSeconds = 0.25;
+
+double seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** Field widths cycled through by the getBits() benchmark. */
+const uint8 kWidths[] = { 1, 4, 2, 8, 3, 1, 16, 5, 1, 7, 12, 2 };
+
+/** Reads mixed width fields until the data is used up, returns a checksum. */
+template<class BITSTREAM>
+uint32 readFields(BITSTREAM &bits, uint32 totalBits) {
+	uint32 check = 0, pos = 0;
+	for (uint i = 0; ; i = (i + 1) % ARRAYSIZE(kWidths)) {
+		if (pos + kWidths[i] > totalBits)
+			break;
+		check += bits.getBits(kWidths[i]);
+		pos += kWidths[i];
+	}
+	return check;
+}
+
+template<class BITSTREAM>
+uint32 decodeSymbols(BITSTREAM &bits, uint32 totalBits, const Common::Huffman<BITSTREAM> &huffman) {
+	// The longest Bink code is 8 bits long
+	uint32 check = 0;
+	while (bits.pos() + 8 <= totalBits)
+		check += huffman.getSymbol(bits);
+	return check;
+}
+
+/** Returns the number of Mbits read per second. */
+template<class BITSTREAM>
+double benchStream(const Common::Array<byte> &data, uint32 &check, const Common::Huffman<BITSTREAM> *huffman) {
+	double bitCount = 0, elapsed;
+	clock_t start = clock();
+	do {
+		Common::MemoryReadStream stream(data.begin(), data.size());
+		BITSTREAM bits(stream);
+		check += huffman ? decodeSymbols(bits, data.size() * 8, *huffman) : readFields(bits, data.size() * 8);
+		bitCount += bits.pos();
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+
+	return bitCount / elapsed / 1e6;
+}
+
+template<class BITSTREAM>
+double benchMemory(const Common::Array<byte> &data, uint32 &check, const Common::Huffman<BITSTREAM> *huffman) {
+	double bitCount = 0, elapsed;
+	clock_t start = clock();
+	do {
+		BITSTREAM bits(data.begin(), data.size());
+		check += huffman ? decodeSymbols(bits, data.size() * 8, *huffman) : readFields(bits, data.size() * 8);
+		bitCount += bits.pos();
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+
+	return bitCount / elapsed / 1e6;
+}
+
+template<class BITSTREAM, class MEMORYBITSTREAM>
+void benchLayout(const char *name, const Common::Array<byte> &data, uint32 &check) {
+	printf("  %-10s %10.1f", name, benchStream<BITSTREAM>(data, check, 0));
+	printf(" %10.1f\n", benchMemory<MEMORYBITSTREAM>(data, check, 0));
+}
+
+} // End of anonymous namespace
+
+int main(int argc, char *argv[]) {
+	Common::Array<byte> data;
+	data.resize(kDataSize);
+	uint32 seed = 1;
+	for (uint i = 0; i < data.size(); i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 24;
+	}
+
+	uint32 check = 0;
+	printf("Reading mixed width fields (Mbits per second):\n");
+	printf("  %-10s %10s %10s\n", "layout", "stream", "memory");
+	benchLayout<Common::BitStream8MSB, Common::BitStreamMemory8MSB>("8MSB", data, check);
+	benchLayout<Common::BitStream8LSB, Common::BitStreamMemory8LSB>("8LSB", data, check);
+	benchLayout<Common::BitStream16LEMSB, Common::BitStreamMemory16LEMSB>("16LEMSB", data, check);
+	benchLayout<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>("32LELSB", data, check);
+	benchLayout<Common::BitStream32BEMSB, Common::BitStreamMemory32BEMSB>("32BEMSB", data, check);
+
+	printf("Huffman decoding of the Bink codebooks (Mbits per second):\n");
+	printf("  %-10s %10s %10s\n", "codebook", "stream", "memory");
+	for (uint i = 0; i < 16; i++) {
+		const uint32 *codes = Video::binkHuffmanCodes[i];
+		const uint8 *lengths = Video::binkHuffmanLengths[i];
+		Common::Huffman<Common::BitStream32LELSB> streamHuffman(0, 16, codes, lengths);
+		Common::Huffman<Common::BitStreamMemory32LELSB> memoryHuffman(0, 16, codes, lengths);
+
+		printf("  %-10u %10.1f", i, benchStream(data, check, &streamHuffman));
+		printf(" %10.1f\n", benchMemory(data, check, &memoryHuffman));
+	}
+
+	// Keep the compiler from dropping the reading
+	if (check == 0xFFFFFFFF)
+		printf(" ");
+
+	// Both readers must see the same bits
+	uint32 streamCheck, memoryCheck;
+	{
+		Common::MemoryReadStream stream(data.begin(), data.size());
+		Common::BitStream32LELSB bits(stream);
+		streamCheck = readFields(bits, data.size() * 8);
+	}
+	{
+		Common::BitStreamMemory32LELSB bits(data.begin(), data.size());
+		memoryCheck = readFields(bits, data.size() * 8);
+	}
+	if (streamCheck != memoryCheck) {
+		printf("The readers read different bits\n");
+		return 1;
+	}
+
+	return 0;
+}
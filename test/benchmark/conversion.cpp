@@ -0,0 +1,163 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of crossBlit and of its conversion kernels for
+// the pixel format pairs commonly used by engines and video decoders.
+// Set SCUMMVM_DISABLE_SIMD to measure crossBlit without SIMD kernels.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "graphics/conversion.h"
+#include "graphics/conversion_kernels.h"
+#include "graphics/pixelformat.h"
+
+#include "common/util.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+namespace {
+
+const uint kWidth = 640;
+const uint kHeight = 480;
+const double kMinSeconds = 0.25;
+
+struct Format {
+	const char *name;
+	Graphics::PixelFormat format;
+};
+
+const Format kFormats[] = {
+	{ "RGB565",   Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+	{ "RGB555",   Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0) },
+	{ "ARGB8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24) },
+	{ "XRGB8888", Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0) },
+	{ "RGBA8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0) },
+	{ "ABGR8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24) }
+};
+
+struct Pair {
+	uint src, dst;
+};
+
+const Pair kPairs[] = {
+	{ 0, 3 }, { 0, 2 }, { 1, 0 }, { 1, 3 }, { 2, 0 }, { 3, 0 },
+	{ 2, 3 }, { 2, 4 }, { 2, 5 }, { 4, 2 }, { 5, 4 }
+};
+
+double seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** The per pixel conversion crossBlit used to do for every format pair. */
+template<typename SrcColor, typename DstColor>
+void convertGeneric(byte *dst, const byte *src, uint count, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+	for (uint i = 0; i < count; ++i) {
+		byte a, r, g, b;
+		srcFmt.colorToARGB(((const SrcColor *)src)[i], a, r, g, b);
+		((DstColor *)dst)[i] = dstFmt.ARGBToColor(a, r, g, b);
+	}
+}
+
+void convertGeneric(byte *dst, const byte *src, uint count, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+	if (srcFmt.bytesPerPixel == 2 && dstFmt.bytesPerPixel == 2)
+		convertGeneric<uint16, uint16>(dst, src, count, dstFmt, srcFmt);
+	else if (srcFmt.bytesPerPixel == 2)
+		convertGeneric<uint16, uint32>(dst, src, count, dstFmt, srcFmt);
+	else if (dstFmt.bytesPerPixel == 2)
+		convertGeneric<uint32, uint16>(dst, src, count, dstFmt, srcFmt);
+	else
+		convertGeneric<uint32, uint32>(dst, src, count, dstFmt, srcFmt);
+}
+
+void convertKernels(const Graphics::ConversionKernels &kernels, byte *dst, const byte *src, uint count, const Graphics::ConversionProgram &program,
+                    const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+	if (srcFmt.bytesPerPixel == 2 && dstFmt.bytesPerPixel == 2)
+		kernels.convert16To16((uint16 *)dst, (const uint16 *)src, count, program);
+	else if (srcFmt.bytesPerPixel == 2)
+		kernels.convert16To32((uint32 *)dst, (const uint16 *)src, count, program);
+	else if (dstFmt.bytesPerPixel == 2)
+		kernels.convert32To16((uint16 *)dst, (const uint32 *)src, count, program);
+	else if (program.isShuffle && kernels.shuffle32To32)
+		kernels.shuffle32To32((uint32 *)dst, (const uint32 *)src, count, program);
+	else
+		kernels.convert32To32((uint32 *)dst, (const uint32 *)src, count, program);
+}
+
+void benchPair(const Format &srcFormat, const Format &dstFormat, const byte *src, byte *dst) {
+	const Graphics::PixelFormat &srcFmt = srcFormat.format, &dstFmt = dstFormat.format;
+	Graphics::ConversionProgram program;
+	program.init(dstFmt, srcFmt);
+
+	printf("  %-8s -> %-8s", srcFormat.name, dstFormat.name);
+
+	double pixels = 0, elapsed;
+	clock_t start = clock();
+	do {
+		convertGeneric(dst, src, kWidth * kHeight, dstFmt, srcFmt);
+		pixels += kWidth * kHeight;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+	printf(" %8.1f", pixels / elapsed / 1e6);
+
+	for (int type = 0; type < Graphics::kConversionKernelsCount; ++type) {
+		const Graphics::ConversionKernels *kernels = Graphics::getConversionKernels((Graphics::ConversionKernelType)type);
+		if (!kernels) {
+			printf(" %8s", "-");
+			continue;
+		}
+
+		pixels = 0;
+		start = clock();
+		do {
+			convertKernels(*kernels, dst, src, kWidth * kHeight, program, dstFmt, srcFmt);
+			pixels += kWidth * kHeight;
+		} while ((elapsed = seconds(start)) < kMinSeconds);
+		printf(" %8.1f", pixels / elapsed / 1e6);
+	}
+
+	pixels = 0;
+	start = clock();
+	do {
+		Graphics::crossBlit(dst, src, kWidth * dstFmt.bytesPerPixel, kWidth * srcFmt.bytesPerPixel, kWidth, kHeight, dstFmt, srcFmt);
+		pixels += kWidth * kHeight;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+	printf(" %8.1f\n", pixels / elapsed / 1e6);
+}
+
+} // End of anonymous namespace
+
+int main(int argc, char *argv[]) {
+	static byte src[kWidth * kHeight * 4], dst[kWidth * kHeight * 4];
+	uint32 seed = 1;
+	for (uint i = 0; i < sizeof(src); ++i) {
+		seed = seed * 1103515245 + 12345;
+		src[i] = (byte)(seed >> 24);
+	}
+
+	printf("Pixel format conversion (Mpixels per second):\n");
+	printf("  %-20s %8s %8s %8s %8s %8s %8s %8s\n", "", "generic", "scalar", "sse2", "ssse3", "avx2", "neon", "crossBlit");
+	for (uint i = 0; i < ARRAYSIZE(kPairs); ++i)
+		benchPair(kFormats[kPairs[i].src], kFormats[kPairs[i].dst], src, dst);
+
+	return 0;
+}
@@ -0,0 +1,216 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures how game detection scales when a tree of game directories is
+// scanned by several threads, each of them handling whole directories the
+// way EngineManager::detectGamesInDirectories() does: list the directory,
+// map the file names, and hash the files named in the detection tables.
+//
+// The engines and the backend threads can not be linked into a benchmark,
+// so the tables are synthetic and the threads are plain POSIX threads.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/array.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+const int kGameDirs = 256;
+const int kFilesPerDir = 24;
+const int kFileSize = 16384;
+const int kDetectionEntries = 64;
+const int kMD5Bytes = 5000;
+const int kRuns = 3;
+
+typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileMap;
+
+double now() {
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/** Creates kGameDirs directories, each with a different subset of the files. */
+bool createTree(const Common::String &root) {
+	static char data[kFileSize];
+	uint32 seed = 1;
+	for (int i = 0; i < kFileSize; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (char)(seed >> 24);
+	}
+
+	for (int dir = 0; dir < kGameDirs; ++dir) {
+		const Common::String dirPath = root + Common::String::format("/game%03d", dir);
+		if (mkdir(dirPath.c_str(), 0700))
+			return false;
+
+		for (int file = 0; file < kFilesPerDir; ++file) {
+			const int id = (dir * 7 + file * 3) % kDetectionEntries;
+			FILE *f = fopen((dirPath + Common::String::format("/FILE%02d.DAT", id)).c_str(), "wb");
+			if (!f)
+				return false;
+			data[0] = (char)dir;
+			fwrite(data, 1, kFileSize, f);
+			fclose(f);
+		}
+	}
+	return true;
+}
+
+void removeTree(const Common::String &root) {
+	for (int dir = 0; dir < kGameDirs; ++dir) {
+		const Common::String dirPath = root + Common::String::format("/game%03d", dir);
+		for (int id = 0; id < kDetectionEntries; ++id)
+			unlink((dirPath + Common::String::format("/FILE%02d.DAT", id)).c_str());
+		rmdir(dirPath.c_str());
+	}
+	rmdir(root.c_str());
+}
+
+/** Runs the synthetic detector on one directory and returns the number of hashed files. */
+int detectDirectory(const Common::String &dirPath) {
+	FileMap allFiles;
+	DIR *dir = opendir(dirPath.c_str());
+	if (!dir)
+		return 0;
+	while (dirent *entry = readdir(dir)) {
+		if (entry->d_name[0] != '.')
+			allFiles[entry->d_name] = dirPath + "/" + entry->d_name;
+	}
+	closedir(dir);
+
+	int hashed = 0;
+	for (int id = 0; id < kDetectionEntries; ++id) {
+		const FileMap::const_iterator file = allFiles.find(Common::String::format("file%02d.dat", id));
+		if (file == allFiles.end())
+			continue;
+
+		FILE *f = fopen(file->_value.c_str(), "rb");
+		if (!f)
+			continue;
+		byte *data = (byte *)malloc(kMD5Bytes);
+		const size_t size = fread(data, 1, kMD5Bytes, f);
+		fclose(f);
+
+		Common::MemoryReadStream stream(data, size, DisposeAfterUse::YES);
+		if (!Common::computeStreamMD5AsString(stream, kMD5Bytes).empty())
+			++hashed;
+	}
+	return hashed;
+}
+
+struct Scan {
+	const Common::Array<Common::String> *dirs;
+	pthread_mutex_t mutex;
+	uint next;
+	int hashed;
+};
+
+void *scanThread(void *param) {
+	Scan &scan = *(Scan *)param;
+	int hashed = 0;
+	for (;;) {
+		pthread_mutex_lock(&scan.mutex);
+		const uint dir = scan.next++;
+		pthread_mutex_unlock(&scan.mutex);
+		if (dir >= scan.dirs->size())
+			break;
+		hashed += detectDirectory((*scan.dirs)[dir]);
+	}
+
+	pthread_mutex_lock(&scan.mutex);
+	scan.hashed += hashed;
+	pthread_mutex_unlock(&scan.mutex);
+	return 0;
+}
+
+void benchScan(const Common::Array<Common::String> &dirs, int threads) {
+	double best = 0;
+	int hashed = 0;
+	for (int run = 0; run < kRuns; ++run) {
+		Scan scan;
+		scan.dirs = &dirs;
+		pthread_mutex_init(&scan.mutex, 0);
+		scan.next = 0;
+		scan.hashed = 0;
+
+		const double start = now();
+		Common::Array<pthread_t> workers;
+		workers.resize(threads - 1);
+		for (int i = 0; i < threads - 1; ++i)
+			pthread_create(&workers[i], 0, scanThread, &scan);
+		// The calling thread takes part, like WorkerPool::runAll()
+		scanThread(&scan);
+		for (int i = 0; i < threads - 1; ++i)
+			pthread_join(workers[i], 0);
+		const double elapsed = now() - start;
+
+		pthread_mutex_destroy(&scan.mutex);
+		hashed = scan.hashed;
+		if (!run || elapsed < best)
+			best = elapsed;
+	}
+
+	printf("  %d thread(s): %8.2f ms, %6.0f dirs/s (%d files hashed)\n", threads, best * 1000, dirs.size() / best, hashed);
+}
+
+} // End of anonymous namespace
+
+int main(int argc, char *argv[]) {
+	char root[] = "/tmp/scummvm-detection-XXXXXX";
+	if (!mkdtemp(root)) {
+		printf("Could not create the synthetic game tree\n");
+		return 1;
+	}
+
+	if (!createTree(root)) {
+		printf("Could not create the synthetic game tree\n");
+		removeTree(root);
+		return 1;
+	}
+
+	Common::Array<Common::String> dirs;
+	for (int dir = 0; dir < kGameDirs; ++dir)
+		dirs.push_back(Common::String(root) + Common::String::format("/game%03d", dir));
+
+	printf("Detection over %d directories of %d files:\n", kGameDirs, kFilesPerDir);
+	static const int threads[] = { 1, 2, 4 };
+	for (uint i = 0; i < ARRAYSIZE(threads); ++i)
+		benchScan(dirs, threads[i]);
+
+	removeTree(root);
+	return 0;
+}
@@ -0,0 +1,143 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of the video DSP kernels, in 8x8 blocks per
+// second, for each implementation supported by the CPU.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "video/dsp.h"
+
+#include "common/util.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+namespace {
+
+const uint kBlocks = 1024;
+const int kPitch = 64;
+const double kMinSeconds = 0.25;
+
+const char *const kTypeNames[] = { "scalar", "SSE2", "AVX2", "NEON" };
+
+int16 g_coefficients[kBlocks][64];
+float g_samples[kBlocks][64];
+byte g_plane[kPitch * 16];
+byte g_prev[kPitch * 16];
+
+double seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+enum Kernel {
+	kKernelBinkIDCTPut,
+	kKernelBinkIDCTAdd,
+	kKernelAdd,
+	kKernelCopy8,
+	kKernelPattern,
+	kKernelMDECIDCT,
+	kKernelPutSigned,
+
+	kKernelCount
+};
+
+const char *const kKernelNames[] = { "binkIDCTPut", "binkIDCTAdd", "add8x8", "copy8x8", "pattern8x8", "mdecIDCT", "putSigned8x8" };
+
+void runKernel(const Video::DSPKernels &kernels, Kernel kernel, uint block) {
+	float result[64];
+
+	switch (kernel) {
+	case kKernelBinkIDCTPut:
+		kernels.binkIDCTPut(g_plane, kPitch, g_coefficients[block]);
+		break;
+	case kKernelBinkIDCTAdd:
+		kernels.binkIDCTAdd(g_plane, kPitch, g_coefficients[block]);
+		break;
+	case kKernelAdd:
+		kernels.add8x8(g_plane, kPitch, g_coefficients[block]);
+		break;
+	case kKernelCopy8:
+		kernels.copy8x8(g_plane + (block & 7), g_prev + (block & 15), kPitch);
+		break;
+	case kKernelPattern:
+		kernels.pattern8x8(g_plane, kPitch, (const byte *)g_coefficients[block], block, ~block);
+		break;
+	case kKernelMDECIDCT:
+		kernels.mdecIDCT(result, g_samples[block]);
+		g_plane[block & 63] = (byte)result[block & 63];
+		break;
+	case kKernelPutSigned:
+		kernels.putSigned8x8(g_plane, kPitch, g_samples[block]);
+		break;
+	default:
+		break;
+	}
+}
+
+double benchKernel(const Video::DSPKernels &kernels, Kernel kernel) {
+	double blocks = 0, elapsed;
+	clock_t start = clock();
+	do {
+		for (uint i = 0; i < kBlocks; i++)
+			runKernel(kernels, kernel, i);
+		blocks += kBlocks;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+
+	return blocks / elapsed / 1e6;
+}
+
+} // End of anonymous namespace
+
+int main(int argc, char *argv[]) {
+	// Coefficients like those of a dequantized block, mostly small and zero
+	uint32 seed = 1;
+	for (uint i = 0; i < kBlocks; i++) {
+		for (uint j = 0; j < 64; j++) {
+			seed = seed * 1103515245 + 12345;
+			const int value = (int)((seed >> 16) % 512) - 256;
+			g_coefficients[i][j] = (j < 16 || (seed & 0x300) == 0) ? value : 0;
+			g_samples[i][j] = value * 0.75f;
+		}
+	}
+	memset(g_prev, 0x80, sizeof(g_prev));
+
+	printf("Video DSP kernels (Mblocks per second):\n");
+	printf("  %-14s", "kernel");
+	for (int type = 0; type < Video::kDSPKernelsCount; type++)
+		if (Video::getDSPKernels((Video::DSPKernelType)type))
+			printf(" %10s", kTypeNames[type]);
+	printf("\n");
+
+	for (int kernel = 0; kernel < kKernelCount; kernel++) {
+		printf("  %-14s", kKernelNames[kernel]);
+		for (int type = 0; type < Video::kDSPKernelsCount; type++) {
+			const Video::DSPKernels *kernels = Video::getDSPKernels((Video::DSPKernelType)type);
+			if (kernels)
+				printf(" %10.2f", benchKernel(*kernels, (Kernel)kernel));
+		}
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the Huffman symbol throughput with the Bink video codebooks,
+// for Common::Huffman and for the list search it used to do.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/array.h"
+#include "common/bitstream.h"
+#include "common/huffman.h"
+#include "common/list.h"
+#include "common/memstream.h"
+#include "common/util.h"
+
+#include "video/binkdata.h"
+
+#include <stdio.h>
+#include <time.h>
+
+namespace {
+
+const uint kSymbolCount = 1 << 20;
+const double kMinSeconds = 0.25;
+
+double seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/** The decoder Common::Huffman used to be: one bit at a time, searching the codes of each length. */
+class ListHuffman {
+public:
+	ListHuffman(uint32 codeCount, const uint32 *codes, const uint8 *lengths) {
+		uint8 maxLength = 0;
+		for (uint32 i = 0; i < codeCount; i++)
+			maxLength = MAX(maxLength, lengths[i]);
+
+		_codes.resize(maxLength);
+		for (uint32 i = 0; i < codeCount; i++)
+			_codes[lengths[i] - 1].push_back(Symbol(codes[i], i));
+	}
+
+	uint32 getSymbol(Common::BitStream &bits) const {
+		uint32 code = 0;
+
+		for (uint32 i = 0; i < _codes.size(); i++) {
+			bits.addBit(code, i);
+
+			for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
+				if (code == cCode->code)
+					return cCode->symbol;
+		}
+
+		return 0;
+	}
+
+private:
+	struct Symbol {
+		uint32 code;
+		uint32 symbol;
+
+		Symbol(uint32 c, uint32 s) : code(c), symbol(s) {}
+	};
+
+	typedef Common::List<Symbol> CodeList;
+	Common::Array<CodeList> _codes;
+};
+
+/**
+ * Encodes random symbols of a codebook, each with the probability its code
+ * length stands for, into Bink's LSB first bit stream layout.
+ */
+uint32 encodeSymbols(Common::Array<uint32> &data, const uint32 *codes, const uint8 *lengths) {
+	data.clear();
+	data.resize(kSymbolCount * 16 / 32 + 2);
+
+	uint32 seed = 1, pos = 0;
+	for (uint i = 0; i < kSymbolCount; i++) {
+		// A code of length n is picked with a probability of 2^-n
+		seed = seed * 1103515245 + 12345;
+		uint32 r = seed >> 8, symbol = 0, threshold = 0;
+		for (symbol = 0; symbol < 15; symbol++) {
+			threshold += (1 << 24) >> lengths[symbol];
+			if (r < threshold)
+				break;
+		}
+
+		for (uint bit = 0; bit < lengths[symbol]; bit++, pos++)
+			data[pos / 32] |= ((codes[symbol] >> bit) & 1) << (pos % 32);
+	}
+
+	for (uint i = 0; i < data.size(); i++)
+		data[i] = TO_LE_32(data[i]);
+	return pos;
+}
+
+/** Returns whether both decoders decode the same symbols. */
+bool decodeSame(const ListHuffman &list, const Common::Huffman<Common::BitStream32LELSB> &table, const Common::Array<uint32> &data) {
+	Common::MemoryReadStream stream1((const byte *)data.begin(), data.size() * 4);
+	Common::MemoryReadStream stream2((const byte *)data.begin(), data.size() * 4);
+	Common::BitStream32LELSB bits1(stream1), bits2(stream2);
+	for (uint i = 0; i < kSymbolCount; i++)
+		if (list.getSymbol(bits1) != table.getSymbol(bits2))
+			return false;
+	return true;
+}
+
+template<class Decoder>
+double benchDecoder(const Decoder &decoder, const Common::Array<uint32> &data) {
+	double symbols = 0, elapsed;
+	uint32 check = 0;
+	clock_t start = clock();
+	do {
+		Common::MemoryReadStream stream((const byte *)data.begin(), data.size() * 4);
+		Common::BitStream32LELSB bits(stream);
+		for (uint i = 0; i < kSymbolCount; i++)
+			check += decoder.getSymbol(bits);
+		symbols += kSymbolCount;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+
+	// Keep the compiler from dropping the decoding
+	if (check == 0xFFFFFFFF)
+		printf(" ");
+	return symbols / elapsed / 1e6;
+}
+
+} // End of anonymous namespace
+
+int main(int argc, char *argv[]) {
+	printf("Huffman decoding of the Bink codebooks (Msymbols per second):\n");
+	printf("  %-10s %10s %10s %10s\n", "codebook", "bits/sym", "list", "table");
+
+	Common::Array<uint32> data;
+	for (uint i = 0; i < 16; i++) {
+		const uint32 *codes = Video::binkHuffmanCodes[i];
+		const uint8 *lengths = Video::binkHuffmanLengths[i];
+		const uint32 bits = encodeSymbols(data, codes, lengths);
+
+		ListHuffman list(16, codes, lengths);
+		Common::Huffman<Common::BitStream32LELSB> table(0, 16, codes, lengths);
+
+		printf("  %-10u %10.2f", i, (double)bits / kSymbolCount);
+		printf(" %10.1f", benchDecoder(list, data));
+		printf(" %10.1f\n", benchDecoder(table, data));
+
+		if (!decodeSame(list, table, data)) {
+			printf("Codebook %u decodes differently\n", i);
+			return 1;
+		}
+	}
+
+	return 0;
+}
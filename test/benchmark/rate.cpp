@@ -0,0 +1,175 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of the rate converters and of their kernels.
+// Set SCUMMVM_DISABLE_SIMD to measure the converters without SIMD kernels.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/rate_kernels.h"
+
+#include "common/util.h"
+
+#include <stdio.h>
+#include <time.h>
+
+namespace {
+
+const int kBlockFrames = 1024;
+const double kMinSeconds = 0.25;
+
+/** An endless stream of noise, which costs next to nothing to read. */
+class NoiseStream : public Audio::AudioStream {
+public:
+	NoiseStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _pos(0) {
+		uint32 seed = 1;
+		for (uint i = 0; i < ARRAYSIZE(_noise); ++i) {
+			seed = seed * 1103515245 + 12345;
+			_noise[i] = (int16)(seed >> 16);
+		}
+	}
+
+	virtual int readBuffer(int16 *buffer, const int numSamples) {
+		int left = numSamples;
+		while (left > 0) {
+			const int n = MIN<int>(left, ARRAYSIZE(_noise) - _pos);
+			memcpy(buffer, _noise + _pos, n * sizeof(int16));
+			buffer += n;
+			left -= n;
+			_pos = (_pos + n) % ARRAYSIZE(_noise);
+		}
+		return numSamples;
+	}
+
+	virtual bool isStereo() const { return _stereo; }
+	virtual int getRate() const { return _rate; }
+	virtual bool endOfData() const { return false; }
+
+private:
+	int _rate;
+	bool _stereo;
+	int _pos;
+	int16 _noise[4096];
+};
+
+double seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+void benchConverter(Audio::st_rate_t inrate, Audio::st_rate_t outrate, bool stereo, Audio::RateQuality quality) {
+	NoiseStream input(inrate, stereo);
+	Audio::RateConverter *converter = Audio::makeRateConverter(inrate, outrate, stereo, false, quality);
+	static int16 output[kBlockFrames * 2];
+
+	double frames = 0, elapsed;
+	const clock_t start = clock();
+	do {
+		for (int i = 0; i < 64; ++i)
+			frames += converter->flow(input, output, kBlockFrames, 200, 180);
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+
+	static const char *const sincNames[] = { "", "sinc16", "sinc32", "sinc64" };
+	const char *type;
+	if (inrate == outrate)
+		type = "copy";
+	else if (quality != Audio::kRateQualityDefault)
+		type = sincNames[quality];
+	else
+		type = (inrate % outrate) == 0 ? "simple" : "linear";
+
+	printf("  %-6s %-6s %5d -> %5d Hz: %8.2f Msamples/s\n", type, stereo ? "stereo" : "mono", inrate, outrate, frames / elapsed / 1e6);
+
+	delete converter;
+}
+
+void benchKernels(const char *name, const Audio::RateKernels &kernels) {
+	static int16 src[kBlockFrames * 2], dst[kBlockFrames * 2];
+	for (int i = 0; i < kBlockFrames * 2; ++i)
+		src[i] = (int16)(i * 37);
+
+	double frames = 0, elapsed;
+	clock_t start = clock();
+	do {
+		for (int i = 0; i < 256; ++i)
+			kernels.mixStereo(dst, src, kBlockFrames, 200, 180);
+		frames += 256 * kBlockFrames;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+	printf("  %-6s mixStereo: %8.2f Msamples/s\n", name, frames / elapsed / 1e6);
+
+	frames = 0;
+	start = clock();
+	do {
+		for (int i = 0; i < 256; ++i)
+			kernels.mixMono(dst, src, kBlockFrames, 200, 180);
+		frames += 256 * kBlockFrames;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+	printf("  %-6s mixMono:   %8.2f Msamples/s\n", name, frames / elapsed / 1e6);
+
+	static int32 accum[kBlockFrames * 2];
+	frames = 0;
+	start = clock();
+	do {
+		for (int i = 0; i < 256; ++i)
+			kernels.accumStereo(accum, src, kBlockFrames, 200, 180);
+		kernels.clip(dst, accum, kBlockFrames * 2);
+		memset(accum, 0, sizeof(accum));
+		frames += 256 * kBlockFrames;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+	printf("  %-6s mix bus:   %8.2f Msamples/s\n", name, frames / elapsed / 1e6);
+}
+
+} // End of anonymous namespace
+
+int main(int argc, char *argv[]) {
+	static const Audio::st_rate_t rates[][2] = {
+		{ 44100, 44100 },
+		{ 44100, 22050 },
+		{ 11025, 44100 },
+		{ 22050, 44100 },
+		{ 48000, 44100 },
+		{ 22050, 48000 }
+	};
+
+	printf("Rate converters (output samples per second):\n");
+	for (uint i = 0; i < ARRAYSIZE(rates); ++i) {
+		for (int quality = Audio::kRateQualityDefault; quality <= Audio::kRateQualityHigh; ++quality) {
+			// The quality does not matter when no conversion is needed
+			if (rates[i][0] == rates[i][1] && quality != Audio::kRateQualityDefault)
+				continue;
+
+			benchConverter(rates[i][0], rates[i][1], false, (Audio::RateQuality)quality);
+			benchConverter(rates[i][0], rates[i][1], true, (Audio::RateQuality)quality);
+		}
+	}
+
+	static const char *const names[] = { "scalar", "sse2", "avx2", "neon" };
+	printf("Rate kernels (output samples per second):\n");
+	for (int type = 0; type < Audio::kRateKernelsCount; ++type) {
+		const Audio::RateKernels *kernels = Audio::getRateKernels((Audio::RateKernelType)type);
+		if (kernels)
+			benchKernels(names[type], *kernels);
+	}
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of the YUV to RGB kernels, in pixels per second,
+// for each implementation supported by the CPU.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#include <stdio.h>
+#include <time.h>
+
+namespace {
+
+const uint kWidth = 1920;
+const double kMinSeconds = 0.25;
+
+const char *const kTypeNames[] = { "scalar", "SSE2", "AVX2", "NEON" };
+
+byte g_y[2 * kWidth];
+byte g_u[kWidth / 2];
+byte g_v[kWidth / 2];
+uint32 g_dst[2 * kWidth];
+
+double seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+enum Kernel {
+	kKernel444To16,
+	kKernel444To32,
+	kKernel420To16,
+	kKernel420To32,
+
+	kKernelCount
+};
+
+const char *const kKernelNames[] = { "444 to 16 bit", "444 to 32 bit", "420 to 16 bit", "420 to 32 bit" };
+
+void runKernel(const Graphics::YUVToRGBKernels &kernels, Kernel kernel, const Graphics::YUVToRGBTables &tables16, const Graphics::YUVToRGBTables &tables32) {
+	switch (kernel) {
+	case kKernel444To16:
+		kernels.convert444To16((uint16 *)g_dst, g_y, g_y + kWidth / 2, g_y + kWidth, kWidth, tables16);
+		kernels.convert444To16((uint16 *)g_dst + kWidth, g_y + kWidth, g_y, g_y + kWidth / 2, kWidth, tables16);
+		break;
+	case kKernel444To32:
+		kernels.convert444To32(g_dst, g_y, g_y + kWidth / 2, g_y + kWidth, kWidth, tables32);
+		kernels.convert444To32(g_dst + kWidth, g_y + kWidth, g_y, g_y + kWidth / 2, kWidth, tables32);
+		break;
+	case kKernel420To16:
+		kernels.convert420To16((uint16 *)g_dst, kWidth * 2, g_y, kWidth, g_u, g_v, kWidth, tables16);
+		break;
+	case kKernel420To32:
+		kernels.convert420To32(g_dst, kWidth * 4, g_y, kWidth, g_u, g_v, kWidth, tables32);
+		break;
+	default:
+		break;
+	}
+}
+
+double benchKernel(const Graphics::YUVToRGBKernels &kernels, Kernel kernel, const Graphics::YUVToRGBTables &tables16, const Graphics::YUVToRGBTables &tables32) {
+	double pixels = 0, elapsed;
+	clock_t start = clock();
+	do {
+		for (uint i = 0; i < 64; i++)
+			runKernel(kernels, kernel, tables16, tables32);
+		pixels += 64 * 2 * kWidth;
+	} while ((elapsed = seconds(start)) < kMinSeconds);
+
+	return pixels / elapsed / 1e6;
+}
+
+} // End of anonymous namespace
+
+int main(int argc, char *argv[]) {
+	uint32 seed = 1;
+	for (uint i = 0; i < 2 * kWidth; i++) {
+		seed = seed * 1103515245 + 12345;
+		g_y[i] = seed >> 24;
+	}
+	for (uint i = 0; i < kWidth / 2; i++) {
+		g_u[i] = g_y[i * 3] ^ 0x55;
+		g_v[i] = g_y[i * 3 + 1] ^ 0xAA;
+	}
+
+	// Tables of the formats Bink and Theora usually convert to
+	static Graphics::YUVToRGBTables tables16, tables32;
+	tables16.init(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), Graphics::YUVToRGBManager::kScaleITU);
+	tables32.init(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24), Graphics::YUVToRGBManager::kScaleITU);
+
+	printf("YUV to RGB kernels (Mpixels per second):\n");
+	printf("  %-14s", "kernel");
+	for (int type = 0; type < Graphics::kYUVToRGBKernelsCount; type++)
+		if (Graphics::getYUVToRGBKernels((Graphics::YUVToRGBKernelType)type))
+			printf(" %10s", kTypeNames[type]);
+	printf("\n");
+
+	for (int kernel = 0; kernel < kKernelCount; kernel++) {
+		printf("  %-14s", kKernelNames[kernel]);
+		for (int type = 0; type < Graphics::kYUVToRGBKernelsCount; type++) {
+			const Graphics::YUVToRGBKernels *kernels = Graphics::getYUVToRGBKernels((Graphics::YUVToRGBKernelType)type);
+			if (kernels)
+				printf(" %10.2f", benchKernel(*kernels, (Kernel)kernel, tables16, tables32));
+		}
+		printf("\n");
+	}
+
+	return 0;
+}
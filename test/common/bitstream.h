@@ -5,6 +5,68 @@
 
 class BitStreamTestSuite : public CxxTest::TestSuite
 {
+	/**
+	 * Reads the same random data with a BitStreamImpl and a
+	 * BitStreamMemoryImpl of the same layout, in random steps, and checks
+	 * both return the same bits and positions. The data size is not a
+	 * multiple of the value size, to check both ignore the same tail.
+	 */
+	template<class BITSTREAM, class MEMORYBITSTREAM>
+	static bool readsSame() {
+		byte data[261];
+		uint32 seed = 1;
+		for (uint i = 0; i < sizeof(data); i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 24;
+		}
+
+		Common::MemoryReadStream ms(data, sizeof(data));
+		BITSTREAM bs(ms);
+		MEMORYBITSTREAM mbs(data, sizeof(data));
+		if (bs.size() != mbs.size())
+			return false;
+
+		while (bs.pos() < bs.size()) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 left = bs.size() - bs.pos();
+			const uint8 n = MIN<uint32>((seed >> 16) % 33, left);
+			uint32 x = 0, y = 0;
+
+			switch ((seed >> 8) % 5) {
+			case 0:
+				if (bs.getBits(n) != mbs.getBits(n))
+					return false;
+				break;
+			case 1:
+				if (bs.getBit() != mbs.getBit())
+					return false;
+				break;
+			case 2:
+				// Peeks may reach past the end
+				if (bs.peekBits((seed >> 16) % 33) != mbs.peekBits((seed >> 16) % 33))
+					return false;
+				break;
+			case 3:
+				bs.skip(left > 100 ? n * 3 : n);
+				mbs.skip(left > 100 ? n * 3 : n);
+				break;
+			default:
+				bs.addBit(x, n % 32);
+				mbs.addBit(y, n % 32);
+				if (x != y)
+					return false;
+				break;
+			}
+
+			if (bs.pos() != mbs.pos() || bs.eos() != mbs.eos())
+				return false;
+		}
+
+		bs.rewind();
+		mbs.rewind();
+		return mbs.pos() == 0 && bs.getBits(32) == mbs.getBits(32);
+	}
+
 	public:
 	void test_get_bit() {
 		byte contents[] = { 'a' };
@@ -117,6 +179,24 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
+	void test_peek_bits_at_end() {
+		byte contents[] = { 'a', 'b' };
+
+		// Bits past the end read as 0, even when none are left
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		Common::BitStream8MSB bs(ms);
+		bs.skip(11);
+		TS_ASSERT_EQUALS(bs.peekBits(32), 2u << 27);
+		bs.skip(5);
+		TS_ASSERT_EQUALS(bs.peekBits(32), 0u);
+		TS_ASSERT_EQUALS(bs.pos(), 16u);
+
+		Common::MemoryReadStream msLSB(contents, sizeof(contents));
+		Common::BitStream8LSB bsLSB(msLSB);
+		bsLSB.skip(16);
+		TS_ASSERT_EQUALS(bsLSB.peekBits(32), 0u);
+	}
+
 	void test_get_bits_lsb() {
 		byte contents[] = { 'a', 'b' };
 
@@ -149,4 +229,17 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(bs.peekBits(5), 12u);
 		TS_ASSERT(!bs.eos());
 	}
+
+	void test_memory_layouts() {
+		TS_ASSERT((readsSame<Common::BitStream8MSB, Common::BitStreamMemory8MSB>()));
+		TS_ASSERT((readsSame<Common::BitStream8LSB, Common::BitStreamMemory8LSB>()));
+		TS_ASSERT((readsSame<Common::BitStream16LEMSB, Common::BitStreamMemory16LEMSB>()));
+		TS_ASSERT((readsSame<Common::BitStream16LELSB, Common::BitStreamMemory16LELSB>()));
+		TS_ASSERT((readsSame<Common::BitStream16BEMSB, Common::BitStreamMemory16BEMSB>()));
+		TS_ASSERT((readsSame<Common::BitStream16BELSB, Common::BitStreamMemory16BELSB>()));
+		TS_ASSERT((readsSame<Common::BitStream32LEMSB, Common::BitStreamMemory32LEMSB>()));
+		TS_ASSERT((readsSame<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>()));
+		TS_ASSERT((readsSame<Common::BitStream32BEMSB, Common::BitStreamMemory32BEMSB>()));
+		TS_ASSERT((readsSame<Common::BitStream32BELSB, Common::BitStreamMemory32BELSB>()));
+	}
 };
@@ -10,6 +10,61 @@
 * TODO: It could be improved by generating one at runtime.
 */
 class HuffmanTestSuite : public CxxTest::TestSuite {
+	enum {
+		kCodeCount = 20,
+		kSymbolCount = 1000
+	};
+
+	/**
+	 * Encodes random symbols with a code of lengths 1 to 19, which needs
+	 * more than one level of sub-tables, and checks they decode again.
+	 * Codes are written with their first bit in the highest bit for MSB
+	 * first streams, and in the lowest bit for LSB first streams.
+	 */
+	template<class BITSTREAM>
+	static bool decodesLongCodes() {
+		uint8 lengths[kCodeCount];
+		uint32 codes[kCodeCount];
+		uint32 code = 0;
+		for (uint i = 0; i < kCodeCount; i++) {
+			lengths[i] = MIN<uint>(i + 1, kCodeCount - 1);
+			if (i > 0)
+				code = (code + 1) << (lengths[i] - lengths[i - 1]);
+			codes[i] = code;
+			if (!BITSTREAM::isMSB2LSB()) {
+				codes[i] = 0;
+				for (uint bit = 0; bit < lengths[i]; bit++)
+					codes[i] |= ((code >> bit) & 1) << (lengths[i] - 1 - bit);
+			}
+		}
+
+		uint32 symbols[kCodeCount];
+		for (uint i = 0; i < kCodeCount; i++)
+			symbols[i] = 100 + i;
+		Common::Huffman<BITSTREAM> h(0, kCodeCount, codes, lengths, symbols);
+
+		static byte data[kSymbolCount * kCodeCount / 8 + 1];
+		uint32 input[kSymbolCount];
+		uint32 pos = 0, seed = 1;
+		memset(data, 0, sizeof(data));
+		for (uint i = 0; i < kSymbolCount; i++) {
+			seed = seed * 1103515245 + 12345;
+			input[i] = (seed >> 16) % kCodeCount;
+			for (uint bit = 0; bit < lengths[input[i]]; bit++, pos++) {
+				const uint32 value = BITSTREAM::isMSB2LSB() ?
+					(codes[input[i]] >> (lengths[input[i]] - 1 - bit)) & 1 : (codes[input[i]] >> bit) & 1;
+				data[pos / 8] |= value << (BITSTREAM::isMSB2LSB() ? 7 - pos % 8 : pos % 8);
+			}
+		}
+
+		Common::MemoryReadStream ms(data, (pos + 7) / 8);
+		BITSTREAM bs(ms);
+		for (uint i = 0; i < kSymbolCount; i++)
+			if (h.getSymbol(bs) != symbols[input[i]])
+				return false;
+		return bs.pos() == pos;
+	}
+
 	public:
 	void test_get_with_full_symbols() {
 
@@ -32,7 +87,7 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		const uint32 codes[]  = {0x2, 0x3, 0x3, 0x0, 0x2};
 		const uint32 symbols[]  = {0xA, 0xB, 0xC, 0xD, 0xE};
 
-		Common::Huffman h(maxLength, codeCount, codes, lengths, symbols);
+		Common::Huffman<Common::BitStream8MSB> h(maxLength, codeCount, codes, lengths, symbols);
 
 		byte input[] = {0x4F, 0x20};
 		// Provided input...
@@ -78,7 +133,7 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		const uint8 lengths[] = {3,3,2,2,2};
 		const uint32 codes[]  = {0x2, 0x3, 0x3, 0x0, 0x2};
 
-		Common::Huffman h(0, codeCount, codes, lengths, 0);
+		Common::Huffman<Common::BitStream8MSB> h(0, codeCount, codes, lengths, 0);
 
 		byte input[] = {0x4F, 0x20};
 		uint32 expected[] = {0, 1, 2, 3, 4, 3 ,3};
@@ -114,7 +169,7 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		const uint8 lengths[] = {3,3,2,2,2};
 		const uint32 codes[]  = {0x2, 0x3, 0x3, 0x0, 0x2};
 
-		Common::Huffman h(0, codeCount, codes, lengths, 0);
+		Common::Huffman<Common::BitStream8MSB> h(0, codeCount, codes, lengths, 0);
 
 		const uint32 symbols[]  = {0xA, 0xB, 0xC, 0xD, 0xE};
 		h.setSymbols(symbols);
@@ -141,4 +196,9 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[5]);
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[6]);
 	}
+
+	void test_long_codes() {
+		TS_ASSERT(decodesLongCodes<Common::BitStream8MSB>());
+		TS_ASSERT(decodesLongCodes<Common::BitStream8LSB>());
+	}
 };
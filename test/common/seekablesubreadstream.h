@@ -70,4 +70,29 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_safe_direct_data() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SafeSeekableSubReadStream first(&ms, 2, 8);
+		Common::SafeSeekableSubReadStream second(&ms, 5, 10);
+		TS_ASSERT_EQUALS(first.getData(), contents + 2);
+		TS_ASSERT_EQUALS(second.getData(), contents + 5);
+
+		// Both substreams read straight from the parent's data, so reading
+		// them in turn doesn't need the parent to be repositioned
+		ms.seek(9);
+		TS_ASSERT_EQUALS(first.readByte(), 2);
+		TS_ASSERT_EQUALS(second.readByte(), 5);
+		TS_ASSERT_EQUALS(first.readByte(), 3);
+		TS_ASSERT_EQUALS(second.readByte(), 6);
+		TS_ASSERT_EQUALS(ms.pos(), 9);
+
+		byte buf[8];
+		TS_ASSERT_EQUALS(second.read(buf, sizeof(buf)), (uint32)3);
+		TS_ASSERT_EQUALS(buf[2], 9);
+		TS_ASSERT(second.eos());
+		TS_ASSERT(!first.eos());
+	}
 };
@@ -0,0 +1,239 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+	struct Member {
+		const char *name;
+		uint16 method;
+		const byte *data;	// stored or deflated contents
+		uint32 size;
+		uint32 compressedSize;
+		uint32 crc;
+		uint32 offset;
+	};
+
+	Common::ScopedPtr<Common::MemoryWriteStreamDynamic> _zip;
+	Common::Array<byte> _stored;
+	Common::Array<byte> _deflated;
+
+	static uint32 crc32(const byte *data, uint32 size) {
+		uint32 crc = 0xFFFFFFFF;
+		for (uint32 i = 0; i < size; i++) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+		}
+		return ~crc;
+	}
+
+	static void writeName(Common::WriteStream &out, const char *name) {
+		out.write(name, strlen(name));
+	}
+
+	// Deflates the given data into a gzip stream and strips the gzip header
+	// and trailer, leaving the raw deflate data used by ZIP
+	static Common::Array<byte> deflate(const byte *data, uint32 size) {
+		// The compressing stream takes ownership of the stream it wraps
+		Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::WriteStream *out = Common::wrapCompressedWriteStream(gzip);
+		out->write(data, size);
+		out->finalize();
+
+		Common::Array<byte> raw;
+		if (gzip->size() > 18)
+			raw.assign(gzip->getData() + 10, gzip->getData() + gzip->size() - 8);
+		delete out;
+		return raw;
+	}
+
+	void writeArchive(Member *members, uint count) {
+		for (uint i = 0; i < count; i++) {
+			Member &m = members[i];
+			m.offset = _zip->pos();
+			_zip->writeUint32LE(0x04034b50);
+			_zip->writeUint16LE(20);
+			_zip->writeUint16LE(0);
+			_zip->writeUint16LE(m.method);
+			_zip->writeUint32LE(0); // time and date
+			_zip->writeUint32LE(m.crc);
+			_zip->writeUint32LE(m.compressedSize);
+			_zip->writeUint32LE(m.size);
+			_zip->writeUint16LE(strlen(m.name));
+			_zip->writeUint16LE(0);
+			writeName(*_zip, m.name);
+			_zip->write(m.data, m.compressedSize);
+		}
+
+		const uint32 centralDir = _zip->pos();
+		for (uint i = 0; i < count; i++) {
+			const Member &m = members[i];
+			_zip->writeUint32LE(0x02014b50);
+			_zip->writeUint16LE(20);
+			_zip->writeUint16LE(20);
+			_zip->writeUint16LE(0);
+			_zip->writeUint16LE(m.method);
+			_zip->writeUint32LE(0); // time and date
+			_zip->writeUint32LE(m.crc);
+			_zip->writeUint32LE(m.compressedSize);
+			_zip->writeUint32LE(m.size);
+			_zip->writeUint16LE(strlen(m.name));
+			_zip->writeUint16LE(0);
+			_zip->writeUint16LE(0);
+			_zip->writeUint16LE(0);
+			_zip->writeUint16LE(0);
+			_zip->writeUint32LE(0);
+			_zip->writeUint32LE(m.offset);
+			writeName(*_zip, m.name);
+		}
+
+		_zip->writeUint32LE(0x06054b50);
+		_zip->writeUint16LE(0);
+		_zip->writeUint16LE(0);
+		_zip->writeUint16LE(count);
+		_zip->writeUint16LE(count);
+		_zip->writeUint32LE(_zip->pos() - 12 - centralDir);
+		_zip->writeUint32LE(centralDir);
+		_zip->writeUint16LE(0);
+	}
+
+	static bool checkRead(Common::SeekableReadStream *s, const Common::Array<byte> &expected, uint32 pos, uint32 len) {
+		byte buf[4096];
+		assert(len <= sizeof(buf));
+		if (s->pos() != (int32)pos || s->read(buf, len) != len)
+			return false;
+		return !memcmp(buf, &expected[pos], len);
+	}
+
+	public:
+	void setUp() {
+		// Every test writes an archive of its own
+		_zip.reset(new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES));
+
+		_stored.resize(3000);
+		for (uint i = 0; i < _stored.size(); i++)
+			_stored[i] = i * 7;
+
+		// Large enough to span a couple of restart points
+		uint32 seed = 1;
+		_deflated.resize(1536 * 1024 + 123);
+		for (uint i = 0; i < _deflated.size(); i++) {
+			seed = seed * 1103515245 + 12345;
+			_deflated[i] = (seed >> 24) & 0x1F;
+		}
+	}
+
+	void test_stored_and_deflated_members() {
+#ifdef USE_ZLIB
+		const Common::Array<byte> &plain = _deflated;
+		Common::Array<byte> raw = deflate(&plain[0], plain.size());
+		TS_ASSERT(!raw.empty());
+		if (raw.empty())
+			return;
+
+		Member members[2] = {
+			{ "stored.bin", 0, &_stored[0], _stored.size(), _stored.size(), crc32(&_stored[0], _stored.size()), 0 },
+			{ "deflated.bin", 8, &raw[0], plain.size(), raw.size(), crc32(&plain[0], plain.size()), 0 }
+		};
+		writeArchive(members, 2);
+
+		Common::ScopedPtr<Common::Archive> archive(Common::makeZipArchive(
+			new Common::MemoryReadStream(_zip->getData(), _zip->size())));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> deflated(archive->createReadStreamForMember("deflated.bin"));
+		TS_ASSERT(stored && deflated);
+		if (!stored || !deflated)
+			return;
+		TS_ASSERT_EQUALS(stored->size(), (int32)_stored.size());
+		TS_ASSERT_EQUALS(deflated->size(), (int32)plain.size());
+
+		// Reading both members in turn must not mix up their data
+		uint32 storedPos = 0;
+		for (uint32 pos = 0; pos + 4096 <= plain.size(); pos += 4096) {
+			TS_ASSERT(checkRead(deflated.get(), plain, pos, 4096));
+			if (storedPos + 100 <= _stored.size()) {
+				TS_ASSERT(checkRead(stored.get(), _stored, storedPos, 100));
+				storedPos += 100;
+			}
+		}
+
+		// Seek backwards, and forwards across restart points
+		const uint32 positions[] = { 100, 1400 * 1024, 600 * 1024, 0, 1024 * 1024 - 7, plain.size() - 50 };
+		for (uint i = 0; i < ARRAYSIZE(positions); i++) {
+			TS_ASSERT(deflated->seek(positions[i]));
+			TS_ASSERT(checkRead(deflated.get(), plain, positions[i], 50));
+		}
+
+		byte b;
+		TS_ASSERT_EQUALS(deflated->read(&b, 1), (uint32)0);
+		TS_ASSERT(deflated->eos());
+		TS_ASSERT(!deflated->err());
+
+		TS_ASSERT(deflated->seek(-20, SEEK_END));
+		TS_ASSERT(checkRead(deflated.get(), plain, plain.size() - 20, 20));
+
+		TS_ASSERT(stored->seek(-10, SEEK_END));
+		TS_ASSERT(checkRead(stored.get(), _stored, _stored.size() - 10, 10));
+
+		TS_ASSERT(!archive->createReadStreamForMember("missing.bin"));
+#endif
+	}
+
+	void test_member_outlives_archive() {
+		Member members[1] = {
+			{ "stored.bin", 0, &_stored[0], _stored.size(), _stored.size(), crc32(&_stored[0], _stored.size()), 0 }
+		};
+		writeArchive(members, 1);
+
+		// The archive owns the stream it is created from
+		Common::Archive *archive = Common::makeZipArchive(
+			new Common::MemoryReadStream(_zip->getData(), _zip->size()));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.bin"));
+		delete archive;
+		TS_ASSERT(stored);
+		if (!stored)
+			return;
+
+		TS_ASSERT(checkRead(stored.get(), _stored, 0, _stored.size()));
+		TS_ASSERT(!stored->err());
+	}
+
+	void test_crc_mismatch() {
+#ifdef USE_ZLIB
+		Member members[1] = {
+			{ "stored.bin", 0, &_stored[0], _stored.size(), _stored.size(), crc32(&_stored[0], _stored.size()) ^ 1, 0 }
+		};
+		writeArchive(members, 1);
+
+		Common::ScopedPtr<Common::Archive> archive(Common::makeZipArchive(
+			new Common::MemoryReadStream(_zip->getData(), _zip->size())));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.bin"));
+		TS_ASSERT(stored);
+		if (!stored)
+			return;
+
+		// Only reading the member to its end reveals the mismatch
+		TS_ASSERT(checkRead(stored.get(), _stored, 0, 1000));
+		TS_ASSERT(!stored->err());
+		TS_ASSERT(stored->seek(0));
+		TS_ASSERT(checkRead(stored.get(), _stored, 0, _stored.size()));
+		TS_ASSERT(stored->err());
+#endif
+	}
+};
@@ -0,0 +1,153 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/conversion.h"
+#include "graphics/conversion_kernels.h"
+#include "graphics/pixelformat.h"
+
+class ConversionTestSuite : public CxxTest::TestSuite {
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) | (_seed << 16);
+	}
+
+	static Graphics::PixelFormat getFormat(uint i) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),		// RGB565
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 0, 5, 11, 0),		// BGR565
+			Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0),		// RGB555
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),		// ARGB1555
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 12, 8, 4, 0),		// RGBA4444
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),		// ARGB8888
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),		// XRGB8888
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),		// RGBA8888
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24),		// ABGR8888
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0),		// XBGR8888
+			Graphics::PixelFormat(4, 7, 6, 5, 2, 20, 10, 2, 28)		// something odd
+		};
+		return i < ARRAYSIZE(formats) ? formats[i] : Graphics::PixelFormat();
+	}
+
+	static uint32 convertReference(uint32 color, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		byte a, r, g, b;
+		srcFmt.colorToARGB(color, a, r, g, b);
+		return dstFmt.ARGBToColor(a, r, g, b);
+	}
+
+	void fill(uint32 *buf, uint count, uint bytesPerPixel) {
+		for (uint i = 0; i < count; ++i)
+			buf[i] = (bytesPerPixel == 2) ? (nextRandom() & 0xFFFF) : nextRandom();
+	}
+
+	void compareKernels(const Graphics::ConversionKernels &kernels, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		const uint maxCount = 71;
+		uint32 src32[maxCount], dst32[maxCount];
+		uint16 src16[maxCount], dst16[maxCount];
+
+		Graphics::ConversionProgram program;
+		program.init(dstFmt, srcFmt);
+
+		for (uint count = 0; count < maxCount; count += 5) {
+			fill(src32, count, srcFmt.bytesPerPixel);
+			for (uint i = 0; i < count; ++i)
+				src16[i] = src32[i];
+
+			bool equal = true;
+			if (srcFmt.bytesPerPixel == 2 && dstFmt.bytesPerPixel == 2) {
+				kernels.convert16To16(dst16, src16, count, program);
+				for (uint i = 0; i < count; ++i)
+					equal &= (dst16[i] == (uint16)convertReference(src32[i], dstFmt, srcFmt));
+			} else if (srcFmt.bytesPerPixel == 2) {
+				kernels.convert16To32(dst32, src16, count, program);
+				for (uint i = 0; i < count; ++i)
+					equal &= (dst32[i] == convertReference(src32[i], dstFmt, srcFmt));
+			} else if (dstFmt.bytesPerPixel == 2) {
+				kernels.convert32To16(dst16, src32, count, program);
+				for (uint i = 0; i < count; ++i)
+					equal &= (dst16[i] == (uint16)convertReference(src32[i], dstFmt, srcFmt));
+			} else {
+				kernels.convert32To32(dst32, src32, count, program);
+				for (uint i = 0; i < count; ++i)
+					equal &= (dst32[i] == convertReference(src32[i], dstFmt, srcFmt));
+
+				if (program.isShuffle && kernels.shuffle32To32) {
+					memset(dst32, 0, sizeof(dst32));
+					kernels.shuffle32To32(dst32, src32, count, program);
+					for (uint i = 0; i < count; ++i)
+						equal &= (dst32[i] == convertReference(src32[i], dstFmt, srcFmt));
+				}
+			}
+			TS_ASSERT(equal);
+		}
+	}
+
+	public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void test_program() {
+		Graphics::ConversionProgram program;
+
+		// ARGB8888 to XRGB8888 only masks off the alpha
+		program.init(getFormat(6), getFormat(5));
+		TS_ASSERT_EQUALS(program.numTerms, 1U);
+		TS_ASSERT_EQUALS(program.terms[0].mask, 0x00FFFFFFU);
+		TS_ASSERT(program.isShuffle);
+
+		// Sources without alpha become opaque
+		program.init(getFormat(5), getFormat(0));
+		TS_ASSERT_EQUALS(program.fill, 0xFF000000U);
+		TS_ASSERT(!program.isShuffle);
+		TS_ASSERT_EQUALS(program.convert(0xFFFF), 0xFFF8FCF8U);
+
+		// Swapping red and blue is a byte permutation
+		program.init(getFormat(8), getFormat(5));
+		TS_ASSERT(program.isShuffle);
+		TS_ASSERT_EQUALS(program.convert(0x11223344), 0x11443322U);
+	}
+
+	void test_kernels() {
+		for (int type = 0; type < Graphics::kConversionKernelsCount; ++type) {
+			const Graphics::ConversionKernels *kernels = Graphics::getConversionKernels((Graphics::ConversionKernelType)type);
+			TS_ASSERT(kernels || type != Graphics::kConversionKernelsScalar);
+			if (!kernels)
+				continue;
+
+			for (uint src = 0; getFormat(src).bytesPerPixel; ++src) {
+				for (uint dst = 0; getFormat(dst).bytesPerPixel; ++dst)
+					compareKernels(*kernels, getFormat(dst), getFormat(src));
+			}
+		}
+	}
+
+	void test_crossblit_in_place() {
+		const uint w = 37, h = 5;
+		uint32 buffer[w * h], original[w * h];
+
+		// RGB565 to ARGB8888, the destination rows are twice as long
+		const Graphics::PixelFormat fmt16 = getFormat(0), fmt32 = getFormat(5);
+		fill(original, w * h, 4);
+		memcpy(buffer, original, sizeof(buffer));
+		TS_ASSERT(Graphics::crossBlit((byte *)buffer, (const byte *)buffer, w * 4, w * 2, w, h, fmt32, fmt16));
+
+		bool equal = true;
+		for (uint y = 0; y < h; ++y) {
+			for (uint x = 0; x < w; ++x) {
+				const uint16 color = ((const uint16 *)original)[y * w + x];
+				equal &= (buffer[y * w + x] == convertReference(color, fmt32, fmt16));
+			}
+		}
+		TS_ASSERT(equal);
+
+		// And back
+		memcpy(original, buffer, sizeof(buffer));
+		TS_ASSERT(Graphics::crossBlit((byte *)buffer, (const byte *)buffer, w * 2, w * 4, w, h, fmt16, fmt32));
+
+		equal = true;
+		for (uint i = 0; i < w * h; ++i)
+			equal &= (((const uint16 *)buffer)[i] == convertReference(original[i], fmt16, fmt32));
+		TS_ASSERT(equal);
+	}
+};
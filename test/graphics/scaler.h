@@ -0,0 +1,177 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/intern.h"
+#include "graphics/pixelformat.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+	enum {
+		// The scalers read up to two pixels around the rect
+		kBorder = 2,
+		kWidth = 24,
+		kHeight = 36,
+		kPitch = kWidth + 2 * kBorder,
+		kMaxScale = 3
+	};
+
+	uint32 _seed;
+	uint32 _src[(kHeight + 2 * kBorder) * kPitch];
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) | (_seed << 16);
+	}
+
+	// Fill the source with runs of a few colors, so the edge detection of
+	// the more elaborate scalers has something to work with
+	void fillSource(uint bytesPerPixel) {
+		uint32 colors[5];
+		for (uint i = 0; i < ARRAYSIZE(colors); ++i)
+			colors[i] = (bytesPerPixel == 2) ? (nextRandom() & 0xFFFF) : nextRandom();
+
+		uint32 color = colors[0];
+		for (uint i = 0; i < ARRAYSIZE(_src); ++i) {
+			if ((nextRandom() & 3) == 0)
+				color = colors[nextRandom() % ARRAYSIZE(colors)];
+			_src[i] = color;
+		}
+	}
+
+	template<typename Pixel>
+	static void copyPixels(Pixel *dst, const uint32 *src, uint count) {
+		for (uint i = 0; i < count; ++i)
+			dst[i] = src[i];
+	}
+
+	template<typename Pixel>
+	static void scale(ScalerProc *scaler, const Pixel *src, Pixel *dst, int firstRow, int numRows, int scaleFactor) {
+		const uint32 srcPitch = kPitch * sizeof(Pixel);
+		const uint32 dstPitch = kWidth * kMaxScale * sizeof(Pixel);
+		scaler((const uint8 *)(src + (kBorder + firstRow) * kPitch + kBorder), srcPitch,
+			(uint8 *)dst + firstRow * scaleFactor * dstPitch, dstPitch, kWidth, numRows);
+	}
+
+	/**
+	 * Scales the source in one go and in two bands, the way ScaleInBands()
+	 * splits it, and checks both give the same result.
+	 */
+	template<typename Pixel>
+	static bool scalesInBands(ScalerProc *scaler, int scaleFactor, const Pixel *src) {
+		const uint dstSize = kWidth * kMaxScale * kHeight * kMaxScale;
+		Pixel whole[dstSize], bands[dstSize];
+		memset(whole, 0, sizeof(whole));
+		memset(bands, 0, sizeof(bands));
+
+		scale(scaler, src, whole, 0, kHeight, scaleFactor);
+		scale(scaler, src, bands, 0, 16, scaleFactor);
+		scale(scaler, src, bands, 16, kHeight - 16, scaleFactor);
+		return !memcmp(whole, bands, sizeof(whole));
+	}
+
+	struct Scaler {
+		ScalerProc *proc;
+		int scaleFactor;
+	};
+
+	static uint getScalers(Scaler *scalers) {
+		uint count = 0;
+		scalers[count].proc = Normal1x;
+		scalers[count++].scaleFactor = 1;
+#ifdef USE_SCALERS
+		scalers[count].proc = Normal2x;
+		scalers[count++].scaleFactor = 2;
+		scalers[count].proc = Normal3x;
+		scalers[count++].scaleFactor = 3;
+		scalers[count].proc = _2xSaI;
+		scalers[count++].scaleFactor = 2;
+		scalers[count].proc = Super2xSaI;
+		scalers[count++].scaleFactor = 2;
+		scalers[count].proc = SuperEagle;
+		scalers[count++].scaleFactor = 2;
+		scalers[count].proc = AdvMame2x;
+		scalers[count++].scaleFactor = 2;
+		scalers[count].proc = AdvMame3x;
+		scalers[count++].scaleFactor = 3;
+		scalers[count].proc = TV2x;
+		scalers[count++].scaleFactor = 2;
+		scalers[count].proc = DotMatrix;
+		scalers[count++].scaleFactor = 2;
+#ifdef USE_HQ_SCALERS
+		scalers[count].proc = HQ2x;
+		scalers[count++].scaleFactor = 2;
+		scalers[count].proc = HQ3x;
+		scalers[count++].scaleFactor = 3;
+#endif
+#endif
+		return count;
+	}
+
+	public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void tearDown() {
+		DestroyScalers();
+	}
+
+	void test_interpolate8888() {
+		for (uint i = 0; i < 1000; ++i) {
+			const uint32 p1 = nextRandom(), p2 = nextRandom(), p3 = nextRandom();
+			const uint32 result = interpolate16_2_7_7<Graphics::ColorMasks<8888> >(p1, p2, p3);
+
+			bool exact = true;
+			for (int shift = 0; shift < 32; shift += 8) {
+				const uint32 expected = (2 * ((p1 >> shift) & 0xFF) + 7 * ((p2 >> shift) & 0xFF) + 7 * ((p3 >> shift) & 0xFF)) >> 4;
+				exact &= (((result >> shift) & 0xFF) == expected);
+			}
+			TS_ASSERT(exact);
+		}
+	}
+
+	void test_bands() {
+		Scaler scalers[16];
+		const uint numScalers = getScalers(scalers);
+
+		uint16 src16[ARRAYSIZE(_src)];
+		fillSource(2);
+		copyPixels(src16, _src, ARRAYSIZE(_src));
+		InitScalers(Graphics::createPixelFormat<565>());
+		for (uint i = 0; i < numScalers; ++i)
+			TS_ASSERT(scalesInBands(scalers[i].proc, scalers[i].scaleFactor, src16));
+
+		fillSource(4);
+		InitScalers(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+		for (uint i = 0; i < numScalers; ++i)
+			TS_ASSERT(scalesInBands(scalers[i].proc, scalers[i].scaleFactor, _src));
+	}
+
+	void test_32bit_layouts() {
+		// Scaling RGBA pixels must give the same result as scaling the same
+		// colors as ARGB pixels
+		Scaler scalers[16];
+		const uint numScalers = getScalers(scalers);
+
+		fillSource(4);
+		uint32 rotated[ARRAYSIZE(_src)];
+		for (uint i = 0; i < ARRAYSIZE(_src); ++i)
+			rotated[i] = (_src[i] << 8) | (_src[i] >> 24);
+
+		const uint dstSize = kWidth * kMaxScale * kHeight * kMaxScale;
+		static uint32 argb[dstSize], rgba[dstSize];
+		for (uint i = 0; i < numScalers; ++i) {
+			memset(argb, 0, sizeof(argb));
+			memset(rgba, 0, sizeof(rgba));
+
+			InitScalers(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+			scale(scalers[i].proc, _src, argb, 0, kHeight, scalers[i].scaleFactor);
+			InitScalers(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+			scale(scalers[i].proc, rotated, rgba, 0, kHeight, scalers[i].scaleFactor);
+
+			bool equal = true;
+			for (uint j = 0; j < dstSize; ++j)
+				equal &= (rgba[j] == ((argb[j] << 8) | (argb[j] >> 24)));
+			TS_ASSERT(equal);
+		}
+	}
+};
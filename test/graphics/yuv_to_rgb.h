@@ -0,0 +1,193 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#include "test/testsystem.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	enum {
+		// Not a multiple of any SIMD width, so that the tails are covered too
+		kWidth = 70,
+		kPitch = 80
+	};
+
+	uint32 _seed;
+	byte _y[2 * kPitch];
+	byte _u[kPitch];
+	byte _v[kPitch];
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) | (_seed << 16);
+	}
+
+	void fillPlanes() {
+		for (uint i = 0; i < ARRAYSIZE(_y); ++i)
+			_y[i] = nextRandom();
+		for (uint i = 0; i < kPitch; ++i) {
+			_u[i] = nextRandom();
+			_v[i] = nextRandom();
+		}
+	}
+
+	static Graphics::PixelFormat getFormat(uint i) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),		// RGB565
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),		// ARGB1555
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 12, 8, 4, 0),		// RGBA4444
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),		// ARGB8888
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24),		// ABGR8888
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 24, 16, 8, 0),		// RGBX8888
+			Graphics::PixelFormat(4, 7, 6, 5, 2, 20, 10, 2, 28),	// something odd
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 12, 4, 20, 0)		// red spans both halves
+		};
+		return i < ARRAYSIZE(formats) ? formats[i] : Graphics::PixelFormat();
+	}
+
+	static byte channel(int x, Graphics::YUVToRGBManager::LuminanceScale scale) {
+		if (scale == Graphics::YUVToRGBManager::kScaleFull)
+			return CLIP(x, 0, 255);
+		return (CLIP(x, 16, 235) - 16) * 255 / 219;
+	}
+
+	/** The color of a pixel, computed like the lookup tables are. */
+	static uint32 reference(const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, byte y, byte u, byte v) {
+		const int16 cr = v - 128, cb = u - 128;
+		const int r = y + (int16)((0.419 / 0.299) * cr);
+		const int g = y + (int16)(-(0.299 / 0.419) * cr) + (int16)(-(0.114 / 0.331) * cb);
+		const int b = y + (int16)((0.587 / 0.331) * cb);
+		return format.RGBToColor(channel(r, scale), channel(g, scale), channel(b, scale));
+	}
+
+	template<typename PixelInt>
+	bool check444(const PixelInt *dst, const Graphics::YUVToRGBTables &tables) {
+		bool equal = true;
+		for (uint i = 0; i < kWidth; ++i)
+			equal &= (dst[i] == (PixelInt)reference(tables.format, tables.scale, _y[i], _u[i], _v[i]));
+		return equal;
+	}
+
+	template<typename PixelInt>
+	bool check420(const PixelInt *dst, const Graphics::YUVToRGBTables &tables) {
+		bool equal = true;
+		for (uint row = 0; row < 2; ++row) {
+			for (uint i = 0; i < kWidth; ++i)
+				equal &= (dst[row * kPitch + i] == (PixelInt)reference(tables.format, tables.scale, _y[row * kPitch + i], _u[i / 2], _v[i / 2]));
+		}
+		return equal;
+	}
+
+	void compareKernels(const Graphics::YUVToRGBKernels &kernels, const Graphics::YUVToRGBTables &tables) {
+		uint16 dst16[2 * kPitch];
+		uint32 dst32[2 * kPitch];
+
+		// Enough rounds to go through all chroma values a few times
+		for (uint round = 0; round < 32; ++round) {
+			fillPlanes();
+
+			if (tables.format.bytesPerPixel == 2) {
+				kernels.convert444To16(dst16, _y, _u, _v, kWidth, tables);
+				TS_ASSERT(check444(dst16, tables));
+				kernels.convert420To16(dst16, kPitch * 2, _y, kPitch, _u, _v, kWidth, tables);
+				TS_ASSERT(check420(dst16, tables));
+			} else {
+				kernels.convert444To32(dst32, _y, _u, _v, kWidth, tables);
+				TS_ASSERT(check444(dst32, tables));
+				kernels.convert420To32(dst32, kPitch * 4, _y, kPitch, _u, _v, kWidth, tables);
+				TS_ASSERT(check420(dst32, tables));
+			}
+		}
+	}
+
+	public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void test_kernels() {
+		for (int type = 0; type < Graphics::kYUVToRGBKernelsCount; ++type) {
+			const Graphics::YUVToRGBKernels *kernels = Graphics::getYUVToRGBKernels((Graphics::YUVToRGBKernelType)type);
+			TS_ASSERT(kernels || type != Graphics::kYUVToRGBKernelsScalar);
+			if (!kernels)
+				continue;
+
+			for (uint i = 0; getFormat(i).bytesPerPixel; ++i) {
+				Graphics::YUVToRGBTables tables;
+				tables.init(getFormat(i), Graphics::YUVToRGBManager::kScaleFull);
+				compareKernels(*kernels, tables);
+				tables.init(getFormat(i), Graphics::YUVToRGBManager::kScaleITU);
+				compareKernels(*kernels, tables);
+			}
+		}
+	}
+
+	void test_best_kernels() {
+		// The kernels the manager uses, on their own
+		const Graphics::YUVToRGBKernels &kernels = Graphics::getBestYUVToRGBKernels();
+		Graphics::YUVToRGBTables tables;
+		tables.init(getFormat(3), Graphics::YUVToRGBManager::kScaleITU);
+		uint32 dst[2 * kPitch];
+		fillPlanes();
+
+		kernels.convert420To32(dst, kPitch * 4, _y, kPitch, _u, _v, kWidth, tables);
+		TS_ASSERT(check420(dst, tables));
+
+		// Full scale black and white, and ITU black
+		memset(_u, 128, sizeof(_u));
+		memset(_v, 128, sizeof(_v));
+		memset(_y, 0, kPitch);
+		memset(_y + kPitch, 255, kPitch);
+		tables.init(getFormat(3), Graphics::YUVToRGBManager::kScaleFull);
+		kernels.convert420To32(dst, kPitch * 4, _y, kPitch, _u, _v, kWidth, tables);
+		TS_ASSERT_EQUALS(dst[kWidth - 1], 0xFF000000U);
+		TS_ASSERT_EQUALS(dst[kPitch + kWidth - 1], 0xFFFFFFFFU);
+
+		memset(_y, 16, kPitch);
+		tables.init(getFormat(3), Graphics::YUVToRGBManager::kScaleITU);
+		kernels.convert420To32(dst, kPitch * 4, _y, kPitch, _u, _v, kWidth, tables);
+		TS_ASSERT_EQUALS(dst[0], 0xFF000000U);
+	}
+
+	void test_convert420_in_bands() {
+		// Large enough to be converted in bands by the manager's worker pool,
+		// which needs an OSystem for its threads
+		const int width = 646, height = 400, yPitch = 656, uvPitch = 328;
+		const Graphics::PixelFormat format = getFormat(3);
+
+		byte *y = new byte[yPitch * height];
+		byte *u = new byte[uvPitch * height / 2];
+		byte *v = new byte[uvPitch * height / 2];
+		for (int i = 0; i < yPitch * height; ++i)
+			y[i] = nextRandom();
+		for (int i = 0; i < uvPitch * height / 2; ++i) {
+			u[i] = nextRandom();
+			v[i] = nextRandom();
+		}
+
+		Graphics::Surface surface;
+		surface.create(width, height, format);
+
+		TestSystem system;
+		g_system = &system;
+		YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, height, yPitch, uvPitch);
+		Graphics::YUVToRGBManager::destroy();
+		g_system = 0;
+
+		bool equal = true;
+		for (int row = 0; row < height; ++row) {
+			const uint32 *dst = (const uint32 *)surface.getBasePtr(0, row);
+			const int uvOffset = row / 2 * uvPitch;
+			for (int i = 0; i < width; ++i)
+				equal &= (dst[i] == reference(format, Graphics::YUVToRGBManager::kScaleITU, y[row * yPitch + i], u[uvOffset + i / 2], v[uvOffset + i / 2]));
+		}
+		TS_ASSERT(equal);
+
+		surface.free();
+		delete[] y;
+		delete[] u;
+		delete[] v;
+	}
+};
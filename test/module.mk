@@ -3,10 +3,15 @@
 # Use the 'test' target to run them.
 # Edit TESTS and TESTLIBS to add more tests.
 #
+# Benchmarks are standalone programs in test/benchmark.
+# Use the 'bench' target to build and run them.
+#
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/video/*.h
+TEST_LIBS    := video/libvideo.a graphics/libgraphics.a audio/libaudio.a common/libcommon.a
+# An OSystem providing mutexes and threads, see test/testsystem.h
+TEST_SRCS    := $(srcdir)/test/testsystem.cpp
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
@@ -28,15 +33,23 @@ endif
 
 test: test/runner
 	./test/runner
-test/runner: test/runner.cpp $(TEST_LIBS)
+test/runner: test/runner.cpp $(TEST_SRCS) $(TEST_LIBS)
 	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
 test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+BENCHMARKS   := $(patsubst $(srcdir)/%.cpp,%,$(wildcard $(srcdir)/test/benchmark/*.cpp))
+
+bench: $(BENCHMARKS)
+	@for bench in $(BENCHMARKS); do echo "$$bench:"; ./$$bench || exit 1; done
+test/benchmark/%: $(srcdir)/test/benchmark/%.cpp $(TEST_LIBS)
+	@mkdir -p test/benchmark
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner $(BENCHMARKS)
 
-.PHONY: test clean-test
+.PHONY: test bench clean-test
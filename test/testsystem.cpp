@@ -0,0 +1,167 @@
+// pthread.h pulls in time.h, which clashes with the forbidden symbols
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/testsystem.h"
+#include "graphics/pixelformat.h"
+
+#include <string.h>
+
+#ifdef POSIX
+#include <pthread.h>
+
+namespace {
+
+struct Semaphore {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	uint count;
+};
+
+struct Thread {
+	pthread_t thread;
+	OSystem::ThreadProc proc;
+	void *param;
+};
+
+void *threadProc(void *param) {
+	Thread *thread = (Thread *)param;
+	thread->proc(thread->param);
+	return 0;
+}
+
+} // End of anonymous namespace
+#endif
+
+const OSystem::GraphicsMode *TestSystem::getSupportedGraphicsModes() const {
+	static const GraphicsMode modes[] = { { 0, 0, 0 } };
+	return modes;
+}
+
+Graphics::PixelFormat TestSystem::getScreenFormat() const {
+	return Graphics::PixelFormat::createFormatCLUT8();
+}
+
+Common::List<Graphics::PixelFormat> TestSystem::getSupportedFormats() const {
+	return Common::List<Graphics::PixelFormat>();
+}
+
+Graphics::PixelFormat TestSystem::getOverlayFormat() const {
+	return Graphics::PixelFormat::createFormatCLUT8();
+}
+
+void TestSystem::getTimeAndDate(TimeDate &t) const {
+	memset(&t, 0, sizeof(t));
+}
+
+#ifdef POSIX
+
+OSystem::MutexRef TestSystem::createMutex() {
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_t *mutex = new pthread_mutex_t;
+	pthread_mutex_init(mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	return (MutexRef)mutex;
+}
+
+void TestSystem::lockMutex(MutexRef mutex) {
+	pthread_mutex_lock((pthread_mutex_t *)mutex);
+}
+
+void TestSystem::unlockMutex(MutexRef mutex) {
+	pthread_mutex_unlock((pthread_mutex_t *)mutex);
+}
+
+void TestSystem::deleteMutex(MutexRef mutex) {
+	pthread_mutex_destroy((pthread_mutex_t *)mutex);
+	delete (pthread_mutex_t *)mutex;
+}
+
+OSystem::ThreadRef TestSystem::createThread(ThreadProc proc, void *param) {
+	Thread *thread = new Thread;
+	thread->proc = proc;
+	thread->param = param;
+	if (pthread_create(&thread->thread, 0, threadProc, thread)) {
+		delete thread;
+		return 0;
+	}
+	return (ThreadRef)thread;
+}
+
+void TestSystem::joinThread(ThreadRef thread) {
+	pthread_join(((Thread *)thread)->thread, 0);
+	delete (Thread *)thread;
+}
+
+OSystem::SemaphoreRef TestSystem::createSemaphore(uint initialCount) {
+	Semaphore *semaphore = new Semaphore;
+	pthread_mutex_init(&semaphore->mutex, 0);
+	pthread_cond_init(&semaphore->cond, 0);
+	semaphore->count = initialCount;
+	return (SemaphoreRef)semaphore;
+}
+
+void TestSystem::waitSemaphore(SemaphoreRef semaphore) {
+	Semaphore *s = (Semaphore *)semaphore;
+	pthread_mutex_lock(&s->mutex);
+	while (!s->count)
+		pthread_cond_wait(&s->cond, &s->mutex);
+	s->count--;
+	pthread_mutex_unlock(&s->mutex);
+}
+
+void TestSystem::postSemaphore(SemaphoreRef semaphore) {
+	Semaphore *s = (Semaphore *)semaphore;
+	pthread_mutex_lock(&s->mutex);
+	s->count++;
+	pthread_cond_signal(&s->cond);
+	pthread_mutex_unlock(&s->mutex);
+}
+
+void TestSystem::deleteSemaphore(SemaphoreRef semaphore) {
+	Semaphore *s = (Semaphore *)semaphore;
+	pthread_cond_destroy(&s->cond);
+	pthread_mutex_destroy(&s->mutex);
+	delete s;
+}
+
+#else
+
+// Without threads, mutexes never have to block and the worker pools run
+// their jobs right away
+
+OSystem::MutexRef TestSystem::createMutex() {
+	return (MutexRef)1;
+}
+
+void TestSystem::lockMutex(MutexRef mutex) {
+}
+
+void TestSystem::unlockMutex(MutexRef mutex) {
+}
+
+void TestSystem::deleteMutex(MutexRef mutex) {
+}
+
+OSystem::ThreadRef TestSystem::createThread(ThreadProc proc, void *param) {
+	return 0;
+}
+
+void TestSystem::joinThread(ThreadRef thread) {
+}
+
+OSystem::SemaphoreRef TestSystem::createSemaphore(uint initialCount) {
+	return 0;
+}
+
+void TestSystem::waitSemaphore(SemaphoreRef semaphore) {
+}
+
+void TestSystem::postSemaphore(SemaphoreRef semaphore) {
+}
+
+void TestSystem::deleteSemaphore(SemaphoreRef semaphore) {
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef TEST_TESTSYSTEM_H
+#define TEST_TESTSYSTEM_H
+
+#include "common/system.h"
+
+/**
+ * Just enough of an OSystem for code which needs mutexes and threads, like
+ * Common::WorkerPool. Threads are only available on POSIX systems. Install
+ * it as g_system only for the duration of a test.
+ *
+ * The implementation lives in test/testsystem.cpp, since the system headers
+ * it needs clash with common/forbidden.h in the test runner.
+ */
+class TestSystem : public OSystem {
+public:
+	const GraphicsMode *getSupportedGraphicsModes() const;
+	int getDefaultGraphicsMode() const { return 0; }
+	bool setGraphicsMode(int mode) { return true; }
+	int getGraphicsMode() const { return 0; }
+	Graphics::PixelFormat getScreenFormat() const;
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const;
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	int16 getHeight() { return 0; }
+	int16 getWidth() { return 0; }
+	PaletteManager *getPaletteManager() { return 0; }
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	Graphics::Surface *lockScreen() { return 0; }
+	void unlockScreen() {}
+	void fillScreen(uint32 col) {}
+	void updateScreen() {}
+	void setShakePos(int shakeOffset) {}
+	void showOverlay() {}
+	void hideOverlay() {}
+	Graphics::PixelFormat getOverlayFormat() const;
+	void clearOverlay() {}
+	void grabOverlay(void *buf, int pitch) {}
+	void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	int16 getOverlayHeight() { return 0; }
+	int16 getOverlayWidth() { return 0; }
+	bool showMouse(bool visible) { return false; }
+	void warpMouse(int x, int y) {}
+	void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) {}
+	uint32 getMillis(bool skipRecord) { return 0; }
+	void delayMillis(uint msecs) {}
+	void getTimeAndDate(TimeDate &t) const;
+	Audio::Mixer *getMixer() { return 0; }
+	void quit() {}
+	void displayMessageOnOSD(const char *msg) {}
+	void logMessage(LogMessageType::Type type, const char *message) {}
+
+	MutexRef createMutex();
+	void lockMutex(MutexRef mutex);
+	void unlockMutex(MutexRef mutex);
+	void deleteMutex(MutexRef mutex);
+
+	ThreadRef createThread(ThreadProc proc, void *param);
+	void joinThread(ThreadRef thread);
+
+	SemaphoreRef createSemaphore(uint initialCount);
+	void waitSemaphore(SemaphoreRef semaphore);
+	void postSemaphore(SemaphoreRef semaphore);
+	void deleteSemaphore(SemaphoreRef semaphore);
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include <cxxtest/TestSuite.h>
+
+#include "video/dsp.h"
+
+class DSPTestSuite : public CxxTest::TestSuite {
+	enum {
+		// Blocks are written to planes with a pitch other than their width
+		kPitch = 21
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) | (_seed << 16);
+	}
+
+	/** Fills a block of coefficients, from sparse small ones to the full int16 range. */
+	void fillCoefficients(int16 *block, uint pass) {
+		const uint range = (pass % 3 == 0) ? 0x10000 : (pass % 3 == 1) ? 0x800 : 0x40;
+		const bool sparse = (pass & 4) != 0;
+
+		for (uint i = 0; i < 64; ++i) {
+			if (sparse && i && (nextRandom() & 7))
+				block[i] = 0;
+			else
+				block[i] = (int16)((int)(nextRandom() % range) - (int)(range / 2));
+		}
+	}
+
+	void fillBytes(byte *buf, uint size) {
+		for (uint i = 0; i < size; ++i)
+			buf[i] = nextRandom() & 0xFF;
+	}
+
+	void fillFloats(float *buf, uint count, int range) {
+		for (uint i = 0; i < count; ++i)
+			buf[i] = (float)((int)(nextRandom() % (2 * range * 16)) - range * 16) / 16.0f;
+	}
+
+	void compareBinkIDCT(const Video::DSPKernels &kernels, const Video::DSPKernels &scalar) {
+		for (uint pass = 0; pass < 200; ++pass) {
+			int16 coefficients[64], expected[64], block[64];
+			fillCoefficients(coefficients, pass);
+
+			memcpy(expected, coefficients, sizeof(expected));
+			memcpy(block, coefficients, sizeof(block));
+			scalar.binkIDCT(expected);
+			kernels.binkIDCT(block);
+			TS_ASSERT(!memcmp(block, expected, sizeof(block)));
+
+			byte plane1[8 * kPitch], plane2[8 * kPitch];
+			fillBytes(plane1, sizeof(plane1));
+			memcpy(plane2, plane1, sizeof(plane2));
+			scalar.binkIDCTPut(plane1, kPitch, coefficients);
+			kernels.binkIDCTPut(plane2, kPitch, coefficients);
+			TS_ASSERT(!memcmp(plane1, plane2, sizeof(plane1)));
+
+			fillBytes(plane1, sizeof(plane1));
+			memcpy(plane2, plane1, sizeof(plane2));
+			scalar.binkIDCTAdd(plane1, kPitch, coefficients);
+			kernels.binkIDCTAdd(plane2, kPitch, coefficients);
+			TS_ASSERT(!memcmp(plane1, plane2, sizeof(plane1)));
+
+			fillBytes(plane1, sizeof(plane1));
+			memcpy(plane2, plane1, sizeof(plane2));
+			scalar.add8x8(plane1, kPitch, coefficients);
+			kernels.add8x8(plane2, kPitch, coefficients);
+			TS_ASSERT(!memcmp(plane1, plane2, sizeof(plane1)));
+		}
+	}
+
+	void compareBlockCopies(const Video::DSPKernels &kernels, const Video::DSPKernels &scalar) {
+		byte src[16 * kPitch], plane1[16 * kPitch], plane2[16 * kPitch];
+		fillBytes(src, sizeof(src));
+
+		fillBytes(plane1, sizeof(plane1));
+		memcpy(plane2, plane1, sizeof(plane2));
+		scalar.copy8x8(plane1 + 3, src + 5, kPitch);
+		kernels.copy8x8(plane2 + 3, src + 5, kPitch);
+		TS_ASSERT(!memcmp(plane1, plane2, sizeof(plane1)));
+
+		scalar.copy16x16(plane1 + 1, src + 2, kPitch);
+		kernels.copy16x16(plane2 + 1, src + 2, kPitch);
+		TS_ASSERT(!memcmp(plane1, plane2, sizeof(plane1)));
+
+		for (uint pass = 0; pass < 20; ++pass) {
+			byte patterns[8];
+			fillBytes(patterns, sizeof(patterns));
+			const byte color0 = nextRandom() & 0xFF, color1 = nextRandom() & 0xFF;
+
+			scalar.pattern8x8(plane1 + 7, kPitch, patterns, color0, color1);
+			kernels.pattern8x8(plane2 + 7, kPitch, patterns, color0, color1);
+			TS_ASSERT(!memcmp(plane1, plane2, sizeof(plane1)));
+		}
+	}
+
+	void compareMDEC(const Video::DSPKernels &kernels, const Video::DSPKernels &scalar) {
+		for (uint pass = 0; pass < 100; ++pass) {
+			float block[64], expected[64], result[64];
+			fillFloats(block, 64, (pass & 1) ? 2048 : 64);
+
+			scalar.mdecIDCT(expected, block);
+			kernels.mdecIDCT(result, block);
+			TS_ASSERT(!memcmp(result, expected, sizeof(result)));
+
+			// Samples outside [-128, 127] have to be saturated
+			fillFloats(block, 64, 300);
+			byte plane1[8 * kPitch], plane2[8 * kPitch];
+			fillBytes(plane1, sizeof(plane1));
+			memcpy(plane2, plane1, sizeof(plane2));
+			scalar.putSigned8x8(plane1, kPitch, block);
+			kernels.putSigned8x8(plane2, kPitch, block);
+			TS_ASSERT(!memcmp(plane1, plane2, sizeof(plane1)));
+		}
+	}
+
+	public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void test_bink_idct_dc() {
+		// A block with only a DC coefficient is flat
+		int16 block[64];
+		memset(block, 0, sizeof(block));
+		block[0] = 8 * 256;
+
+		const Video::DSPKernels *scalar = Video::getDSPKernels(Video::kDSPKernelsScalar);
+		TS_ASSERT(scalar);
+		if (!scalar)
+			return;
+
+		byte plane[8 * kPitch];
+		memset(plane, 0, sizeof(plane));
+		scalar->binkIDCTPut(plane, kPitch, block);
+
+		bool flat = true;
+		for (uint y = 0; y < 8; ++y)
+			for (uint x = 0; x < kPitch; ++x)
+				flat &= (plane[y * kPitch + x] == ((x < 8) ? 8 : 0));
+		TS_ASSERT(flat);
+	}
+
+	void test_kernels() {
+		const Video::DSPKernels *scalar = Video::getDSPKernels(Video::kDSPKernelsScalar);
+		TS_ASSERT(scalar);
+		if (!scalar)
+			return;
+
+		for (int type = 0; type < Video::kDSPKernelsCount; ++type) {
+			const Video::DSPKernels *kernels = Video::getDSPKernels((Video::DSPKernelType)type);
+			if (!kernels)
+				continue;
+
+			compareBinkIDCT(*kernels, *scalar);
+			compareBlockCopies(*kernels, *scalar);
+			compareMDEC(*kernels, *scalar);
+		}
+	}
+};
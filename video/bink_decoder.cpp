@@ -31,7 +31,6 @@
 #include "common/textconsole.h"
 #include "common/math.h"
 #include "common/stream.h"
-#include "common/substream.h"
 #include "common/file.h"
 #include "common/str.h"
 #include "common/bitstream.h"
@@ -45,6 +44,7 @@
 
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
+#include "video/dsp.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
@@ -63,10 +63,14 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+	_decodePool = 0;
+	_decodeAhead = true;
 }
 
 BinkDecoder::~BinkDecoder() {
 	close();
+
+	delete _decodePool;
 }
 
 bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
@@ -99,11 +103,14 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 
 	_bink = stream;
 
+	if (!_decodePool)
+		_decodePool = new Common::WorkerPool(kDecodeThreads);
+
 	uint32 videoFlags = _bink->readUint32LE();
 
 	// BIKh and BIKi swap the chroma planes
 	addTrack(new BinkVideoTrack(width, height, getDefaultHighColorFormat(), frameCount,
-			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id));
+			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id, *_decodePool));
 
 	uint32 audioTrackCount = _bink->readUint32LE();
 
@@ -162,7 +169,19 @@ void BinkDecoder::readNextPacket() {
 	if (videoTrack->endOfTrack())
 		return;
 
-	VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
+	// The frame might have been read ahead already
+	if (!videoTrack->hasPendingPacket())
+		readPacket(_frames[videoTrack->getCurFrame() + 1], false);
+
+	videoTrack->finishFrame();
+
+	// Decode the next frame while this one is shown
+	if (_decodeAhead && _decodePool->isThreaded() && !videoTrack->endOfTrack())
+		readPacket(_frames[videoTrack->getCurFrame() + 1], true);
+}
+
+void BinkDecoder::readPacket(VideoFrame &frame, bool decodeAhead) {
+	BinkVideoTrack *videoTrack = (BinkVideoTrack *)getTrack(0);
 
 	if (!_bink->seek(frame.offset))
 		error("Bad bink seek");
@@ -182,36 +201,35 @@ void BinkDecoder::readNextPacket() {
 		if (audioPacketLength >= 4) {
 			// Get our track - audio index plus one as the first track is video
 			BinkAudioTrack *audioTrack = (BinkAudioTrack *)getTrack(i + 1);
-			uint32 audioPacketStart = _bink->pos();
-			uint32 audioPacketEnd   = _bink->pos() + audioPacketLength;
+			uint32 audioPacketEnd = _bink->pos() + audioPacketLength;
 
 			//                  Number of samples in bytes
 			audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
 
-			audio.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-					audioPacketStart + 4, audioPacketEnd), true);
+			byte *audioPacket = new byte[audioPacketLength - 4];
+			if (_bink->read(audioPacket, audioPacketLength - 4) != audioPacketLength - 4)
+				error("Failed to read the audio packet");
+
+			audio.bits = new Common::BitStreamMemory32LELSB(audioPacket, audioPacketLength - 4);
 
 			audioTrack->decodePacket();
 
 			delete audio.bits;
 			audio.bits = 0;
 
+			delete[] audioPacket;
+
 			_bink->seek(audioPacketEnd);
 
 			frameSize -= audioPacketLength;
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
-
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), true);
-
-	videoTrack->decodePacket(frame);
+	byte *videoPacket = new byte[frameSize];
+	if (_bink->read(videoPacket, frameSize) != frameSize)
+		error("Failed to read the video packet");
 
-	delete frame.bits;
-	frame.bits = 0;
+	videoTrack->decodePacket(frame, videoPacket, frameSize, decodeAhead);
 }
 
 BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
@@ -234,8 +252,10 @@ BinkDecoder::AudioInfo::~AudioInfo() {
 	delete dct;
 }
 
-BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id) :
-		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id) {
+BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id, Common::WorkerPool &pool) :
+		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id),
+		_pool(pool), _decodeJob(this), _pendingPacket(false), _packetFrame(0), _packet(0), _packetSize(0),
+		_dsp(getBestDSPKernels()) {
 	_curFrame = -1;
 
 	for (int i = 0; i < 16; i++)
@@ -278,6 +298,10 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	_surface.h = height;
 	_surface.w = width;
 
+	_nextSurface.create(_surfaceWidth, _surfaceHeight, format);
+	_nextSurface.h = height;
+	_nextSurface.w = width;
+
 	// Give the planes a bit extra space
 	width  = _surface.w + 32;
 	height = _surface.h + 32;
@@ -306,6 +330,9 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 }
 
 BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
+	_pool.cancel(&_decodeJob);
+	delete[] _packet;
+
 	for (int i = 0; i < 4; i++) {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
@@ -319,10 +346,39 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 	}
 
 	_surface.free();
+	_nextSurface.free();
+}
+
+void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame, byte *data, uint32 size, bool decodeAhead) {
+	assert(!_pendingPacket);
+
+	_pendingPacket = true;
+	_packetFrame   = &frame;
+	_packet        = data;
+	_packetSize    = size;
+
+	if (decodeAhead)
+		_pool.schedule(&_decodeJob);
+}
+
+void BinkDecoder::BinkVideoTrack::finishFrame() {
+	assert(_pendingPacket);
+
+	// Decode the packet ourselves if no worker picked it up yet
+	_pool.cancel(&_decodeJob);
+	if (_packet)
+		decodeFrame();
+
+	SWAP(_surface, _nextSurface);
+
+	_pendingPacket = false;
+	_curFrame++;
 }
 
-void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
-	assert(frame.bits);
+void BinkDecoder::BinkVideoTrack::decodeFrame() {
+	VideoFrame &frame = *_packetFrame;
+
+	frame.bits = new Common::BitStreamMemory32LELSB(_packet, _packetSize);
 
 	if (_hasAlpha) {
 		if (_id == kBIKiID)
@@ -348,14 +404,18 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
 	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
+	YUVToRGBMan.convert420(&_nextSurface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
 			_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
 		SWAP(_curPlanes[i], _oldPlanes[i]);
 
-	_curFrame++;
+	delete frame.bits;
+	frame.bits = 0;
+
+	delete[] _packet;
+	_packet = 0;
 }
 
 void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
@@ -583,7 +643,7 @@ void BinkDecoder::BinkVideoTrack::deinitBundles() {
 
 void BinkDecoder::BinkVideoTrack::initHuffman() {
 	for (int i = 0; i < 16; i++)
-		_huffman[i] = new Common::Huffman(binkHuffmanLengths[i][15], 16, binkHuffmanCodes[i], binkHuffmanLengths[i]);
+		_huffman[i] = new Common::Huffman<Common::BitStreamMemory32LELSB>(binkHuffmanLengths[i][15], 16, binkHuffmanCodes[i], binkHuffmanLengths[i]);
 }
 
 byte BinkDecoder::BinkVideoTrack::getHuffmanSymbol(VideoFrame &video, Huffman &huffman) {
@@ -616,19 +676,11 @@ uint32 BinkDecoder::BinkVideoTrack::readBundleCount(VideoFrame &video, Bundle &b
 }
 
 void BinkDecoder::BinkVideoTrack::blockSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
-
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	_dsp.copy8x8(ctx.dest, ctx.prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
-
-	for (int j = 0; j < 16; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 16);
+	_dsp.copy16x16(ctx.dest, ctx.prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
@@ -675,7 +727,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCT(block);
+	_dsp.binkIDCT(block);
 
 	int16 *src   = block;
 	byte  *dest1 = ctx.dest;
@@ -759,13 +811,11 @@ void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
 	int8 xOff = getBundleValue(kSourceXOff);
 	int8 yOff = getBundleValue(kSourceYOff);
 
-	byte *dest = ctx.dest;
 	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
 	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd))
 		error("Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
 
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	_dsp.copy8x8(ctx.dest, prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
@@ -805,11 +855,7 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 
 	readResidue(*ctx.video, block, v);
 
-	byte  *dst = ctx.dest;
-	int16 *src = block;
-	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8)
-		for (int j = 0; j < 8; j++)
-			dst[j] += src[j];
+	_dsp.add8x8(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
@@ -820,7 +866,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCTPut(ctx, block);
+	_dsp.binkIDCTPut(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
@@ -841,7 +887,7 @@ void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, false);
 
-	IDCTAdd(ctx, block);
+	_dsp.binkIDCTAdd(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
@@ -850,13 +896,8 @@ void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 	for (int i = 0; i < 2; i++)
 		col[i] = getBundleValue(kSourceColors);
 
-	byte *dest = ctx.dest;
-	for (int i = 0; i < 8; i++, dest += ctx.pitch - 8) {
-		byte v = getBundleValue(kSourcePattern);
-
-		for (int j = 0; j < 8; j++, v >>= 1)
-			*dest++ = col[v & 1];
-	}
+	_dsp.pattern8x8(ctx.dest, ctx.pitch, _bundles[kSourcePattern].curPtr, col[0], col[1]);
+	_bundles[kSourcePattern].curPtr += 8;
 }
 
 void BinkDecoder::BinkVideoTrack::blockRaw(DecodeContext &ctx) {
@@ -1259,88 +1300,6 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-    const int a0 = (src)[s0] + (src)[s4]; \
-    const int a1 = (src)[s0] - (src)[s4]; \
-    const int a2 = (src)[s2] + (src)[s6]; \
-    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-    const int a4 = (src)[s5] + (src)[s3]; \
-    const int a5 = (src)[s5] - (src)[s3]; \
-    const int a6 = (src)[s1] + (src)[s7]; \
-    const int a7 = (src)[s1] - (src)[s7]; \
-    const int b0 = a4 + a6; \
-    const int b1 = (A3*(a5 + a7)) >> 11; \
-    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-    (dest)[d0] = munge(a0+a2   +b0); \
-    (dest)[d1] = munge(a1+a3-a2+b2); \
-    (dest)[d2] = munge(a1-a3+a2+b3); \
-    (dest)[d3] = munge(a0-a2   -b4); \
-    (dest)[d4] = munge(a0-a2   +b4); \
-    (dest)[d5] = munge(a1-a3+a2-b3); \
-    (dest)[d6] = munge(a1+a3-a2-b2); \
-    (dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int16 *dest, const int16 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
-	int i;
-	int16 temp[64];
-
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int16 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int16 *block) {
-	int i;
-	int16 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
-	}
-}
-
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio) : _audioInfo(&audio) {
 	_audioStream = Audio::makeQueuingAudioStream(_audioInfo->outSampleRate, _audioInfo->outChannels == 2);
 }
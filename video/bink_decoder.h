@@ -32,7 +32,9 @@
 #define VIDEO_BINK_DECODER_H
 
 #include "common/array.h"
+#include "common/bitstream.h"
 #include "common/rational.h"
+#include "common/workerpool.h"
 
 #include "video/video_decoder.h"
 
@@ -45,8 +47,7 @@ class QueuingAudioStream;
 
 namespace Common {
 class SeekableReadStream;
-class BitStream;
-class Huffman;
+template<class BITSTREAM> class Huffman;
 
 class RDFT;
 class DCT;
@@ -58,6 +59,8 @@ struct Surface;
 
 namespace Video {
 
+struct DSPKernels;
+
 /**
  * Decoder for Bink videos.
  *
@@ -72,10 +75,20 @@ public:
 	bool loadStream(Common::SeekableReadStream *stream);
 	void close();
 
+	/**
+	 * Set whether the next frame is decoded on a worker thread while the
+	 * current one is shown. Enabled by default, it has no effect if the
+	 * backend does not support threads.
+	 */
+	void setDecodeAhead(bool decodeAhead) { _decodeAhead = decodeAhead; }
+
 protected:
 	void readNextPacket();
 
 private:
+	/** Number of worker threads decoding video frames. */
+	static const int kDecodeThreads = 1;
+
 	static const int kAudioChannelsMax  = 2;
 	static const int kAudioBlockSizeMax = (kAudioChannelsMax << 11);
 
@@ -98,7 +111,7 @@ private:
 
 		uint32 sampleCount;
 
-		Common::BitStream *bits;
+		Common::BitStreamMemory32LELSB *bits;
 
 		bool first;
 
@@ -131,7 +144,7 @@ private:
 		uint32 offset;
 		uint32 size;
 
-		Common::BitStream *bits;
+		Common::BitStreamMemory32LELSB *bits;
 
 		VideoFrame();
 		~VideoFrame();
@@ -139,7 +152,7 @@ private:
 
 	class BinkVideoTrack : public FixedRateVideoTrack {
 	public:
-		BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id);
+		BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id, Common::WorkerPool &pool);
 		~BinkVideoTrack();
 
 		uint16 getWidth() const { return _surface.w; }
@@ -149,8 +162,16 @@ private:
 		int getFrameCount() const { return _frameCount; }
 		const Graphics::Surface *decodeNextFrame() { return &_surface; }
 
-		/** Decode a video packet. */
-		void decodePacket(VideoFrame &frame);
+		/**
+		 * Decode a video packet, the track takes ownership of the data. With
+		 * decodeAhead set, the packet is decoded on a worker thread, else it
+		 * is decoded by finishFrame().
+		 */
+		void decodePacket(VideoFrame &frame, byte *data, uint32 size, bool decodeAhead);
+		/** Is there a packet which was not finished yet? */
+		bool hasPendingPacket() const { return _pendingPacket; }
+		/** Wait for the pending packet to be decoded and make it the current frame. */
+		void finishFrame();
 
 	protected:
 		Common::Rational getFrameRate() const { return _frameRate; }
@@ -209,6 +230,15 @@ private:
 			kBlockRaw           ///< Uncoded 8x8 block.
 		};
 
+		class DecodeJob : public Common::WorkerJob {
+		public:
+			DecodeJob(BinkVideoTrack *track) : _track(track) {}
+			void run() { _track->decodeFrame(); }
+
+		private:
+			BinkVideoTrack *_track;
+		};
+
 		/** Data structure for decoding and tranlating Huffman'd data. */
 		struct Huffman {
 			int  index;       ///< Index of the Huffman codebook to use.
@@ -233,6 +263,8 @@ private:
 		int _frameCount;
 
 		Graphics::Surface _surface;
+		/** The surface the pending packet is converted to, swapped with _surface once finished. */
+		Graphics::Surface _nextSurface;
 		int _surfaceWidth; ///< The actual surface width
 		int _surfaceHeight; ///< The actual surface height
 
@@ -245,7 +277,7 @@ private:
 
 		Bundle _bundles[kSourceMAX]; ///< Bundles for decoding all data types.
 
-		Common::Huffman *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
+		Common::Huffman<Common::BitStreamMemory32LELSB> *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
 
 		/** Huffman codebooks to use for decoding high nibbles in color data types. */
 		Huffman _colHighHuffman[16];
@@ -255,6 +287,16 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		Common::WorkerPool &_pool;
+		DecodeJob _decodeJob;
+
+		bool _pendingPacket; ///< Was a packet passed to decodePacket() but not finished yet?
+		VideoFrame *_packetFrame;
+		byte *_packet;       ///< Packet data, freed by the decoding job once done.
+		uint32 _packetSize;
+
+		const DSPKernels &_dsp; ///< IDCT and block copies.
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -263,6 +305,9 @@ private:
 		/** Initialize the Huffman decoders. */
 		void initHuffman();
 
+		/** Decode the pending packet into the planes and _nextSurface. */
+		void decodeFrame();
+
 		/** Decode a plane. */
 		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
 
@@ -309,11 +354,6 @@ private:
 		void readDCS         (VideoFrame &video, Bundle &bundle, int startBits, bool hasSign);
 		void readDCTCoeffs   (VideoFrame &video, int16 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
-
-		// Bink video IDCT
-		void IDCT(int16 *block);
-		void IDCTPut(DecodeContext &ctx, int16 *block);
-		void IDCTAdd(DecodeContext &ctx, int16 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -347,10 +387,16 @@ private:
 
 	Common::SeekableReadStream *_bink;
 
+	Common::WorkerPool *_decodePool;
+	bool _decodeAhead;
+
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
 	void initAudioTrack(AudioInfo &audio);
+
+	/** Read a frame's packet, decoding its audio and passing its video on to the video track. */
+	void readPacket(VideoFrame &frame, bool decodeAhead);
 };
 
 } // End of namespace Video
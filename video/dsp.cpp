@@ -0,0 +1,777 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "video/dsp.h"
+
+#include "common/cpudetect.h"
+#include "common/util.h"
+
+#if defined(SCUMMVM_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(SCUMMVM_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Video {
+
+// Bink's IDCT is based on the one in FFmpeg
+
+#define A1  2896 /* (1/sqrt(2))<<12 */
+#define A2  2217
+#define A3  3784
+#define A4 -5352
+
+#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
+    const int a0 = (src)[s0] + (src)[s4]; \
+    const int a1 = (src)[s0] - (src)[s4]; \
+    const int a2 = (src)[s2] + (src)[s6]; \
+    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
+    const int a4 = (src)[s5] + (src)[s3]; \
+    const int a5 = (src)[s5] - (src)[s3]; \
+    const int a6 = (src)[s1] + (src)[s7]; \
+    const int a7 = (src)[s1] - (src)[s7]; \
+    const int b0 = a4 + a6; \
+    const int b1 = (A3*(a5 + a7)) >> 11; \
+    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
+    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
+    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
+    (dest)[d0] = munge(a0+a2   +b0); \
+    (dest)[d1] = munge(a1+a3-a2+b2); \
+    (dest)[d2] = munge(a1-a3+a2+b3); \
+    (dest)[d3] = munge(a0-a2   -b4); \
+    (dest)[d4] = munge(a0-a2   +b4); \
+    (dest)[d5] = munge(a1-a3+a2-b3); \
+    (dest)[d6] = munge(a1+a3-a2-b2); \
+    (dest)[d7] = munge(a0+a2   -b0); \
+}
+/* end IDCT_TRANSFORM macro */
+
+#define MUNGE_NONE(x) (x)
+#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
+
+#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
+#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
+
+// The MDEC IDCT table built with :
+// _idct8x8[x][y] = cos(((2 * x + 1) * y) * (M_PI / 16.0)) * 0.5;
+// _idct8x8[x][y] /= sqrt(2.0) if y == 0
+static const double s_idct8x8[8][8] = {
+	{ 0.353553390593274,  0.490392640201615,  0.461939766255643,  0.415734806151273,  0.353553390593274,  0.277785116509801,  0.191341716182545,  0.097545161008064 },
+	{ 0.353553390593274,  0.415734806151273,  0.191341716182545, -0.097545161008064, -0.353553390593274, -0.490392640201615, -0.461939766255643, -0.277785116509801 },
+	{ 0.353553390593274,  0.277785116509801, -0.191341716182545, -0.490392640201615, -0.353553390593274,  0.097545161008064,  0.461939766255643,  0.415734806151273 },
+	{ 0.353553390593274,  0.097545161008064, -0.461939766255643, -0.277785116509801,  0.353553390593274,  0.415734806151273, -0.191341716182545, -0.490392640201615 },
+	{ 0.353553390593274, -0.097545161008064, -0.461939766255643,  0.277785116509801,  0.353553390593274, -0.415734806151273, -0.191341716182545,  0.490392640201615 },
+	{ 0.353553390593274, -0.277785116509801, -0.191341716182545,  0.490392640201615, -0.353553390593273, -0.097545161008064,  0.461939766255643, -0.415734806151273 },
+	{ 0.353553390593274, -0.415734806151273,  0.191341716182545,  0.097545161008064, -0.353553390593274,  0.490392640201615, -0.461939766255643,  0.277785116509801 },
+	{ 0.353553390593274, -0.490392640201615,  0.461939766255643, -0.415734806151273,  0.353553390593273, -0.277785116509801,  0.191341716182545, -0.097545161008064 }
+};
+
+#pragma mark -
+#pragma mark --- Generic kernels ---
+#pragma mark -
+
+static inline void binkIDCTCol(int16 *dest, const int16 *src) {
+	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
+		dest[ 0] =
+		dest[ 8] =
+		dest[16] =
+		dest[24] =
+		dest[32] =
+		dest[40] =
+		dest[48] =
+		dest[56] = src[0];
+	} else {
+		IDCT_COL(dest, src);
+	}
+}
+
+static void binkIDCTScalar(int16 *block) {
+	int16 temp[64];
+
+	for (int i = 0; i < 8; i++)
+		binkIDCTCol(&temp[i], &block[i]);
+	for (int i = 0; i < 8; i++) {
+		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
+	}
+}
+
+static void binkIDCTPutScalar(byte *dst, int pitch, const int16 *block) {
+	int16 temp[64];
+
+	for (int i = 0; i < 8; i++)
+		binkIDCTCol(&temp[i], &block[i]);
+	for (int i = 0; i < 8; i++) {
+		IDCT_ROW( (&dst[i*pitch]), (&temp[8*i]) );
+	}
+}
+
+static void add8x8Scalar(byte *dst, int pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dst += pitch, block += 8)
+		for (int j = 0; j < 8; j++)
+			dst[j] += block[j];
+}
+
+static void binkIDCTAddScalar(byte *dst, int pitch, const int16 *block) {
+	int16 temp[64];
+	memcpy(temp, block, sizeof(temp));
+
+	binkIDCTScalar(temp);
+	add8x8Scalar(dst, pitch, temp);
+}
+
+static void copy8x8Scalar(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++, dst += pitch, src += pitch)
+		memcpy(dst, src, 8);
+}
+
+static void copy16x16Scalar(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 16; i++, dst += pitch, src += pitch)
+		memcpy(dst, src, 16);
+}
+
+static void pattern8x8Scalar(byte *dst, int pitch, const byte *patterns, byte color0, byte color1) {
+	const byte colors[2] = { color0, color1 };
+
+	for (int i = 0; i < 8; i++, dst += pitch) {
+		byte v = patterns[i];
+
+		for (int j = 0; j < 8; j++, v >>= 1)
+			dst[j] = colors[v & 1];
+	}
+}
+
+static void mdecIDCTScalar(float *result, const float *block) {
+	// IDCT code based on JPEG's IDCT code
+	// TODO: Switch to the integer-based one mentioned in the docs
+
+	float tmp[8 * 8];
+
+	// Apply 1D IDCT to rows
+	for (int y = 0; y < 8; y++) {
+		for (int x = 0; x < 8; x++) {
+			tmp[y + x * 8] = block[0] * s_idct8x8[x][0]
+							+ block[1] * s_idct8x8[x][1]
+							+ block[2] * s_idct8x8[x][2]
+							+ block[3] * s_idct8x8[x][3]
+							+ block[4] * s_idct8x8[x][4]
+							+ block[5] * s_idct8x8[x][5]
+							+ block[6] * s_idct8x8[x][6]
+							+ block[7] * s_idct8x8[x][7];
+		}
+
+		block += 8;
+	}
+
+	// Apply 1D IDCT to columns
+	for (int x = 0; x < 8; x++) {
+		const float *u = tmp + x * 8;
+		for (int y = 0; y < 8; y++) {
+			result[y * 8 + x] = u[0] * s_idct8x8[y][0]
+								+ u[1] * s_idct8x8[y][1]
+								+ u[2] * s_idct8x8[y][2]
+								+ u[3] * s_idct8x8[y][3]
+								+ u[4] * s_idct8x8[y][4]
+								+ u[5] * s_idct8x8[y][5]
+								+ u[6] * s_idct8x8[y][6]
+								+ u[7] * s_idct8x8[y][7];
+		}
+	}
+}
+
+static void putSigned8x8Scalar(byte *dst, int pitch, const float *block) {
+	for (int y = 0; y < 8; y++, dst += pitch)
+		for (int x = 0; x < 8; x++)
+			dst[x] = (int)CLIP<float>(block[y * 8 + x], -128.0f, 127.0f) + 128;
+}
+
+static const DSPKernels s_scalarKernels = {
+	binkIDCTScalar,
+	binkIDCTPutScalar,
+	binkIDCTAddScalar,
+	add8x8Scalar,
+	copy8x8Scalar,
+	copy16x16Scalar,
+	pattern8x8Scalar,
+	mdecIDCTScalar,
+	putSigned8x8Scalar
+};
+
+#if defined(SCUMMVM_SIMD_X86)
+
+#pragma mark -
+#pragma mark --- SSE2 kernels ---
+#pragma mark -
+
+/**
+ * Multiplies 32 bit values by a positive 16 bit factor, keeping the low 32
+ * bits like the scalar code. With x = xh * 2^16 + xl, the product is
+ * factor * xl plus the low 16 bits of factor * xh shifted up, and
+ * _mm_mullo_epi16 calculates the low halves of both at once.
+ */
+SCUMMVM_TARGET_SSE2 static inline __m128i mul32SSE2(__m128i x, int factor) {
+	const __m128i f = _mm_set1_epi16(factor);
+	return _mm_add_epi32(_mm_mullo_epi16(x, f), _mm_slli_epi32(_mm_mulhi_epu16(x, f), 16));
+}
+
+SCUMMVM_TARGET_SSE2 static inline __m128i mulShiftSSE2(__m128i x, int factor) {
+	if (factor < 0)
+		return _mm_srai_epi32(_mm_sub_epi32(_mm_setzero_si128(), mul32SSE2(x, -factor)), 11);
+	return _mm_srai_epi32(mul32SSE2(x, factor), 11);
+}
+
+/** IDCT_TRANSFORM on four columns or rows at once, d and s may not overlap. */
+SCUMMVM_TARGET_SSE2 static inline void binkTransformSSE2(__m128i *d, const __m128i *s) {
+	const __m128i a0 = _mm_add_epi32(s[0], s[4]);
+	const __m128i a1 = _mm_sub_epi32(s[0], s[4]);
+	const __m128i a2 = _mm_add_epi32(s[2], s[6]);
+	const __m128i a3 = mulShiftSSE2(_mm_sub_epi32(s[2], s[6]), A1);
+	const __m128i a4 = _mm_add_epi32(s[5], s[3]);
+	const __m128i a5 = _mm_sub_epi32(s[5], s[3]);
+	const __m128i a6 = _mm_add_epi32(s[1], s[7]);
+	const __m128i a7 = _mm_sub_epi32(s[1], s[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = mulShiftSSE2(_mm_add_epi32(a5, a7), A3);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(mulShiftSSE2(a5, A4), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(mulShiftSSE2(_mm_sub_epi32(a6, a4), A1), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(mulShiftSSE2(a7, A2), b3), b1);
+
+	const __m128i a02 = _mm_add_epi32(a0, a2), a0m2 = _mm_sub_epi32(a0, a2);
+	const __m128i a13 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i a1m3 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+
+	d[0] = _mm_add_epi32(a02, b0);
+	d[1] = _mm_add_epi32(a13, b2);
+	d[2] = _mm_add_epi32(a1m3, b3);
+	d[3] = _mm_sub_epi32(a0m2, b4);
+	d[4] = _mm_add_epi32(a0m2, b4);
+	d[5] = _mm_sub_epi32(a1m3, b3);
+	d[6] = _mm_sub_epi32(a13, b2);
+	d[7] = _mm_sub_epi32(a02, b0);
+}
+
+SCUMMVM_TARGET_SSE2 static inline void transpose8x8SSE2(__m128i *r) {
+	const __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]), a1 = _mm_unpackhi_epi16(r[0], r[1]);
+	const __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]), a3 = _mm_unpackhi_epi16(r[2], r[3]);
+	const __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]), a5 = _mm_unpackhi_epi16(r[4], r[5]);
+	const __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]), a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+	const __m128i b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2);
+	const __m128i b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3);
+	const __m128i b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6);
+	const __m128i b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7);
+
+	r[0] = _mm_unpacklo_epi64(b0, b4); r[1] = _mm_unpackhi_epi64(b0, b4);
+	r[2] = _mm_unpacklo_epi64(b1, b5); r[3] = _mm_unpackhi_epi64(b1, b5);
+	r[4] = _mm_unpacklo_epi64(b2, b6); r[5] = _mm_unpackhi_epi64(b2, b6);
+	r[6] = _mm_unpacklo_epi64(b3, b7); r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/** Truncates two vectors of 32 bit values to 16 bits and packs them. */
+SCUMMVM_TARGET_SSE2 static inline __m128i pack16SSE2(__m128i lo, __m128i hi) {
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+/**
+ * One pass of Bink's IDCT over all eight lanes, which are the columns, or
+ * the rows once the block was transposed.
+ */
+SCUMMVM_TARGET_SSE2 static inline void binkPassSSE2(__m128i *r, bool rows) {
+	__m128i lo[8], hi[8], dLo[8], dHi[8];
+
+	for (int i = 0; i < 8; i++) {
+		lo[i] = _mm_srai_epi32(_mm_unpacklo_epi16(r[i], r[i]), 16);
+		hi[i] = _mm_srai_epi32(_mm_unpackhi_epi16(r[i], r[i]), 16);
+	}
+
+	binkTransformSSE2(dLo, lo);
+	binkTransformSSE2(dHi, hi);
+
+	if (rows) {
+		const __m128i round = _mm_set1_epi32(0x7F);
+		for (int i = 0; i < 8; i++) {
+			dLo[i] = _mm_srai_epi32(_mm_add_epi32(dLo[i], round), 8);
+			dHi[i] = _mm_srai_epi32(_mm_add_epi32(dHi[i], round), 8);
+		}
+	}
+
+	for (int i = 0; i < 8; i++)
+		r[i] = pack16SSE2(dLo[i], dHi[i]);
+}
+
+/** Bink's IDCT, returning the rows of the result truncated to 16 bits. */
+SCUMMVM_TARGET_SSE2 static inline void binkIDCTRowsSSE2(__m128i *r, const int16 *block) {
+	for (int i = 0; i < 8; i++)
+		r[i] = _mm_loadu_si128((const __m128i *)(block + 8 * i));
+
+	// The columns, the transform works on each lane
+	binkPassSSE2(r, false);
+
+	// The rows, after which the lanes have to be turned back into columns
+	transpose8x8SSE2(r);
+	binkPassSSE2(r, true);
+	transpose8x8SSE2(r);
+}
+
+SCUMMVM_TARGET_SSE2 static void binkIDCTSSE2(int16 *block) {
+	__m128i r[8];
+	binkIDCTRowsSSE2(r, block);
+
+	for (int i = 0; i < 8; i++)
+		_mm_storeu_si128((__m128i *)(block + 8 * i), r[i]);
+}
+
+/** Stores the low bytes of the rows of a block. */
+SCUMMVM_TARGET_SSE2 static inline void putRowsSSE2(byte *dst, int pitch, const __m128i *r) {
+	const __m128i lowByte = _mm_set1_epi16(0xFF);
+	for (int i = 0; i < 8; i++, dst += pitch)
+		_mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(_mm_and_si128(r[i], lowByte), _mm_setzero_si128()));
+}
+
+SCUMMVM_TARGET_SSE2 static inline void addRowSSE2(byte *dst, __m128i row) {
+	const __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dst), _mm_setzero_si128());
+	const __m128i sum = _mm_and_si128(_mm_add_epi16(pixels, row), _mm_set1_epi16(0xFF));
+	_mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(sum, _mm_setzero_si128()));
+}
+
+SCUMMVM_TARGET_SSE2 static void binkIDCTPutSSE2(byte *dst, int pitch, const int16 *block) {
+	__m128i r[8];
+	binkIDCTRowsSSE2(r, block);
+	putRowsSSE2(dst, pitch, r);
+}
+
+SCUMMVM_TARGET_SSE2 static void binkIDCTAddSSE2(byte *dst, int pitch, const int16 *block) {
+	__m128i r[8];
+	binkIDCTRowsSSE2(r, block);
+
+	for (int i = 0; i < 8; i++, dst += pitch)
+		addRowSSE2(dst, r[i]);
+}
+
+SCUMMVM_TARGET_SSE2 static void add8x8SSE2(byte *dst, int pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dst += pitch, block += 8)
+		addRowSSE2(dst, _mm_loadu_si128((const __m128i *)block));
+}
+
+SCUMMVM_TARGET_SSE2 static void copy8x8SSE2(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++, dst += pitch, src += pitch)
+		_mm_storel_epi64((__m128i *)dst, _mm_loadl_epi64((const __m128i *)src));
+}
+
+SCUMMVM_TARGET_SSE2 static void copy16x16SSE2(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 16; i++, dst += pitch, src += pitch)
+		_mm_storeu_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+}
+
+SCUMMVM_TARGET_SSE2 static void pattern8x8SSE2(byte *dst, int pitch, const byte *patterns, byte color0, byte color1) {
+	const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	const __m128i c0 = _mm_set1_epi8((char)color0);
+	const __m128i c1 = _mm_set1_epi8((char)color1);
+
+	// Two rows at a time
+	for (int i = 0; i < 8; i += 2, dst += 2 * pitch) {
+		const __m128i v = _mm_unpacklo_epi64(_mm_set1_epi8((char)patterns[i]), _mm_set1_epi8((char)patterns[i + 1]));
+		const __m128i mask = _mm_cmpeq_epi8(_mm_and_si128(v, bits), bits);
+		const __m128i result = _mm_or_si128(_mm_and_si128(mask, c1), _mm_andnot_si128(mask, c0));
+
+		_mm_storel_epi64((__m128i *)dst, result);
+		_mm_storel_epi64((__m128i *)(dst + pitch), _mm_srli_si128(result, 8));
+	}
+}
+
+/**
+ * One pass of the MDEC IDCT, transforming the rows of src into the columns
+ * of dst. Like the scalar code, the sums are calculated in double precision
+ * from left to right and rounded to float at the end, which keeps the
+ * results bit exact.
+ */
+SCUMMVM_TARGET_SSE2 static inline void mdecPassSSE2(float *dst, const float *src) {
+	// Two rows at a time, which end up next to each other in dst
+	for (int p = 0; p < 8; p += 2) {
+		__m128d in[8];
+		for (int k = 0; k < 8; k++)
+			in[k] = _mm_cvtps_pd(_mm_setr_ps(src[p * 8 + k], src[(p + 1) * 8 + k], 0.0f, 0.0f));
+
+		for (int x = 0; x < 8; x++) {
+			__m128d sum = _mm_mul_pd(in[0], _mm_set1_pd(s_idct8x8[x][0]));
+			for (int k = 1; k < 8; k++)
+				sum = _mm_add_pd(sum, _mm_mul_pd(in[k], _mm_set1_pd(s_idct8x8[x][k])));
+
+			_mm_storel_pi((__m64 *)(dst + x * 8 + p), _mm_cvtpd_ps(sum));
+		}
+	}
+}
+
+SCUMMVM_TARGET_SSE2 static void mdecIDCTSSE2(float *result, const float *block) {
+	float tmp[8 * 8];
+
+	// The rows, then the columns which are the rows of tmp
+	mdecPassSSE2(tmp, block);
+	mdecPassSSE2(result, tmp);
+}
+
+SCUMMVM_TARGET_SSE2 static void putSigned8x8SSE2(byte *dst, int pitch, const float *block) {
+	const __m128 minValue = _mm_set1_ps(-128.0f);
+	const __m128 maxValue = _mm_set1_ps(127.0f);
+	const __m128i offset = _mm_set1_epi32(128);
+
+	for (int y = 0; y < 8; y++, dst += pitch, block += 8) {
+		const __m128 lo = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(block), minValue), maxValue);
+		const __m128 hi = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(block + 4), minValue), maxValue);
+		const __m128i words = _mm_packs_epi32(_mm_add_epi32(_mm_cvttps_epi32(lo), offset), _mm_add_epi32(_mm_cvttps_epi32(hi), offset));
+		_mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(words, _mm_setzero_si128()));
+	}
+}
+
+static const DSPKernels s_sse2Kernels = {
+	binkIDCTSSE2,
+	binkIDCTPutSSE2,
+	binkIDCTAddSSE2,
+	add8x8SSE2,
+	copy8x8SSE2,
+	copy16x16SSE2,
+	pattern8x8SSE2,
+	mdecIDCTSSE2,
+	putSigned8x8SSE2
+};
+
+#pragma mark -
+#pragma mark --- AVX2 kernels ---
+#pragma mark -
+
+// AVX2 has a 32 bit multiplication and twice the lanes, which is what
+// Bink's IDCT needs. The other kernels are the SSE2 ones.
+
+SCUMMVM_TARGET_AVX2 static inline __m256i mulShiftAVX2(__m256i x, int factor) {
+	return _mm256_srai_epi32(_mm256_mullo_epi32(x, _mm256_set1_epi32(factor)), 11);
+}
+
+/** IDCT_TRANSFORM on all eight columns or rows at once, d and s may not overlap. */
+SCUMMVM_TARGET_AVX2 static inline void binkTransformAVX2(__m256i *d, const __m256i *s) {
+	const __m256i a0 = _mm256_add_epi32(s[0], s[4]);
+	const __m256i a1 = _mm256_sub_epi32(s[0], s[4]);
+	const __m256i a2 = _mm256_add_epi32(s[2], s[6]);
+	const __m256i a3 = mulShiftAVX2(_mm256_sub_epi32(s[2], s[6]), A1);
+	const __m256i a4 = _mm256_add_epi32(s[5], s[3]);
+	const __m256i a5 = _mm256_sub_epi32(s[5], s[3]);
+	const __m256i a6 = _mm256_add_epi32(s[1], s[7]);
+	const __m256i a7 = _mm256_sub_epi32(s[1], s[7]);
+	const __m256i b0 = _mm256_add_epi32(a4, a6);
+	const __m256i b1 = mulShiftAVX2(_mm256_add_epi32(a5, a7), A3);
+	const __m256i b2 = _mm256_add_epi32(_mm256_sub_epi32(mulShiftAVX2(a5, A4), b0), b1);
+	const __m256i b3 = _mm256_sub_epi32(mulShiftAVX2(_mm256_sub_epi32(a6, a4), A1), b2);
+	const __m256i b4 = _mm256_sub_epi32(_mm256_add_epi32(mulShiftAVX2(a7, A2), b3), b1);
+
+	const __m256i a02 = _mm256_add_epi32(a0, a2), a0m2 = _mm256_sub_epi32(a0, a2);
+	const __m256i a13 = _mm256_sub_epi32(_mm256_add_epi32(a1, a3), a2);
+	const __m256i a1m3 = _mm256_add_epi32(_mm256_sub_epi32(a1, a3), a2);
+
+	d[0] = _mm256_add_epi32(a02, b0);
+	d[1] = _mm256_add_epi32(a13, b2);
+	d[2] = _mm256_add_epi32(a1m3, b3);
+	d[3] = _mm256_sub_epi32(a0m2, b4);
+	d[4] = _mm256_add_epi32(a0m2, b4);
+	d[5] = _mm256_sub_epi32(a1m3, b3);
+	d[6] = _mm256_sub_epi32(a13, b2);
+	d[7] = _mm256_sub_epi32(a02, b0);
+}
+
+SCUMMVM_TARGET_AVX2 static inline void binkPassAVX2(__m128i *r, bool rows) {
+	__m256i s[8], d[8];
+
+	for (int i = 0; i < 8; i++)
+		s[i] = _mm256_cvtepi16_epi32(r[i]);
+
+	binkTransformAVX2(d, s);
+
+	for (int i = 0; i < 8; i++) {
+		if (rows)
+			d[i] = _mm256_srai_epi32(_mm256_add_epi32(d[i], _mm256_set1_epi32(0x7F)), 8);
+
+		const __m256i w = _mm256_srai_epi32(_mm256_slli_epi32(d[i], 16), 16);
+		r[i] = _mm_packs_epi32(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1));
+	}
+}
+
+SCUMMVM_TARGET_AVX2 static inline void binkIDCTRowsAVX2(__m128i *r, const int16 *block) {
+	for (int i = 0; i < 8; i++)
+		r[i] = _mm_loadu_si128((const __m128i *)(block + 8 * i));
+
+	binkPassAVX2(r, false);
+
+	transpose8x8SSE2(r);
+	binkPassAVX2(r, true);
+	transpose8x8SSE2(r);
+}
+
+SCUMMVM_TARGET_AVX2 static void binkIDCTAVX2(int16 *block) {
+	__m128i r[8];
+	binkIDCTRowsAVX2(r, block);
+
+	for (int i = 0; i < 8; i++)
+		_mm_storeu_si128((__m128i *)(block + 8 * i), r[i]);
+}
+
+SCUMMVM_TARGET_AVX2 static void binkIDCTPutAVX2(byte *dst, int pitch, const int16 *block) {
+	__m128i r[8];
+	binkIDCTRowsAVX2(r, block);
+	putRowsSSE2(dst, pitch, r);
+}
+
+SCUMMVM_TARGET_AVX2 static void binkIDCTAddAVX2(byte *dst, int pitch, const int16 *block) {
+	__m128i r[8];
+	binkIDCTRowsAVX2(r, block);
+
+	for (int i = 0; i < 8; i++, dst += pitch)
+		addRowSSE2(dst, r[i]);
+}
+
+static const DSPKernels s_avx2Kernels = {
+	binkIDCTAVX2,
+	binkIDCTPutAVX2,
+	binkIDCTAddAVX2,
+	add8x8SSE2,
+	copy8x8SSE2,
+	copy16x16SSE2,
+	pattern8x8SSE2,
+	mdecIDCTSSE2,
+	putSigned8x8SSE2
+};
+
+#endif // SCUMMVM_SIMD_X86
+
+#if defined(SCUMMVM_SIMD_NEON)
+
+#pragma mark -
+#pragma mark --- NEON kernels ---
+#pragma mark -
+
+/** IDCT_TRANSFORM on four columns or rows at once, d and s may not overlap. */
+static inline void binkTransformNEON(int32x4_t *d, const int32x4_t *s) {
+	const int32x4_t a0 = vaddq_s32(s[0], s[4]);
+	const int32x4_t a1 = vsubq_s32(s[0], s[4]);
+	const int32x4_t a2 = vaddq_s32(s[2], s[6]);
+	const int32x4_t a3 = vshrq_n_s32(vmulq_n_s32(vsubq_s32(s[2], s[6]), A1), 11);
+	const int32x4_t a4 = vaddq_s32(s[5], s[3]);
+	const int32x4_t a5 = vsubq_s32(s[5], s[3]);
+	const int32x4_t a6 = vaddq_s32(s[1], s[7]);
+	const int32x4_t a7 = vsubq_s32(s[1], s[7]);
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = vshrq_n_s32(vmulq_n_s32(vaddq_s32(a5, a7), A3), 11);
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(vshrq_n_s32(vmulq_n_s32(a5, A4), 11), b0), b1);
+	const int32x4_t b3 = vsubq_s32(vshrq_n_s32(vmulq_n_s32(vsubq_s32(a6, a4), A1), 11), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(vshrq_n_s32(vmulq_n_s32(a7, A2), 11), b3), b1);
+
+	const int32x4_t a02 = vaddq_s32(a0, a2), a0m2 = vsubq_s32(a0, a2);
+	const int32x4_t a13 = vsubq_s32(vaddq_s32(a1, a3), a2);
+	const int32x4_t a1m3 = vaddq_s32(vsubq_s32(a1, a3), a2);
+
+	d[0] = vaddq_s32(a02, b0);
+	d[1] = vaddq_s32(a13, b2);
+	d[2] = vaddq_s32(a1m3, b3);
+	d[3] = vsubq_s32(a0m2, b4);
+	d[4] = vaddq_s32(a0m2, b4);
+	d[5] = vsubq_s32(a1m3, b3);
+	d[6] = vsubq_s32(a13, b2);
+	d[7] = vsubq_s32(a02, b0);
+}
+
+static inline void transpose8x8NEON(int16x8_t *r) {
+	const int16x8x2_t t01 = vtrnq_s16(r[0], r[1]);
+	const int16x8x2_t t23 = vtrnq_s16(r[2], r[3]);
+	const int16x8x2_t t45 = vtrnq_s16(r[4], r[5]);
+	const int16x8x2_t t67 = vtrnq_s16(r[6], r[7]);
+
+	const int32x4x2_t u02 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[0]), vreinterpretq_s32_s16(t23.val[0]));
+	const int32x4x2_t u13 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[1]), vreinterpretq_s32_s16(t23.val[1]));
+	const int32x4x2_t u46 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[0]), vreinterpretq_s32_s16(t67.val[0]));
+	const int32x4x2_t u57 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[1]), vreinterpretq_s32_s16(t67.val[1]));
+
+	r[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u02.val[0]), vget_low_s32(u46.val[0])));
+	r[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u13.val[0]), vget_low_s32(u57.val[0])));
+	r[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u02.val[1]), vget_low_s32(u46.val[1])));
+	r[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u13.val[1]), vget_low_s32(u57.val[1])));
+	r[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u02.val[0]), vget_high_s32(u46.val[0])));
+	r[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u13.val[0]), vget_high_s32(u57.val[0])));
+	r[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u02.val[1]), vget_high_s32(u46.val[1])));
+	r[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u13.val[1]), vget_high_s32(u57.val[1])));
+}
+
+static inline void binkPassNEON(int16x8_t *r, bool rows) {
+	int32x4_t lo[8], hi[8], dLo[8], dHi[8];
+
+	for (int i = 0; i < 8; i++) {
+		lo[i] = vmovl_s16(vget_low_s16(r[i]));
+		hi[i] = vmovl_s16(vget_high_s16(r[i]));
+	}
+
+	binkTransformNEON(dLo, lo);
+	binkTransformNEON(dHi, hi);
+
+	if (rows) {
+		const int32x4_t round = vdupq_n_s32(0x7F);
+		for (int i = 0; i < 8; i++) {
+			dLo[i] = vshrq_n_s32(vaddq_s32(dLo[i], round), 8);
+			dHi[i] = vshrq_n_s32(vaddq_s32(dHi[i], round), 8);
+		}
+	}
+
+	// Narrowing truncates to 16 bits, like storing to an int16 does
+	for (int i = 0; i < 8; i++)
+		r[i] = vcombine_s16(vmovn_s32(dLo[i]), vmovn_s32(dHi[i]));
+}
+
+static inline void binkIDCTRowsNEON(int16x8_t *r, const int16 *block) {
+	for (int i = 0; i < 8; i++)
+		r[i] = vld1q_s16(block + 8 * i);
+
+	binkPassNEON(r, false);
+
+	transpose8x8NEON(r);
+	binkPassNEON(r, true);
+	transpose8x8NEON(r);
+}
+
+static void binkIDCTNEON(int16 *block) {
+	int16x8_t r[8];
+	binkIDCTRowsNEON(r, block);
+
+	for (int i = 0; i < 8; i++)
+		vst1q_s16(block + 8 * i, r[i]);
+}
+
+static void binkIDCTPutNEON(byte *dst, int pitch, const int16 *block) {
+	int16x8_t r[8];
+	binkIDCTRowsNEON(r, block);
+
+	for (int i = 0; i < 8; i++, dst += pitch)
+		vst1_u8(dst, vmovn_u16(vreinterpretq_u16_s16(r[i])));
+}
+
+static inline void addRowNEON(byte *dst, int16x8_t row) {
+	const int16x8_t sum = vaddq_s16(row, vreinterpretq_s16_u16(vmovl_u8(vld1_u8(dst))));
+	vst1_u8(dst, vmovn_u16(vreinterpretq_u16_s16(sum)));
+}
+
+static void binkIDCTAddNEON(byte *dst, int pitch, const int16 *block) {
+	int16x8_t r[8];
+	binkIDCTRowsNEON(r, block);
+
+	for (int i = 0; i < 8; i++, dst += pitch)
+		addRowNEON(dst, r[i]);
+}
+
+static void add8x8NEON(byte *dst, int pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dst += pitch, block += 8)
+		addRowNEON(dst, vld1q_s16(block));
+}
+
+static void copy8x8NEON(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++, dst += pitch, src += pitch)
+		vst1_u8(dst, vld1_u8(src));
+}
+
+static void copy16x16NEON(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 16; i++, dst += pitch, src += pitch)
+		vst1q_u8(dst, vld1q_u8(src));
+}
+
+static void pattern8x8NEON(byte *dst, int pitch, const byte *patterns, byte color0, byte color1) {
+	static const uint8 kBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint8x16_t bits = vld1q_u8(kBits);
+	const uint8x16_t c0 = vdupq_n_u8(color0);
+	const uint8x16_t c1 = vdupq_n_u8(color1);
+
+	// Two rows at a time
+	for (int i = 0; i < 8; i += 2, dst += 2 * pitch) {
+		const uint8x16_t v = vcombine_u8(vdup_n_u8(patterns[i]), vdup_n_u8(patterns[i + 1]));
+		const uint8x16_t result = vbslq_u8(vtstq_u8(v, bits), c1, c0);
+
+		vst1_u8(dst, vget_low_u8(result));
+		vst1_u8(dst + pitch, vget_high_u8(result));
+	}
+}
+
+static void putSigned8x8NEON(byte *dst, int pitch, const float *block) {
+	const float32x4_t minValue = vdupq_n_f32(-128.0f);
+	const float32x4_t maxValue = vdupq_n_f32(127.0f);
+	const int32x4_t offset = vdupq_n_s32(128);
+
+	for (int y = 0; y < 8; y++, dst += pitch, block += 8) {
+		const float32x4_t lo = vminq_f32(vmaxq_f32(vld1q_f32(block), minValue), maxValue);
+		const float32x4_t hi = vminq_f32(vmaxq_f32(vld1q_f32(block + 4), minValue), maxValue);
+		const int16x8_t words = vcombine_s16(vmovn_s32(vaddq_s32(vcvtq_s32_f32(lo), offset)), vmovn_s32(vaddq_s32(vcvtq_s32_f32(hi), offset)));
+		vst1_u8(dst, vmovn_u16(vreinterpretq_u16_s16(words)));
+	}
+}
+
+// 32 bit ARM has no double precision NEON, which the MDEC IDCT needs to
+// stay bit exact, so that one is left to the scalar code
+static const DSPKernels s_neonKernels = {
+	binkIDCTNEON,
+	binkIDCTPutNEON,
+	binkIDCTAddNEON,
+	add8x8NEON,
+	copy8x8NEON,
+	copy16x16NEON,
+	pattern8x8NEON,
+	mdecIDCTScalar,
+	putSigned8x8NEON
+};
+
+#endif // SCUMMVM_SIMD_NEON
+
+#pragma mark -
+
+const DSPKernels *getDSPKernels(DSPKernelType type) {
+	switch (type) {
+	case kDSPKernelsScalar:
+		return &s_scalarKernels;
+#if defined(SCUMMVM_SIMD_X86)
+	case kDSPKernelsSSE2:
+		return Common::hasCPUFeature(Common::kCPUFeatureSSE2) ? &s_sse2Kernels : 0;
+	case kDSPKernelsAVX2:
+		return Common::hasCPUFeature(Common::kCPUFeatureAVX2) ? &s_avx2Kernels : 0;
+#endif
+#if defined(SCUMMVM_SIMD_NEON)
+	case kDSPKernelsNEON:
+		return Common::hasCPUFeature(Common::kCPUFeatureNEON) ? &s_neonKernels : 0;
+#endif
+	default:
+		return 0;
+	}
+}
+
+const DSPKernels &getBestDSPKernels() {
+	for (int type = kDSPKernelsCount - 1; type > kDSPKernelsScalar; --type) {
+		const DSPKernels *kernels = getDSPKernels((DSPKernelType)type);
+		if (kernels)
+			return *kernels;
+	}
+
+	return s_scalarKernels;
+}
+
+} // End of namespace Video
@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef VIDEO_DSP_H
+#define VIDEO_DSP_H
+
+#include "common/scummsys.h"
+
+namespace Video {
+
+/**
+ * The 8x8 block operations of the video decoders, in a plain C++ version
+ * and, where available, SIMD versions. All versions produce the same
+ * results.
+ *
+ * Bink's integer IDCT keeps the wrap-around arithmetic of the decoder it
+ * was taken from: results are truncated to 16 bits between the passes and
+ * to 8 bits when written to a plane. Only the MDEC output is saturated.
+ */
+struct DSPKernels {
+	/** Bink's integer IDCT, transforming the coefficients in place. */
+	void (*binkIDCT)(int16 *block);
+	/** Bink's integer IDCT, storing the result to dst. */
+	void (*binkIDCTPut)(byte *dst, int pitch, const int16 *block);
+	/** Bink's integer IDCT, adding the result to dst. */
+	void (*binkIDCTAdd)(byte *dst, int pitch, const int16 *block);
+
+	/** Add a block of differences to dst, wrapping around. */
+	void (*add8x8)(byte *dst, int pitch, const int16 *block);
+	/** Copy an 8x8 block between two planes with the same pitch, e.g. for motion compensation. */
+	void (*copy8x8)(byte *dst, const byte *src, int pitch);
+	/** Copy a 16x16 block between two planes with the same pitch. */
+	void (*copy16x16)(byte *dst, const byte *src, int pitch);
+	/**
+	 * Fill an 8x8 block with two colors. Bit i of the pattern byte of a row
+	 * selects color1 over color0 for column i.
+	 */
+	void (*pattern8x8)(byte *dst, int pitch, const byte *patterns, byte color0, byte color1);
+
+	/** The floating point IDCT of the PlayStation MDEC. */
+	void (*mdecIDCT)(float *result, const float *block);
+	/** Store samples in [-128, 127] to dst as bytes, saturating those outside. */
+	void (*putSigned8x8)(byte *dst, int pitch, const float *block);
+};
+
+enum DSPKernelType {
+	kDSPKernelsScalar,
+	kDSPKernelsSSE2,
+	kDSPKernelsAVX2,
+	kDSPKernelsNEON,
+
+	kDSPKernelsCount
+};
+
+/**
+ * Returns the given kernel implementation, or 0 if it is not supported by
+ * the CPU or was not compiled in.
+ */
+const DSPKernels *getDSPKernels(DSPKernelType type);
+
+/**
+ * Returns the fastest kernel implementation supported by the CPU.
+ */
+const DSPKernels &getBestDSPKernels();
+
+} // End of namespace Video
+
+#endif